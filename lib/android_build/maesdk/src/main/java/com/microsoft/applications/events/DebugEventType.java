@@ -26,6 +26,8 @@ public enum DebugEventType {
 
   /// <summary>Event(s) added to queue.</summary>
   EVT_ADDED(0x01001000L),
+  /// <summary>Incoming event queue is full, backpressure policy applied.</summary>
+  EVT_INGEST_OVERFLOW(0x01001001L),
   /// <summary>Event(s) cached in offline storage.</summary>
   EVT_CACHED(0x02000000L),
   /// <summary>Event(s) dropped.</summary>
@@ -45,6 +47,8 @@ public enum DebugEventType {
   EVT_SEND_RETRY_DROPPED(0x04000003L),
   /// <summary>Event(s) skip UTC registration.</summary>
   EVT_SEND_SKIP_UTC_REGISTRATION(0x04000004L),
+  /// <summary>Adaptive upload controller updated.</summary>
+  EVT_UPLOAD_CONTROL(0x04000005L),
   /// <summary>Event(s) rejectedL), e.g.
   /// Failed regexp check or missing event name.
   /// </summary>
@@ -42,17 +42,98 @@ namespace MAT_NS_BEGIN
         m_customContextFields = copy.m_customContextFields;
         m_commonContextEventToConfigIds = copy.m_commonContextEventToConfigIds;
         m_ticketsMap = copy.m_ticketsMap;
+        LOCKGUARD(m_lock);
+        invalidateLocked();
         return *this;
     }
 
     void ContextFieldsProvider::writeToRecord(::CsProtocol::Record& record, bool commonOnly)
     {
+        // Records coming straight from the Logger have no Part A yet and get a
+        // copy of the prebuilt one, anything else is merged field by field.
+        if (record.data.empty() && record.extApp.empty() && record.extDevice.empty() &&
+            record.extOs.empty() && record.extUser.empty() && record.extLoc.empty() &&
+            record.extNet.empty() && record.extProtocol.empty() && record.extM365a.empty())
+        {
+            std::shared_ptr<const PartA> partA = getPartA();
+            record.extApp = partA->record.extApp;
+            record.extDevice = partA->record.extDevice;
+            record.extOs = partA->record.extOs;
+            record.extUser = partA->record.extUser;
+            record.extLoc = partA->record.extLoc;
+            record.extNet = partA->record.extNet;
+            record.extProtocol = partA->record.extProtocol;
+            record.extM365a = partA->record.extM365a;
+            record.data = commonOnly ? partA->record.data : partA->allData;
+
+            // for ECS set event specific config ids
+            if (!partA->eventToConfigIds.empty() && !record.name.empty())
+            {
+                const auto& iter = partA->eventToConfigIds.find(record.name);
+                if (iter != partA->eventToConfigIds.end())
+                {
+                    record.extApp[0].expId = iter->second;
+                }
+            }
+            LOG_TRACE("Record=%p decorated with SemanticContext=%p", &record, this);
+            return;
+        }
+
         // Append parent scope context variables if not detached from parent
         if (m_parent)
         {
             m_parent->writeToRecord(record);
         }
 
+        LOCKGUARD(m_lock);
+        writeFieldsToRecordLocked(record, commonOnly);
+    }
+
+    std::shared_ptr<const ContextFieldsProvider::PartA> ContextFieldsProvider::getPartA()
+    {
+        // Parent first, so that parent and child locks are never held together
+        std::shared_ptr<const PartA> parentPartA = m_parent ? m_parent->getPartA() : nullptr;
+
+        LOCKGUARD(m_lock);
+        if (m_partA && (m_partAVersion == m_version) && (m_partAParent == parentPartA))
+        {
+            return m_partA;
+        }
+
+        auto partA = std::make_shared<PartA>();
+        if (parentPartA)
+        {
+            partA->record = parentPartA->record;
+            partA->record.data = parentPartA->allData;
+            partA->eventToConfigIds = parentPartA->eventToConfigIds;
+        }
+
+        ::CsProtocol::Record full = partA->record;
+        writeFieldsToRecordLocked(full, false);
+        writeFieldsToRecordLocked(partA->record, true);
+        partA->allData = std::move(full.data);
+
+        // Experiment ids of the innermost context that has any win
+        auto iter = m_commonContextFields.find(COMMONFIELDS_APP_EXPERIMENTIDS);
+        if ((iter != m_commonContextFields.end()) && !std::string(iter->second.as_string).empty())
+        {
+            partA->eventToConfigIds = m_commonContextEventToConfigIds;
+        }
+
+        LOG_TRACE("SemanticContext=%p rebuilt Part A, version %llu", this, static_cast<unsigned long long>(m_version));
+        m_partA = partA;
+        m_partAParent = parentPartA;
+        m_partAVersion = m_version;
+        return m_partA;
+    }
+
+    void ContextFieldsProvider::invalidateLocked()
+    {
+        m_version++;
+    }
+
+    void ContextFieldsProvider::writeFieldsToRecordLocked(::CsProtocol::Record& record, bool commonOnly)
+    {
         if (record.data.size() == 0)
         {
             ::CsProtocol::Data data;
@@ -106,11 +187,10 @@ namespace MAT_NS_BEGIN
             record.extM365a.push_back(m365a);
         }
 
-        std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
+        ::CsProtocol::PropertyMap& ext = record.data[0].properties;
         {
-            LOCKGUARD(m_lock);
-
-            std::string value = m_commonContextFields[COMMONFIELDS_APP_EXPERIMENTIDS].as_string;
+            auto expIter = m_commonContextFields.find(COMMONFIELDS_APP_EXPERIMENTIDS);
+            std::string value = (expIter != m_commonContextFields.end()) ? expIter->second.as_string : std::string();
             if (!value.empty())
             {// for ECS set event specific config ids
                 std::string eventName = record.name;
@@ -409,7 +489,9 @@ namespace MAT_NS_BEGIN
         SetCommonField(COMMONFIELDS_APP_EXPERIMENTIDS, "");
 
         // Clear the map of all ExperimentsIds (that's associated with event)
+        LOCKGUARD(m_lock);
         m_commonContextEventToConfigIds.clear();
+        invalidateLocked();
     }
 
     void ContextFieldsProvider::SetEventExperimentIds(std::string const& eventName, std::string const& experimentIds)
@@ -420,6 +502,7 @@ namespace MAT_NS_BEGIN
         }
 
         std::string eventNameNormalized = toLower(eventName);
+        LOCKGUARD(m_lock);
         if (!experimentIds.empty())
         {
             m_commonContextEventToConfigIds[eventNameNormalized] = experimentIds;
@@ -428,18 +511,21 @@ namespace MAT_NS_BEGIN
         {
             m_commonContextEventToConfigIds.erase(eventNameNormalized);
         }
+        invalidateLocked();
     }
 
     void ContextFieldsProvider::SetCommonField(const std::string& name, const EventProperty& value)
     {
         LOCKGUARD(m_lock);
         m_commonContextFields[name] = value;
+        invalidateLocked();
     }
 
     void ContextFieldsProvider::SetCustomField(const std::string& name, const EventProperty& value)
     {
         LOCKGUARD(m_lock);
         m_customContextFields[name] = value;
+        invalidateLocked();
     }
 
     void ContextFieldsProvider::SetTicket(TicketType type, const std::string& ticketValue)
@@ -448,23 +534,42 @@ namespace MAT_NS_BEGIN
         if (!ticketValue.empty())
         {
             m_ticketsMap[type] = ticketValue;
+            invalidateLocked();
         }
     }
 
     void ContextFieldsProvider::SetParentContext(ContextFieldsProvider* parent)
     {
+        LOCKGUARD(m_lock);
         m_parent = parent;
+        invalidateLocked();
     }
 
-    std::map<std::string, EventProperty>& ContextFieldsProvider::GetCommonFields()
+    const std::map<std::string, EventProperty>& ContextFieldsProvider::GetCommonFields()
     {
+        LOCKGUARD(m_lock);
         return m_commonContextFields;
     }
 
-    std::map<std::string, EventProperty>& ContextFieldsProvider::GetCustomFields()
+    const std::map<std::string, EventProperty>& ContextFieldsProvider::GetCustomFields()
     {
+        LOCKGUARD(m_lock);
         return m_customContextFields;
     }
 
+    void ContextFieldsProvider::ClearCommonFields()
+    {
+        LOCKGUARD(m_lock);
+        m_commonContextFields.clear();
+        invalidateLocked();
+    }
+
+    void ContextFieldsProvider::ClearCustomFields()
+    {
+        LOCKGUARD(m_lock);
+        m_customContextFields.clear();
+        invalidateLocked();
+    }
+
 } MAT_NS_END
 
@@ -10,6 +10,7 @@
 
 #include "utils/Utils.hpp"
 
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
@@ -37,14 +38,39 @@ namespace MAT_NS_BEGIN
         virtual void SetEventExperimentIds(std::string const & eventName, std::string const & experimentIds) override;
         virtual void ClearExperimentIds() override;
 
-        virtual std::map<std::string, EventProperty>& GetCommonFields();
-        virtual std::map<std::string, EventProperty>& GetCustomFields();
+        // Read-only, changes go through the setters so that the cached Part A is rebuilt
+        virtual const std::map<std::string, EventProperty>& GetCommonFields();
+        virtual const std::map<std::string, EventProperty>& GetCustomFields();
+
+        virtual void ClearCommonFields();
+        virtual void ClearCustomFields();
 
     protected:
 
+        /// <summary>
+        /// Part A fields of this context merged with all parent contexts,
+        /// built once per context version and copied into every record.
+        /// </summary>
+        struct PartA
+        {
+            ::CsProtocol::Record                 record;
+            std::vector<::CsProtocol::Data>      allData;
+            std::map<std::string, std::string>   eventToConfigIds;
+        };
+
+        std::shared_ptr<const PartA> getPartA();
+        void writeFieldsToRecordLocked(::CsProtocol::Record& record, bool commonOnly);
+        void invalidateLocked();
+
         std::mutex              m_lock;
         ContextFieldsProvider*  m_parent;
 
+        // Bumped on every context change, the cached PartA is rebuilt on mismatch
+        uint64_t                      m_version = 0;
+        uint64_t                      m_partAVersion = 0;
+        std::shared_ptr<const PartA>  m_partA;
+        std::shared_ptr<const PartA>  m_partAParent;
+
         std::map<std::string, EventProperty> m_commonContextFields;
         std::map<std::string, EventProperty> m_customContextFields;
 
@@ -154,7 +154,8 @@ namespace MAT_NS_BEGIN
         /// Gets the maximum payload size for an upload request.
         /// </summary>
         /// <remarks>
-        /// The size limit is enforced on uncompressed request data, and does not take
+        /// The size limit is enforced on uncompressed request data, or on the compressed
+        /// data when streaming compression is enabled, and does not take
         /// overhead (like HTTPS handshake or HTTP headers) into account. This method
         /// is called every time events are packaged for uploading.<br>
         /// <b>Note:</b> If the returned value stops the library from sending even just one
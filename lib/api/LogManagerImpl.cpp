@@ -19,6 +19,7 @@
 #include "http/HttpClientFactory.hpp"
 #include "pal/TaskDispatcher.hpp"
 #include "utils/Utils.hpp"
+#include "decorators/EventPropertiesDecorator.hpp"
 
 #ifdef HAVE_MAT_UTC
 #if defined __has_include
@@ -222,7 +223,17 @@ namespace MAT_NS_BEGIN
 
         if (m_taskDispatcher == nullptr)
         {
-            m_taskDispatcher = PAL::getDefaultTaskDispatcher();
+            uint32_t dispatcherThreads = (*m_config)[CFG_INT_TASK_DISPATCHER_THREADS];
+            if (dispatcherThreads > 1)
+            {
+                // Owned by this instance, joined when released on teardown
+                m_taskDispatcher = PAL::WorkerThreadPoolFactory::Create(dispatcherThreads);
+                LOG_TRACE("TaskDispatcher: Pool of %u threads", dispatcherThreads);
+            }
+            else
+            {
+                m_taskDispatcher = PAL::getDefaultTaskDispatcher();
+            }
         }
         else
         {
@@ -269,6 +280,12 @@ namespace MAT_NS_BEGIN
             {
                 client->SetMsRootCheck(m_logConfiguration[CFG_MAP_HTTP][CFG_BOOL_HTTP_MS_ROOT_CHECK]);
             }
+#elif defined(HAVE_MAT_CURL_HTTP_CLIENT)
+            HttpClient_Curl* client = static_cast<HttpClient_Curl*>(m_httpClient.get());
+            if (client != nullptr && static_cast<bool>(m_logConfiguration[CFG_MAP_HTTP][CFG_BOOL_HTTP_CURL_MULTI]))
+            {
+                client->EnableMultiHandle();
+            }
 #endif
         }
         else
@@ -323,6 +340,7 @@ namespace MAT_NS_BEGIN
             m_system->start();
             m_isSystemStarted = true;
         }
+        updateDirectSerialization();
 
 #ifdef HAVE_MAT_DEFAULT_FILTER
         m_modules.push_back(std::unique_ptr<CompliantByDefaultEventFilterModule>(new CompliantByDefaultEventFilterModule()));
@@ -403,6 +421,7 @@ namespace MAT_NS_BEGIN
             m_taskDispatcher = nullptr;
             m_dataViewer = nullptr;
             m_dataInspector = nullptr;
+            updateDirectSerialization();
 
             m_filters.UnregisterAllFilters();
 
@@ -702,23 +721,79 @@ namespace MAT_NS_BEGIN
         LOCKGUARD(m_lock);
         if (GetSystem())
         {
-            if (m_customDecorator)
+            prepareEvent(event);
+            GetSystem()->sendEvent(event);
+        }
+    }
+
+    void LogManagerImpl::sendEvents(std::vector<IncomingEventContextPtr> const& events)
+    {
+        LOCKGUARD(m_lock);
+        if (GetSystem())
+        {
+            for (auto const& event : events)
             {
-                m_customDecorator->decorate(*(event->source));
+                prepareEvent(event);
             }
+            GetSystem()->sendEvents(events);
+        }
+    }
 
-            {
-                LOCKGUARD(m_dataInspectorGuard);
+    /// <summary>
+    /// Runs the log manager wide steps on an event before it goes to the
+    /// telemetry system. Must be called with m_lock held.
+    /// </summary>
+    void LogManagerImpl::prepareEvent(IncomingEventContextPtr const& event)
+    {
+        if (event->properties && !CanSerializePropertiesDirectly())
+        {
+            // Things changed since the Logger chose direct serialization
+            EventPropertiesDecorator::mergeProperties(*(event->source), *(event->properties));
+            event->properties = nullptr;
+        }
 
-                if (m_dataInspector)
-                {
-                    m_dataInspector->InspectRecord(*(event->source));
-                }
+        if (m_customDecorator)
+        {
+            m_customDecorator->decorate(*(event->source));
+        }
+
+        {
+            LOCKGUARD(m_dataInspectorGuard);
+
+            if (m_dataInspector)
+            {
+                m_dataInspector->InspectRecord(*(event->source));
             }
-            GetSystem()->sendEvent(event);
         }
     }
 
+    bool LogManagerImpl::CanSerializePropertiesDirectly()
+    {
+        // Called for every event, so only the listeners version is checked here. Everything
+        // else that decides it updates the flag when it changes.
+        if (m_directSerializationVersion != DebugEventSource::GetListenersVersion())
+        {
+            updateDirectSerialization();
+        }
+        return m_canSerializeDirectly;
+    }
+
+    void LogManagerImpl::updateDirectSerialization()
+    {
+        LOCKGUARD(m_lock);
+        // Read first, a listener change while this runs gets picked up by the next check
+        uint64_t version = DebugEventSource::GetListenersVersion();
+        bool canSerializeDirectly = m_system && m_system->serializesEventProperties() && !m_customDecorator;
+        if (canSerializeDirectly)
+        {
+            LOCKGUARD(m_dataInspectorGuard);
+            canSerializeDirectly = !m_dataInspector;
+        }
+        canSerializeDirectly = canSerializeDirectly && !m_debugEventSource.HasListeners(DebugEventType::EVT_LOG_EVENT);
+        m_canSerializeDirectly = canSerializeDirectly;
+        m_directSerializationVersion = version;
+    }
+
     ILogController* LogManagerImpl::GetLogController()
     {
         return this;
@@ -806,8 +881,11 @@ namespace MAT_NS_BEGIN
 
     void LogManagerImpl::SetDataInspector(const std::shared_ptr<IDataInspector>& dataInspector)
     {
-        LOCKGUARD(m_dataInspectorGuard);
-        m_dataInspector = dataInspector;
+        {
+            LOCKGUARD(m_dataInspectorGuard);
+            m_dataInspector = dataInspector;
+        }
+        updateDirectSerialization();
     }
 
     std::shared_ptr<IDataInspector> LogManagerImpl::GetDataInspector() noexcept
@@ -34,6 +34,7 @@
 
 #include <mutex>
 #include <set>
+#include <vector>
 
 namespace MAT_NS_BEGIN
 {
@@ -122,6 +123,26 @@ namespace MAT_NS_BEGIN
         std::shared_ptr<IDecoratorModule> m_customDecorator;
 
         virtual void sendEvent(IncomingEventContextPtr const& event) = 0;
+
+        /// <summary>
+        /// Sends a batch of events logged together by one logger.
+        /// </summary>
+        virtual void sendEvents(std::vector<IncomingEventContextPtr> const& events)
+        {
+            for (auto const& event : events)
+            {
+                sendEvent(event);
+            }
+        }
+
+        /// <summary>
+        /// True if Part C properties of events can be left out of the record and
+        /// serialized straight from EventProperties: the telemetry system supports
+        /// it and nothing else looks at the record (custom decorator, data
+        /// inspector or EVT_LOG_EVENT listener).
+        /// </summary>
+        virtual bool CanSerializePropertiesDirectly() = 0;
+
         virtual const ContextFieldsProvider& GetContext() = 0;
         virtual const DiagLevelFilter& GetLevelFilter() = 0;
     };
@@ -272,6 +293,14 @@ namespace MAT_NS_BEGIN
         /// <param name="event">The event.</param>
         virtual void sendEvent(IncomingEventContextPtr const& event) override;
 
+        /// <summary>
+        /// Adds a batch of incoming events, taking the log manager lock once.
+        /// </summary>
+        /// <param name="events">The events.</param>
+        virtual void sendEvents(std::vector<IncomingEventContextPtr> const& events) override;
+
+        virtual bool CanSerializePropertiesDirectly() override;
+
         void SetLevelFilter(uint8_t defaultLevel, uint8_t levelMin, uint8_t levelMax) override;
 
         void SetLevelFilter(uint8_t defaultLevel, const std::set<uint8_t>& allowedLevels) override;
@@ -302,6 +331,7 @@ namespace MAT_NS_BEGIN
 
        protected:
         std::unique_ptr<ITelemetrySystem>& GetSystem();
+        void prepareEvent(IncomingEventContextPtr const& event);
         void InitializeModules() noexcept;
         void TeardownModules() noexcept;
 
@@ -339,6 +369,11 @@ namespace MAT_NS_BEGIN
         DataViewerCollection m_dataViewerCollection;
         std::shared_ptr<IDataInspector> m_dataInspector;
         std::recursive_mutex m_dataInspectorGuard;
+
+        // What CanSerializePropertiesDirectly() returns, and the debug listeners version it was worked out for
+        std::atomic<bool> m_canSerializeDirectly { false };
+        std::atomic<uint64_t> m_directSerializationVersion { 0 };
+        void updateDirectSerialization();
     };
 
 }
@@ -16,51 +16,38 @@ using namespace MAT;
 
 namespace MAT_NS_BEGIN
 {
+    // High bit of Logger::m_active_state, the bits below count the calls in progress
+    static constexpr uint32_t LoggerShutdownFlag = 0x80000000u;
+
     class ActiveLoggerCall
     {
        public:
         const Logger& m_logger;
         bool m_active;
 
-        ActiveLoggerCall(ActiveLoggerCall const& source) : m_logger(source.m_logger)
+        ActiveLoggerCall(ActiveLoggerCall const& source) :
+            ActiveLoggerCall(source.m_logger)
         {
-            std::lock_guard<std::mutex> lock(m_logger.m_shutdown_mutex);
-            m_active = m_logger.m_active;
-            if (m_active)
-            {
-                m_logger.m_active_count += 1;
-            }
         }
 
-        /// Record current state on construction; increment active
-        /// count if we are active.
+        /// Count the call in with one atomic increment. A call that
+        /// starts after shut-down began counts itself out again at once.
         explicit ActiveLoggerCall(const Logger& parent) :
             m_logger(parent)
         {
-            std::lock_guard<std::mutex> lock(m_logger.m_shutdown_mutex);
-            m_active = m_logger.m_active;
-            if (m_active)
+            uint32_t state = m_logger.m_active_state.fetch_add(1);
+            m_active = (state & LoggerShutdownFlag) == 0;
+            if (!m_active)
             {
-                m_logger.m_active_count += 1;
+                leave();
             }
         }
 
-        /// If active, decrement active count, wake any listeners when
-        /// active count reaches zero (usually there are no listeners).
         ~ActiveLoggerCall()
         {
             if (m_active)
             {
-                std::lock_guard<std::mutex> lock(m_logger.m_shutdown_mutex);
-
-                if (m_logger.m_active_count > 0)
-                {
-                    m_logger.m_active_count -= 1;
-                    if (m_logger.m_active_count == 0)
-                    {
-                        const_cast<std::condition_variable*>(&m_logger.m_shutdown_condition)->notify_all();
-                    }
-                }
+                leave();
             }
         }
 
@@ -68,6 +55,19 @@ namespace MAT_NS_BEGIN
         {
             return !m_active;
         }
+
+       private:
+        /// Count the call out. Only the last call to leave during
+        /// shut-down takes the mutex, to wake RecordShutdown().
+        void leave()
+        {
+            uint32_t state = m_logger.m_active_state.fetch_sub(1);
+            if (state == (LoggerShutdownFlag | 1))
+            {
+                std::lock_guard<std::mutex> lock(m_logger.m_shutdown_mutex);
+                m_logger.m_shutdown_condition.notify_all();
+            }
+        }
     };
 
     static NullLogManager nullManager;
@@ -81,6 +81,7 @@ namespace MAT_NS_BEGIN
         ContextFieldsProvider& parentContext,
         IRuntimeConfig& runtimeConfig) :
         m_tenantToken(tenantToken),
+        m_tenantId(TenantRegistry::Intern(tenantToken)),
         m_source(source),
         // TODO: scope parameter can be used to rewire the logger to alternate context.
         // Scope must uniquely identify the "shared context" instance id.
@@ -283,6 +284,20 @@ namespace MAT_NS_BEGIN
     /// </summary>
     /// <param name="properties">The properties.</param>
     void Logger::LogEvent(EventProperties const& properties)
+    {
+        logCustomEvent(properties, false);
+    }
+
+    /// <summary>
+    /// Logs the event, moving array values into the record instead of copying them.
+    /// </summary>
+    /// <param name="properties">The properties.</param>
+    void Logger::LogEvent(EventProperties&& properties)
+    {
+        logCustomEvent(properties, true);
+    }
+
+    void Logger::logCustomEvent(EventProperties const& properties, bool consumeProperties)
     {
         ActiveLoggerCall active(*this);
         if (active.LoggerIsDead())
@@ -309,7 +324,12 @@ namespace MAT_NS_BEGIN
 
         ::CsProtocol::Record record;
 
-        if (!applyCommonDecorators(record, properties, latency))
+        // Plain custom events skip building CsProtocol::Value objects for Part C
+        const bool serializeDirectly =
+            EventPropertiesDecorator::canSerializeDirectly(properties) &&
+            m_logManager.CanSerializePropertiesDirectly();
+
+        if (!applyCommonDecorators(record, properties, latency, serializeDirectly, consumeProperties))
         {
             LOG_ERROR("Failed to log %s event %s/%s: invalid arguments provided",
                       "custom",
@@ -318,10 +338,97 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        submit(record, properties);
+        submit(record, properties, serializeDirectly);
         DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_EVENT, size_t(latency), size_t(0), static_cast<void*>(&record), sizeof(record)));
     }
 
+    /// <summary>
+    /// Logs a batch of custom events. The logger is entered once, the filters
+    /// are run over the whole batch and the records go to the log manager
+    /// together, so storage takes its locks once per batch.
+    /// </summary>
+    /// <param name="events">The properties of the events.</param>
+    void Logger::LogEvents(std::vector<EventProperties> const& events)
+    {
+        ActiveLoggerCall active(*this);
+        if (active.LoggerIsDead() || events.empty())
+        {
+            return;
+        }
+
+        LOG_TRACE("%p: LogEvents(%u events)", this, static_cast<unsigned>(events.size()));
+
+        std::vector<bool> allowed(events.size(), true);
+        m_filters.CanEventPropertiesBeSent(events, allowed);
+        m_logManager.GetEventFilters().CanEventPropertiesBeSent(events, allowed);
+
+        const bool canSerializeDirectly = m_logManager.CanSerializePropertiesDirectly();
+
+        // Contexts point into records, reserve both so neither moves
+        std::vector<::CsProtocol::Record> records(events.size());
+        std::vector<IncomingEventContext> contexts;
+        contexts.reserve(events.size());
+        std::vector<IncomingEventContextPtr> batch;
+        batch.reserve(events.size());
+        // The telemetry system clears IncomingEventContext::source, keep what EVT_LOG_EVENT needs
+        std::vector<std::pair<::CsProtocol::Record*, EventLatency>> logged;
+        logged.reserve(events.size());
+
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            EventProperties const& properties = events[i];
+            if (!allowed[i])
+            {
+                DispatchEvent(DebugEventType::EVT_FILTERED);
+                continue;
+            }
+
+            EventLatency latency = EventLatency_Normal;
+            if (properties.GetLatency() > EventLatency_Unspecified)
+            {
+                latency = properties.GetLatency();
+            }
+
+            ::CsProtocol::Record& record = records[i];
+            const bool serializeDirectly = canSerializeDirectly && EventPropertiesDecorator::canSerializeDirectly(properties);
+            if (!applyCommonDecorators(record, properties, latency, serializeDirectly))
+            {
+                LOG_ERROR("Failed to log %s event %s/%s: invalid arguments provided",
+                          "custom",
+                          tenantTokenToId(m_tenantToken).c_str(),
+                          properties.GetName().empty() ? "<unnamed>" : properties.GetName().c_str());
+                continue;
+            }
+
+            if (!canSubmit(record, properties))
+            {
+                continue;
+            }
+
+            contexts.emplace_back(m_tenantId, properties.GetLatency(), properties.GetPersistence(), &record);
+            IncomingEventContext& event = contexts.back();
+            event.policyBitFlags = properties.GetPolicyBitFlags();
+            if (serializeDirectly)
+            {
+                event.properties = &properties;
+            }
+            batch.push_back(&event);
+            logged.emplace_back(&record, latency);
+        }
+
+        if (batch.empty())
+        {
+            return;
+        }
+
+        m_logManager.sendEvents(batch);
+
+        for (auto const& item : logged)
+        {
+            DispatchEvent(DebugEvent(DebugEventType::EVT_LOG_EVENT, size_t(item.second), size_t(0), static_cast<void*>(item.first), sizeof(::CsProtocol::Record)));
+        }
+    }
+
     /// <summary>
     /// Logs a failure event - such as an application exception.
     /// </summary>
@@ -481,15 +588,11 @@ namespace MAT_NS_BEGIN
     /// <param name="record">The record.</param>
     /// <param name="properties">The properties.</param>
     /// <param name="latency">The latency.</param>
+    /// <param name="consumeProperties">True if the caller handed the properties over and their values may be moved.</param>
     /// <returns></returns>
-    bool Logger::applyCommonDecorators(::CsProtocol::Record& record, EventProperties const& properties, EventLatency& latency)
+    bool Logger::applyCommonDecorators(::CsProtocol::Record& record, EventProperties const& properties, EventLatency& latency, bool serializeDirectly, bool consumeProperties)
     {
-        ActiveLoggerCall active(*this);
-        if (active.LoggerIsDead())
-        {
-            return false;
-        }
-
+        // Callers hold an ActiveLoggerCall for the whole call
         record.name = properties.GetName();
         record.baseType = EVENTRECORD_TYPE_CUSTOM_EVENT;
 
@@ -510,10 +613,10 @@ namespace MAT_NS_BEGIN
         }
         record.iKey = m_iKey;
 
-        return m_baseDecorator.decorate(record) && m_semanticContextDecorator.decorate(record) && m_eventPropertiesDecorator.decorate(record, latency, properties);
+        return m_baseDecorator.decorate(record) && m_semanticContextDecorator.decorate(record) && m_eventPropertiesDecorator.decorate(record, latency, properties, serializeDirectly, consumeProperties);
     }
 
-    void Logger::submit(::CsProtocol::Record& record, const EventProperties& props)
+    void Logger::submit(::CsProtocol::Record& record, const EventProperties& props, bool serializeDirectly)
     {
         ActiveLoggerCall active(*this);
         if (active.LoggerIsDead())
@@ -521,13 +624,31 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        const auto policyBitFlags = props.GetPolicyBitFlags();
-        const auto persistence = props.GetPersistence();
-        const auto latency = props.GetLatency();
+        if (!canSubmit(record, props))
+        {
+            return;
+        }
+
+        IncomingEventContext event(m_tenantId, props.GetLatency(), props.GetPersistence(), &record);
+        event.policyBitFlags = props.GetPolicyBitFlags();
+        if (serializeDirectly)
+        {
+            event.properties = &props;
+        }
+
+        m_logManager.sendEvent(&event);
+    }
+
+    /// <summary>
+    /// Applies the diagnostic level filter and drops events with latency Off,
+    /// dispatching EVT_FILTERED or EVT_DROPPED for the events it rejects.
+    /// </summary>
+    bool Logger::canSubmit(::CsProtocol::Record const& record, const EventProperties& props)
+    {
         auto levelFilter = m_logManager.GetLevelFilter();
         if (levelFilter.IsLevelFilterEnabled())
         {
-            const auto& m_props = props.GetProperties();
+            const auto& m_props = props.GetPropertiesFlat();
             const auto it = m_props.find(COMMONFIELDS_EVENT_LEVEL);
             //
             // Level policy:
@@ -548,29 +669,24 @@ namespace MAT_NS_BEGIN
                     LOG_INFO("Event %s/%s dropped: no diagnostic level assigned!",
                              tenantTokenToId(m_tenantToken).c_str(), record.baseType.c_str());
                     DispatchEvent(DebugEventType::EVT_FILTERED);
-                    return;
+                    return false;
                 }
             }
             if (!levelFilter.IsLevelEnabled(level))
             {
                 DispatchEvent(DebugEventType::EVT_FILTERED);
-                return;
+                return false;
             }
         }
 
-        if (latency == EventLatency_Off)
+        if (props.GetLatency() == EventLatency_Off)
         {
             DispatchEvent(DebugEventType::EVT_DROPPED);
             LOG_INFO("Event %s/%s dropped: calculated latency 0 (Off)",
                      tenantTokenToId(m_tenantToken).c_str(), record.baseType.c_str());
-            return;
+            return false;
         }
-
-        // TODO: [MG] - check if optimization is possible in generateUuidString
-        IncomingEventContext event(PAL::generateUuidString(), m_tenantToken, latency, persistence, &record);
-        event.policyBitFlags = policyBitFlags;
-
-        m_logManager.sendEvent(&event);
+        return true;
     }
 
     void Logger::onSubmitted()
@@ -937,16 +1053,15 @@ namespace MAT_NS_BEGIN
 
     void Logger::RecordShutdown()
     {
-        std::unique_lock<std::mutex> shutdownLock(m_shutdown_mutex);
-        m_active = false;
-        if (m_active_count > 0)
+        // No new call gets in once the flag is set, wait for the ones in progress
+        uint32_t state = m_active_state.fetch_or(LoggerShutdownFlag);
+        if ((state & ~LoggerShutdownFlag) != 0)
         {
-            // wait for idle before continuing
-            // as with all condition variables, we hold the lock,
-            // so no thread can decrement m_active_count until
-            // wait() releases (and later reacquires) the lock.
+            // The last call to leave takes the mutex before notifying,
+            // so the wakeup cannot slip in between check and wait.
+            std::unique_lock<std::mutex> shutdownLock(m_shutdown_mutex);
             m_shutdown_condition.wait(shutdownLock, [this]() {
-                return m_active_count == 0; // we hold the lock for this call
+                return (m_active_state.load() & ~LoggerShutdownFlag) == 0;
             });
         }
     }
@@ -138,10 +138,16 @@ namespace MAT_NS_BEGIN
         virtual void LogSession(SessionState state,
                                 const EventProperties& properties) override;
 
+        using ILogger::LogEvent;
+
         virtual void LogEvent(std::string const& name) override;
 
         virtual void LogEvent(EventProperties const& properties) override;
 
+        virtual void LogEvent(EventProperties&& properties) override;
+
+        virtual void LogEvents(std::vector<EventProperties> const& events) override;
+
         virtual void LogFailure(std::string const& signature,
                                 std::string const& detail,
                                 std::string const& category,
@@ -229,10 +235,20 @@ namespace MAT_NS_BEGIN
        protected:
         bool applyCommonDecorators(::CsProtocol::Record& record,
                                    EventProperties const& properties,
-                                   MAT::EventLatency& latency);
+                                   MAT::EventLatency& latency,
+                                   bool serializeDirectly = false,
+                                   bool consumeProperties = false);
 
+        void logCustomEvent(EventProperties const& properties, bool consumeProperties);
+
+        /// <summary>
+        /// Sends the record on. With serializeDirectly the Part C properties
+        /// were left out of the record and are serialized from props.
+        /// </summary>
         virtual void
-        submit(::CsProtocol::Record& record, const EventProperties& props);
+        submit(::CsProtocol::Record& record, const EventProperties& props, bool serializeDirectly = false);
+
+        bool canSubmit(::CsProtocol::Record const& record, const EventProperties& props);
 
         bool
         CanEventPropertiesBeSent(EventProperties const& properties) const noexcept;
@@ -240,6 +256,7 @@ namespace MAT_NS_BEGIN
         std::mutex m_lock;
 
         std::string m_tenantToken;
+        TenantId    m_tenantId;
         std::string m_iKey;
         std::string m_source;
 
@@ -266,24 +283,21 @@ namespace MAT_NS_BEGIN
         bool m_resetSessionOnEnd;
         EventFilterCollection m_filters;
 
-        /// m_shutdown_mutex protects shut-down state
-        mutable std::mutex m_shutdown_mutex;
+        /// m_active_state counts the calls into this logger in progress,
+        /// and its high bit is set when the shut-down state transition
+        /// starts. No new calls get in after that, so the count drains
+        /// to zero as calls complete. Calls only touch this atomic, the
+        /// logging path takes no lock for it.
+        mutable std::atomic<uint32_t> m_active_state { 0 };
 
-        /// RecordShutdown() uses m_shutdown_condition to wait until
-        /// m_active goes to zero.
+        /// RecordShutdown() waits on m_shutdown_condition until the
+        /// count drains; the last call to leave wakes it.
+        mutable std::mutex m_shutdown_mutex;
         mutable std::condition_variable m_shutdown_condition;
-        /// m_active count records how many calls into this logger
-        /// are in progress. We can only complete the shutdown state
-        /// transition when active_count drains to zero.
-        mutable size_t m_active_count = 0;
-        /// m_active is set to false when we start the shut-down state
-        /// transition. No new calls will start once this is false, so
-        /// m_active_count should decrement to zero as calls complete.
-        mutable bool m_active = true;
 
         /// ActiveLoggerCall is a stack-allocated class to handle
         /// shut-down state for individual Logger methods: increment
-        /// and decrement m_active_count as needed, record whether
+        /// and decrement the m_active_state count, record whether
         /// this method call is in the active or shut-down state.
         friend class ActiveLoggerCall;
     };
@@ -241,9 +241,10 @@ evt_status_t mat_log(evt_context_t *ctx)
     EventProperties props;
     props.unpack(evt, ctx->size);
 
-    auto m = props.GetProperties();
-    EventProperty &prop = m[COMMONFIELDS_IKEY];
-    std::string token = prop.as_string;
+    // Look the routing fields up in place: the properties are handed over to the logger below
+    const auto& m = props.GetPropertiesFlat();
+    const auto iKey = m.find(COMMONFIELDS_IKEY);
+    std::string token = ((iKey != m.cend()) && (iKey->second.type == EventProperty::TYPE_STRING)) ? iKey->second.as_string : "";
     props.erase(COMMONFIELDS_IKEY);
 
     // Privacy feature for OTEL C API client:
@@ -278,7 +279,7 @@ evt_status_t mat_log(evt_context_t *ctx)
     else
     {
         logger->SetParentContext(nullptr);
-        logger->LogEvent(props);
+        logger->LogEvent(std::move(props));
         ctx->result = EOK;
     }
     return ctx->result;
@@ -10,23 +10,319 @@
 #include "bond/generated/CsProtocol_readers.hpp"
 #include "oacr.h"
 
+#include <algorithm>
+#include <string.h>
+
 namespace MAT_NS_BEGIN {
 
+    namespace {
+
+        using bond_lite::CompactBinaryProtocolWriter;
+
+        void writeStringValue(CompactBinaryProtocolWriter& writer, EventProperty const& property)
+        {
+            // 3: stringValue, omitted when empty
+            if (property.type == EventProperty::TYPE_STRING)
+            {
+                size_t size = (property.as_string != nullptr) ? strlen(property.as_string) : 0;
+                if (size > 0)
+                {
+                    writer.WriteFieldBegin(bond_lite::BT_STRING, 3, nullptr);
+                    writer.WriteUInt32(static_cast<uint32_t>(size));
+                    writer.WriteBlob(property.as_string, size);
+                    writer.WriteFieldEnd();
+                }
+                return;
+            }
+            std::string value = property.to_string();
+            if (!value.empty())
+            {
+                writer.WriteFieldBegin(bond_lite::BT_STRING, 3, nullptr);
+                writer.WriteString(value);
+                writer.WriteFieldEnd();
+            }
+        }
+
+        void writeValueKind(CompactBinaryProtocolWriter& writer, ::CsProtocol::ValueKind kind)
+        {
+            // 1: type, omitted for ValueString
+            writer.WriteFieldBegin(bond_lite::BT_INT32, 1, nullptr);
+            writer.WriteInt32(static_cast<int32_t>(kind));
+            writer.WriteFieldEnd();
+        }
+
+        void writeLongValue(CompactBinaryProtocolWriter& writer, int64_t value)
+        {
+            // 4: longValue, omitted when 0
+            if (value != 0)
+            {
+                writer.WriteFieldBegin(bond_lite::BT_INT64, 4, nullptr);
+                writer.WriteInt64(value);
+                writer.WriteFieldEnd();
+            }
+        }
+
+        void writeGuidBytes(CompactBinaryProtocolWriter& writer, GUID_t const& guid)
+        {
+            uint8_t guid_bytes[16] = { 0 };
+            guid.to_bytes(guid_bytes);
+            writer.WriteContainerBegin(sizeof(guid_bytes), bond_lite::BT_UINT8);
+            writer.WriteBlob(guid_bytes, sizeof(guid_bytes));
+            writer.WriteContainerEnd();
+        }
+
+        /// <summary>
+        /// Writes the CsProtocol::Value that EventPropertiesDecorator would build
+        /// for the property, without building it.
+        /// </summary>
+        void writeProperty(CompactBinaryProtocolWriter& writer, EventProperty const& property)
+        {
+            writer.WriteStructBegin(nullptr, false);
+
+            if (property.piiKind != PiiKind_None)
+            {
+                // 2: attributes, a single entry with either pii or customerContent
+                writer.WriteFieldBegin(bond_lite::BT_LIST, 2, nullptr);
+                writer.WriteContainerBegin(1, bond_lite::BT_STRUCT);
+                writer.WriteStructBegin(nullptr, false);
+                if (property.piiKind == PiiKind::CustomerContentKind_GenericData)
+                {
+                    ::CsProtocol::CustomerContent cc;
+                    cc.Kind = ::CsProtocol::CustomerContentKind::GenericContent;
+                    writer.WriteFieldBegin(bond_lite::BT_LIST, 2, nullptr);
+                    writer.WriteContainerBegin(1, bond_lite::BT_STRUCT);
+                    bond_lite::Serialize(writer, cc, false);
+                }
+                else
+                {
+                    ::CsProtocol::PII pii;
+                    pii.Kind = static_cast<::CsProtocol::PIIKind>(property.piiKind);
+                    writer.WriteFieldBegin(bond_lite::BT_LIST, 1, nullptr);
+                    writer.WriteContainerBegin(1, bond_lite::BT_STRUCT);
+                    bond_lite::Serialize(writer, pii, false);
+                }
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+                writer.WriteStructEnd(false);
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+
+                writeStringValue(writer, property);
+                writer.WriteStructEnd(false);
+                return;
+            }
+
+            switch (property.type)
+            {
+            case EventProperty::TYPE_STRING:
+                writeStringValue(writer, property);
+                break;
+
+            case EventProperty::TYPE_INT64:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueInt64);
+                writeLongValue(writer, property.as_int64);
+                break;
+
+            case EventProperty::TYPE_DOUBLE:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueDouble);
+                if (property.as_double != 0.0)
+                {
+                    writer.WriteFieldBegin(bond_lite::BT_DOUBLE, 5, nullptr);
+                    writer.WriteDouble(property.as_double);
+                    writer.WriteFieldEnd();
+                }
+                break;
+
+            case EventProperty::TYPE_TIME:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueDateTime);
+                writeLongValue(writer, static_cast<int64_t>(property.as_time_ticks.ticks));
+                break;
+
+            case EventProperty::TYPE_BOOLEAN:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueBool);
+                writeLongValue(writer, property.as_bool);
+                break;
+
+            case EventProperty::TYPE_GUID:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueGuid);
+                writer.WriteFieldBegin(bond_lite::BT_LIST, 6, nullptr);
+                writer.WriteContainerBegin(1, bond_lite::BT_LIST);
+                writeGuidBytes(writer, property.as_guid);
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+                break;
+
+            case EventProperty::TYPE_STRING_ARRAY:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueArrayString);
+                writer.WriteFieldBegin(bond_lite::BT_LIST, 10, nullptr);
+                writer.WriteContainerBegin(1, bond_lite::BT_LIST);
+                writer.WriteContainerBegin(property.as_stringArray->size(), bond_lite::BT_STRING);
+                for (auto const& item : *property.as_stringArray)
+                {
+                    writer.WriteString(item);
+                }
+                writer.WriteContainerEnd();
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+                break;
+
+            case EventProperty::TYPE_INT64_ARRAY:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueArrayInt64);
+                writer.WriteFieldBegin(bond_lite::BT_LIST, 11, nullptr);
+                writer.WriteContainerBegin(1, bond_lite::BT_LIST);
+                writer.WriteContainerBegin(property.as_longArray->size(), bond_lite::BT_INT64);
+                for (auto item : *property.as_longArray)
+                {
+                    writer.WriteInt64(item);
+                }
+                writer.WriteContainerEnd();
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+                break;
+
+            case EventProperty::TYPE_DOUBLE_ARRAY:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueArrayDouble);
+                writer.WriteFieldBegin(bond_lite::BT_LIST, 12, nullptr);
+                writer.WriteContainerBegin(1, bond_lite::BT_LIST);
+                writer.WriteContainerBegin(property.as_doubleArray->size(), bond_lite::BT_DOUBLE);
+                for (auto item : *property.as_doubleArray)
+                {
+                    writer.WriteDouble(item);
+                }
+                writer.WriteContainerEnd();
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+                break;
+
+            case EventProperty::TYPE_GUID_ARRAY:
+                writeValueKind(writer, ::CsProtocol::ValueKind::ValueArrayGuid);
+                writer.WriteFieldBegin(bond_lite::BT_LIST, 13, nullptr);
+                writer.WriteContainerBegin(1, bond_lite::BT_LIST);
+                writer.WriteContainerBegin(property.as_guidArray->size(), bond_lite::BT_LIST);
+                for (auto const& item : *property.as_guidArray)
+                {
+                    writeGuidBytes(writer, item);
+                }
+                writer.WriteContainerEnd();
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+                break;
+
+            default:
+                // Convert all unknown types to string
+                writeStringValue(writer, property);
+                break;
+            }
+
+            writer.WriteStructEnd(false);
+        }
+
+        /// <summary>
+        /// Writes data[0].properties as the map EventPropertiesDecorator would
+        /// produce: the context properties already in the record, overridden by
+        /// the event properties.
+        /// </summary>
+        void writeMergedProperties(CompactBinaryProtocolWriter& writer,
+            ::CsProtocol::PropertyMap const& context,
+            FlatMap<std::string, EventProperty> const& properties)
+        {
+            size_t count = context.size();
+            for (auto const& kv : properties)
+            {
+                if (context.find(kv.first) == context.end())
+                {
+                    count++;
+                }
+            }
+
+            writer.WriteStructBegin(nullptr, false);
+            if (count > 0)
+            {
+                writer.WriteFieldBegin(bond_lite::BT_MAP, 1, nullptr);
+                writer.WriteMapContainerBegin(count, bond_lite::BT_STRING, bond_lite::BT_STRUCT);
+
+                // Both maps are sorted by key, same as the merged PropertyMap
+                auto ctx = context.begin();
+                auto evt = properties.begin();
+                while (ctx != context.end() || evt != properties.end())
+                {
+                    if (evt == properties.end() || (ctx != context.end() && ctx->first < evt->first))
+                    {
+                        writer.WriteString(ctx->first);
+                        bond_lite::Serialize(writer, ctx->second, false);
+                        ++ctx;
+                        continue;
+                    }
+                    if (ctx != context.end() && ctx->first == evt->first)
+                    {
+                        ++ctx;
+                    }
+                    writer.WriteString(evt->first);
+                    writeProperty(writer, evt->second);
+                    ++evt;
+                }
+
+                writer.WriteContainerEnd();
+                writer.WriteFieldEnd();
+            }
+            writer.WriteStructEnd(false);
+        }
+
+        void serializeWithProperties(bond_lite::CompactBinaryProtocolWriter& writer, ::CsProtocol::Record& source, EventProperties const& properties)
+        {
+            // data is the last field of Record. Write all other fields as usual,
+            // then put the merged data[0] in place of the struct end.
+            std::vector<::CsProtocol::Data> data;
+            data.swap(source.data);
+            bond_lite::Serialize(writer, source);
+            data.swap(source.data);
+            uint8_t structEnd = writer.PopBack();
+            assert(structEnd == bond_lite::BT_STOP);
+            UNREFERENCED_PARAMETER(structEnd);
+
+            static const ::CsProtocol::PropertyMap noProperties;
+            auto const& context = source.data.empty() ? noProperties : source.data[0].properties;
+
+            writer.WriteFieldBegin(bond_lite::BT_LIST, 70, nullptr);
+            writer.WriteContainerBegin(std::max<size_t>(source.data.size(), 1), bond_lite::BT_STRUCT);
+            writeMergedProperties(writer, context, properties.GetPropertiesFlat());
+            for (size_t i = 1; i < source.data.size(); i++)
+            {
+                bond_lite::Serialize(writer, source.data[i], false);
+            }
+            writer.WriteContainerEnd();
+            writer.WriteFieldEnd();
+
+            writer.WriteStructEnd(false);
+        }
+
+    }
+
     bool BondSerializer::handleSerialize(IncomingEventContextPtr const& ctx)
     {
         OACR_USE_PTR(this);
         {
             bond_lite::CompactBinaryProtocolWriter writer(ctx->record.blob);
-            bond_lite::Serialize(writer, *ctx->source);
+            // Events of one application tend to be alike, so the last blob size is
+            // a cheap estimate that saves growing the writer's buffer step by step
+            writer.Reserve(m_sizeEstimate.load(std::memory_order_relaxed));
+            if (ctx->properties)
+            {
+                serializeWithProperties(writer, *ctx->source, *ctx->properties);
+            }
+            else
+            {
+                bond_lite::Serialize(writer, *ctx->source);
+            }
         }
+        m_sizeEstimate.store(ctx->record.blob.size(), std::memory_order_relaxed);
 
-        LOG_TRACE("Event %s/%s submitted, priority %u (%s), serialized size %u bytes, ID %s",
+        LOG_TRACE("Event %s/%s submitted, priority %u (%s), serialized size %u bytes, ID %llu",
             tenantTokenToId(ctx->record.tenantToken).c_str(), ctx->source->baseType.c_str(),
             ctx->record.latency, latencyToStr(ctx->record.latency),
-            static_cast<unsigned>(ctx->record.blob.size()), ctx->record.id.c_str());
+            static_cast<unsigned>(ctx->record.blob.size()), static_cast<unsigned long long>(ctx->record.id));
 
         return true;
     }
 
 } MAT_NS_END
-
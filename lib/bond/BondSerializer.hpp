@@ -7,11 +7,15 @@
 #include "system/Contexts.hpp"
 #include "system/Route.hpp"
 
+#include <atomic>
+
 namespace MAT_NS_BEGIN {
 
 
 class BondSerializer {
   protected:
+    std::atomic<size_t> m_sizeEstimate { 0 };
+
     bool handleSerialize(IncomingEventContextPtr const& ctx);
 
   public:
@@ -7,52 +7,172 @@
 
 #include "pal/PAL.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <string.h>
+
 namespace bond_lite {
 
 // Based on:
 // https://github.com/Microsoft/bond/blob/master/cpp/inc/bond/protocol/compact_binary.h
 
+/// <summary>
+/// Writes through a raw cursor into a scratch buffer, which is left
+/// uninitialized as it grows. The bytes written are appended to the output
+/// vector when the writer goes away, so the output gets no more capacity
+/// than they need and must not be used while a writer on it is alive.
+/// The first writer alive on a thread reuses a per-thread scratch buffer,
+/// so serializing an event allocates only its output.
+/// </summary>
 class CompactBinaryProtocolWriter {
   protected:
+    struct Buffer {
+        std::unique_ptr<uint8_t[]> data;
+        size_t                     capacity = 0;
+        bool                       inUse = false;
+    };
+
+    // Larger scratch buffers are freed after use rather than kept for the thread
+    static constexpr size_t MaxKeptScratch = 64 * 1024;
+
+    static Buffer& threadScratch()
+    {
+        static thread_local Buffer scratch;
+        return scratch;
+    }
+
     std::vector<uint8_t>& m_output;
+    Buffer                m_ownBuffer;
+    Buffer*               m_buffer;
+    uint8_t*              m_cursor;
+    uint8_t*              m_end;
 
   public:
     CompactBinaryProtocolWriter(std::vector<uint8_t>& output)
       : m_output(output)
     {
+        Buffer& scratch = threadScratch();
+        m_buffer = scratch.inUse ? &m_ownBuffer : &scratch;
+        m_buffer->inUse = true;
+        m_cursor = m_buffer->data.get();
+        m_end = m_cursor + m_buffer->capacity;
+    }
+
+    CompactBinaryProtocolWriter(CompactBinaryProtocolWriter const&) = delete;
+    CompactBinaryProtocolWriter& operator=(CompactBinaryProtocolWriter const&) = delete;
+
+    ~CompactBinaryProtocolWriter()
+    {
+        m_output.insert(m_output.end(), m_buffer->data.get(), m_cursor);
+        m_buffer->inUse = false;
+        if (m_buffer->capacity > MaxKeptScratch) {
+            m_buffer->data.reset();
+            m_buffer->capacity = 0;
+        }
+    }
+
+    /// <summary>
+    /// Number of bytes in the output, including those it had before.
+    /// </summary>
+    size_t getSize() const
+    {
+        return m_output.size() + written();
+    }
+
+    /// <summary>
+    /// Makes room for size more bytes up front, so that writing that much
+    /// does not reallocate.
+    /// </summary>
+    void Reserve(size_t size)
+    {
+        ensure(size);
+    }
+
+    /// <summary>
+    /// Takes back the last byte this writer wrote and returns it.
+    /// </summary>
+    uint8_t PopBack()
+    {
+        assert(written() > 0);
+        return *--m_cursor;
     }
 
   protected:
+    size_t written() const
+    {
+        return static_cast<size_t>(m_cursor - m_buffer->data.get());
+    }
+
+    uint8_t* ensure(size_t size)
+    {
+        if (static_cast<size_t>(m_end - m_cursor) < size) {
+            grow(size);
+        }
+        return m_cursor;
+    }
+
+    void grow(size_t size)
+    {
+        size_t used = written();
+        size_t capacity = std::max<size_t>(used + size, std::max<size_t>(m_buffer->capacity * 2, 64));
+        // Not value-initialized, every byte is written before it is handed out
+        std::unique_ptr<uint8_t[]> data(new uint8_t[capacity]);
+        if (used > 0) {
+            memcpy(data.get(), m_buffer->data.get(), used);
+        }
+        m_buffer->data = std::move(data);
+        m_buffer->capacity = capacity;
+        m_cursor = m_buffer->data.get() + used;
+        m_end = m_buffer->data.get() + capacity;
+    }
+
     template<typename T>
     void writeVarint(T value)
     {
+        // At most 10 bytes for 64-bit values, one capacity check for all of them
+        uint8_t* out = ensure(10);
+        if (value < 0x80) {
+            out[0] = static_cast<uint8_t>(value);
+            m_cursor = out + 1;
+            return;
+        }
+        if (value < 0x4000) {
+            out[0] = static_cast<uint8_t>(value | 0x80);
+            out[1] = static_cast<uint8_t>(value >> 7);
+            m_cursor = out + 2;
+            return;
+        }
         while (value > 127) {
-            m_output.push_back((value & 127) | 128);
+            *out++ = static_cast<uint8_t>(value | 0x80);
             value >>= 7;
         }
-        m_output.push_back(value & 127);
+        *out++ = static_cast<uint8_t>(value);
+        m_cursor = out;
     }
 
   public:
     void WriteBlob(void const* data, size_t size)
     {
-        uint8_t const* ptr = static_cast<uint8_t const*>(data);
-        m_output.insert(m_output.end(), ptr, ptr + size);
+        if (size > 0) {
+            memcpy(ensure(size), data, size);
+            m_cursor += size;
+        }
     }
 
     void WriteBool(bool value)
     {
-        m_output.push_back(value ? 1 : 0);
+        WriteUInt8(value ? 1 : 0);
     }
 
     void WriteUInt8(uint8_t value)
     {
-        m_output.push_back(value);
+        *ensure(1) = value;
+        m_cursor++;
     }
 
     void WriteUInt16(uint16_t value)
@@ -110,12 +230,17 @@ class CompactBinaryProtocolWriter {
 
     void WriteString(std::string const& value)
     {
-        if (value.empty()) {
-            WriteUInt32(0);
+        size_t size = value.size();
+        assert(size <= UINT32_MAX);
+        if (size < 0x80) {
+            // Length and characters in one go
+            uint8_t* out = ensure(1 + size);
+            out[0] = static_cast<uint8_t>(size);
+            memcpy(out + 1, value.data(), size);
+            m_cursor = out + 1 + size;
         } else {
-            assert(value.size() <= UINT32_MAX);
-            WriteUInt32(static_cast<uint32_t>(value.size()));
-            WriteBlob(value.data(), value.size());
+            WriteUInt32(static_cast<uint32_t>(size));
+            WriteBlob(value.data(), size);
         }
     }
 
@@ -148,15 +273,19 @@ class CompactBinaryProtocolWriter {
     void WriteFieldBegin(uint8_t type, uint16_t id, void* metadata)
     {
 		UNREFERENCED_PARAMETER(metadata);
+        uint8_t* out = ensure(3);
         if (id <= 5) {
-            m_output.push_back(type | ((uint8_t)id << 5));
+            out[0] = type | ((uint8_t)id << 5);
+            m_cursor = out + 1;
         } else if (id <= 0xff) {
-            m_output.push_back(type | (6 << 5));
-            m_output.push_back(id & 255);
+            out[0] = type | (6 << 5);
+            out[1] = id & 255;
+            m_cursor = out + 2;
         } else {
-            m_output.push_back(type | (7 << 5));
-            m_output.push_back(id & 255);
-            m_output.push_back(id >> 8);
+            out[0] = type | (7 << 5);
+            out[1] = id & 255;
+            out[2] = id >> 8;
+            m_cursor = out + 3;
         }
     }
 
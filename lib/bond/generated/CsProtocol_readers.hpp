@@ -2413,7 +2413,7 @@ bool Deserialize(TReader& reader, ::CsProtocol::Data& value, bool isBase)
                     if (!reader.ReadString(key4)) {
                         return false;
                     }
-                    if (!Deserialize(reader, value.properties[key4], false)) {
+                    if (!Deserialize(reader, value.properties[std::move(key4)], false)) {
                         return false;
                     }
                 }
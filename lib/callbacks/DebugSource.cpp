@@ -11,12 +11,16 @@
 
 namespace MAT_NS_BEGIN {
 
+    // Bumped under stateLock() by every change that HasListeners() could see
+    static std::atomic<uint64_t> s_listenersVersion(0);
+
     /// <summary>Add event listener for specific debug event type.</summary>
     void DebugEventSource::AddEventListener(DebugEventType type, DebugEventListener &listener)
     {
         DE_LOCKGUARD(stateLock());
         auto &v = listeners[type];
         v.push_back(&listener);
+        s_listenersVersion++;
     }
 
     /// <summary>Remove previously added debug event listener for specific type.</summary>
@@ -30,6 +34,7 @@ namespace MAT_NS_BEGIN {
         auto &registeredListeners = (*registeredTypes).second;
         auto it = std::remove(registeredListeners.begin(), registeredListeners.end(), &listener);
         registeredListeners.erase(it, registeredListeners.end());
+        s_listenersVersion++;
     }
 
     /// <summary>Microsoft Telemetry SDK invokes this method to dispatch event to client callback</summary>
@@ -65,6 +70,27 @@ namespace MAT_NS_BEGIN {
         return dispatched;
     }
 
+    /// <summary>Checks if this source or any cascaded source has a listener for the specified type</summary>
+    bool DebugEventSource::HasListeners(DebugEventType type)
+    {
+        DE_LOCKGUARD(stateLock());
+        auto registeredTypes = listeners.find(type);
+        if (registeredTypes != listeners.end() && !registeredTypes->second.empty())
+            return true;
+
+        for (auto item : cascaded)
+        {
+            if (item && item->HasListeners(type))
+                return true;
+        }
+        return false;
+    }
+
+    uint64_t DebugEventSource::GetListenersVersion()
+    {
+        return s_listenersVersion;
+    }
+
     /// <summary>Attach cascaded DebugEventSource to forward all events to</summary>
     bool DebugEventSource::AttachEventSource(DebugEventSource & other)
     {
@@ -73,6 +99,7 @@ namespace MAT_NS_BEGIN {
 
         DE_LOCKGUARD(stateLock());
         cascaded.insert(&other);
+        s_listenersVersion++;
         return true;
     }
 
@@ -80,6 +107,7 @@ namespace MAT_NS_BEGIN {
     bool DebugEventSource::DetachEventSource(DebugEventSource & other)
     {
         DE_LOCKGUARD(stateLock());
+        s_listenersVersion++;
         return (cascaded.erase(&other)!=0);
     }
 
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "DeflateCodec.hpp"
+#include "DeflateContextPool.hpp"
+
+namespace MAT_NS_BEGIN {
+
+    DeflateCodec::DeflateCodec(std::string const& contentEncoding, int level)
+        : m_contentEncoding(contentEncoding),
+          m_windowBits(StreamingDeflate::GetWindowBits(contentEncoding)),
+          m_level(level)
+    {
+    }
+
+    const char* DeflateCodec::GetContentEncoding() const noexcept
+    {
+        return m_contentEncoding.c_str();
+    }
+
+    bool DeflateCodec::Compress(std::vector<uint8_t>& body)
+    {
+        size_t reusedStateBytes;
+        return Compress(body, reusedStateBytes);
+    }
+
+    bool DeflateCodec::Compress(std::vector<uint8_t>& body, size_t& reusedStateBytes)
+    {
+        reusedStateBytes = 0;
+        std::unique_ptr<StreamingDeflate> deflater = DeflateContextPool::Acquire(m_windowBits, m_level);
+        if (!deflater ||
+            !deflater->Append(body.data(), body.size()) ||
+            !deflater->Finish(body)) {
+            DeflateContextPool::Release(std::move(deflater));
+            return false;
+        }
+        reusedStateBytes = deflater->GetReusedStateBytes();
+        DeflateContextPool::Release(std::move(deflater));
+        return true;
+    }
+
+} MAT_NS_END
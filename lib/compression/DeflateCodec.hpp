@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+#include "Version.hpp"
+#include "ICompressionCodec.hpp"
+
+#include <memory>
+#include <string>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Built-in zlib codec. "deflate" is raw deflate without zlib header, as
+    /// required by IIS, "gzip" adds a simple gzip header. Streams come from
+    /// the per-thread DeflateContextPool.
+    /// </summary>
+    class DeflateCodec : public ICompressionCodec {
+    public:
+        DeflateCodec(std::string const& contentEncoding, int level = -1);
+
+        const char* GetContentEncoding() const noexcept override;
+        bool Compress(std::vector<uint8_t>& body) override;
+
+        /// <summary>
+        /// Compress and report how many zlib state bytes a pooled stream saved.
+        /// </summary>
+        bool Compress(std::vector<uint8_t>& body, size_t& reusedStateBytes);
+
+        int GetWindowBits() const { return m_windowBits; }
+        int GetLevel() const { return m_level; }
+
+    protected:
+        std::string m_contentEncoding;
+        int         m_windowBits;
+        int         m_level;
+    };
+
+} MAT_NS_END
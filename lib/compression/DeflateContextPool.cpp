@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "DeflateContextPool.hpp"
+
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    namespace {
+        thread_local std::vector<std::unique_ptr<StreamingDeflate>> t_streams;
+    }
+
+    std::unique_ptr<StreamingDeflate> DeflateContextPool::Acquire(int windowBits, int level)
+    {
+        std::unique_ptr<StreamingDeflate> deflater;
+        for (auto it = t_streams.begin(); it != t_streams.end(); ++it) {
+            if ((*it)->GetWindowBits() == windowBits && (*it)->GetLevel() == level) {
+                deflater = std::move(*it);
+                t_streams.erase(it);
+                break;
+            }
+        }
+        if (!deflater) {
+            deflater.reset(new StreamingDeflate());
+        }
+        if (!deflater->Begin(windowBits, level)) {
+            return nullptr;
+        }
+        return deflater;
+    }
+
+    void DeflateContextPool::Release(std::unique_ptr<StreamingDeflate>&& deflater)
+    {
+        if (deflater && !deflater->IsActive() && t_streams.size() < kMaxStreamsPerThread) {
+            t_streams.push_back(std::move(deflater));
+        }
+        deflater.reset();
+    }
+
+} MAT_NS_END
@@ -0,0 +1,38 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+#include "Version.hpp"
+#include "StreamingDeflate.hpp"
+
+#include <memory>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Per-thread cache of deflate streams. A zlib deflate state takes about
+    /// 256 KB at the default settings; reusing it with deflateReset() avoids
+    /// allocating and freeing that for every uploaded package. Each thread
+    /// keeps its own streams, so no locking is needed.
+    /// </summary>
+    class DeflateContextPool {
+    public:
+        /// <summary>
+        /// Get a stream that has been started with Begin(windowBits, level),
+        /// or nullptr if zlib could not be initialized.
+        /// </summary>
+        static std::unique_ptr<StreamingDeflate> Acquire(int windowBits, int level = -1);
+
+        /// <summary>
+        /// Return a finished stream to the calling thread's cache.
+        /// </summary>
+        static void Release(std::unique_ptr<StreamingDeflate>&& deflater);
+
+    protected:
+        // One per Content-Encoding and level is all an upload pipeline needs
+        static const size_t kMaxStreamsPerThread = 2;
+    };
+
+} MAT_NS_END
@@ -8,21 +8,36 @@
 #include "api/IRuntimeConfig.hpp"
 #include "system/Route.hpp"
 #include "system/Contexts.hpp"
+#include "ICompressionCodec.hpp"
+#include "DeflateCodec.hpp"
+
+#include <memory>
 
 namespace MAT_NS_BEGIN {
 
 
     class HttpDeflateCompression {
     public:
-        HttpDeflateCompression(IRuntimeConfig& runtimeConfig);
+        /// <summary>
+        /// Compresses request bodies with the given codec, or with the built-in
+        /// zlib codec for the configured Content-Encoding if codec is nullptr.
+        /// </summary>
+        HttpDeflateCompression(IRuntimeConfig& runtimeConfig, std::shared_ptr<ICompressionCodec> const& codec = nullptr);
         ~HttpDeflateCompression();
 
+        /// <summary>
+        /// true if the built-in zlib codec is used, which the packager can stream into.
+        /// </summary>
+        bool IsBuiltInCodec() const { return m_deflateCodec != nullptr; }
+
     protected:
         bool handleCompress(EventsUploadContextPtr const& ctx);
 
     protected:
         IRuntimeConfig& m_config;
-        int m_windowBits;
+        std::shared_ptr<ICompressionCodec> m_codec;
+        // Same object as m_codec when the built-in codec is used
+        DeflateCodec* m_deflateCodec;
 
     public:
         RouteSource<EventsUploadContextPtr const&>                              compressionFailed;
@@ -30,4 +45,3 @@ namespace MAT_NS_BEGIN {
     };
 
 } MAT_NS_END
-
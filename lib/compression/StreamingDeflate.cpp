@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "StreamingDeflate.hpp"
+#include "pal/PAL.hpp"
+#include "utils/Utils.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+#ifdef HAVE_MAT_ZLIB
+#define ZLIB_CONST
+#include <zlib.h>
+#else
+struct z_stream_s {};
+#endif
+
+namespace MAT_NS_BEGIN {
+
+    StreamingDeflate::StreamingDeflate()
+        : m_stream(new z_stream_s())
+    {
+    }
+
+    StreamingDeflate::~StreamingDeflate()
+    {
+        end();
+    }
+
+    int StreamingDeflate::GetWindowBits(std::string const& contentEncoding)
+    {
+#ifdef HAVE_MAT_ZLIB
+        return (contentEncoding == "gzip") ? (MAX_WBITS | 16) : -MAX_WBITS;
+#else
+        UNREFERENCED_PARAMETER(contentEncoding);
+        return 0;
+#endif
+    }
+
+    size_t StreamingDeflate::GetStateSize(int windowBits)
+    {
+        // (1 << (windowBits + 2)) + (1 << (memLevel + 9)), windowBits without the raw/gzip flags
+        int bits = (windowBits < 0) ? -windowBits : (windowBits & 15);
+        return (size_t { 1 } << (bits + 2)) + (size_t { 1 } << (8 /*DEF_MEM_LEVEL*/ + 9));
+    }
+
+    bool StreamingDeflate::Begin(int windowBits, int level)
+    {
+        m_output.clear();
+        m_inputSize = 0;
+        m_pendingInput = 0;
+        m_active = false;
+        m_reused = false;
+#ifdef HAVE_MAT_ZLIB
+        if (m_initialized && m_windowBits == windowBits && m_level == level && deflateReset(m_stream.get()) == Z_OK) {
+            m_stream->next_out = nullptr;
+            m_stream->avail_out = 0;
+            m_reused = true;
+            m_active = true;
+            return true;
+        }
+
+        end();
+        memset(m_stream.get(), 0, sizeof(z_stream));
+        int result = deflateInit2(m_stream.get(), level, Z_DEFLATED, windowBits, 8 /*DEF_MEM_LEVEL*/, Z_DEFAULT_STRATEGY);
+        if (result != Z_OK) {
+            LOG_WARN("Streaming compression init failed, error=%d (%s)", result, m_stream->msg);
+            return false;
+        }
+        m_windowBits = windowBits;
+        m_level = level;
+        m_initialized = true;
+        m_active = true;
+#else
+        UNREFERENCED_PARAMETER(windowBits);
+        UNREFERENCED_PARAMETER(level);
+#endif
+        return m_active;
+    }
+
+    bool StreamingDeflate::Append(uint8_t const* data, size_t size)
+    {
+        UNREFERENCED_PARAMETER(data);
+        if (!m_active) {
+            return false;
+        }
+#ifdef HAVE_MAT_ZLIB
+        m_stream->next_in = data;
+        m_stream->avail_in = static_cast<uInt>(size);
+        if (!deflateChunk(Z_NO_FLUSH)) {
+            return false;
+        }
+        m_inputSize += size;
+        m_pendingInput += size;
+        if (m_pendingInput >= kSyncFlushInterval) {
+            return Flush();
+        }
+#endif
+        return true;
+    }
+
+    bool StreamingDeflate::Flush()
+    {
+        if (!m_active) {
+            return false;
+        }
+#ifdef HAVE_MAT_ZLIB
+        if (m_pendingInput > 0) {
+            if (!deflateChunk(Z_SYNC_FLUSH)) {
+                return false;
+            }
+            m_pendingInput = 0;
+        }
+#endif
+        return true;
+    }
+
+    bool StreamingDeflate::Finish(std::vector<uint8_t>& output)
+    {
+        if (!m_active) {
+            return false;
+        }
+#ifdef HAVE_MAT_ZLIB
+        m_stream->next_in = nullptr;
+        m_stream->avail_in = 0;
+        if (!deflateChunk(Z_FINISH)) {
+            return false;
+        }
+        m_output.resize(m_stream->total_out);
+        output.swap(m_output);
+        // Whatever the caller had in output becomes the next output buffer
+        m_output.clear();
+        if (m_output.capacity() > kMaxRetainedOutput) {
+            std::vector<uint8_t>().swap(m_output);
+        }
+        m_pendingInput = 0;
+#else
+        UNREFERENCED_PARAMETER(output);
+#endif
+        // Keep the zlib state for the next Begin()
+        m_active = false;
+        return true;
+    }
+
+    size_t StreamingDeflate::GetSizeEstimate() const
+    {
+#ifdef HAVE_MAT_ZLIB
+        if (m_active) {
+            return static_cast<size_t>(m_stream->total_out) + m_pendingInput;
+        }
+#endif
+        return m_output.size();
+    }
+
+    bool StreamingDeflate::deflateChunk(int flush)
+    {
+#ifdef HAVE_MAT_ZLIB
+        for (;;) {
+            if (m_stream->avail_out == 0) {
+                size_t used = m_stream->total_out;
+                m_output.resize(std::max<size_t>({ m_output.size() * 2, m_output.capacity(), size_t { 16 * 1024 } }));
+                m_stream->next_out = m_output.data() + used;
+                m_stream->avail_out = static_cast<uInt>(m_output.size() - used);
+            }
+
+            int result = deflate(m_stream.get(), flush);
+            if (result == Z_STREAM_END) {
+                return true;
+            }
+            if (result != Z_OK && result != Z_BUF_ERROR) {
+                LOG_WARN("Streaming compression failed, error=%d (%s)", result, m_stream->msg);
+                end();
+                return false;
+            }
+            // Done once all input is consumed and zlib did not fill the output,
+            // i.e. it has nothing more to write for this flush mode.
+            if (flush != Z_FINISH && m_stream->avail_in == 0 && m_stream->avail_out != 0) {
+                return true;
+            }
+        }
+#else
+        UNREFERENCED_PARAMETER(flush);
+        return false;
+#endif
+    }
+
+    void StreamingDeflate::end()
+    {
+#ifdef HAVE_MAT_ZLIB
+        if (m_initialized) {
+            deflateEnd(m_stream.get());
+        }
+#endif
+        m_initialized = false;
+        m_active = false;
+    }
+
+} MAT_NS_END
@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+#include "Version.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct z_stream_s;
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Deflate stream that is fed one record at a time while a package is
+    /// being built, so that the body is already compressed when packaging
+    /// finishes and the compressed size is known for every added record.
+    /// </summary>
+    class StreamingDeflate {
+    public:
+        StreamingDeflate();
+        ~StreamingDeflate();
+
+        StreamingDeflate(StreamingDeflate const&) = delete;
+        StreamingDeflate& operator=(StreamingDeflate const&) = delete;
+
+        /// <summary>
+        /// zlib windowBits for the HTTP Content-Encoding: raw deflate without
+        /// zlib header (as required by IIS) for "deflate", gzip header for "gzip".
+        /// </summary>
+        static int GetWindowBits(std::string const& contentEncoding);
+
+        /// <summary>
+        /// Approximate size of the zlib deflate state, as documented in zconf.h.
+        /// </summary>
+        static size_t GetStateSize(int windowBits);
+
+        /// <summary>
+        /// Start a new stream. A stream that was used before with the same
+        /// windowBits and level is reset with deflateReset() instead of being
+        /// reallocated. Level -1 is the zlib default.
+        /// </summary>
+        bool Begin(int windowBits, int level = -1);
+        bool Append(uint8_t const* data, size_t size);
+
+        /// <summary>
+        /// Sync flush so that GetSizeEstimate() is exact, used when the
+        /// estimate gets close to the upload size limit.
+        /// </summary>
+        bool Flush();
+
+        /// <summary>
+        /// Finish the stream and move the compressed data into output.
+        /// The object can be reused with another Begin() afterwards.
+        /// </summary>
+        bool Finish(std::vector<uint8_t>& output);
+
+        /// <summary>
+        /// Upper estimate of the compressed size so far: bytes already produced
+        /// plus the input that zlib may still hold back since the last flush.
+        /// </summary>
+        size_t GetSizeEstimate() const;
+
+        size_t GetInputSize() const { return m_inputSize; }
+
+        bool IsActive() const { return m_active; }
+
+        int GetWindowBits() const { return m_windowBits; }
+
+        int GetLevel() const { return m_level; }
+
+        /// <summary>
+        /// Bytes of zlib state the last Begin() did not have to allocate.
+        /// </summary>
+        size_t GetReusedStateBytes() const { return m_reused ? GetStateSize(m_windowBits) : 0; }
+
+    protected:
+        bool deflateChunk(int flush);
+        void end();
+
+        // Flush every so often so that the size estimate does not drift too far
+        // from the real compressed size. A sync flush costs about 5 bytes.
+        static const size_t kSyncFlushInterval = 64 * 1024;
+
+        // Output buffers up to this capacity are kept for the next stream
+        static const size_t kMaxRetainedOutput = 256 * 1024;
+
+        std::unique_ptr<z_stream_s> m_stream;
+        std::vector<uint8_t>        m_output;
+        size_t                      m_inputSize = 0;
+        size_t                      m_pendingInput = 0;
+        int                         m_windowBits = 0;
+        int                         m_level = -1;
+        bool                        m_initialized = false;
+        bool                        m_active = false;
+        bool                        m_reused = false;
+    };
+
+} MAT_NS_END
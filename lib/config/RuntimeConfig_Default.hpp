@@ -19,6 +19,8 @@ namespace MAT_NS_BEGIN
         {CFG_BOOL_ENABLE_DB_DROP_IF_FULL, false},
         {CFG_INT_MAX_TEARDOWN_TIME, 1},
         {CFG_INT_MAX_PENDING_REQ, 4},
+        {CFG_INT_MAX_PENDING_REQ_PER_LATENCY, 2},
+        {CFG_INT_TASK_DISPATCHER_THREADS, 1},
         {CFG_INT_RAM_QUEUE_BUFFERS, 3},
         {CFG_INT_TRACE_LEVEL_MASK, 0},
         {CFG_BOOL_ENABLE_TRACE, true},
@@ -53,7 +55,10 @@ namespace MAT_NS_BEGIN
              {CFG_BOOL_HTTP_COMPRESSION, false}
 #endif
              ,
-             {"contentEncoding", "deflate"},
+             {CFG_STR_HTTP_CONTENT_ENCODING, "deflate"},
+             {CFG_INT_HTTP_COMPRESSION_LEVEL, -1},
+             {CFG_BOOL_HTTP_STREAM_COMPRESSION, false},
+             {CFG_BOOL_HTTP_CURL_MULTI, false},
              /* Optional parameter to require Microsoft Root CA */
              {CFG_BOOL_HTTP_MS_ROOT_CHECK, false}}},
         {CFG_MAP_TPM,
@@ -62,6 +67,15 @@ namespace MAT_NS_BEGIN
              {CFG_INT_TPM_MAX_RETRY, 5},
              {CFG_BOOL_TPM_CLOCK_SKEW_ENABLED, true},
              {CFG_STR_TPM_BACKOFF, "E,3000,300000,2,1"},
+             {CFG_BOOL_TPM_ADAPTIVE_UPLOAD, false},
+             {CFG_INT_TPM_MIN_UPLOAD_BYTES, 65536},
+             {CFG_INT_TPM_MAX_TIMER_PERCENT, 400},
+         }},
+        {CFG_MAP_INGEST,
+         {
+             {CFG_INT_INGEST_QUEUE_SIZE, 0},
+             {CFG_INT_INGEST_BATCH_SIZE, 256},
+             {CFG_STR_INGEST_BACKPRESSURE, "spill"},
          }},
         {CFG_MAP_COMPAT,
          {
@@ -149,7 +163,7 @@ namespace MAT_NS_BEGIN
 
         virtual const std::string& GetHttpRequestContentEncoding() const override
         {
-            return config[CFG_MAP_HTTP]["contentEncoding"];
+            return config[CFG_MAP_HTTP][CFG_STR_HTTP_CONTENT_ENCODING];
         }
 
         virtual unsigned GetMinimumUploadBandwidthBps() override
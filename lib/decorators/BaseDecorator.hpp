@@ -45,7 +45,7 @@ namespace MAT_NS_BEGIN
             return false;
         }
 
-        void setIfNotEmpty(std::map<std::string, CsProtocol::Value>& dest, std::string const& key, std::string const& value)
+        void setIfNotEmpty(::CsProtocol::PropertyMap& dest, std::string const& key, std::string const& value)
         {
             if (!value.empty())
             {
@@ -56,7 +56,7 @@ namespace MAT_NS_BEGIN
             }
         }
 
-        void setOrErase(std::map<std::string, CsProtocol::Value>& dest, std::string const& key, std::string const& value)
+        void setOrErase(::CsProtocol::PropertyMap& dest, std::string const& key, std::string const& value)
         {
             if (!value.empty())
             {
@@ -71,7 +71,7 @@ namespace MAT_NS_BEGIN
             }
         }
 
-        void setBoolValue(std::map<std::string, CsProtocol::Value>& dest, std::string const& key, bool const& value)
+        void setBoolValue(::CsProtocol::PropertyMap& dest, std::string const& key, bool const& value)
         {
             CsProtocol::Value temp;
             temp.type = CsProtocol::ValueKind::ValueBool;
@@ -86,7 +86,7 @@ namespace MAT_NS_BEGIN
             dest[key] = temp;
         }
 
-        void setDateTimeValue(std::map<std::string, CsProtocol::Value>& dest, std::string const& key, int64_t const& value)
+        void setDateTimeValue(::CsProtocol::PropertyMap& dest, std::string const& key, int64_t const& value)
         {
             CsProtocol::Value temp;
             temp.type = CsProtocol::ValueKind::ValueDateTime;
@@ -94,7 +94,7 @@ namespace MAT_NS_BEGIN
             dest[key] = temp;
         }
 
-        void setInt64Value(std::map<std::string, CsProtocol::Value>& dest, std::string const& key, int64_t const& value)
+        void setInt64Value(::CsProtocol::PropertyMap& dest, std::string const& key, int64_t const& value)
         {
             CsProtocol::Value temp;
             temp.type = CsProtocol::ValueKind::ValueInt64;
@@ -102,7 +102,7 @@ namespace MAT_NS_BEGIN
             dest[key] = temp;
         }
 
-        void setDoubleValue(std::map<std::string, CsProtocol::Value>& dest, std::string const& key, double const& value)
+        void setDoubleValue(::CsProtocol::PropertyMap& dest, std::string const& key, double const& value)
         {
             CsProtocol::Value temp;
             temp.type = CsProtocol::ValueKind::ValueDouble;
@@ -116,7 +116,7 @@ namespace MAT_NS_BEGIN
         };
 
         template<size_t N>
-        void setEnumValue(std::map<std::string, CsProtocol::Value>& dest, std::string const& key, ptrdiff_t value, EnumValueName const (&names)[N])
+        void setEnumValue(::CsProtocol::PropertyMap& dest, std::string const& key, ptrdiff_t value, EnumValueName const (&names)[N])
         {
             for (EnumValueName const& item : names) {
                 if (item.value == value) {
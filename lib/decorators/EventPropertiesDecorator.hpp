@@ -8,6 +8,7 @@
 #include "IDecorator.hpp"
 #include "EventProperties.hpp"
 #include "CorrelationVector.hpp"
+#include "system/EventPropertiesStorage.hpp"
 #include "utils/Utils.hpp"
 
 #include <algorithm>
@@ -87,7 +88,344 @@ namespace MAT_NS_BEGIN {
             record.cV = "";
         }
 
-        bool decorate(::CsProtocol::Record& record, EventLatency& latency, EventProperties const& eventProperties)
+        /// <summary>
+        /// True if BondSerializer can write the Part C properties of the event
+        /// straight from EventProperties, without building CsProtocol::Value
+        /// objects first. Part B properties and the correlation vector change
+        /// other parts of the record and always take the regular path.
+        /// </summary>
+        static bool canSerializeDirectly(EventProperties const& eventProperties)
+        {
+            if (!eventProperties.GetPropertiesFlat(DataCategory_PartB).empty())
+            {
+                return false;
+            }
+            for (auto const& kv : eventProperties.GetPropertiesFlat())
+            {
+                if (kv.second.dataCategory == DataCategory_PartB || kv.first == CorrelationVector::PropertyName)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Adds the Part C properties that decorate() left out for direct
+        /// serialization, for when the record is needed after all.
+        /// </summary>
+        static void mergeProperties(::CsProtocol::Record& record, EventProperties const& eventProperties)
+        {
+            if (record.data.size() == 0)
+            {
+                ::CsProtocol::Data data;
+                record.data.push_back(data);
+            }
+            ::CsProtocol::PropertyMap extPartB;
+            for (auto const& kv : eventProperties.GetPropertiesFlat())
+            {
+                addProperty(record.data[0].properties, extPartB, kv.first, kv.second);
+            }
+        }
+
+        static void addProperty(::CsProtocol::PropertyMap& ext, ::CsProtocol::PropertyMap& extPartB,
+            std::string const& k, EventProperty const& v)
+        {
+            if (v.piiKind != PiiKind_None)
+            {
+                if (v.piiKind == PiiKind::CustomerContentKind_GenericData)
+                {  //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
+                    CsProtocol::CustomerContent cc;
+                    cc.Kind = CsProtocol::CustomerContentKind::GenericContent;
+                    CsProtocol::Value temp;
+
+                    CsProtocol::Attributes attrib;
+                    attrib.customerContent.push_back(cc);
+
+                    temp.attributes.push_back(attrib);
+                    temp.stringValue = v.to_string();
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+
+                }
+                else
+                { //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
+                    CsProtocol::PII pii;
+                    pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
+                    CsProtocol::Value temp;
+
+                    CsProtocol::Attributes attrib;
+                    attrib.pii.push_back(pii);
+
+
+                    temp.attributes.push_back(attrib);
+                    temp.stringValue = v.to_string();
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+#if 0 /* v2 code */
+                    if (v.piiKind != PiiKind_None)
+                    {
+                        //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
+                        CsProtocol::PII pii;
+                        pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
+                        pii.RawContent = v.to_string();
+                        // ScrubType = 1 is the O365 scrubber which is the default behavior.
+                        // pii.ScrubType = static_cast<PIIScrubber>(O365);
+                        pii.ScrubType = CsProtocol::O365;
+                        PIIExtensions[k] = pii;
+                        // 4. Send event's Pii context fields as record.PIIExtensions
+                    }
+                    else
+                    {
+                        //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
+                        CsProtocol::CustomerContent cc;
+                        cc.Kind = static_cast<CsProtocol::CustomerContentKind>(v.ccKind);
+                        cc.RawContent = v.to_string();
+                        ccExtensions[k] = cc;
+                        // 4. Send event's Pii context fields as record.PIIExtensions
+#endif
+                }
+            }
+            else {
+                std::vector<uint8_t> guid;
+                uint8_t guid_bytes[16] = { 0 };
+
+                switch (v.type)
+                {
+                case EventProperty::TYPE_STRING:
+                {
+                    CsProtocol::Value temp;
+                    temp.stringValue = v.to_string();
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_INT64:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueInt64;
+                    temp.longValue = v.as_int64;
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_DOUBLE:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueDouble;
+                    temp.doubleValue = v.as_double;
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_TIME:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueDateTime;
+                    temp.longValue = v.as_time_ticks.ticks;
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_BOOLEAN:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueBool;
+                    temp.longValue = v.as_bool;
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_GUID:
+                {
+                    GUID_t temp = v.as_guid;
+                    temp.to_bytes(guid_bytes);
+                    guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
+
+                    CsProtocol::Value tempValue;
+                    tempValue.type = ::CsProtocol::ValueKind::ValueGuid;
+                    tempValue.guidValue.push_back(guid);
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(tempValue);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(tempValue);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_INT64_ARRAY:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueArrayInt64;
+                    temp.longArray.push_back(*v.as_longArray);
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_DOUBLE_ARRAY:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueArrayDouble;
+                    temp.doubleArray.push_back(*v.as_doubleArray);
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_STRING_ARRAY:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueArrayString;
+                    temp.stringArray.push_back(*v.as_stringArray);
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                case EventProperty::TYPE_GUID_ARRAY:
+                {
+                    CsProtocol::Value temp;
+                    temp.type = ::CsProtocol::ValueKind::ValueArrayGuid;
+
+                    std::vector<std::vector<uint8_t>> values;
+                    for (const auto& tempValue : *v.as_guidArray)
+                    {
+                        tempValue.to_bytes(guid_bytes);
+                        guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
+                        values.push_back(guid);
+                    }
+                    temp.guidArray.push_back(values);
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                    break;
+                }
+                default:
+                {
+                    // Convert all unknown types to string
+                    CsProtocol::Value temp;
+                    temp.stringValue = v.to_string();
+                    if (v.dataCategory == DataCategory_PartB)
+                    {
+                        extPartB[k] = std::move(temp);
+                    }
+                    else
+                    {
+                        ext[k] = std::move(temp);
+                    }
+                }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Same as addProperty above, but moves array values out of the
+        /// property instead of copying them element by element. Strings are
+        /// still copied: EventProperty keeps them as C strings for the C API.
+        /// </summary>
+        static void addProperty(::CsProtocol::PropertyMap& ext, ::CsProtocol::PropertyMap& extPartB,
+            std::string const& k, EventProperty&& v)
+        {
+            CsProtocol::Value temp;
+            switch ((v.piiKind == PiiKind_None) ? v.type : EventProperty::TYPE_STRING)
+            {
+            case EventProperty::TYPE_INT64_ARRAY:
+                temp.type = ::CsProtocol::ValueKind::ValueArrayInt64;
+                temp.longArray.push_back(std::move(*v.as_longArray));
+                break;
+            case EventProperty::TYPE_DOUBLE_ARRAY:
+                temp.type = ::CsProtocol::ValueKind::ValueArrayDouble;
+                temp.doubleArray.push_back(std::move(*v.as_doubleArray));
+                break;
+            case EventProperty::TYPE_STRING_ARRAY:
+                temp.type = ::CsProtocol::ValueKind::ValueArrayString;
+                temp.stringArray.push_back(std::move(*v.as_stringArray));
+                break;
+            default:
+                addProperty(ext, extPartB, k, static_cast<EventProperty const&>(v));
+                return;
+            }
+            if (v.dataCategory == DataCategory_PartB)
+            {
+                extPartB[k] = std::move(temp);
+            }
+            else
+            {
+                ext[k] = std::move(temp);
+            }
+        }
+
+        /// <summary>
+        /// Decorates the record with the event properties. With consumeProperties
+        /// the caller handed the event over (ILogger::LogEvent(EventProperties&&))
+        /// and array values are moved into the record rather than copied.
+        /// </summary>
+        bool decorate(::CsProtocol::Record& record, EventLatency& latency, EventProperties const& eventProperties, bool serializeDirectly = false, bool consumeProperties = false)
         {
             if (latency == EventLatency_Unspecified)
                 latency = EventLatency_Normal;
@@ -151,10 +489,14 @@ namespace MAT_NS_BEGIN {
             }
             record.flags = flags;
 
-            std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
-            std::map<std::string, ::CsProtocol::Value> extPartB;
+            ::CsProtocol::PropertyMap& ext = record.data[0].properties;
+            ::CsProtocol::PropertyMap extPartB;
 
-            for (auto &kv : eventProperties.GetProperties()) {
+            if (consumeProperties) {
+                // Array values are moved out below
+                eventProperties.m_storage->invalidateCopies();
+            }
+            for (auto &kv : eventProperties.m_storage->properties) {
 
                 EventRejectedReason isValidPropertyName = validatePropertyName(kv.first);
                 if (isValidPropertyName != REJECTED_REASON_OK)
@@ -165,265 +507,26 @@ namespace MAT_NS_BEGIN {
                     m_owner.DispatchEvent(evt);
                     return false;
                 }
-                const auto &k = kv.first;
-                const auto &v = kv.second;
-                if (v.piiKind != PiiKind_None)
+                if (serializeDirectly)
                 {
-                    if (v.piiKind == PiiKind::CustomerContentKind_GenericData)
-                    {  //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                        CsProtocol::CustomerContent cc;
-                        cc.Kind = CsProtocol::CustomerContentKind::GenericContent;
-                        CsProtocol::Value temp;
-
-                        CsProtocol::Attributes attrib;
-                        attrib.customerContent.push_back(cc);
-
-                        temp.attributes.push_back(attrib);
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-
-                    }
-                    else
-                    { //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                        CsProtocol::PII pii;
-                        pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
-                        CsProtocol::Value temp;
-
-                        CsProtocol::Attributes attrib;
-                        attrib.pii.push_back(pii);
-
-
-                        temp.attributes.push_back(attrib);
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-#if 0 /* v2 code */
-                        if (v.piiKind != PiiKind_None)
-                        {
-                            //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                            CsProtocol::PII pii;
-                            pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
-                            pii.RawContent = v.to_string();
-                            // ScrubType = 1 is the O365 scrubber which is the default behavior.
-                            // pii.ScrubType = static_cast<PIIScrubber>(O365);
-                            pii.ScrubType = CsProtocol::O365;
-                            PIIExtensions[k] = pii;
-                            // 4. Send event's Pii context fields as record.PIIExtensions
-                        }
-                        else
-                        {
-                            //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                            CsProtocol::CustomerContent cc;
-                            cc.Kind = static_cast<CsProtocol::CustomerContentKind>(v.ccKind);
-                            cc.RawContent = v.to_string();
-                            ccExtensions[k] = cc;
-                            // 4. Send event's Pii context fields as record.PIIExtensions
-#endif
-                    }
+                    // BondSerializer writes the value straight from eventProperties
+                    continue;
                 }
-                else {
-                    std::vector<uint8_t> guid;
-                    uint8_t guid_bytes[16] = { 0 };
-
-                    switch (v.type)
-                    {
-                    case EventProperty::TYPE_STRING:
-                    {
-                        CsProtocol::Value temp;
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_INT64:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueInt64;
-                        temp.longValue = v.as_int64;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_DOUBLE:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueDouble;
-                        temp.doubleValue = v.as_double;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_TIME:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueDateTime;
-                        temp.longValue = v.as_time_ticks.ticks;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_BOOLEAN:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueBool;
-                        temp.longValue = v.as_bool;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_GUID:
-                    {
-                        GUID_t temp = v.as_guid;
-                        temp.to_bytes(guid_bytes);
-                        guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-
-                        CsProtocol::Value tempValue;
-                        tempValue.type = ::CsProtocol::ValueKind::ValueGuid;
-                        tempValue.guidValue.push_back(guid);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = tempValue;
-                        }
-                        else
-                        {
-                            ext[k] = tempValue;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_INT64_ARRAY:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueArrayInt64;
-                        temp.longArray.push_back(*v.as_longArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_DOUBLE_ARRAY:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueArrayDouble;
-                        temp.doubleArray.push_back(*v.as_doubleArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_STRING_ARRAY:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueArrayString;
-                        temp.stringArray.push_back(*v.as_stringArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    case EventProperty::TYPE_GUID_ARRAY:
-                    {
-                        CsProtocol::Value temp;
-                        temp.type = ::CsProtocol::ValueKind::ValueArrayGuid;
-
-                        std::vector<std::vector<uint8_t>> values;
-                        for (const auto& tempValue : *v.as_guidArray)
-                        {
-                            tempValue.to_bytes(guid_bytes);
-                            guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-                            values.push_back(guid);
-                        }
-                        temp.guidArray.push_back(values);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                        break;
-                    }
-                    default:
-                    {
-                        // Convert all unknown types to string
-                        CsProtocol::Value temp;
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-                    }
-                    }
+                if (consumeProperties)
+                {
+                    addProperty(ext, extPartB, kv.first, std::move(kv.second));
+                }
+                else
+                {
+                    addProperty(ext, extPartB, kv.first, kv.second);
                 }
             }
 
             if (extPartB.size() > 0)
             {
                 ::CsProtocol::Data partBdata;
-                partBdata.properties = extPartB;
-                record.baseData.push_back(partBdata);
+                partBdata.properties = std::move(extPartB);
+                record.baseData.push_back(std::move(partBdata));
             }
 
             // special case of CorrelationVector value
@@ -59,6 +59,26 @@ namespace MAT_NS_BEGIN
             });
     }
 
+    void EventFilterCollection::CanEventPropertiesBeSent(const std::vector<EventProperties>& events, std::vector<bool>& allowed) const noexcept
+    {
+        if (Empty())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_filterLock);
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            if (allowed[i])
+            {
+                allowed[i] = std::all_of(m_filters.cbegin(), m_filters.cend(),
+                    [&events, i](const std::unique_ptr<IEventFilter>& filter)
+                    {
+                        return filter->CanEventPropertiesBeSent(events[i]);
+                    });
+            }
+        }
+    }
+
     size_t EventFilterCollection::Size() const noexcept
     {
         return m_size.load();
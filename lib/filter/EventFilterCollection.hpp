@@ -22,6 +22,7 @@ namespace MAT_NS_BEGIN
         void UnregisterEventFilter(const char* filterName) override;
         void UnregisterAllFilters() noexcept override;
         bool CanEventPropertiesBeSent(const EventProperties& properties) const noexcept override;
+        void CanEventPropertiesBeSent(const std::vector<EventProperties>& events, std::vector<bool>& allowed) const noexcept override;
         virtual size_t Size() const noexcept override;
         virtual bool Empty() const noexcept override;
 
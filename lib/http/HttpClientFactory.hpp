@@ -29,6 +29,19 @@ private:
 #include "http/HttpClient_WinInet.hpp"
 #endif
 
+#ifdef __APPLE__
+#include <TargetConditionals.h>
+#endif
+
+// Same choice as HttpClientFactory::Create(): libcurl unless the platform has its own client
+#if !defined(MATSDK_PAL_WIN32) && !defined(HAVE_MAT_CURL_HTTP_CLIENT) && \
+    !(TARGET_OS_IPHONE || (defined(__APPLE__) && defined(APPLE_HTTP)) || defined(ANDROID))
+#define HAVE_MAT_CURL_HTTP_CLIENT
+#endif
+#if defined(HAVE_MAT_CURL_HTTP_CLIENT) && !defined(MATSDK_PAL_WIN32)
+#include "http/HttpClient_Curl.hpp"
+#endif
+
 #endif // HAVE_MAT_DEFAULT_HTTP_CLIENT
 
 #endif // HTTPCLIENTFACTORY_HPP
@@ -10,7 +10,9 @@
 
 #include "Version.hpp"
 
+#include <map>
 #include <memory>
+#include <thread>
 
 #include "utils/Utils.hpp"
 #include "HttpClient_Curl.hpp"
@@ -43,6 +45,292 @@ namespace MAT_NS_BEGIN {
         std::shared_ptr<CurlHttpOperation> m_curlOperation;
     };
 
+    /**
+     * Set the result of a finished request. code is the HTTP status code on
+     * success and the CURLcode otherwise, the two sets do not intersect.
+     */
+    static void SetResponseResult(SimpleHttpResponse& response, long code, bool aborted)
+    {
+        response.m_result = HttpResult_OK;
+        response.m_statusCode = code;
+        if (code == CURLE_FAILED_INIT) {
+            // There was an error in CURL stack while trying to create request
+            response.m_result = HttpResult_LocalFailure;
+        } else if ((CURLE_OK < code) && (code <= CURL_LAST)) {
+            if (aborted) {
+                // Operation was manually aborted
+                response.m_result = HttpResult_Aborted;
+            } else {
+                // There was an error in CURL stack while trying to connect
+                response.m_result = HttpResult_NetworkFailure;
+            }
+        }
+    }
+
+    /**
+     * Runs the requests of HttpClient_Curl in multi-handle mode on a single
+     * curl_multi event loop thread. The multi handle keeps connections alive
+     * between requests and finished easy handles go back to a pool, so
+     * consecutive uploads skip the TCP and TLS handshakes.
+     */
+    class CurlMultiEngine
+    {
+    public:
+        CurlMultiEngine() :
+            m_multi(curl_multi_init()),
+            m_stopping(false)
+        {
+#ifdef CURLPIPE_MULTIPLEX
+            // Send concurrent requests to one host over a single HTTP/2 connection
+            curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+            m_thread = std::thread(&CurlMultiEngine::Run, this);
+        }
+
+        ~CurlMultiEngine()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_stopping = true;
+            }
+            Wakeup();
+            m_thread.join();
+            for (CURL* easy : m_pool) {
+                curl_easy_cleanup(easy);
+            }
+            curl_multi_cleanup(m_multi);
+        }
+
+        void Send(CurlHttpRequest* request, IHttpResponseCallback* callback)
+        {
+            std::unique_ptr<Transfer> transfer(new Transfer());
+            transfer->request = request;
+            transfer->callback = callback;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_pending.push_back(std::move(transfer));
+            }
+            Wakeup();
+        }
+
+        void Cancel(std::string const& id)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_cancelled.push_back(id);
+            }
+            Wakeup();
+        }
+
+    protected:
+        // Easy handles kept for reuse, more than this are cleaned up
+        static constexpr size_t MaxPooledHandles = 8;
+        // Longest wait for socket activity without wakeup support
+        static constexpr int PollTimeoutMs = 1000;
+
+        struct Transfer
+        {
+            // Not owned, lives until the response is delivered
+            CurlHttpRequest*        request = nullptr;
+            IHttpResponseCallback*  callback = nullptr;
+            CURL*                   easy = nullptr;
+            struct curl_slist*      headers = nullptr;
+            std::vector<uint8_t>    respHeaders;
+            std::vector<uint8_t>    respBody;
+        };
+
+        void Wakeup()
+        {
+#if LIBCURL_VERSION_NUM >= 0x074400
+            curl_multi_wakeup(m_multi);
+#endif
+        }
+
+        void Run()
+        {
+            for (;;)
+            {
+                std::vector<std::unique_ptr<Transfer>> added;
+                std::vector<std::string> cancelled;
+                bool stopping;
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    added.swap(m_pending);
+                    cancelled.swap(m_cancelled);
+                    stopping = m_stopping;
+                }
+
+                for (auto& transfer : added) {
+                    Start(std::move(transfer));
+                }
+                for (auto const& id : cancelled) {
+                    auto it = m_active.find(id);
+                    if (it != m_active.end()) {
+                        Finish(it, CURLE_ABORTED_BY_CALLBACK, true);
+                    }
+                }
+                if (stopping) {
+                    while (!m_active.empty()) {
+                        Finish(m_active.begin(), CURLE_ABORTED_BY_CALLBACK, true);
+                    }
+                    return;
+                }
+
+                int running = 0;
+                curl_multi_perform(m_multi, &running);
+
+                CURLMsg* msg;
+                int queued = 0;
+                while ((msg = curl_multi_info_read(m_multi, &queued)) != nullptr) {
+                    if (msg->msg != CURLMSG_DONE) {
+                        continue;
+                    }
+                    char* priv = nullptr;
+                    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &priv);
+                    Transfer* transfer = reinterpret_cast<Transfer*>(priv);
+                    long code = msg->data.result;
+                    if (msg->data.result == CURLE_OK) {
+                        curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &code);
+                    }
+                    Finish(m_active.find(transfer->request->GetId()), code, false);
+                }
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+                curl_multi_poll(m_multi, nullptr, 0, PollTimeoutMs, nullptr);
+#else
+                // No way to wake curl_multi_wait up, keep the wait short
+                curl_multi_wait(m_multi, nullptr, 0, 50, nullptr);
+#endif
+            }
+        }
+
+        void Start(std::unique_ptr<Transfer> transfer)
+        {
+            std::string id = transfer->request->GetId();
+            CurlHttpRequest& request = *transfer->request;
+            // Claim the ID first, a rejected emplace would destroy a moved-in transfer
+            auto result = m_active.emplace(id, nullptr);
+            if (!result.second) {
+                // A response would carry the ID of the live transfer and have its owner
+                // release the request while curl still uses it, so drop this one quietly
+                TRACE("Error: request %s is already in flight, ignoring it\n", id.c_str());
+                return;
+            }
+            auto it = result.first;
+            if (m_pool.empty()) {
+                transfer->easy = curl_easy_init();
+            } else {
+                transfer->easy = m_pool.back();
+                m_pool.pop_back();
+            }
+            it->second = std::move(transfer);
+            Transfer& t = *it->second;
+            if (t.easy == nullptr) {
+                TRACE("libcurl failed to init!\n");
+                Finish(it, CURLE_FAILED_INIT, false);
+                return;
+            }
+
+            CURL* curl = t.easy;
+            curl_easy_setopt(curl, CURLOPT_PRIVATE, &t);
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(curl, CURLOPT_URL, request.m_url.c_str());
+
+            // TODO: expose SSL cert verification opts via ILogConfiguration
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
+#ifdef CURL_HTTP_VERSION_2TLS
+            // HTTP/2 over TLS when the server offers it, HTTP/1.1 keep-alive otherwise
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072B00
+            // Wait for a connection that can be multiplexed rather than opening another one
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+#endif
+
+            for (auto const& kv : request.m_headers) {
+                std::string header = kv.first;
+                header += ": ";
+                header += kv.second;
+                t.headers = curl_slist_append(t.headers, header.c_str());
+            }
+            if (t.headers != nullptr) {
+                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, t.headers);
+            }
+
+            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &WriteVectorCallback);
+            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &t.respHeaders);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &WriteVectorCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t.respBody);
+
+            // TODO: only two methods supported for now - POST and GET
+            if (request.m_method == "POST") {
+                curl_easy_setopt(curl, CURLOPT_POST, 1L);
+                // An empty body still needs a buffer, without one curl reads the body from stdin
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.m_body.empty() ? "" : reinterpret_cast<const char*>(request.m_body.data()));
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.m_body.size()));
+            } else if (request.m_method != "GET") {
+                TRACE("Error: unsupported method %s\n", request.m_method.c_str());
+                Finish(it, CURLE_UNSUPPORTED_PROTOCOL, false);
+                return;
+            }
+
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, HTTP_CONN_TIMEOUT);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 30L);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 4096L);
+
+            if (curl_multi_add_handle(m_multi, curl) != CURLM_OK) {
+                Finish(it, CURLE_FAILED_INIT, false);
+            }
+        }
+
+        void Finish(std::map<std::string, std::unique_ptr<Transfer>>::iterator it, long code, bool aborted)
+        {
+            std::unique_ptr<Transfer> transfer = std::move(it->second);
+            m_active.erase(it);
+
+            if (transfer->easy != nullptr) {
+                curl_multi_remove_handle(m_multi, transfer->easy);
+                if (m_pool.size() < MaxPooledHandles) {
+                    curl_easy_reset(transfer->easy);
+                    m_pool.push_back(transfer->easy);
+                } else {
+                    curl_easy_cleanup(transfer->easy);
+                }
+            }
+            curl_slist_free_all(transfer->headers);
+
+            std::unique_ptr<SimpleHttpResponse> response(new SimpleHttpResponse(transfer->request->GetId()));
+            SetResponseResult(*response, code, aborted);
+            CurlHttpOperation::ParseResponseHeaders(transfer->respHeaders, response->m_headers);
+            response->m_body = std::move(transfer->respBody);
+
+            // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear()
+            transfer->callback->OnHttpResponse(response.release());
+        }
+
+        static size_t WriteVectorCallback(void* ptr, size_t size, size_t nmemb, void* userp)
+        {
+            auto data = static_cast<std::vector<uint8_t>*>(userp);
+            auto begin = static_cast<uint8_t const*>(ptr);
+            data->insert(data->end(), begin, begin + size * nmemb);
+            return size * nmemb;
+        }
+
+        CURLM*                                              m_multi;
+        std::thread                                         m_thread;
+
+        // Handed over to the event loop thread
+        std::mutex                                          m_lock;
+        std::vector<std::unique_ptr<Transfer>>              m_pending;
+        std::vector<std::string>                            m_cancelled;
+        bool                                                m_stopping;
+
+        // Owned by the event loop thread
+        std::map<std::string, std::unique_ptr<Transfer>>    m_active;
+        std::vector<CURL*>                                  m_pool;
+    };
+
     HttpClient_Curl::HttpClient_Curl()
     {
         /* In windows, this will init the winsock stuff */
@@ -51,12 +339,28 @@ namespace MAT_NS_BEGIN {
         TRACE("libcurl version = %s\n", curl_version_info(CURLVERSION_NOW)->version);
     }
 
+    HttpClient_Curl::HttpClient_Curl(bool multiHandle) :
+        HttpClient_Curl()
+    {
+        if (multiHandle) {
+            EnableMultiHandle();
+        }
+    }
+
     HttpClient_Curl::~HttpClient_Curl()
     {
+        m_multi.reset();
         curl_global_cleanup();
         TRACE("Destroyed HttpClient_Curl.\n");
     };
 
+    void HttpClient_Curl::EnableMultiHandle()
+    {
+        if (m_multi == nullptr) {
+            m_multi.reset(new CurlMultiEngine());
+        }
+    }
+
     IHttpRequest* HttpClient_Curl::CreateRequest()
     {
         return new CurlHttpRequest();
@@ -64,6 +368,11 @@ namespace MAT_NS_BEGIN {
 
     void HttpClient_Curl::SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback)
     {
+        if (m_multi != nullptr) {
+            m_multi->Send(static_cast<CurlHttpRequest*>(request), callback);
+            return;
+        }
+
         // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear()
         AddRequest(request);
         auto curlRequest = static_cast<CurlHttpRequest*>(request);
@@ -82,24 +391,9 @@ namespace MAT_NS_BEGIN {
             this->EraseRequest(requestId);
 
             auto response = std::unique_ptr<SimpleHttpResponse>(new SimpleHttpResponse(requestId));
-            response->m_result = HttpResult_OK;
-
-            response->m_statusCode = operation.GetResponseCode();
-            if (response->m_statusCode == CURLE_FAILED_INIT) {
-                // There was an error in CURL stack while trying to create request
-                response->m_result = HttpResult_LocalFailure;
-            } else if ((CURLE_OK < response->m_statusCode) && (response->m_statusCode <= CURL_LAST)) {
-                if (operation.WasAborted()) {
-                    // Operation was manually aborted
-                    response->m_result = HttpResult_Aborted;
-                } else {
-                    // There was an error in CURL stack while trying to connect
-                    response->m_result = HttpResult_NetworkFailure;
-                }
-            }
+            SetResponseResult(*response, operation.GetResponseCode(), operation.WasAborted());
 
-            auto responseHeaders = operation.GetResponseHeaders();
-            response->m_headers.insert(responseHeaders.begin(), responseHeaders.end());
+            operation.GetResponseHeaders(response->m_headers);
             response->m_body = operation.GetResponseBody();
             
             // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear()
@@ -109,6 +403,11 @@ namespace MAT_NS_BEGIN {
 
     void HttpClient_Curl::CancelRequestAsync(std::string const& id)
     {
+        if (m_multi != nullptr) {
+            m_multi->Cancel(id);
+            return;
+        }
+
         CurlHttpRequest* request = nullptr;
         {
             // Hold the lock only while iterating over the list of requests
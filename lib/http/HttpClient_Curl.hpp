@@ -11,7 +11,6 @@
 #include <cstdlib>
 #include <cstdint>
 #include <string.h>
-#include <regex>
 
 #include <string>
 #include <sstream>
@@ -22,31 +21,44 @@
 #include <numeric>
 #include <future>
 #include <atomic>
+#include <memory>
 
 #include <curl/curl.h>
 
 #include <unistd.h>
 
 #include "IHttpClient.hpp"
+#include "http/HttpHeaderTokenizer.hpp"
 #include "pal/PAL.hpp"
 
 #define HTTP_CONN_TIMEOUT       5L
-#define HTTP_STATUS_REGEXP		"HTTP\\/\\d\\.\\d (\\d+)\\ .*"
-#define HTTP_HEADER_REGEXP      "(.*)\\: (.*)\\n*"
 
 #undef TRACE
 #define TRACE(...)	// printf
 
 namespace MAT_NS_BEGIN {
 
+class CurlMultiEngine;
+
 /**
  * Curl-based HTTP client
+ *
+ * By default every request gets its own easy handle, connection and thread.
+ * In multi-handle mode all requests run on one curl_multi event loop thread
+ * instead, reusing easy handles and keep-alive connections, multiplexed over
+ * HTTP/2 when libcurl and the server support it.
  */
 class HttpClient_Curl : public IHttpClient {
 public:
     HttpClient_Curl();
+    explicit HttpClient_Curl(bool multiHandle);
     virtual ~HttpClient_Curl();
 
+    /**
+     * Switch to multi-handle mode. Call before sending the first request.
+     */
+    void EnableMultiHandle();
+
     virtual IHttpRequest* CreateRequest() override;
     virtual void SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback) override;
     virtual void CancelRequestAsync(std::string const& id) override;
@@ -57,6 +69,8 @@ private:
 
     std::mutex m_requestsMtx;
     std::map<std::string, IHttpRequest*> m_requests;
+
+    std::unique_ptr<CurlMultiEngine> m_multi;
 };
 
 class CurlHttpOperation {
@@ -272,11 +286,8 @@ public:
         /* Code snippet to parse raw HTTP response. This might come in handy
          * if we ever consider to handle the raw upload instead of curl_easy_perform
        ...
-       std::string resp((const char *)response);
-       std::regex http_status_regex(HTTP_STATUS_REGEXP);
-       std::smatch match;
-       if(std::regex_search(resp, match, http_status_regex))
-         http_code = std::stol(match[1]);
+       HttpHeaders headers;
+       http_code = ParseHttpHeaders((const char *)response, responseSize, headers);
        ...
          */
 
@@ -322,28 +333,24 @@ cleanup:
     }
 
     /**
-     * Return a copy of resposne headers
+     * Copy response headers into 'headers'
      *
-     * @return
+     * @param headers
      */
-    std::map<std::string, std::string> GetResponseHeaders()
+    void GetResponseHeaders(HttpHeaders& headers)
     {
-        std::map<std::string, std::string> result;
-        if (respHeaders.size() == 0)
-            return result;
-
-        std::stringstream ss;
-        std::string headers((const char *)&respHeaders[0], respHeaders.size());
-        ss.str(headers);
+        ParseResponseHeaders(respHeaders, headers);
+    }
 
-        std::string header;
-        while (std::getline(ss, header, '\n')) {
-            std::smatch match;
-            std::regex http_headers_regex(HTTP_HEADER_REGEXP);
-            if (std::regex_search(header, match, http_headers_regex))
-                result[match[1]] = match[2];    // Key: value
-        }
-        return result;
+    /**
+     * Split raw response headers of the final response into 'headers'
+     *
+     * @param respHeaders
+     * @param headers
+     */
+    static void ParseResponseHeaders(std::vector<uint8_t> const& respHeaders, HttpHeaders& headers)
+    {
+        ParseHttpHeaders(reinterpret_cast<char const*>(respHeaders.data()), respHeaders.size(), headers);
     }
 
     /**
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef HTTPHEADERTOKENIZER_HPP
+#define HTTPHEADERTOKENIZER_HPP
+
+#include "IHttpClient.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Walks a raw HTTP/1.x or HTTP/2 response header block, as collected from
+    /// the header callback of an HTTP stack, one status line or header field at
+    /// a time. Tokens point into the caller's buffer, so tokenizing allocates
+    /// and copies nothing.
+    /// </summary>
+    /// <remarks>
+    /// Blank lines, folded continuation lines and lines that are neither a
+    /// status line nor a "name: value" field are skipped. Lines may end in
+    /// CRLF or a bare LF, and the last line needs no line break at all.
+    /// </remarks>
+    class HttpHeaderTokenizer
+    {
+    public:
+        struct Token
+        {
+            char const* data;
+            size_t      size;
+
+            bool equals(char const* text) const
+            {
+                return (strlen(text) == size) && (memcmp(data, text, size) == 0);
+            }
+
+            std::string str() const
+            {
+                return std::string(data, size);
+            }
+        };
+
+        enum LineType
+        {
+            StatusLine,
+            Field
+        };
+
+        HttpHeaderTokenizer(char const* data, size_t size) :
+            m_next(data),
+            m_end(data + size),
+            m_type(Field),
+            m_status(0),
+            m_name{data, 0},
+            m_value{data, 0}
+        {
+        }
+
+        /// <summary>
+        /// Moves to the next status line or header field.
+        /// </summary>
+        /// <returns>false once the whole block has been read.</returns>
+        bool next()
+        {
+            while (m_next < m_end) {
+                char const* begin = m_next;
+                char const* end = static_cast<char const*>(memchr(begin, '\n', static_cast<size_t>(m_end - begin)));
+                if (end == nullptr) {
+                    end = m_end;
+                    m_next = m_end;
+                } else {
+                    m_next = end + 1;
+                }
+                if (end > begin && end[-1] == '\r') {
+                    end--;
+                }
+                if (parseStatusLine(begin, end) || parseField(begin, end)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        LineType type() const { return m_type; }
+
+        /// <summary>
+        /// Status code of the current status line.
+        /// </summary>
+        int statusCode() const { return m_status; }
+
+        /// <summary>
+        /// Name of the current field, never empty.
+        /// </summary>
+        Token const& name() const { return m_name; }
+
+        /// <summary>
+        /// Value of the current field without surrounding whitespace.
+        /// </summary>
+        Token const& value() const { return m_value; }
+
+    protected:
+        static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+        static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+        // "HTTP/1.1 200 OK", "HTTP/2 429"
+        bool parseStatusLine(char const* begin, char const* end)
+        {
+            static char const prefix[] = "HTTP/";
+            size_t const prefixSize = sizeof(prefix) - 1;
+            if (static_cast<size_t>(end - begin) < prefixSize || memcmp(begin, prefix, prefixSize) != 0) {
+                return false;
+            }
+            char const* p = begin + prefixSize;
+            if (p == end || !isDigit(*p)) {
+                return false;
+            }
+            while (p < end && (isDigit(*p) || *p == '.')) {
+                p++;
+            }
+            if (p == end || *p != ' ') {
+                return false;
+            }
+            while (p < end && *p == ' ') {
+                p++;
+            }
+            if (end - p < 3 || !isDigit(p[0]) || !isDigit(p[1]) || !isDigit(p[2]) || (end - p > 3 && p[3] != ' ')) {
+                return false;
+            }
+            m_type = StatusLine;
+            m_status = (p[0] - '0') * 100 + (p[1] - '0') * 10 + (p[2] - '0');
+            return true;
+        }
+
+        // "Name: value", no whitespace allowed in or after the name
+        bool parseField(char const* begin, char const* end)
+        {
+            char const* colon = static_cast<char const*>(memchr(begin, ':', static_cast<size_t>(end - begin)));
+            if (colon == nullptr || colon == begin) {
+                return false;
+            }
+            for (char const* p = begin; p < colon; p++) {
+                if (static_cast<unsigned char>(*p) <= ' ' || *p == '\x7F') {
+                    return false;
+                }
+            }
+            char const* valueBegin = colon + 1;
+            while (valueBegin < end && isSpace(*valueBegin)) {
+                valueBegin++;
+            }
+            char const* valueEnd = end;
+            while (valueEnd > valueBegin && isSpace(valueEnd[-1])) {
+                valueEnd--;
+            }
+            m_type = Field;
+            m_name = Token{begin, static_cast<size_t>(colon - begin)};
+            m_value = Token{valueBegin, static_cast<size_t>(valueEnd - valueBegin)};
+            return true;
+        }
+
+        char const* m_next;
+        char const* m_end;
+        LineType    m_type;
+        int         m_status;
+        Token       m_name;
+        Token       m_value;
+    };
+
+    /// <summary>
+    /// Replaces the content of headers with the fields of the final response
+    /// in a raw header block. The fields of interim responses that precede it,
+    /// like "100 Continue" or a followed redirect, are dropped.
+    /// </summary>
+    /// <returns>Status code of the final response, 0 without a status line.</returns>
+    inline int ParseHttpHeaders(char const* data, size_t size, HttpHeaders& headers)
+    {
+        headers.clear();
+        int status = 0;
+        HttpHeaderTokenizer tokenizer(data, size);
+        while (tokenizer.next()) {
+            if (tokenizer.type() == HttpHeaderTokenizer::StatusLine) {
+                headers.clear();
+                status = tokenizer.statusCode();
+            } else {
+                headers.emplace(tokenizer.name().str(), tokenizer.value().str());
+            }
+        }
+        return status;
+    }
+
+} MAT_NS_END
+#endif
@@ -136,12 +136,12 @@ namespace MAT_NS_BEGIN {
             if (!tenantTokens.empty()) {
                 tenantTokens.push_back(',');
             }
-            tenantTokens.append(item.first);
+            tenantTokens.append(TenantRegistry::GetToken(item.first));
         }
         ctx->httpRequest->GetHeaders().set("APIKey", tenantTokens);
 
         if (ctx->compressed) {
-            ctx->httpRequest->GetHeaders().add("Content-Encoding", "deflate");
+            ctx->httpRequest->GetHeaders().add("Content-Encoding", ctx->contentEncoding.empty() ? "deflate" : ctx->contentEncoding);
         }
 
 
@@ -152,6 +152,7 @@ namespace MAT_NS_BEGIN {
         bond_lite::Deserialize(reader, result);
 #endif
 
+        ctx->bodySize = static_cast<unsigned>(ctx->body.size());
         ctx->httpRequest->SetBody(ctx->body);
         // IHttpRequest::SetBody() is free to swap the real body out, but better clear it anyway.
         ctx->body.clear();
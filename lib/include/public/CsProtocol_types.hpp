@@ -26,6 +26,8 @@
 #endif
 #endif
 
+#include "FlatMap.hpp"
+
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -942,9 +944,11 @@ struct Value {
     }
 };
 
+typedef MAT::FlatMap<std::string, ::CsProtocol::Value> PropertyMap;
+
 struct Data {
     // 1: optional map<string, Value> properties
-    std::map<std::string, ::CsProtocol::Value> properties;
+    ::CsProtocol::PropertyMap properties;
 
     bool operator==(Data const& other) const
     {
@@ -69,6 +69,8 @@ namespace MAT_NS_BEGIN
 
         /// <summary>Event(s) added to queue.</summary>
         EVT_ADDED               = 0x01001000,
+        /// <summary>Incoming event queue is full, backpressure policy applied.</summary>
+        EVT_INGEST_OVERFLOW     = 0x01001001,
         /// <summary>Event(s) cached in offline storage.</summary>
         EVT_CACHED              = 0x02000000,
         /// <summary>Event(s) dropped.</summary>
@@ -88,6 +90,8 @@ namespace MAT_NS_BEGIN
         EVT_SEND_RETRY_DROPPED  = 0x04000003,
         /// <summary>Event(s) skip UTC registration.</summary>
         EVT_SEND_SKIP_UTC_REGISTRATION = 0x04000004,
+        /// <summary>Adaptive upload controller updated, data points to an UploadControlState.</summary>
+        EVT_UPLOAD_CONTROL      = 0x04000005,
         /// <summary>Event(s) rejected, e.g.
         /// Failed regexp check or missing event name.
         /// </summary>
@@ -135,6 +139,27 @@ namespace MAT_NS_BEGIN
         //EVT_MASK_ALL        = 0xFFFFFFFF // We don't allow the 'all' handler at this time.
     } DebugEventType;
 
+    /// <summary>
+    /// State of the adaptive upload controller, reported by EVT_UPLOAD_CONTROL
+    /// after every completed upload. The event also carries uploadSizeBytes in
+    /// param1 and timerIntervalPercent in param2.
+    /// </summary>
+    struct UploadControlState
+    {
+        /// <summary>Size limit of the next upload packages in bytes.</summary>
+        size_t uploadSizeBytes;
+        /// <summary>Upload timer interval in percent of the transmit profile timers.</summary>
+        size_t timerIntervalPercent;
+        /// <summary>Smoothed HTTP request round trip time in milliseconds.</summary>
+        size_t rttMs;
+        /// <summary>Smoothed upload throughput in compressed bytes per second.</summary>
+        size_t throughputBytesPerSec;
+        /// <summary>Smoothed request body size in percent of the package size.</summary>
+        size_t compressionPercent;
+        /// <summary>Smoothed share of uploads throttled with HTTP 429 or 503, in permille.</summary>
+        size_t throttledPermille;
+    };
+
     /// <summary>The DebugEvent class represents a debug event object.</summary>
     class DebugEvent
     {
@@ -220,6 +245,12 @@ namespace MAT_NS_BEGIN
         /// <summary>Detach cascaded DebugEventSource to forward all events to</summary>
         virtual bool DetachEventSource(DebugEventSource & other);
 
+        /// <summary>Checks if this source or any cascaded source has a listener for the specified type.</summary>
+        bool HasListeners(DebugEventType type);
+
+        /// <summary>Changes whenever a listener or cascaded source is added to or removed from any source.</summary>
+        static uint64_t GetListenersVersion();
+
     protected:
 #ifndef _MANAGED
         /// <summary>
@@ -26,6 +26,9 @@ namespace MAT_NS_BEGIN
 {
     struct EventPropertiesStorage;
 
+    template<typename TKey, typename TValue>
+    class FlatMap;
+
     /// <summary>
     /// The EventProperties class encapsulates event properties.
     /// </summary>
@@ -78,6 +81,22 @@ namespace MAT_NS_BEGIN
         /// </summary>
         EventProperties& operator=(const std::map<std::string, EventProperty>& properties);
 
+        /// <summary>
+        /// Constructs an EventProperties object from a map of string to EventProperty,
+        /// moving the property values instead of copying them.
+        /// </summary>
+        EventProperties(const std::string& name, std::map<std::string, EventProperty>&& properties);
+
+        /// <summary>
+        /// Adds a map of <string, EventProperty> to EventProperties, moving the property values.
+        /// </summary>
+        EventProperties& operator+=(std::map<std::string, EventProperty>&& properties);
+
+        /// <summary>
+        /// Assigns a map of <string, EventProperty> to EventProperties, moving the property values.
+        /// </summary>
+        EventProperties& operator=(std::map<std::string, EventProperty>&& properties);
+
         /// <summary>
         /// An EventProperties constructor using a C++11 initializer list.
         /// </summary>
@@ -218,6 +237,7 @@ namespace MAT_NS_BEGIN
         /// <param name='name'>Name of the property</param>
         /// <param name='value'>Value of the property</param>
         /// <param name='piiKind'>PIIKind of the property</param>
+        /// <remarks>The value is moved into the event, pass a temporary or std::move it to avoid a copy.</remarks>
         void SetProperty(const std::string& name, EventProperty value);
 
         /// <summary>
@@ -346,9 +366,21 @@ namespace MAT_NS_BEGIN
         /// <summary>
         /// Get the properties bag of an event.
         /// </summary>
+        /// <remarks>
+        /// The event keeps its properties in a flat map. This returns a copy
+        /// that stays the same object until the properties change, and is
+        /// brought up to date on the next call after a change.
+        /// </remarks>
         /// <returns>Properties bag of the event</returns>
         const std::map<std::string, EventProperty>& GetProperties(DataCategory category = DataCategory_PartC) const;
 
+        /// <summary>
+        /// Get the properties bag of an event as stored, without a copy.
+        /// </summary>
+        /// <remarks>For use within the SDK, include FlatMap.hpp to use the result.</remarks>
+        /// <returns>Properties bag of the event</returns>
+        const FlatMap<std::string, EventProperty>& GetPropertiesFlat(DataCategory category = DataCategory_PartC) const;
+
         /// <summary>
         /// Get the Pii properties bag of an event.
         /// </summary>
@@ -360,6 +392,12 @@ namespace MAT_NS_BEGIN
         /// </summary>
         size_t erase(const std::string& key, DataCategory category = DataCategory_PartC);
 
+        /// <summary>
+        /// Reserves room for the given number of properties, so that setting
+        /// them does not grow the properties bag one step at a time.
+        /// </summary>
+        void reserve(size_t count, DataCategory category = DataCategory_PartC);
+
         virtual ~EventProperties() noexcept;
 
 #ifdef MAT_C_API
@@ -369,6 +407,7 @@ namespace MAT_NS_BEGIN
 #endif
 
        private:
+        friend class EventPropertiesDecorator;
         EventPropertiesStorage* m_storage;
     };
 } MAT_NS_END
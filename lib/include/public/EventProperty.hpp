@@ -315,10 +315,11 @@ namespace MAT_NS_BEGIN
         EventProperty(const EventProperty& source);
 
         /// <summary>
-        /// The EventProperty move constructor.
+        /// The EventProperty move constructor. Takes over the string or array
+        /// data of the source, which is left holding an int64 zero.
         /// </summary>
         /// <param name="source">The EventProperty object to move.</param>
-        EventProperty(EventProperty&& source);
+        EventProperty(EventProperty&& source) noexcept;
 
         /// <summary>
         /// The EventProperty equalto operator.
@@ -330,6 +331,12 @@ namespace MAT_NS_BEGIN
         /// </summary>
         EventProperty& operator=(const EventProperty& source);
 
+        /// <summary>
+        /// An EventProperty move assignment operator. Takes over the string or
+        /// array data of the source, which is left holding an int64 zero.
+        /// </summary>
+        EventProperty& operator=(EventProperty&& source) noexcept;
+
         /// <summary>
         /// An EventProperty assignment operator that takes a string value.
         /// </summary>
@@ -519,6 +526,8 @@ namespace MAT_NS_BEGIN
     private:
         void copydata(EventProperty const* source);
 
+        void release();
+
     };
 
 } MAT_NS_END
@@ -0,0 +1,329 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef MAT_FLATMAP_HPP
+#define MAT_FLATMAP_HPP
+
+#include "Version.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Map for the property sets of an event: a few dozen entries, built once
+    /// and read once or twice. Entries live in one vector in the order they
+    /// were added, and a second vector holds their indexes sorted by key. Adding
+    /// an entry appends it and inserts one index, so nothing but the index moves
+    /// and a reserved map adds entries without allocating.
+    /// </summary>
+    /// <remarks>
+    /// Offers the part of the std::map interface the SDK uses and iterates in
+    /// key order like std::map. Unlike std::map, adding or erasing entries may
+    /// move the others, so references and iterators into the map do not
+    /// survive modifications.
+    /// </remarks>
+    template<typename TKey, typename TValue>
+    class FlatMap
+    {
+    public:
+        typedef TKey                    key_type;
+        typedef TValue                  mapped_type;
+        typedef std::pair<TKey, TValue> value_type;
+        typedef size_t                  size_type;
+
+    protected:
+        typedef std::vector<value_type> entries_type;
+        typedef std::vector<uint32_t>   order_type;
+
+        template<typename TEntry, typename TEntries>
+        class basic_iterator
+        {
+        public:
+            typedef std::bidirectional_iterator_tag iterator_category;
+            typedef typename std::remove_const<TEntry>::type value_type;
+            typedef std::ptrdiff_t                  difference_type;
+            typedef TEntry*                         pointer;
+            typedef TEntry&                         reference;
+
+            basic_iterator() : m_entries(nullptr), m_position(nullptr) {}
+
+            basic_iterator(TEntries* entries, uint32_t const* position) :
+                m_entries(entries),
+                m_position(position)
+            {
+            }
+
+            // iterator converts to const_iterator, not the other way around
+            template<typename TOtherEntry, typename TOtherEntries,
+                typename = typename std::enable_if<std::is_convertible<TOtherEntries*, TEntries*>::value>::type>
+            basic_iterator(basic_iterator<TOtherEntry, TOtherEntries> const& other) :
+                m_entries(other.m_entries),
+                m_position(other.m_position)
+            {
+            }
+
+            reference operator*() const { return (*m_entries)[*m_position]; }
+            pointer operator->() const { return &(*m_entries)[*m_position]; }
+
+            basic_iterator& operator++() { ++m_position; return *this; }
+            basic_iterator operator++(int) { basic_iterator result = *this; ++m_position; return result; }
+            basic_iterator& operator--() { --m_position; return *this; }
+            basic_iterator operator--(int) { basic_iterator result = *this; --m_position; return result; }
+
+            template<typename TOtherEntry, typename TOtherEntries>
+            bool operator==(basic_iterator<TOtherEntry, TOtherEntries> const& other) const { return m_position == other.m_position; }
+
+            template<typename TOtherEntry, typename TOtherEntries>
+            bool operator!=(basic_iterator<TOtherEntry, TOtherEntries> const& other) const { return m_position != other.m_position; }
+
+        protected:
+            template<typename, typename> friend class basic_iterator;
+            friend class FlatMap;
+
+            TEntries*       m_entries;
+            uint32_t const* m_position;
+        };
+
+    public:
+        typedef basic_iterator<value_type, entries_type>             iterator;
+        typedef basic_iterator<value_type const, entries_type const> const_iterator;
+
+        FlatMap() = default;
+
+        FlatMap(std::initializer_list<value_type> items)
+        {
+            reserve(items.size());
+            for (auto const& item : items)
+            {
+                insert(item);
+            }
+        }
+
+        iterator begin() { return iterator(&m_entries, m_order.data()); }
+        iterator end() { return iterator(&m_entries, m_order.data() + m_order.size()); }
+        const_iterator begin() const { return const_iterator(&m_entries, m_order.data()); }
+        const_iterator end() const { return const_iterator(&m_entries, m_order.data() + m_order.size()); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        size_type size() const { return m_entries.size(); }
+        bool empty() const { return m_entries.empty(); }
+
+        void clear()
+        {
+            m_entries.clear();
+            m_order.clear();
+        }
+
+        void reserve(size_type count)
+        {
+            m_entries.reserve(count);
+            m_order.reserve(count);
+        }
+
+        iterator find(TKey const& key)
+        {
+            size_t position = lowerBound(key);
+            return found(position, key) ? at_position(position) : end();
+        }
+
+        const_iterator find(TKey const& key) const
+        {
+            return const_cast<FlatMap*>(this)->find(key);
+        }
+
+        iterator lower_bound(TKey const& key)
+        {
+            return at_position(lowerBound(key));
+        }
+
+        const_iterator lower_bound(TKey const& key) const
+        {
+            return const_cast<FlatMap*>(this)->lower_bound(key);
+        }
+
+        size_type count(TKey const& key) const
+        {
+            return found(lowerBound(key), key) ? 1 : 0;
+        }
+
+        TValue& at(TKey const& key)
+        {
+            size_t position = lowerBound(key);
+            if (!found(position, key))
+            {
+                throw std::out_of_range("FlatMap::at");
+            }
+            return m_entries[m_order[position]].second;
+        }
+
+        TValue const& at(TKey const& key) const
+        {
+            return const_cast<FlatMap*>(this)->at(key);
+        }
+
+        TValue& operator[](TKey const& key)
+        {
+            return emplace(key, TValue()).first->second;
+        }
+
+        TValue& operator[](TKey&& key)
+        {
+            size_t position = lowerBound(key);
+            if (!found(position, key))
+            {
+                add(position, std::move(key), TValue());
+            }
+            return m_entries[m_order[position]].second;
+        }
+
+        std::pair<iterator, bool> insert(value_type const& item)
+        {
+            return emplace(item.first, item.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& item)
+        {
+            size_t position = lowerBound(item.first);
+            if (found(position, item.first))
+            {
+                return std::make_pair(at_position(position), false);
+            }
+            add(position, std::move(item.first), std::move(item.second));
+            return std::make_pair(at_position(position), true);
+        }
+
+        template<typename TArg>
+        std::pair<iterator, bool> emplace(TKey const& key, TArg&& value)
+        {
+            size_t position = lowerBound(key);
+            if (found(position, key))
+            {
+                return std::make_pair(at_position(position), false);
+            }
+            add(position, key, std::forward<TArg>(value));
+            return std::make_pair(at_position(position), true);
+        }
+
+        /// <summary>
+        /// Adds the entry or assigns the value of the existing one, without
+        /// default-constructing a value first as operator[] does.
+        /// </summary>
+        template<typename TArg>
+        std::pair<iterator, bool> insert_or_assign(TKey const& key, TArg&& value)
+        {
+            size_t position = lowerBound(key);
+            if (found(position, key))
+            {
+                m_entries[m_order[position]].second = std::forward<TArg>(value);
+                return std::make_pair(at_position(position), false);
+            }
+            add(position, key, std::forward<TArg>(value));
+            return std::make_pair(at_position(position), true);
+        }
+
+        /// <summary>
+        /// Erases the entry and returns the one after it in key order.
+        /// </summary>
+        iterator erase(const_iterator it)
+        {
+            size_t position = static_cast<size_t>(it.m_position - m_order.data());
+            uint32_t index = m_order[position];
+            m_order.erase(m_order.begin() + position);
+
+            // Fill the hole with the last entry so no other index changes
+            uint32_t last = static_cast<uint32_t>(m_entries.size() - 1);
+            if (index != last)
+            {
+                m_entries[index] = std::move(m_entries[last]);
+                *std::find(m_order.begin(), m_order.end(), last) = index;
+            }
+            m_entries.pop_back();
+            return at_position(position);
+        }
+
+        size_type erase(TKey const& key)
+        {
+            size_t position = lowerBound(key);
+            if (!found(position, key))
+            {
+                return 0;
+            }
+            erase(at_position(position));
+            return 1;
+        }
+
+        bool operator==(FlatMap const& other) const
+        {
+            return (size() == other.size()) && std::equal(begin(), end(), other.begin());
+        }
+
+        bool operator!=(FlatMap const& other) const
+        {
+            return !(*this == other);
+        }
+
+    protected:
+        entries_type m_entries;
+        order_type   m_order;
+
+        TKey const& keyAt(size_t position) const
+        {
+            return m_entries[m_order[position]].first;
+        }
+
+        size_t lowerBound(TKey const& key) const
+        {
+            // Entries often arrive in key order, check for an append first
+            if (m_order.empty() || keyAt(m_order.size() - 1) < key)
+            {
+                return m_order.size();
+            }
+            size_t low = 0;
+            size_t high = m_order.size() - 1;
+            while (low < high)
+            {
+                size_t middle = low + (high - low) / 2;
+                if (keyAt(middle) < key)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            return low;
+        }
+
+        bool found(size_t position, TKey const& key) const
+        {
+            return (position < m_order.size()) && !(key < keyAt(position));
+        }
+
+        iterator at_position(size_t position)
+        {
+            return iterator(&m_entries, m_order.data() + position);
+        }
+
+        template<typename TKeyArg, typename TValueArg>
+        void add(size_t position, TKeyArg&& key, TValueArg&& value)
+        {
+            m_entries.emplace_back(std::forward<TKeyArg>(key), std::forward<TValueArg>(value));
+            m_order.insert(m_order.begin() + position, static_cast<uint32_t>(m_entries.size() - 1));
+        }
+    };
+
+} MAT_NS_END
+
+#endif
@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef ICOMPRESSIONCODEC_HPP
+#define ICOMPRESSIONCODEC_HPP
+
+#include "Version.hpp"
+#include "ctmacros.hpp"
+#include "IModule.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// This interface allows SDK users to supply the codec used to compress
+    /// upload request bodies, e.g. zstd for a collector that accepts it.
+    /// Register it with ILogConfiguration::AddModule(CFG_MODULE_COMPRESSION_CODEC, codec).
+    /// </summary>
+    class ICompressionCodec : public IModule
+    {
+    public:
+        /// <summary>
+        /// Value sent in the HTTP Content-Encoding header of compressed requests.
+        /// </summary>
+        virtual const char* GetContentEncoding() const noexcept = 0;
+
+        /// <summary>
+        /// Compress the request body in place.
+        /// </summary>
+        /// <param name="body">Uncompressed body on input, compressed body on output.</param>
+        /// <returns>false if compression failed, the events are then released for a later retry.</returns>
+        virtual bool Compress(std::vector<uint8_t>& body) = 0;
+    };
+
+} MAT_NS_END
+
+#endif // ICOMPRESSIONCODEC_HPP
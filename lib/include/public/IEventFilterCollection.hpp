@@ -9,6 +9,7 @@
 #include "IEventFilter.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace MAT_NS_BEGIN
 {
@@ -47,6 +48,24 @@ namespace MAT_NS_BEGIN
         /// <returns>True if the event satisfies the all the registered ondtitions, false otherwise.</returns>
         virtual bool CanEventPropertiesBeSent(const EventProperties& properties) const noexcept = 0;
 
+        /// <summary>
+        /// Checks a batch of events against all registered IEventFilters, clearing
+        /// allowed[i] for every event that does not satisfy them. Events already
+        /// marked as not allowed are not checked again.
+        /// </summary>
+        /// <param name="events">The events that may be sent</param>
+        /// <param name="allowed">One flag per event, updated in place</param>
+        virtual void CanEventPropertiesBeSent(const std::vector<EventProperties>& events, std::vector<bool>& allowed) const noexcept
+        {
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                if (allowed[i] && !CanEventPropertiesBeSent(events[i]))
+                {
+                    allowed[i] = false;
+                }
+            }
+        }
+
         /// <summary>
         /// Return size.
         /// Returns the number of elements in the collection.
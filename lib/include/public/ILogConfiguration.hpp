@@ -190,6 +190,20 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_INT_MAX_PENDING_REQ = "maxPendingHTTPRequests";
 
+    /// <summary>
+    /// The maximum number of pending HTTP requests of one upload lane, Normal or
+    /// RealTime latency, within the CFG_INT_MAX_PENDING_REQ total.
+    /// </summary>
+    static constexpr const char* const CFG_INT_MAX_PENDING_REQ_PER_LATENCY = "maxPendingHTTPRequestsPerLatency";
+
+    /// <summary>
+    /// Number of threads of the built-in task dispatcher. 1 (default) runs all SDK
+    /// tasks on a single worker thread. Larger values use a thread pool that keeps
+    /// each component's tasks serialized but runs different components in parallel.
+    /// Ignored when a custom CFG_MODULE_TASK_DISPATCHER is supplied.
+    /// </summary>
+    static constexpr const char* const CFG_INT_TASK_DISPATCHER_THREADS = "taskDispatcherThreads";
+
     /// <summary>
     /// The maximum package drop on full.
     /// </summary>
@@ -262,6 +276,11 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_MODULE_OFFLINE_STORAGE = "offlineStorage";
 
+    /// <summary>
+    /// ICompressionCodec override module for HTTP request bodies
+    /// </summary>
+    static constexpr const char* const CFG_MODULE_COMPRESSION_CODEC = "compressionCodec";
+
     /// <summary>
     /// Pointer to the Android app's JavaVM
     /// </summary>
@@ -337,6 +356,28 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_HTTP_COMPRESSION = "compress";
 
+    /// <summary>
+    /// HTTP configuration: Content-Encoding of compressed requests, "deflate" or "gzip"
+    /// </summary>
+    static constexpr const char* const CFG_STR_HTTP_CONTENT_ENCODING = "contentEncoding";
+
+    /// <summary>
+    /// HTTP configuration: zlib compression level 1 (fastest) to 9 (smallest), -1 for the zlib default
+    /// </summary>
+    static constexpr const char* const CFG_INT_HTTP_COMPRESSION_LEVEL = "compressionLevel";
+
+    /// <summary>
+    /// HTTP configuration: compress records while they are packaged, so that
+    /// the maximum upload size applies to the compressed request body
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_HTTP_STREAM_COMPRESSION = "streamCompression";
+
+    /// <summary>
+    /// HTTP configuration: run the requests of the libcurl HTTP client on one
+    /// curl_multi event loop thread that keeps connections alive between uploads
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_HTTP_CURL_MULTI = "curlMulti";
+
     /// <summary>
     /// TPM configuration map
     /// </summary>
@@ -362,11 +403,50 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_TPM_CLOCK_SKEW_ENABLED = "clockSkewEnabled";
 
+    /// <summary>
+    /// TPM configuration: adapt the upload size and timer interval to the measured
+    /// round trip time, throughput and server throttling. The upload size moves
+    /// between CFG_INT_TPM_MIN_UPLOAD_BYTES and CFG_INT_TPM_MAX_BLOB_BYTES.
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_TPM_ADAPTIVE_UPLOAD = "adaptiveUpload";
+
+    /// <summary>
+    /// TPM configuration: smallest upload size in bytes of the adaptive upload.
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_MIN_UPLOAD_BYTES = "minUploadSize";
+
+    /// <summary>
+    /// TPM configuration: longest timer interval of the adaptive upload under
+    /// server throttling, in percent of the transmit profile timers.
+    /// </summary>
+    static constexpr const char* const CFG_INT_TPM_MAX_TIMER_PERCENT = "maxTimerIntervalPercent";
+
     /// <summary>
     /// When enabled, the session timer is reset after session is completed, allowing for several session events in the duration of the SDK lifecycle
     /// </summary>
     static constexpr const char* const CFG_BOOL_SESSION_RESET_ENABLED = "sessionResetEnabled";
 
+    /// <summary>
+    /// Ingestion configuration map
+    /// </summary>
+    static constexpr const char* const CFG_MAP_INGEST = "ingest";
+
+    /// <summary>
+    /// Ingestion configuration: capacity of the lock-free incoming event queue.
+    /// 0 (default) stores events synchronously on the calling thread.
+    /// </summary>
+    static constexpr const char* const CFG_INT_INGEST_QUEUE_SIZE = "queueSize";
+
+    /// <summary>
+    /// Ingestion configuration: max number of events stored per worker thread drain
+    /// </summary>
+    static constexpr const char* const CFG_INT_INGEST_BATCH_SIZE = "batchSize";
+
+    /// <summary>
+    /// Ingestion configuration: what to do when the queue is full - "drop", "block" or "spill"
+    /// </summary>
+    static constexpr const char* const CFG_STR_INGEST_BACKPRESSURE = "backpressure";
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4251)
@@ -621,6 +621,34 @@ Refer to https://osgwiki.com/wiki/Common_Schema_Event_Overrides for details on t
         /// Get collection of current event filters.
         /// </summary>
         virtual IEventFilterCollection const& GetEventFilters() const noexcept = 0;
+
+        // New virtual methods go below the existing ones, so that binaries
+        // built against an earlier ILogger keep their vtable layout.
+
+        /// <summary>
+        /// Logs a custom event with the specified name
+        /// and properties, taking over the properties instead of copying them.
+        /// Array values are moved into the event, leaving empty arrays behind.
+        /// </summary>
+        /// <param name="properties">Properties of this custom event, specified using an EventProperties object.</param>
+        virtual void LogEvent(EventProperties&& properties)
+        {
+            LogEvent(static_cast<EventProperties const&>(properties));
+        }
+
+        /// <summary>
+        /// Logs a batch of custom events. Same as calling LogEvent for each of
+        /// them, but the logger and log manager take their locks once for the
+        /// whole batch and the records are stored together.
+        /// </summary>
+        /// <param name="events">Properties of the custom events, one EventProperties object per event.</param>
+        virtual void LogEvents(std::vector<EventProperties> const& events)
+        {
+            for (auto const& properties : events)
+            {
+                LogEvent(properties);
+            }
+        }
     };
 
 
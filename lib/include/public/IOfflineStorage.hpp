@@ -20,12 +20,27 @@ namespace MAT_NS_BEGIN {
     constexpr unsigned int DB_FULL_NOTIFICATION_DEFAULT_PERCENTAGE = 75;
     constexpr uint64_t     DB_FULL_CHECK_INTERVAL_DEFAULT_MS = 5000;
 
-    using StorageRecordId = std::string;
+    /// <summary>
+    /// Record IDs identify an event within the storage that holds it, 0 is
+    /// not a valid ID. They never go on the wire. The telemetry system gives
+    /// every new record an ID from a per-LogManager sequence, which the
+    /// in-memory queue keeps. The SQLite and Room storages ignore it and
+    /// number records as they insert them, so the IDs of records they return
+    /// differ from the ones that were stored.
+    /// </summary>
+    using StorageRecordId = uint64_t;
+
+    /// <summary>
+    /// Tenant tokens are interned to small process-wide IDs, so that the
+    /// pipeline does not copy and compare the long token strings. 0 is not
+    /// a valid ID. They are not persisted and never go on the wire.
+    /// </summary>
+    using TenantId = uint32_t;
 
     using StorageBlob = std::vector<uint8_t>;
 
     struct StorageRecord {
-        StorageRecordId id;
+        StorageRecordId id = 0;
         std::string     tenantToken;
         EventLatency    latency = EventLatency_Unspecified;
         EventPersistence persistence = EventPersistence_Normal;
@@ -33,15 +48,16 @@ namespace MAT_NS_BEGIN {
         StorageBlob     blob;
         int             retryCount = 0;
         int64_t         reservedUntil = 0;
+        TenantId        tenantId = 0;       // interned tenantToken, 0 if not resolved yet
 
         StorageRecord()
         {}
 
-        StorageRecord(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence)
+        StorageRecord(StorageRecordId id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence)
             : id(id), tenantToken(tenantToken), latency(latency), persistence(persistence)
         {}
 
-        StorageRecord(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence,
+        StorageRecord(StorageRecordId id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence,
             int64_t timestamp, std::vector<uint8_t>&& blob, int retryCount = 0, int64_t reservedUntil = 0)
             : id(id), tenantToken(tenantToken), latency(latency), persistence(persistence), timestamp(timestamp), blob(blob), retryCount(retryCount), reservedUntil(reservedUntil)
         {}
@@ -182,9 +198,9 @@ namespace MAT_NS_BEGIN {
         /// inserting the new one in order to maintain its configured size limit.
         /// Called from the internal worker thread.
         /// </remarks>
-        /// <param name="record">Record data to store</param>
-        /// <returns>Number of records stored</returns>
-        virtual size_t StoreRecords(StorageRecordVector & records) = 0;
+        /// <param name="records">Records data to store</param>
+        /// <returns>Whether each record was stored, in the order of records</returns>
+        virtual std::vector<bool> StoreRecords(StorageRecordVector & records) = 0;
 
         /// <summary>
         /// Retrieve the best records to upload based on specified parameters
@@ -217,6 +233,25 @@ namespace MAT_NS_BEGIN {
         virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs,
             EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) = 0;
 
+        /// <summary>
+        /// Same as GetAndReserveRecords, but the consumer only borrows each
+        /// record for the duration of the call
+        /// </summary>
+        /// <remarks>
+        /// Lets implementations that keep reserved records around hand out the
+        /// stored record instead of a copy. Records of skippedTenants (sorted)
+        /// are neither handed out nor reserved, nor do they count against
+        /// maxCount. The default implementation forwards to GetAndReserveRecords
+        /// and does not skip anything.
+        /// </remarks>
+        virtual bool GetAndReserveRecordRefs(std::function<bool(StorageRecord const&)> const& consumer, unsigned leaseTimeMs,
+            EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0,
+            std::vector<TenantId> const& skippedTenants = std::vector<TenantId>())
+        {
+            std::ignore = skippedTenants;
+            return GetAndReserveRecords([&consumer](StorageRecord&& record) { return consumer(record); }, leaseTimeMs, minLatency, maxCount);
+        }
+
         /// <summary>
         /// return where the last read was memory or disk
         /// </summary>
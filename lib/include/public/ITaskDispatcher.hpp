@@ -90,6 +90,13 @@ namespace MAT_NS_BEGIN
         /// The typename of the underlying functor executed by this work item
         /// </summary>
         std::string TypeName;
+
+        /// <summary>
+        /// Key of the logical queue this work item belongs to, typically the object that
+        /// scheduled it. Multi-threaded dispatchers run items that share a key one at a
+        /// time and in queue order. Items without a key share a single queue.
+        /// </summary>
+        const void* Affinity = nullptr;
     };
 
     /// <summary>
@@ -48,6 +48,7 @@ class ISqlite3Proxy {
     virtual int                  sqlite3_reset(sqlite3_stmt* stmt) = 0;
     virtual void                 sqlite3_result_null(sqlite3_context* ctx) = 0;
     virtual void                 sqlite3_result_text(sqlite3_context* ctx, char const* value, int size, void (* d)(void*)) = 0;
+    virtual void                 sqlite3_result_int64(sqlite3_context* ctx, int64_t value) = 0;
     virtual void                 sqlite3_set_auxdata(sqlite3_context* ctx, int N, void* data, void (* d)(void*)) = 0;
     virtual int                  sqlite3_shutdown() = 0;
     virtual int                  sqlite3_step(sqlite3_stmt* stmt) = 0;
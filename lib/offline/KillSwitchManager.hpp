@@ -6,6 +6,7 @@
 #define KILLSWITCHMANAGER_HPP
 
 #include "pal/PAL.hpp"
+#include "system/TenantRegistry.hpp"
 
 #include <map>
 #include <string>
@@ -24,7 +25,7 @@ namespace MAT_NS_BEGIN {
             return !m_tokenTime.empty();
         }
 
-        KillSwitchManager() : m_isRetryAfterActive(false), m_retryAfterExpiryTime(0)
+        KillSwitchManager()
         {
         }
 
@@ -34,20 +35,9 @@ namespace MAT_NS_BEGIN {
 
         bool handleResponse(HttpHeaders& headers)
         {
+            // Retry-After throttles the tenants of the request only, see TenantThrottle
             bool isNewTokenKilled = false;
 
-            std::string timeStr = headers.get("Retry-After");
-            if (!timeStr.empty())
-            {
-                int64_t timeinSecs = std::stoi(timeStr);
-                if (timeinSecs > 0)
-                {
-                    std::lock_guard<std::mutex> guard(m_lock);
-                    m_retryAfterExpiryTime = PAL::getUtcSystemTime() + timeinSecs;
-                    m_isRetryAfterActive = true;
-                }
-            }
-
             std::pair<std::multimap<std::string, std::string>::const_iterator, std::multimap<std::string, std::string>::const_iterator> ret;
             ret = headers.equal_range("kill-tokens");
 
@@ -88,41 +78,32 @@ namespace MAT_NS_BEGIN {
 
         void addToken(const std::string& tokenId, int64_t timeInSeconds)
         {
-            std::lock_guard<std::mutex> guard(m_lock);
             if (timeInSeconds > 0)
             {
-                m_tokenTime[tokenId] = PAL::getUtcSystemTime() + timeInSeconds; //convert milisec to sec
+                TenantId tenantId = TenantRegistry::Intern(tokenId);
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_tokenTime[tenantId] = PAL::getUtcSystemTime() + timeInSeconds; //convert milisec to sec
             }
         }
 
         bool isTokenBlocked(const std::string& tokenId)
         {
-            std::lock_guard<std::mutex> guard(m_lock);
+            return isTokenBlocked(TenantRegistry::Find(tokenId));
+        }
 
-            if (m_isRetryAfterActive)
-            {
-                if (m_retryAfterExpiryTime > PAL::getUtcSystemTime())
-                {
-                    return true;//always return true for all tokens
-                }
-                else
-                {
-                    m_retryAfterExpiryTime = 0;
-                    m_isRetryAfterActive = false;
-                }
-            }
-            std::map<std::string, int64_t>::iterator iter = m_tokenTime.find(tokenId);
+        bool isTokenBlocked(TenantId tenantId)
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            std::map<TenantId, int64_t>::iterator iter = m_tokenTime.find(tenantId);
             if (iter != m_tokenTime.end())
             {//found, check the time stamp
-                int64_t timeStamp = m_tokenTime[tokenId];
-
-                if (timeStamp > PAL::getUtcSystemTime())  //convert milisec to sec
+                if (iter->second > PAL::getUtcSystemTime())  //convert milisec to sec
                 {
                     return true;
                 }
                 else
                 { //remove the entry for this token as this has expired
-                    m_tokenTime.erase(tokenId);
+                    m_tokenTime.erase(iter);
                 }
             }
 
@@ -131,12 +112,9 @@ namespace MAT_NS_BEGIN {
 
         void removeToken(const std::string& tokenId)
         {
+            TenantId tenantId = TenantRegistry::Find(tokenId);
             std::lock_guard<std::mutex> guard(m_lock);
-            std::map<std::string, int64_t>::iterator iter = m_tokenTime.find(tokenId);
-            if (iter != m_tokenTime.end())
-            {//found, check the time stamp
-                m_tokenTime.erase(tokenId);
-            }
+            m_tokenTime.erase(tenantId);
         }
 
         std::list<std::string> getTokensList()
@@ -145,21 +123,14 @@ namespace MAT_NS_BEGIN {
             std::list<std::string> result;
             for (const auto &kv : m_tokenTime)
             {
-                result.push_back(kv.first);
+                result.push_back(TenantRegistry::GetToken(kv.first));
             }
             return result;
         }
 
-        bool isRetryAfterActive()
-        {
-            return m_isRetryAfterActive;
-        }
-
     private:
-        std::map<std::string, int64_t> m_tokenTime;
+        std::map<TenantId, int64_t> m_tokenTime;
         std::mutex      m_lock;
-        bool            m_isRetryAfterActive;
-        int64_t         m_retryAfterExpiryTime;
     };
 
 } MAT_NS_END
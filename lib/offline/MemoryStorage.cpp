@@ -4,7 +4,9 @@
 //
 #include "MemoryStorage.hpp"
 
+#include "system/TenantRegistry.hpp"
 #include "utils/Utils.hpp"
+#include <algorithm>
 #include <climits>
 
 namespace MAT_NS_BEGIN {
@@ -40,12 +42,11 @@ namespace MAT_NS_BEGIN {
     /// </remarks>
     void MemoryStorage::Shutdown()
     {
-        LOCKGUARD(m_reserved_lock);
         LOCKGUARD(m_records_lock);
 
         for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
         {
-            size_t numRecords = m_records[latency].size();
+            size_t numRecords = m_queues[latency].count;
             if (numRecords)
             {
                 // OfflineStorageHandler high-level wrapper must flush these on graceful shutdown
@@ -53,9 +54,9 @@ namespace MAT_NS_BEGIN {
             }
         }
 
-        if (m_reserved_records.size())
+        if (m_reserved.count)
         {
-            LOG_WARN("Discarding %u reserved records", m_reserved_records.size());
+            LOG_WARN("Discarding %u reserved records", m_reserved.count);
         }
     }
     
@@ -69,13 +70,106 @@ namespace MAT_NS_BEGIN {
     {
     }
     
-    template<typename T, typename V>
-    bool contains(T vec, V value)
+    MemoryStorage::RecordHandle MemoryStorage::allocateSlot()
     {
-        auto it = std::find(vec.begin(), vec.end(), value);
-        if (it != vec.end())
-            return true;
-        return false;
+        RecordHandle handle = m_free.head;
+        if (handle != InvalidHandle)
+        {
+            unlink(handle);
+            return handle;
+        }
+        handle = static_cast<RecordHandle>(m_slots.size());
+        m_slots.emplace_back();
+        return handle;
+    }
+
+    void MemoryStorage::link(SlotList& list, RecordHandle handle)
+    {
+        Slot& slot = m_slots[handle];
+        slot.list = &list;
+        slot.prev = list.tail;
+        slot.next = InvalidHandle;
+        if (list.tail != InvalidHandle)
+        {
+            m_slots[list.tail].next = handle;
+        }
+        else
+        {
+            list.head = handle;
+        }
+        list.tail = handle;
+        list.count++;
+    }
+
+    void MemoryStorage::unlink(RecordHandle handle)
+    {
+        Slot& slot = m_slots[handle];
+        SlotList& list = *slot.list;
+        if (slot.prev != InvalidHandle)
+        {
+            m_slots[slot.prev].next = slot.next;
+        }
+        else
+        {
+            list.head = slot.next;
+        }
+        if (slot.next != InvalidHandle)
+        {
+            m_slots[slot.next].prev = slot.prev;
+        }
+        else
+        {
+            list.tail = slot.prev;
+        }
+        list.count--;
+        slot.list = nullptr;
+    }
+
+    bool MemoryStorage::isQueued(Slot const& slot) const
+    {
+        return (slot.list != &m_reserved) && (slot.list != &m_free);
+    }
+
+    /// <summary>
+    /// Removes the record from its list and from the index. The slot keeps the
+    /// id and blob buffers for reuse.
+    /// </summary>
+    void MemoryStorage::freeSlot(RecordHandle handle)
+    {
+        Slot& slot = m_slots[handle];
+        if (isQueued(slot))
+        {
+            m_size -= std::min(m_size, recordSize(slot.record));
+        }
+        unlink(handle);
+        m_index.erase(slot.record.id);
+        slot.record.blob.clear();
+        link(m_free, handle);
+    }
+
+    /// <summary>
+    /// Moves a reserved record back to the end of its latency queue.
+    /// </summary>
+    void MemoryStorage::requeue(RecordHandle handle)
+    {
+        Slot& slot = m_slots[handle];
+        unlink(handle);
+        slot.record.reservedUntil = 0;
+        link(m_queues[slot.record.latency], handle);
+        m_size += recordSize(slot.record);
+    }
+
+    void MemoryStorage::clearLocked()
+    {
+        std::vector<Slot>().swap(m_slots);
+        for (auto& queue : m_queues)
+        {
+            queue = SlotList();
+        }
+        m_reserved = SlotList();
+        m_free = SlotList();
+        m_index.clear();
+        m_size = 0;
     }
 
     /// <summary>
@@ -97,32 +191,58 @@ namespace MAT_NS_BEGIN {
             return false;
 
         LOCKGUARD(m_records_lock);
-        m_size += record.blob.size() + sizeof(record); // approximate contents size
-
-#ifdef DEBUG_DUPLICATE_ROUTES
-        if (contains(m_records[record.latency], record))
-            LOG_WARN("Vector already contains this element!");
-#endif
-
-        m_records[record.latency].push_back(std::move(record));
+        storeRecordLocked(record);
         return true;
     }
 
-    size_t MemoryStorage::StoreRecords(std::vector<StorageRecord> & records)
+    std::vector<bool> MemoryStorage::StoreRecords(std::vector<StorageRecord> & records)
     {
-        size_t stored = 0;
-        for (auto  & i : records) {
-            if (StoreRecord(i)) {
-                ++stored;
+        std::vector<bool> stored(records.size(), false);
+        LOCKGUARD(m_records_lock);
+        for (size_t i = 0; i < records.size(); i++) {
+            if (records[i].latency != EventLatency_Off) {
+                storeRecordLocked(records[i]);
+                stored[i] = true;
             }
         }
         return stored;
     }
 
+    void MemoryStorage::storeRecordLocked(StorageRecord const & record)
+    {
+        // Record IDs are unique, a record stored twice replaces the older copy
+        auto it = m_index.find(record.id);
+        if (it != m_index.end())
+        {
+#ifdef DEBUG_DUPLICATE_ROUTES
+            LOG_WARN("Storage already contains this record!");
+#endif
+            freeSlot(it->second);
+        }
+
+        RecordHandle handle = allocateSlot();
+        Slot& slot = m_slots[handle];
+        // Assign field by field into the reused slot so that its blob buffer is
+        // recycled. The tenant is kept as its interned ID only, the token is
+        // filled in again when the record is handed out.
+        StorageRecord& stored = slot.record;
+        stored.id = record.id;
+        stored.tenantId = TenantRegistry::GetId(record);
+        stored.latency = record.latency;
+        stored.persistence = record.persistence;
+        stored.timestamp = record.timestamp;
+        stored.blob = record.blob;
+        stored.retryCount = record.retryCount;
+        stored.reservedUntil = record.reservedUntil;
+        link(m_queues[record.latency], handle);
+        m_index[slot.record.id] = handle;
+        m_size += recordSize(slot.record);
+    }
+
     /// <summary>
     /// Get records from MemoryStorage.
-    /// Getting records automatically deletes them.
-    /// Reservation is not currently supported.
+    /// Records accepted without a lease are deleted, with a lease they are
+    /// kept as reserved until deleted or released by ID.
     /// </summary>
     /// <param name="consumer">The consumer.</param>
     /// <param name="leaseTimeMs">The lease time ms.</param>
@@ -131,8 +251,36 @@ namespace MAT_NS_BEGIN {
     /// <returns></returns>
     bool MemoryStorage::GetAndReserveRecords(std::function<bool(StorageRecord&&)> const & consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount)
     {
-        UNREFERENCED_PARAMETER(leaseTimeMs);
+        return reserveRecords([&consumer, leaseTimeMs](StorageRecord& record) -> bool
+        {
+            if (leaseTimeMs)
+            {
+                // The consumer owns what it gets, reserved records need their own copy
+                return consumer(StorageRecord(record));
+            }
+            StorageRecord forConsumer(std::move(record)); // move to consumer
+            bool wantMore = consumer(std::move(forConsumer));
+            if (!wantMore)
+            {
+                record = std::move(forConsumer);
+            }
+            return wantMore;
+        }, leaseTimeMs, minLatency, maxCount);
+    }
+
+    /// <summary>
+    /// Get records from MemoryStorage without copying them. The consumer gets
+    /// the stored record, which stays valid until the consumer returns.
+    /// </summary>
+    bool MemoryStorage::GetAndReserveRecordRefs(std::function<bool(StorageRecord const&)> const & consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount,
+        std::vector<TenantId> const& skippedTenants)
+    {
+        return reserveRecords(consumer, leaseTimeMs, minLatency, maxCount, skippedTenants);
+    }
 
+    bool MemoryStorage::reserveRecords(std::function<bool(StorageRecord&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount,
+        std::vector<TenantId> const& skippedTenants)
+    {
         LOG_TRACE("Retrieving max. %u%s events of latency at least %d (%s)",
             maxCount, (maxCount > 0) ? "" : " (unlimited)",
             minLatency, latencyToStr(static_cast<EventLatency>(minLatency)));
@@ -143,33 +291,58 @@ namespace MAT_NS_BEGIN {
         if (minLatency == EventLatency_Unspecified)
             minLatency = EventLatency_Off;
 
-        LOCKGUARD(m_reserved_lock);
         LOCKGUARD(m_records_lock);
         m_lastReadCount = 0;
         // Start processing events of critical latency first
         for (int latency = static_cast<int>(EventLatency_Max); (latency >= static_cast<int>(minLatency)) && (maxCount); latency--)
         {
-            while (maxCount && (m_records[latency]).size())
+            SlotList& queue = m_queues[latency];
+            RecordHandle next = queue.tail;
+            while (maxCount && (next != InvalidHandle))
             {
-                StorageRecord & record = m_records[latency].back();
+                RecordHandle handle = next;
+                StorageRecord& record = m_slots[handle].record;
+                next = m_slots[handle].prev;
+                if (!skippedTenants.empty() && std::binary_search(skippedTenants.begin(), skippedTenants.end(), record.tenantId))
+                {
+                    continue;
+                }
 
-                size_t recordSize = record.blob.size() + sizeof(record);
-                StorageRecord forConsumer(record);
+                size_t size = recordSize(record);
+                int64_t reservedUntil = record.reservedUntil;
+                auto indexed = m_index.end();
                 if (leaseTimeMs)
                 {
-                    forConsumer.reservedUntil = PAL::getUtcSystemTimeMs() + leaseTimeMs;
+                    record.reservedUntil = PAL::getUtcSystemTimeMs() + leaseTimeMs;
+                }
+                else
+                {
+                    // Look up before the consumer, which may take the id
+                    indexed = m_index.find(record.id);
                 }
 
-                bool wantMore = consumer(std::move(forConsumer)); // move to consumer
+                // Lend the token buffer for the duration of the call, so that
+                // consumers of references do not allocate for the token
+                m_lentToken.assign(TenantRegistry::GetToken(record.tenantId));
+                record.tenantToken.swap(m_lentToken);
+                bool wantMore = consumer(record);
+                record.tenantToken.swap(m_lentToken);
                 if (!wantMore) {
+                    record.reservedUntil = reservedUntil;
                     return true;
                 }
 
+                m_size -= std::min(m_size, size);
                 if (leaseTimeMs) {
-                    m_reserved_records[record.id] = std::move(record); // move to reserved
+                    // move to reserved
+                    unlink(handle);
+                    link(m_reserved, handle);
+                }
+                else {
+                    unlink(handle);
+                    m_index.erase(indexed);
+                    link(m_free, handle);
                 }
-                m_records[latency].pop_back();
-                m_size -= std::min(m_size, recordSize);
                 maxCount--;
                 m_lastReadCount++;
             }
@@ -200,26 +373,9 @@ namespace MAT_NS_BEGIN {
 
     void MemoryStorage::DeleteAllRecords()
     {
-        {
-            LOCKGUARD(m_reserved_lock);
-            if (m_reserved_records.size())
-            {
-                m_reserved_records.clear();
-            }
-        }
-        {
-            LOCKGUARD(m_records_lock);
-            for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
-            {
-                auto& records = m_records[latency];
-                if (records.size()) {
-                    records.clear();
-                }
-            }
-            m_size = 0;
-            m_lastReadCount = 0;
-        }
-
+        LOCKGUARD(m_records_lock);
+        clearLocked();
+        m_lastReadCount = 0;
     }
 
     void MemoryStorage::DeleteRecords(const std::map<std::string, std::string> & whereFilter)
@@ -230,8 +386,8 @@ namespace MAT_NS_BEGIN {
             for (const auto &kv : whereFilter)
             {
                 matched &=
-                    (kv.first == "record_id") ? (r.id == kv.second) :
-                    (kv.first == "tenant_token") ? (r.tenantToken == kv.second) :
+                    (kv.first == "record_id") ? (std::to_string(r.id) == kv.second) :
+                    (kv.first == "tenant_token") ? (TenantRegistry::GetToken(r.tenantId) == kv.second) :
                     (kv.first == "latency") ? (std::to_string(r.latency) == kv.second) :
                     (kv.first == "persistence") ? (std::to_string(r.persistence) == kv.second) :
                     (kv.first == "retry_count") ? (std::to_string(r.retryCount) == kv.second) : false;
@@ -241,43 +397,13 @@ namespace MAT_NS_BEGIN {
             return matched;
         };
 
-        // Delete from reserved, which is typically a shorter list
-        std::vector<StorageRecordId> m_reserved_ids;
-        {
-            LOCKGUARD(m_reserved_lock);
-            for (const auto & kv : m_reserved_records)
-            {
-                if (matcher(kv.second, whereFilter))
-                {
-                    m_reserved_ids.push_back(kv.first);
-                }
-            }
-        }
-        if (!m_reserved_ids.empty())
-        {
-            bool fromMemory = true;
-            DeleteRecords(m_reserved_ids, HttpHeaders(), fromMemory);
-        }
-
-        // Delete from ram queue, which is a bigger list
+        LOCKGUARD(m_records_lock);
+        for (RecordHandle handle = 0; handle < m_slots.size(); handle++)
         {
-            LOCKGUARD(m_records_lock);
-            for (unsigned latency = EventLatency_Off; latency <= EventLatency_Max;  latency++)
+            Slot& slot = m_slots[handle];
+            if (slot.list != &m_free && matcher(slot.record, whereFilter))
             {
-                auto& records = m_records[latency];
-                auto it = records.begin();
-                // remove from records all ids that were found in the set
-                while (it != records.end()) {
-                    auto &v = *it;
-                    if (matcher(v, whereFilter))
-                    {
-                        size_t recordSize = v.blob.size() + sizeof(v);
-                        m_size -= std::min(m_size, recordSize);
-                        it = records.erase(it);
-                        continue;
-                    }
-                    ++it;
-                }
+                freeSlot(handle);
             }
         }
     }
@@ -293,60 +419,15 @@ namespace MAT_NS_BEGIN {
         UNREFERENCED_PARAMETER(headers);
         UNREFERENCED_PARAMETER(fromMemory);
 
+        LOCKGUARD(m_records_lock);
+        for (auto const& id : ids)
         {
-            // Delete from reserved records (m_reserved_records)
-            LOCKGUARD(m_reserved_lock);
-            if (m_reserved_records.size())
+            auto it = m_index.find(id);
+            if (it != m_index.end())
             {
-                std::unordered_set<StorageRecordId> idSet(ids.begin(), ids.end());
-                auto it = m_reserved_records.begin();
-                while (it != m_reserved_records.end()) {
-                    auto &kv = *it;
-                    if (idSet.count(kv.first))
-                    {
-                        idSet.erase(kv.first);
-                        it = m_reserved_records.erase(it);
-                        continue;
-                    }
-                    ++it;
-                }
-                if (idSet.size() == 0) // done
-                    return;
+                freeSlot(it->second);
             }
         }
-
-        {
-            // Delete from ram queue (m_records[])
-            LOCKGUARD(m_records_lock);
-
-            // convert vector of ids to unordered set
-            std::unordered_set<StorageRecordId> idSet(ids.begin(), ids.end());
-
-            // For each latency - delete from current unreserved records
-            for (unsigned latency = EventLatency_Off; (latency <= EventLatency_Max); latency++)
-            {
-                auto& records = m_records[latency];
-                if (records.size() && idSet.size())
-                {
-                    auto it = records.begin();
-                    // remove from records all ids that were found in the set
-                    while (it != records.end()) {
-                        auto &v = *it;
-                        if (idSet.count(v.id))
-                        {
-                            // record id appears once only, so remove from set
-                            idSet.erase(v.id);
-                            size_t recordSize = v.blob.size() + sizeof(v);
-                            m_size -= std::min(m_size, recordSize);
-                            it = records.erase(it);
-                            continue;
-                        }
-                        ++it;
-                    }
-                }
-            }
-        }
-
     }
 
     /// <summary>
@@ -358,28 +439,19 @@ namespace MAT_NS_BEGIN {
     /// <param name="fromMemory"></param>
     void MemoryStorage::ReleaseRecords(std::vector<StorageRecordId> const & ids, bool incrementRetryCount, HttpHeaders headers, bool & fromMemory)
     {
-        UNREFERENCED_PARAMETER(incrementRetryCount);
         UNREFERENCED_PARAMETER(headers);
         UNREFERENCED_PARAMETER(fromMemory);
 
         // Move back from reserved records to ram queue
-        LOCKGUARD(m_reserved_lock);
-        if (m_reserved_records.size())
+        LOCKGUARD(m_records_lock);
+        for (auto const& id : ids)
         {
-            std::unordered_set<StorageRecordId> idSet(ids.begin(), ids.end());
-            auto it = m_reserved_records.begin();
-            while (it != m_reserved_records.end()) {
-                auto &kv = *it;
-                if (idSet.count(kv.first))
-                {
-                    if (incrementRetryCount)
-                        kv.second.retryCount++;
-                    StoreRecord(kv.second);
-                    idSet.erase(kv.first);
-                    it = m_reserved_records.erase(it);
-                    continue;
-                }
-                ++it;
+            auto it = m_index.find(id);
+            if (it != m_index.end() && m_slots[it->second].list == &m_reserved)
+            {
+                if (incrementRetryCount)
+                    m_slots[it->second].record.retryCount++;
+                requeue(it->second);
             }
         }
     }
@@ -388,16 +460,10 @@ namespace MAT_NS_BEGIN {
     {
         // In case if HTTP upload has been canceled or didn't succeed,
         // we'd move all reserved records to regular ram queue
-        LOCKGUARD(m_reserved_lock);
-        if (m_reserved_records.size())
+        LOCKGUARD(m_records_lock);
+        while (m_reserved.head != InvalidHandle)
         {
-            auto it = m_reserved_records.begin();
-            while (it != m_reserved_records.end())
-            {
-                auto &kv = *it;
-                StoreRecord(kv.second);
-                it = m_reserved_records.erase(it);
-            }
+            requeue(m_reserved.head);
         }
     }
 
@@ -469,11 +535,11 @@ namespace MAT_NS_BEGIN {
         if (latency == EventLatency_Unspecified)
         {
             for (unsigned lat = EventLatency_Off; lat <= EventLatency_Max; lat++)
-                numRecords += m_records[lat].size();
+                numRecords += m_queues[lat].count;
         }
         else
         {
-            numRecords = m_records[latency].size();
+            numRecords = m_queues[latency].count;
         }
         return numRecords;
     }
@@ -516,8 +582,8 @@ namespace MAT_NS_BEGIN {
     /// <returns></returns>
     size_t MemoryStorage::GetReservedCount()
     {
-        LOCKGUARD(m_reserved_lock);
-        return m_reserved_records.size();
+        LOCKGUARD(m_records_lock);
+        return m_reserved.count;
     }
 
 } MAT_NS_END
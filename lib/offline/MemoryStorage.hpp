@@ -20,7 +20,7 @@
 #include <mutex>
 #include <map>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
 
 namespace MAT_NS_BEGIN {
 
@@ -38,11 +38,15 @@ namespace MAT_NS_BEGIN {
 
         virtual bool StoreRecord(StorageRecord const& record) override;
 
-        virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
+        virtual std::vector<bool> StoreRecords(std::vector<StorageRecord> & records) override;
 
         virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs,
             EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
 
+        virtual bool GetAndReserveRecordRefs(std::function<bool(StorageRecord const&)> const& consumer, unsigned leaseTimeMs,
+            EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0,
+            std::vector<TenantId> const& skippedTenants = std::vector<TenantId>()) override;
+
         virtual bool IsLastReadFromMemory() override;
 
         virtual unsigned LastReadRecordCount() override;
@@ -76,23 +80,85 @@ namespace MAT_NS_BEGIN {
         virtual ~MemoryStorage() override;
 
     protected:
-        
+
+        /// <summary>
+        /// Index of a record slot in m_slots. Handles stay valid while the
+        /// arena grows, freed slots are reused by the next StoreRecord.
+        /// </summary>
+        using RecordHandle = uint32_t;
+
+        static const RecordHandle InvalidHandle = UINT32_MAX;
+
+        /// <summary>
+        /// Intrusive doubly-linked list of slots: one per latency for queued
+        /// records, one for reserved (aka in-flight) records and one for free slots.
+        /// </summary>
+        struct SlotList
+        {
+            RecordHandle head = InvalidHandle;
+            RecordHandle tail = InvalidHandle;
+            size_t       count = 0;
+        };
+
+        struct Slot
+        {
+            StorageRecord record;
+            RecordHandle  prev = InvalidHandle;
+            RecordHandle  next = InvalidHandle;
+            SlotList*     list = nullptr;
+        };
+
+        RecordHandle allocateSlot();
+        void link(SlotList& list, RecordHandle handle);
+        void unlink(RecordHandle handle);
+        void freeSlot(RecordHandle handle);
+        void requeue(RecordHandle handle);
+        bool isQueued(Slot const& slot) const;
+        void clearLocked();
+        void storeRecordLocked(StorageRecord const& record);
+
+        /// <summary>
+        /// Hands queued records to the consumer in place. Records accepted with
+        /// a lease move to the reserved list, without a lease they are freed.
+        /// Records of skippedTenants stay queued.
+        /// </summary>
+        bool reserveRecords(std::function<bool(StorageRecord&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount,
+            std::vector<TenantId> const& skippedTenants = std::vector<TenantId>());
+
+        static size_t recordSize(StorageRecord const& record)
+        {
+            return record.blob.size() + sizeof(record); // approximate contents size
+        }
+
         IOfflineStorageObserver*    m_observer;
         IRuntimeConfig&             m_config;
         ILogManager&                m_logManager;
 
         mutable std::mutex          m_records_lock;
-        std::vector<StorageRecord>  m_records[EventLatency_Max+1];
-        
+
+        /// <summary>
+        /// Record arena. Free slots keep their buffers, so that storing a record
+        /// into a reused slot does not allocate.
+        /// </summary>
+        std::vector<Slot>           m_slots;
+        SlotList                    m_queues[EventLatency_Max+1];
+
         /// <summary>
         /// Contains reserved (aka in-flight) records.
         /// Current storage interface API requires deletion and release by StorageRecordId.
         /// </summary>
-        std::mutex                  m_reserved_lock;
-        std::map<StorageRecordId, StorageRecord> m_reserved_records;
+        SlotList                    m_reserved;
+        SlotList                    m_free;
+        std::unordered_map<StorageRecordId, RecordHandle> m_index;
 
         size_t                      m_size;
 
+        /// <summary>
+        /// Token of the record being handed to a consumer, stored records
+        /// keep their tenant as StorageRecord::tenantId only.
+        /// </summary>
+        std::string                 m_lentToken;
+
         MATSDK_LOG_DECL_COMPONENT_CLASS();
 
     private:
@@ -53,7 +53,7 @@ namespace MAT_NS_BEGIN {
     {
         return (
             /* fast   */ m_killSwitchManager.isActive() &&
-            /* slower */ m_killSwitchManager.isTokenBlocked(record.tenantToken));
+            /* slower */ m_killSwitchManager.isTokenBlocked(TenantRegistry::GetId(record)));
     }
 
     void OfflineStorageHandler::WaitForFlush()
@@ -166,15 +166,9 @@ namespace MAT_NS_BEGIN {
             auto records = m_offlineStorageMemory->GetRecords(false, EventLatency_Unspecified);
             std::vector<StorageRecordId> ids;
 
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("BEGIN");
-
-            size_t totalSaved = m_offlineStorageDisk->StoreRecords(records);
-
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("END");
+            // Persistent storage writes the whole batch in one transaction
+            auto saved = m_offlineStorageDisk->StoreRecords(records);
+            size_t totalSaved = static_cast<size_t>(std::count(saved.begin(), saved.end(), true));
 
             // Delete records from reserved on flush
             HttpHeaders dummy;
@@ -210,9 +204,6 @@ namespace MAT_NS_BEGIN {
             return false;
         }
 
-        // Check cache size only once at start
-        static uint32_t cacheMemorySizeLimitInBytes = m_config[CFG_INT_RAM_QUEUE_SIZE];
-
         if (nullptr != m_offlineStorageMemory && !m_shutdownStarted)
         {
             auto memDbSize = m_offlineStorageMemory->GetSize();
@@ -223,22 +214,7 @@ namespace MAT_NS_BEGIN {
                 // storage)
                 m_offlineStorageMemory->StoreRecord(record);
             }
-
-            // Perform periodic flush to disk
-            if (memDbSize > cacheMemorySizeLimitInBytes)
-            {
-                if (m_flushLock.try_lock())
-                {
-                    if (!m_flushPending)
-                    {
-                        m_flushPending = true;
-                        m_flushComplete.Reset();
-                        m_flushHandle = PAL::scheduleTask(&m_taskDispatcher, 0, this, &OfflineStorageHandler::Flush);
-                        LOG_INFO("Requested Flush (%p)", m_flushHandle.m_task);
-                    }
-                    m_flushLock.unlock();
-                }
-            }
+            scheduleFlushIfFull(memDbSize);
         }
         else
         {
@@ -254,17 +230,55 @@ namespace MAT_NS_BEGIN {
         return true;
     }
 
-    size_t OfflineStorageHandler::StoreRecords(std::vector<StorageRecord>& records)
+    std::vector<bool> OfflineStorageHandler::StoreRecords(std::vector<StorageRecord>& records)
     {
-        size_t stored = 0;
-        for (auto& i : records)
+        // A batch without killed tenants goes to the memory storage in one call
+        bool batched = (nullptr != m_offlineStorageMemory && !m_shutdownStarted);
+        for (size_t i = 0; batched && i < records.size(); i++)
         {
-            if (StoreRecord(i))
+            batched = !isKilled(records[i]);
+        }
+
+        if (batched)
+        {
+            auto memDbSize = m_offlineStorageMemory->GetSize();
+            auto stored = m_offlineStorageMemory->StoreRecords(records);
+            scheduleFlushIfFull(memDbSize);
+            return stored;
+        }
+
+        std::vector<bool> stored(records.size(), false);
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            stored[i] = StoreRecord(records[i]);
+        }
+        return stored;
+    }
+
+    /// <summary>
+    /// Starts a flush to disk when the memory storage holds more than the RAM
+    /// queue size.
+    /// </summary>
+    void OfflineStorageHandler::scheduleFlushIfFull(size_t memDbSize)
+    {
+        // Check cache size only once at start
+        static uint32_t cacheMemorySizeLimitInBytes = m_config[CFG_INT_RAM_QUEUE_SIZE];
+
+        // Perform periodic flush to disk
+        if (memDbSize > cacheMemorySizeLimitInBytes)
+        {
+            if (m_flushLock.try_lock())
             {
-                ++stored;
+                if (!m_flushPending)
+                {
+                    m_flushPending = true;
+                    m_flushComplete.Reset();
+                    m_flushHandle = PAL::scheduleTask(&m_taskDispatcher, 0, this, &OfflineStorageHandler::Flush);
+                    LOG_INFO("Requested Flush (%p)", m_flushHandle.m_task);
+                }
+                m_flushLock.unlock();
             }
         }
-        return stored;
     }
 
     bool OfflineStorageHandler::ResizeDb()
@@ -293,6 +307,21 @@ namespace MAT_NS_BEGIN {
     }
 
     bool OfflineStorageHandler::GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount)
+    {
+        return readRecords([&](IOfflineStorage& storage, unsigned count) {
+            return storage.GetAndReserveRecords(consumer, leaseTimeMs, minLatency, count);
+        }, maxCount);
+    }
+
+    bool OfflineStorageHandler::GetAndReserveRecordRefs(std::function<bool(StorageRecord const&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount,
+        std::vector<TenantId> const& skippedTenants)
+    {
+        return readRecords([&](IOfflineStorage& storage, unsigned count) {
+            return storage.GetAndReserveRecordRefs(consumer, leaseTimeMs, minLatency, count, skippedTenants);
+        }, maxCount);
+    }
+
+    bool OfflineStorageHandler::readRecords(std::function<bool(IOfflineStorage&, unsigned)> const& read, unsigned maxCount)
     {
         bool returnValue = false;
 
@@ -301,7 +330,7 @@ namespace MAT_NS_BEGIN {
 
         if (m_offlineStorageMemory)
         {
-            returnValue |= m_offlineStorageMemory->GetAndReserveRecords(consumer, leaseTimeMs, minLatency, maxCount);
+            returnValue |= read(*m_offlineStorageMemory, maxCount);
             m_lastReadCount += m_offlineStorageMemory->LastReadRecordCount();
             if (m_lastReadCount <= maxCount)
                 maxCount -= m_lastReadCount;
@@ -315,7 +344,7 @@ namespace MAT_NS_BEGIN {
 
         if (m_offlineStorageDisk)
         {
-            returnValue |= m_offlineStorageDisk->GetAndReserveRecords(consumer, leaseTimeMs, minLatency, maxCount);
+            returnValue |= read(*m_offlineStorageDisk, maxCount);
             auto lastOfflineReadCount = m_offlineStorageDisk->LastReadRecordCount();
             if (lastOfflineReadCount)
             {
@@ -424,8 +453,8 @@ namespace MAT_NS_BEGIN {
             DeleteRecordsByKeys(m_killSwitchManager.getTokensList());
         }
 
-        LOG_TRACE(" OfflineStorageHandler Deleting %u sent event(s) {%s%s}...",
-                  static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "");
+        LOG_TRACE(" OfflineStorageHandler Deleting %u sent event(s) {%llu%s}...",
+                  static_cast<unsigned>(ids.size()), static_cast<unsigned long long>(ids.front()), (ids.size() > 1) ? ", ..." : "");
         if (fromMemory && nullptr != m_offlineStorageMemory)
         {
             m_offlineStorageMemory->DeleteRecords(ids, headers, fromMemory);
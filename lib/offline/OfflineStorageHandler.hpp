@@ -32,8 +32,10 @@ namespace MAT_NS_BEGIN {
         virtual void Shutdown() override;
         virtual void Flush() override;
         virtual bool StoreRecord(StorageRecord const& record) override;
-        virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
+        virtual std::vector<bool> StoreRecords(std::vector<StorageRecord> & records) override;
         virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
+        virtual bool GetAndReserveRecordRefs(std::function<bool(StorageRecord const&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0,
+            std::vector<TenantId> const& skippedTenants = std::vector<TenantId>()) override;
 
         virtual bool IsLastReadFromMemory() override;
         virtual unsigned LastReadRecordCount() override;
@@ -64,6 +66,12 @@ namespace MAT_NS_BEGIN {
     protected:
         virtual void DeleteRecordsByKeys(const std::list<std::string> & keys);
 
+        /// <summary>
+        /// Reads from the memory storage first, then from disk, with the given
+        /// read function doing the actual GetAndReserveRecords call.
+        /// </summary>
+        bool readRecords(std::function<bool(IOfflineStorage&, unsigned)> const& read, unsigned maxCount);
+
         IOfflineStorageObserver   * m_observer;
         ILogManager &               m_logManager;
         std::string                 m_databasePath;
@@ -74,6 +82,7 @@ namespace MAT_NS_BEGIN {
         ClockSkewManager            m_clockSkewManager;
 
         virtual bool isKilled(StorageRecord const& record);
+        void scheduleFlushIfFull(size_t memDbSize);
 
         std::mutex                             m_flushLock;
         bool                                   m_flushPending;
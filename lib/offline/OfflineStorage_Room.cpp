@@ -4,6 +4,7 @@
 //
 #include "OfflineStorage_Room.hpp"
 #include "pal/PAL.hpp"
+#include <algorithm>
 #include <cmath>
 #include <exception>
 #include <jni.h>
@@ -234,7 +235,7 @@ namespace MAT_NS_BEGIN
     /**
      * Delete records by identifier.
      *
-     * @param[in] ids A vector of std::string record ids.
+     * @param[in] ids A vector of record ids.
      * @param[out] fromMemory Always false (even when the database
      * is held in memory, which can happen in tests).
      */
@@ -258,30 +259,19 @@ namespace MAT_NS_BEGIN
         ThrowLogic(env, "Unable to get deleteById method");
         size_t index = 0;
 
-        /* Convert string identifiers to int64_t */
-
         env.pushLocalFrame(32);
         std::vector<jlong> roomIds;
         roomIds.reserve(ids.size());
-        for (auto& id : ids)
+        for (auto id : ids)
         {
-            long long n = 0;
-            try
+            if (id > 0 && id <= static_cast<StorageRecordId>(INT64_MAX))
             {
-                n = std::stoll(id);
-                if (n > 0)
-                {
-                    roomIds.push_back(n);
-                }
+                roomIds.push_back(static_cast<jlong>(id));
             }
-            catch (std::out_of_range e)
+            else
             {
                 m_observer->OnStorageFailed("ID out of range");
             }
-            catch (std::invalid_argument e)
-            {
-                m_observer->OnStorageFailed("Empty ID");
-            }
         }
         if (roomIds.empty())
         {
@@ -437,7 +427,7 @@ namespace MAT_NS_BEGIN
                 ThrowLogic(env, "get blob storage");
                 uint8_t *end = start + env->GetArrayLength(blob_java);
                 StorageRecord dest(
-                        std::to_string(id_java),
+                        static_cast<StorageRecordId>(id_java),
                         token_utf,
                         latency,
                         persistence,
@@ -561,24 +551,16 @@ namespace MAT_NS_BEGIN
         }
         std::vector<jlong> roomIds;
         roomIds.reserve(ids.size());
-        for (auto const& id : ids)
+        for (auto id : ids)
         {
-            try
+            if (id > 0 && id <= static_cast<StorageRecordId>(INT64_MAX))
             {
-                long long roomId = std::stoll(id);
-                if (roomId > 0)
-                {
-                    roomIds.push_back(roomId);
-                }
+                roomIds.push_back(static_cast<jlong>(id));
             }
-            catch (std::out_of_range e)
+            else
             {
                 m_observer->OnStorageFailed("id out of range");
             }
-            catch (std::invalid_argument e)
-            {
-                m_observer->OnStorageFailed("id empty");
-            }
         }
         if (roomIds.empty())
         {
@@ -656,7 +638,7 @@ namespace MAT_NS_BEGIN
     {
         StorageRecordVector records;
         records.push_back(record);
-        return StoreRecords(records) > 0;
+        return StoreRecords(records)[0];
     }
 
     /**
@@ -667,20 +649,21 @@ namespace MAT_NS_BEGIN
      * whenever we retrieve records.
      *
      * @param[in] records The records to be persisted.
-     * @return the number of records we persisted.
+     * @return whether each record was persisted.
      */
 
-    size_t OfflineStorage_Room::StoreRecords(StorageRecordVector& records)
+    std::vector<bool> OfflineStorage_Room::StoreRecords(StorageRecordVector& records)
     {
+        std::vector<bool> stored(records.size(), false);
         if (records.size() == 0)
         {
-            return 0;
+            return stored;
         }
 
         ConnectedEnv env(s_vm);
         if (!env)
         {
-            return 0;
+            return stored;
         }
 
         static constexpr char newRecordSignature[] =
@@ -784,7 +767,8 @@ namespace MAT_NS_BEGIN
                 ResizeDbInternal(env);
             }
         }
-        return count;
+        std::fill(stored.begin(), stored.begin() + count, true);
+        return stored;
     }
 
     /**
@@ -1041,7 +1025,7 @@ namespace MAT_NS_BEGIN
             size_t blob_length = env->GetArrayLength(blob_j);
             auto blob_end = blob_store + blob_length;
             records.emplace_back(
-                std::to_string(id_j),
+                static_cast<StorageRecordId>(id_j),
                 tenant_utf,
                 latency,
                 persistence,
@@ -68,7 +68,7 @@ namespace MAT_NS_BEGIN
         void Shutdown() override;
         void Flush() override{};
         bool StoreRecord(StorageRecord const& record) override;
-        size_t StoreRecords(StorageRecordVector& records) override;
+        std::vector<bool> StoreRecords(StorageRecordVector& records) override;
         bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Normal, unsigned maxCount = 0) override;
         bool IsLastReadFromMemory() override;
         unsigned LastReadRecordCount() override;
@@ -8,15 +8,21 @@
 #include "OfflineStorage_SQLite.hpp"
 #include "ILogManager.hpp"
 #include "SQLiteWrapper.hpp"
+#include "system/TenantRegistry.hpp"
 #include "utils/Utils.hpp"
 #include <algorithm>
-#include <numeric>
+#include <string.h>
 #include <set>
 
 namespace MAT_NS_BEGIN {
 
     constexpr static size_t kBlockSize = 8192;
 
+    // Rows per multi-row INSERT. Must keep kInsertBatchRows * kInsertColumns
+    // below SQLITE_MAX_VARIABLE_NUMBER, which is 999 on older sqlite builds.
+    constexpr static size_t kInsertColumns = 5;
+    constexpr static size_t kInsertBatchRows = 64;
+
     class DbTransaction {
         SqliteDB* m_db;
     public:
@@ -41,11 +47,38 @@ namespace MAT_NS_BEGIN {
 
     MATSDK_LOG_INST_COMPONENT_CLASS(OfflineStorage_SQLite, "EventsSDK.Storage", "Events telemetry client - OfflineStorage_SQLite class");
 
-    static int const CURRENT_SCHEMA_VERSION = 1;
+    static int const CURRENT_SCHEMA_VERSION = 4;
 #define TABLE_NAME_EVENTS   "events"
+#define TABLE_NAME_TENANTS  "tenants"
 #define TABLE_NAME_SETTINGS "settings"
 #define TABLE_NAME_PACKAGES "packages"
 
+    // Events refer to their tenant by the rowid of its token in the tenants
+    // table instead of repeating the ~74 character token in every row
+#define SQL_CREATE_TABLE_TENANTS                            \
+    "CREATE TABLE IF NOT EXISTS " TABLE_NAME_TENANTS " ("   \
+    "tenant_id"      " INTEGER PRIMARY KEY,"                \
+    "tenant_token"   " TEXT NOT NULL UNIQUE"                \
+    ")"
+
+    // sqlite numbers the events: several LogManager instances may share the
+    // file, and AUTOINCREMENT keeps the ID of a deleted event from being
+    // handed to a new one while an upload may still refer to it
+#define SQL_CREATE_TABLE_EVENTS                             \
+    "CREATE TABLE IF NOT EXISTS " TABLE_NAME_EVENTS " ("    \
+    "record_id"      " INTEGER PRIMARY KEY AUTOINCREMENT,"  \
+    "tenant_id"      " INTEGER NOT NULL,"                   \
+    "latency"        " INTEGER,"                            \
+    "persistence"    " INTEGER,"                            \
+    "timestamp"      " INTEGER,"                            \
+    "retry_count"    " INTEGER DEFAULT 0,"                  \
+    "reserved_until" " INTEGER DEFAULT 0,"                  \
+    "payload"        " BLOB"                                \
+    ")"
+
+#define SQL_SELECT_TENANT_TOKEN \
+    "(SELECT tenant_token FROM " TABLE_NAME_TENANTS " WHERE " TABLE_NAME_TENANTS ".tenant_id=" TABLE_NAME_EVENTS ".tenant_id)"
+
     bool OfflineStorage_SQLite::isOpen()
     {
         if ((!m_db) || (!m_isOpened))
@@ -136,21 +169,29 @@ namespace MAT_NS_BEGIN {
             m_db->execute(command.c_str());
     }
 
+    bool OfflineStorage_SQLite::isValidRecord(StorageRecord const& record)
+    {
+        if (record.id == 0 || record.tenantToken.empty() || static_cast<int>(record.latency) < 0 || record.timestamp <= 0) {
+            LOG_ERROR("Failed to store event %s:%llu: Invalid parameters",
+                tenantTokenToId(record.tenantToken).c_str(), static_cast<unsigned long long>(record.id));
+            m_observer->OnStorageFailed("Invalid parameters");
+            return false;
+        }
+        return true;
+    }
+
     bool OfflineStorage_SQLite::StoreRecord(StorageRecord const& record)
     {
         // TODO: [MG] - this works, but may not play nicely with several LogManager instances
         // static SqliteStatement sql_insert(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
 
-        if (record.id.empty() || record.tenantToken.empty() || static_cast<int>(record.latency) < 0 || record.timestamp <= 0) {
-            LOG_ERROR("Failed to store event %s:%s: Invalid parameters",
-                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
-            m_observer->OnStorageFailed("Invalid parameters");
+        if (!isValidRecord(record)) {
             return false;
         }
 
         if (!m_db) {
-            LOG_ERROR("Failed to store event %s:%s: Database is not open",
-                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+            LOG_ERROR("Failed to store event %s:%llu: Database is not open",
+                tenantTokenToId(record.tenantToken).c_str(), static_cast<unsigned long long>(record.id));
             m_observer->OnStorageOpenFailed("Database is not open");
             return false;
         }
@@ -161,15 +202,118 @@ namespace MAT_NS_BEGIN {
             DbTransaction transaction(m_db.get());
             if (!transaction.locked)
             {
-                LOG_ERROR("Failed to store event %s:%s: Database error", tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+                LOG_ERROR("Failed to store event %s:%llu: Database error", tenantTokenToId(record.tenantToken).c_str(), static_cast<unsigned long long>(record.id));
                 m_observer->OnStorageFailed("Database error");
                 return false;
             }
 #endif
-            SqliteStatement(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data).execute(record.id, record.tenantToken, static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob);
-            m_DbSizeEstimate += record.id.size() + record.tenantToken.size() + record.blob.size();
+            int64_t tenantRow = getTenantRowId(record);
+            if (tenantRow == 0) {
+                LOG_ERROR("Failed to store event %s:%llu: Database error", tenantTokenToId(record.tenantToken).c_str(), static_cast<unsigned long long>(record.id));
+                m_observer->OnStorageFailed("Database error");
+                return false;
+            }
+            SqliteStatement(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data).execute(tenantRow, static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob);
+            m_DbSizeEstimate += sizeof(record.id) + sizeof(tenantRow) + record.blob.size();
         }
 
+        checkDbSizeLimits();
+        return true;
+    }
+
+    std::vector<bool> OfflineStorage_SQLite::StoreRecords(std::vector<StorageRecord> & records)
+    {
+        std::vector<bool> stored(records.size(), false);
+        if (records.empty()) {
+            return stored;
+        }
+
+        if (!m_db) {
+            LOG_ERROR("Failed to store %u event(s): Database is not open", static_cast<unsigned>(records.size()));
+            m_observer->OnStorageOpenFailed("Database is not open");
+            return stored;
+        }
+
+        // Indices of the records worth inserting
+        std::vector<size_t> valid;
+        valid.reserve(records.size());
+        for (size_t i = 0; i < records.size(); i++) {
+            if (isValidRecord(records[i])) {
+                valid.push_back(i);
+            }
+        }
+        std::vector<int64_t> tenantRows(valid.size());
+
+        size_t storedBytes = 0;
+        {
+            // The whole batch is written under one lock and in one transaction
+            LOCKGUARD(m_lock);
+#ifdef ENABLE_LOCKING
+            DbTransaction transaction(m_db.get());
+            if (!transaction.locked)
+            {
+                LOG_ERROR("Failed to store %u event(s): Database error", static_cast<unsigned>(valid.size()));
+                m_observer->OnStorageFailed("Database error");
+                return stored;
+            }
+#endif
+            // Resolve tenants first, the inserts below must not be interleaved
+            // with other statements
+            for (size_t i = 0; i < valid.size(); i++) {
+                tenantRows[i] = getTenantRowId(records[valid[i]]);
+                if (tenantRows[i] == 0) {
+                    LOG_ERROR("Failed to store %u event(s): Database error", static_cast<unsigned>(valid.size()));
+                    m_observer->OnStorageFailed("Database error");
+                    return stored;
+                }
+            }
+
+            size_t i = 0;
+
+            // Full groups of rows go through the multi-row prepared insert
+            if (m_stmtInsertEvents_batch != 0) {
+                SqliteStatement batchStmt(*m_db, m_stmtInsertEvents_batch);
+                for (; i + kInsertBatchRows <= valid.size(); i += kInsertBatchRows) {
+                    int failedIdx = 0;
+                    size_t groupBytes = 0;
+                    for (size_t j = 0; (j < kInsertBatchRows) && (failedIdx == 0); j++) {
+                        StorageRecord const& record = records[valid[i + j]];
+                        failedIdx = batchStmt.bindGroup(static_cast<int>(j * kInsertColumns),
+                            tenantRows[i + j], static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob);
+                        groupBytes += sizeof(record.id) + sizeof(int64_t) + record.blob.size();
+                    }
+                    if (!batchStmt.executeBound(failedIdx)) {
+                        // Let the row-by-row path below retry what is left
+                        LOG_WARN("Multi-row insert failed, storing remaining %u event(s) one by one", static_cast<unsigned>(valid.size() - i));
+                        batchStmt.reset();
+                        break;
+                    }
+                    for (size_t j = 0; j < kInsertBatchRows; j++) {
+                        stored[valid[i + j]] = true;
+                    }
+                    storedBytes += groupBytes;
+                }
+            }
+
+            // Remainder goes row by row, still within the same transaction
+            SqliteStatement insertStmt(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
+            for (; i < valid.size(); i++) {
+                StorageRecord const& record = records[valid[i]];
+                if (insertStmt.execute(tenantRows[i], static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob)) {
+                    stored[valid[i]] = true;
+                    storedBytes += sizeof(record.id) + sizeof(int64_t) + record.blob.size();
+                }
+            }
+            m_DbSizeEstimate += storedBytes;
+        }
+
+        // Size estimate and limits are checked once per batch
+        checkDbSizeLimits();
+        return stored;
+    }
+
+    void OfflineStorage_SQLite::checkDbSizeLimits()
+    {
         if ((m_DbSizeNotificationLimit != 0) && (m_DbSizeEstimate>m_DbSizeNotificationLimit))
         {
             auto now = PAL::getMonotonicTimeMs();
@@ -199,20 +343,6 @@ namespace MAT_NS_BEGIN {
                 m_resizing = false;
             }
         }
-
-        return true;
-
-    }
-
-    size_t OfflineStorage_SQLite::StoreRecords(std::vector<StorageRecord> & records)
-    {
-        size_t stored = 0;
-        for (auto & i : records) {
-            if (StoreRecord(i)) {
-                ++stored;
-            }
-        }
-        return stored;
     }
 
     // Debug routine to print record count in the DB
@@ -237,6 +367,18 @@ namespace MAT_NS_BEGIN {
     /// <param name="maxCount">The maximum count.</param>
     /// <returns></returns>
     bool OfflineStorage_SQLite::GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount)
+    {
+        return reserveRecords(consumer, leaseTimeMs, minLatency, maxCount, std::vector<TenantId>());
+    }
+
+    bool OfflineStorage_SQLite::GetAndReserveRecordRefs(std::function<bool(StorageRecord const&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount,
+        std::vector<TenantId> const& skippedTenants)
+    {
+        return reserveRecords([&consumer](StorageRecord&& record) { return consumer(record); }, leaseTimeMs, minLatency, maxCount, skippedTenants);
+    }
+
+    bool OfflineStorage_SQLite::reserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount,
+        std::vector<TenantId> const& skippedTenants)
     {
         m_lastReadCount = 0;
 
@@ -269,8 +411,25 @@ namespace MAT_NS_BEGIN {
                 }
             }
 
-            SqliteStatement selectStmt(*m_db, m_stmtSelectEvents);
-            if (!selectStmt.select(static_cast<int>(minLatency), maxCount > 0 ? maxCount : -1)) {
+            // Events of skipped tenants are left out by the query, so that they
+            // do not use up maxCount
+            std::vector<StorageRecordId> skippedRows;
+            for (TenantId tenantId : skippedTenants) {
+                int64_t row = findTenantRowId(tenantId);
+                if (row != 0) {
+                    skippedRows.push_back(static_cast<StorageRecordId>(row));
+                }
+            }
+
+            bool selected;
+            SqliteStatement selectStmt(*m_db, skippedRows.empty() ? m_stmtSelectEvents : m_stmtSelectEvents_skipTenants);
+            if (skippedRows.empty()) {
+                selected = selectStmt.select(static_cast<int>(minLatency), maxCount > 0 ? maxCount : -1);
+            }
+            else {
+                selected = selectStmt.select(packageIdList(skippedRows.begin(), skippedRows.end()), static_cast<int>(minLatency), maxCount > 0 ? maxCount : -1);
+            }
+            if (!selected) {
                 LOG_ERROR("Failed to retrieve events to send: Database error occurred, recreating database");
                 recreate(204);
                 return false;
@@ -281,9 +440,11 @@ namespace MAT_NS_BEGIN {
 
             StorageRecord record;
             int latency;
+            int64_t tenantRow;
 
-            while (selectStmt.getRow(record.id, record.tenantToken, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
+            while (selectStmt.getRow(record.id, tenantRow, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
             {
+                setRecordTenant(record, tenantRow);
                 if (latency < EventLatency_Off || latency > EventLatency_Max) {
                     record.latency = EventLatency_Normal;
                 }
@@ -310,8 +471,8 @@ namespace MAT_NS_BEGIN {
                 return false;
             }
 
-            LOG_TRACE("Reserving %u event(s) {%s%s} for %u milliseconds",
-                static_cast<unsigned>(consumedIds.size()), consumedIds.front().c_str(), (consumedIds.size() > 1) ? ", ..." : "", leaseTimeMs);
+            LOG_TRACE("Reserving %u event(s) {%llu%s} for %u milliseconds",
+                static_cast<unsigned>(consumedIds.size()), static_cast<unsigned long long>(consumedIds.front()), (consumedIds.size() > 1) ? ", ..." : "", leaseTimeMs);
 
             for (size_t i = 0; i < consumedIds.size(); i += kBlockSize)
             {
@@ -354,8 +515,10 @@ namespace MAT_NS_BEGIN {
             if (selectStmt.select(static_cast<int>(minLatency), maxCount > 0 ? maxCount : -1))
             {
                 int latency;
-                while (selectStmt.getRow(record.id, record.tenantToken, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
+                int64_t tenantRow;
+                while (selectStmt.getRow(record.id, tenantRow, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
                 {
+                    setRecordTenant(record, tenantRow);
                     record.latency = static_cast<EventLatency>(latency);
                     records.push_back(record);
                 }
@@ -368,8 +531,10 @@ namespace MAT_NS_BEGIN {
             if (selectStmt.select(static_cast<int>(minLatency), maxCount > 0 ? maxCount : -1))
             {
                 int latency;
-                while (selectStmt.getRow(record.id, record.tenantToken, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
+                int64_t tenantRow;
+                while (selectStmt.getRow(record.id, tenantRow, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
                 {
+                    setRecordTenant(record, tenantRow);
                     record.latency = static_cast<EventLatency>(latency);
                     records.push_back(record);
                 }
@@ -383,7 +548,7 @@ namespace MAT_NS_BEGIN {
     {
         std::string sql = "DELETE FROM "  TABLE_NAME_EVENTS ;
         Execute(sql);
-
+        purgeUnusedTenants();
     }
 
     void OfflineStorage_SQLite::DeleteRecords(const std::map<std::string, std::string> & whereFilter)
@@ -409,14 +574,19 @@ namespace MAT_NS_BEGIN {
                 for (const auto &kv : whereFilter)
                 {
                     bool quotes = false;
-                    if ((kv.first == "record_id") ||
-                        (kv.first == "tenant_token"))
+                    if (kv.first == "tenant_token")
                     {
-                        // string types
-                        quotes = true;
+                        // Tokens live in the tenants table
+                        if (!clause.empty())
+                        {
+                            clause += " AND ";
+                        }
+                        clause += "tenant_id IN (SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token=\"" + kv.second + "\")";
+                        continue;
                     } 
                     else if (
                         // integer types
+                        (kv.first == "record_id") ||
                         (kv.first == "latency") ||
                         (kv.first == "persistence") ||
                         (kv.first == "retry_count"))
@@ -450,8 +620,8 @@ namespace MAT_NS_BEGIN {
         }
 
         if (!m_db) {
-            LOG_ERROR("Failed to delete %u sent event(s) {%s%s}: Database is not open",
-                static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "");
+            LOG_ERROR("Failed to delete %u sent event(s) {%llu%s}: Database is not open",
+                static_cast<unsigned>(ids.size()), static_cast<unsigned long long>(ids.front()), (ids.size() > 1) ? ", ..." : "");
             return;
         }
 
@@ -466,7 +636,7 @@ namespace MAT_NS_BEGIN {
                 return;
             }
 #endif
-            LOG_TRACE("Deleting %u sent event(s) {%s%s}...", static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "");
+            LOG_TRACE("Deleting %u sent event(s) {%llu%s}...", static_cast<unsigned>(ids.size()), static_cast<unsigned long long>(ids.front()), (ids.size() > 1) ? ", ..." : "");
 
             for (size_t i = 0; i < ids.size(); i += kBlockSize) {
                 size_t count = std::min(kBlockSize, ids.size() - i);
@@ -474,8 +644,8 @@ namespace MAT_NS_BEGIN {
                                                             ids.begin() + i + count);
                 if (!SqliteStatement(*m_db, m_stmtDeleteEvents_ids).execute(idList)) {
                     LOG_ERROR(
-                            "Failed to delete %u sent event(s) {%s%s}: Database error occurred, recreating database",
-                            static_cast<unsigned>(ids.size()), ids.front().c_str(),
+                            "Failed to delete %u sent event(s) {%llu%s}: Database error occurred, recreating database",
+                            static_cast<unsigned>(ids.size()), static_cast<unsigned long long>(ids.front()),
                             (ids.size() > 1) ? ", ..." : "");
                     recreate(302);
                     return;
@@ -493,8 +663,8 @@ namespace MAT_NS_BEGIN {
             return;
         }
         if (!m_db) {
-            LOG_ERROR("Failed to release %u event(s) {%s%s}, retry count %s: Database is not open",
-                static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "", incrementRetryCount ? "+1" : "not changed");
+            LOG_ERROR("Failed to release %u event(s) {%llu%s}, retry count %s: Database is not open",
+                static_cast<unsigned>(ids.size()), static_cast<unsigned long long>(ids.front()), (ids.size() > 1) ? ", ..." : "", incrementRetryCount ? "+1" : "not changed");
             return;
         }
 
@@ -508,8 +678,8 @@ namespace MAT_NS_BEGIN {
                 return;
             }
 #endif
-            LOG_TRACE("Releasing %u event(s) {%s%s}, retry count %s...",
-                static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "", incrementRetryCount ? "+1" : "not changed");
+            LOG_TRACE("Releasing %u event(s) {%llu%s}, retry count %s...",
+                static_cast<unsigned>(ids.size()), static_cast<unsigned long long>(ids.front()), (ids.size() > 1) ? ", ..." : "", incrementRetryCount ? "+1" : "not changed");
 
             SqliteStatement releaseStmt(*m_db, m_stmtReleaseEvents_ids_retryCountDelta);
             for (size_t i = 0; i < ids.size(); i += kBlockSize) {
@@ -517,8 +687,8 @@ namespace MAT_NS_BEGIN {
                 std::vector<uint8_t> idList = packageIdList(ids.begin() + i, ids.begin() + i + count);
                 if (!releaseStmt.execute(idList, incrementRetryCount ? 1 : 0)) {
                     LOG_ERROR(
-                            "Failed to release %u event(s) {%s%s}, retry count %s: Database error occurred, recreating database",
-                            static_cast<unsigned>(ids.size()), ids.front().c_str(),
+                            "Failed to release %u event(s) {%llu%s}, retry count %s: Database error occurred, recreating database",
+                            static_cast<unsigned>(ids.size()), static_cast<unsigned long long>(ids.front()),
                             (ids.size() > 1) ? ", ..." : "",
                             incrementRetryCount ? "+1" : "not changed");
                     recreate(403);
@@ -706,6 +876,10 @@ namespace MAT_NS_BEGIN {
             else if (openedDbVersion < CURRENT_SCHEMA_VERSION) {
                 LOG_INFO("Database has older version %d, upgrading to %d",
                     openedDbVersion, CURRENT_SCHEMA_VERSION);
+                if (!upgradeDatabase(openedDbVersion)) {
+                    LOG_WARN("Database upgrade from version %d failed, erasing and replacing with new", openedDbVersion);
+                    return false;
+                }
             }
             else {
                 LOG_WARN("Database version %d is newer than current %d, erasing and replacing with new",
@@ -719,21 +893,14 @@ namespace MAT_NS_BEGIN {
             }
         }
 
-        if (!SqliteStatement(*m_db,
-            "CREATE TABLE IF NOT EXISTS " TABLE_NAME_EVENTS " ("
-            "record_id"      " TEXT,"
-            "tenant_token"   " TEXT NOT NULL,"
-            "latency"        " INTEGER,"
-            "persistence"    " INTEGER,"
-            "timestamp"      " INTEGER,"
-            "retry_count"    " INTEGER DEFAULT 0,"
-            "reserved_until" " INTEGER DEFAULT 0,"
-            "payload"        " BLOB"
-            ")"
-        ).execute()) {
+        if (!SqliteStatement(*m_db, SQL_CREATE_TABLE_TENANTS).execute() ||
+            !SqliteStatement(*m_db, SQL_CREATE_TABLE_EVENTS).execute()) {
             return false;
         }
 
+        // Tenant rows belong to the database that was just opened
+        purgeUnusedTenants();
+
         if (!SqliteStatement(*m_db,
             "CREATE INDEX IF NOT EXISTS k_latency_timestamp ON " TABLE_NAME_EVENTS
             " (latency DESC, persistence DESC, timestamp ASC)"
@@ -778,7 +945,7 @@ namespace MAT_NS_BEGIN {
             "SELECT count(*) FROM " TABLE_NAME_EVENTS " WHERE latency=?");
 
         PREPARE_SQL(m_stmtPerTenantTrimCount,
-            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
+            "SELECT " SQL_SELECT_TENANT_TOKEN " FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
             "(SELECT COUNT(record_id) FROM " TABLE_NAME_EVENTS ")"
             "* ? / 100)");
         PREPARE_SQL(m_stmtTrimEvents_percent,
@@ -790,48 +957,70 @@ namespace MAT_NS_BEGIN {
 
         PREPARE_SQL(m_stmtDeleteEvents_tenants,
                 SQL_SUPPLY_PACKAGED_IDS
-                "DELETE FROM " TABLE_NAME_EVENTS " WHERE tenant_token IN ids");
+                "DELETE FROM " TABLE_NAME_EVENTS " WHERE tenant_id IN (SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token IN ids)");
         PREPARE_SQL(m_stmtDeleteEvents_ids,
-            SQL_SUPPLY_PACKAGED_IDS
+            SQL_SUPPLY_PACKAGED_RECORD_IDS
             "DELETE FROM " TABLE_NAME_EVENTS " WHERE record_id IN ids");
         PREPARE_SQL(m_stmtReleaseExpiredEvents,
             "UPDATE " TABLE_NAME_EVENTS
             " SET reserved_until=0, retry_count=retry_count+1"
             " WHERE reserved_until<>0 AND reserved_until<=?");
         PREPARE_SQL(m_stmtSelectEvents,
-            "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
+            "SELECT record_id,tenant_id,latency,timestamp,retry_count,reserved_until,payload"
             " FROM " TABLE_NAME_EVENTS
             " WHERE latency>=? AND reserved_until=0"
             " ORDER BY latency DESC,persistence DESC, timestamp ASC LIMIT ?");
+        // Tenant rows go through the record ID list, both are 8-byte integers.
+        // The list ends with a NULL, which would make NOT IN match nothing.
+        PREPARE_SQL(m_stmtSelectEvents_skipTenants,
+            SQL_SUPPLY_PACKAGED_RECORD_IDS
+            "SELECT record_id,tenant_id,latency,timestamp,retry_count,reserved_until,payload"
+            " FROM " TABLE_NAME_EVENTS
+            " WHERE latency>=? AND reserved_until=0 AND tenant_id NOT IN (SELECT id FROM ids WHERE id IS NOT NULL)"
+            " ORDER BY latency DESC,persistence DESC, timestamp ASC LIMIT ?");
         PREPARE_SQL(m_stmtSelectEventAtShutdown,
-            "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
+            "SELECT record_id,tenant_id,latency,timestamp,retry_count,reserved_until,payload"
             " FROM " TABLE_NAME_EVENTS
             " WHERE latency>=?"
             " ORDER BY latency DESC,persistence DESC, timestamp ASC LIMIT ?");
         PREPARE_SQL(m_stmtSelectEventsMinlatency,
-            "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
+            "SELECT record_id,tenant_id,latency,timestamp,retry_count,reserved_until,payload"
             " FROM " TABLE_NAME_EVENTS
             " WHERE latency=(SELECT MIN(latency) FROM " TABLE_NAME_EVENTS " WHERE reserved_until=0 AND latency>=?) AND reserved_until=0"
             " ORDER BY timestamp ASC LIMIT ?");
 
         PREPARE_SQL(m_stmtReserveEvents,
-            SQL_SUPPLY_PACKAGED_IDS
+            SQL_SUPPLY_PACKAGED_RECORD_IDS
             "UPDATE " TABLE_NAME_EVENTS
             " SET reserved_until=?"
             " WHERE record_id IN ids");
         PREPARE_SQL(m_stmtReleaseEvents_ids_retryCountDelta,
-            SQL_SUPPLY_PACKAGED_IDS
+            SQL_SUPPLY_PACKAGED_RECORD_IDS
             "UPDATE " TABLE_NAME_EVENTS
             " SET reserved_until=0, retry_count=retry_count+?"
             " WHERE record_id IN ids AND reserved_until>0");
         PREPARE_SQL(m_stmtSelectEventsRetried_maxRetryCount,
-            "SELECT tenant_token FROM " TABLE_NAME_EVENTS
+            "SELECT " SQL_SELECT_TENANT_TOKEN " FROM " TABLE_NAME_EVENTS
             " WHERE retry_count>?");
         PREPARE_SQL(m_stmtDeleteEventsRetried_maxRetryCount,
             "DELETE FROM " TABLE_NAME_EVENTS
             " WHERE retry_count>?");
+        // The record ID of the caller only addresses the RAM queue
         PREPARE_SQL(m_stmtInsertEvent_id_tenant_prio_ts_data,
-            "REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_token,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+            "INSERT INTO " TABLE_NAME_EVENTS " (tenant_id,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?)");
+        {
+            std::string batchInsert("INSERT INTO " TABLE_NAME_EVENTS " (tenant_id,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?)");
+            for (size_t i = 1; i < kInsertBatchRows; i++) {
+                batchInsert += ",(?,?,?,?,?)";
+            }
+            PREPARE_SQL(m_stmtInsertEvents_batch, batchInsert.c_str());
+        }
+        PREPARE_SQL(m_stmtInsertTenant_token,
+            "INSERT OR IGNORE INTO " TABLE_NAME_TENANTS " (tenant_token) VALUES (?)");
+        PREPARE_SQL(m_stmtSelectTenantId_token,
+            "SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token=?");
+        PREPARE_SQL(m_stmtSelectTenantToken_id,
+            "SELECT tenant_token FROM " TABLE_NAME_TENANTS " WHERE tenant_id=?");
         PREPARE_SQL(m_stmtInsertSetting_name_value,
             "REPLACE INTO " TABLE_NAME_SETTINGS " (name,value) VALUES (?,?)");
         PREPARE_SQL(m_stmtDeleteSetting_name,
@@ -849,6 +1038,129 @@ namespace MAT_NS_BEGIN {
         return true;
 }
 
+    bool OfflineStorage_SQLite::upgradeDatabase(int fromVersion)
+    {
+        if (fromVersion < 3) {
+            // Versions 1 and 2 kept the tenant token in every row. Version 1
+            // also keyed events by UUID string: let sqlite number those, new
+            // events get ids far above the rowids.
+            std::string recordId = (fromVersion < 2) ? "" : "record_id,";
+            std::string sql =
+                "BEGIN;"
+                "ALTER TABLE " TABLE_NAME_EVENTS " RENAME TO " TABLE_NAME_EVENTS "_old;"
+                SQL_CREATE_TABLE_TENANTS ";"
+                "INSERT OR IGNORE INTO " TABLE_NAME_TENANTS " (tenant_token)"
+                " SELECT DISTINCT tenant_token FROM " TABLE_NAME_EVENTS "_old;"
+                SQL_CREATE_TABLE_EVENTS ";"
+                "INSERT INTO " TABLE_NAME_EVENTS " (" + recordId + "tenant_id,latency,persistence,timestamp,retry_count,payload)"
+                " SELECT " + recordId + "(SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE " TABLE_NAME_TENANTS ".tenant_token=" TABLE_NAME_EVENTS "_old.tenant_token),"
+                "latency,persistence,timestamp,retry_count,payload FROM " TABLE_NAME_EVENTS "_old;"
+                "DROP TABLE " TABLE_NAME_EVENTS "_old;"
+                "COMMIT;";
+            if (m_db->sqlite3_exec(sql.c_str()) != SQLITE_OK) {
+                m_db->sqlite3_exec("ROLLBACK;");
+                return false;
+            }
+        }
+        else if (fromVersion < 4) {
+            // Version 3 stored the IDs the LogManager assigned, keep them and
+            // let sqlite continue above the highest
+            std::string sql =
+                "BEGIN;"
+                "ALTER TABLE " TABLE_NAME_EVENTS " RENAME TO " TABLE_NAME_EVENTS "_old;"
+                SQL_CREATE_TABLE_EVENTS ";"
+                "INSERT INTO " TABLE_NAME_EVENTS " (record_id,tenant_id,latency,persistence,timestamp,retry_count,reserved_until,payload)"
+                " SELECT record_id,tenant_id,latency,persistence,timestamp,retry_count,reserved_until,payload FROM " TABLE_NAME_EVENTS "_old;"
+                "DROP TABLE " TABLE_NAME_EVENTS "_old;"
+                "COMMIT;";
+            if (m_db->sqlite3_exec(sql.c_str()) != SQLITE_OK) {
+                m_db->sqlite3_exec("ROLLBACK;");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void OfflineStorage_SQLite::purgeUnusedTenants()
+    {
+        LOCKGUARD(m_lock);
+        Execute("DELETE FROM " TABLE_NAME_TENANTS " WHERE tenant_id NOT IN (SELECT tenant_id FROM " TABLE_NAME_EVENTS ")");
+        m_tenantRows.clear();
+        m_tenantIds.clear();
+    }
+
+    int64_t OfflineStorage_SQLite::getTenantRowId(StorageRecord const& record)
+    {
+        LOCKGUARD(m_lock);
+        TenantId tenantId = TenantRegistry::GetId(record);
+        auto it = m_tenantRows.find(tenantId);
+        if (it != m_tenantRows.end()) {
+            return it->second;
+        }
+
+        std::string const& tenantToken = TenantRegistry::GetToken(tenantId);
+        int64_t row = 0;
+        if (!SqliteStatement(*m_db, m_stmtInsertTenant_token).execute(tenantToken)) {
+            return 0;
+        }
+        SqliteStatement selectStmt(*m_db, m_stmtSelectTenantId_token);
+        bool found = selectStmt.select(tenantToken) && selectStmt.getOneValue(row);
+        selectStmt.reset();
+        if (!found || row == 0) {
+            return 0;
+        }
+        m_tenantRows[tenantId] = row;
+        m_tenantIds[row] = tenantId;
+        return row;
+    }
+
+    int64_t OfflineStorage_SQLite::findTenantRowId(TenantId tenantId)
+    {
+        LOCKGUARD(m_lock);
+        auto it = m_tenantRows.find(tenantId);
+        if (it != m_tenantRows.end()) {
+            return it->second;
+        }
+
+        // Unlike getTenantRowId this does not add the tenant
+        int64_t row = 0;
+        SqliteStatement selectStmt(*m_db, m_stmtSelectTenantId_token);
+        bool found = selectStmt.select(TenantRegistry::GetToken(tenantId)) && selectStmt.getOneValue(row);
+        selectStmt.reset();
+        if (!found || row == 0) {
+            return 0;
+        }
+        m_tenantRows[tenantId] = row;
+        m_tenantIds[row] = tenantId;
+        return row;
+    }
+
+    void OfflineStorage_SQLite::setRecordTenant(StorageRecord& record, int64_t tenantRow)
+    {
+        LOCKGUARD(m_lock);
+        auto it = m_tenantIds.find(tenantRow);
+        if (it == m_tenantIds.end()) {
+            std::string tenantToken;
+            SqliteStatement selectStmt(*m_db, m_stmtSelectTenantToken_id);
+            if (selectStmt.select(tenantRow)) {
+                selectStmt.getOneValue(tenantToken);
+            }
+            selectStmt.reset();
+            TenantId tenantId = TenantRegistry::Intern(tenantToken);
+            if (tenantId == TenantRegistry::InvalidTenantId) {
+                LOG_WARN("Event %llu refers to unknown tenant row %lld",
+                    static_cast<unsigned long long>(record.id), static_cast<long long>(tenantRow));
+                record.tenantId = TenantRegistry::InvalidTenantId;
+                record.tenantToken.clear();
+                return;
+            }
+            it = m_tenantIds.emplace(tenantRow, tenantId).first;
+            m_tenantRows[tenantId] = tenantRow;
+        }
+        record.tenantId = it->second;
+        record.tenantToken = TenantRegistry::GetToken(it->second);
+    }
+
     size_t OfflineStorage_SQLite::GetSize()
     {
         if (!m_db) {
@@ -927,6 +1239,7 @@ namespace MAT_NS_BEGIN {
             {
                 LOG_TRACE("DB is too big, deleting...");
                 Execute("DELETE FROM " TABLE_NAME_EVENTS);
+                purgeUnusedTenants();
                 Execute("VACUUM");
                 return true;
             }
@@ -938,9 +1251,10 @@ namespace MAT_NS_BEGIN {
                 LOG_TRACE("Evict all non-critical");
                 Execute("DELETE FROM " TABLE_NAME_EVENTS " WHERE persistence=1");
             }
+            trimStmt.reset();
             eventsDropped = count - GetRecordCountUnsafe(EventLatency::EventLatency_Unspecified);
             LOG_TRACE("Db resized, events dropeed: %d", eventsDropped);
-            trimStmt.reset();
+            purgeUnusedTenants();
         }
 
         m_DbSizeEstimate = GetSize();
@@ -953,23 +1267,15 @@ namespace MAT_NS_BEGIN {
     }
 
     std::vector<uint8_t> OfflineStorage_SQLite::packageIdList(
-        std::vector<std::string>::const_iterator const & begin,
-        std::vector<std::string>::const_iterator const & end) const
+        std::vector<StorageRecordId>::const_iterator const & begin,
+        std::vector<StorageRecordId>::const_iterator const & end) const
     {
-        size_t size = std::accumulate(begin, end, size_t(0), [](size_t sum, std::string const& id) -> size_t {
-            return sum + id.length() + 1;
-        });
-
-        std::vector<uint8_t> result;
-        result.reserve(size);
-
-        for (auto i = begin; i != end; ++i)
+        // Native byte order, read back by tokenize_ids() in the same process
+        std::vector<uint8_t> result(static_cast<size_t>(end - begin) * sizeof(StorageRecordId));
+        if (!result.empty())
         {
-            std::string const & id(*i);
-            uint8_t const* ptr = reinterpret_cast<uint8_t const*>(id.c_str());
-            result.insert(result.end(), ptr, ptr + id.size() + 1);
+            memcpy(result.data(), &*begin, result.size());
         }
-
         return result;
     }
     
@@ -16,6 +16,7 @@
 #include <memory>
 #include <atomic>
 #include <mutex>
+#include <unordered_map>
 
 #define ENABLE_LOCKING      // Enable DB locking for flush
 
@@ -34,8 +35,10 @@ namespace MAT_NS_BEGIN {
         virtual void Flush() override {};
         virtual void Execute(std::string command);
         virtual bool StoreRecord(StorageRecord const& record) override;
-        virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
+        virtual std::vector<bool> StoreRecords(std::vector<StorageRecord> & records) override;
         virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Normal, unsigned maxCount = 0) override;
+        virtual bool GetAndReserveRecordRefs(std::function<bool(StorageRecord const&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Normal, unsigned maxCount = 0,
+            std::vector<TenantId> const& skippedTenants = std::vector<TenantId>()) override;
         virtual bool IsLastReadFromMemory() override;
         virtual unsigned LastReadRecordCount() override;
 
@@ -54,11 +57,14 @@ namespace MAT_NS_BEGIN {
 
     protected:
         bool initializeDatabase();
+        bool upgradeDatabase(int fromVersion);
         bool recreate(unsigned failureCode);
+        bool reserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount,
+            std::vector<TenantId> const& skippedTenants);
 
         std::vector<uint8_t> packageIdList(
-            std::vector<std::string>::const_iterator const & begin,
-            std::vector<std::string>::const_iterator const & end) const;
+            std::vector<StorageRecordId>::const_iterator const & begin,
+            std::vector<StorageRecordId>::const_iterator const & end) const;
 
         // Debug routine to print record count in the DB
         void printRecordCount();
@@ -92,6 +98,7 @@ namespace MAT_NS_BEGIN {
         size_t                      m_stmtReleaseExpiredEvents {};
         size_t                      m_stmtDeleteEvents_tenants {};
         size_t                      m_stmtSelectEvents {};
+        size_t                      m_stmtSelectEvents_skipTenants {};
         size_t                      m_stmtSelectEventAtShutdown {};
         size_t                      m_stmtSelectEventsMinlatency {};
         size_t                      m_stmtReserveEvents {};
@@ -99,6 +106,10 @@ namespace MAT_NS_BEGIN {
         size_t                      m_stmtDeleteEventsRetried_maxRetryCount {};
         size_t                      m_stmtSelectEventsRetried_maxRetryCount {};
         size_t                      m_stmtInsertEvent_id_tenant_prio_ts_data {};
+        size_t                      m_stmtInsertEvents_batch {};
+        size_t                      m_stmtInsertTenant_token {};
+        size_t                      m_stmtSelectTenantId_token {};
+        size_t                      m_stmtSelectTenantToken_id {};
         size_t                      m_stmtInsertSetting_name_value {};
         size_t                      m_stmtDeleteSetting_name {};
         size_t                      m_stmtSelectSetting_name {};
@@ -111,11 +122,21 @@ namespace MAT_NS_BEGIN {
         std::atomic<size_t>         m_DbSizeEstimate {};
         uint64_t                    m_isStorageFullNotificationSendTime {};
 
+        // Tenants table rows of the open database, by process-wide TenantId and back
+        std::unordered_map<TenantId, int64_t> m_tenantRows;
+        std::unordered_map<int64_t, TenantId> m_tenantIds;
+
     protected:
         MATSDK_LOG_DECL_COMPONENT_CLASS();
 
     private:
         size_t GetRecordCountUnsafe(EventLatency latency) const;
+        bool isValidRecord(StorageRecord const& record);
+        void purgeUnusedTenants();
+        int64_t findTenantRowId(TenantId tenantId);
+        int64_t getTenantRowId(StorageRecord const& record);
+        void setRecordTenant(StorageRecord& record, int64_t tenantRow);
+        void checkDbSizeLimits();
     };
 
 
@@ -150,6 +150,11 @@ namespace MAT_NS_BEGIN {
             return ::sqlite3_result_text(ctx, value, size, d);
         }
 
+        void sqlite3_result_int64(sqlite3_context* ctx, int64_t value) override
+        {
+            return ::sqlite3_result_int64(ctx, value);
+        }
+
         void sqlite3_set_auxdata(sqlite3_context* ctx, int N, void* data, void(*d)(void*)) override
         {
             return ::sqlite3_set_auxdata(ctx, N, data, d);
@@ -201,6 +206,17 @@ namespace MAT_NS_BEGIN {
     "LIMIT 10000 OFFSET 1"         \
     ") "
 
+    /// Provide virtual table 'ids' filled from a list of 8-byte record ids
+    /// (input blob is split with a custom function 'tokenize_ids')
+#define SQL_SUPPLY_PACKAGED_RECORD_IDS \
+    "WITH RECURSIVE ids(id) AS ("      \
+    "SELECT 0 "                        \
+    "UNION ALL "                       \
+    "SELECT tokenize_ids(?) FROM ids " \
+    "WHERE id IS NOT NULL "            \
+    "LIMIT 10000 OFFSET 1"             \
+    ") "
+
     class SqliteDB {
         std::mutex m_lock;
     public:
@@ -450,10 +466,30 @@ namespace MAT_NS_BEGIN {
             g_sqlite3Proxy->sqlite3_set_auxdata(ctx, 0, reinterpret_cast<void*>(static_cast<intptr_t>(pos + 1)), NULL);
         }
 
+        static void sqliteFunc_tokenize_ids(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+        {
+            UNREFERENCED_PARAMETER(argc);
+            int len = g_sqlite3Proxy->sqlite3_value_bytes(argv[0]);
+            int ofs = static_cast<int>(reinterpret_cast<intptr_t>(g_sqlite3Proxy->sqlite3_get_auxdata(ctx, 0)));
+            if (ofs + static_cast<int>(sizeof(uint64_t)) > len) {
+                g_sqlite3Proxy->sqlite3_result_null(ctx);
+                return;
+            }
+            char const* data = static_cast<char const*>(g_sqlite3Proxy->sqlite3_value_blob(argv[0]));
+            uint64_t id;
+            memcpy(&id, data + ofs, sizeof(id));
+            g_sqlite3Proxy->sqlite3_result_int64(ctx, static_cast<int64_t>(id));
+            g_sqlite3Proxy->sqlite3_set_auxdata(ctx, 0, reinterpret_cast<void*>(static_cast<intptr_t>(ofs + sizeof(id))), NULL);
+        }
+
         bool registerTokenizeFunction()
         {
             int result = g_sqlite3Proxy->sqlite3_create_function_v2(m_db, "tokenize", 1, SQLITE_UTF8, NULL,
                 &SqliteDB::sqliteFunc_tokenize, NULL, NULL, NULL);
+            if (result == SQLITE_OK) {
+                result = g_sqlite3Proxy->sqlite3_create_function_v2(m_db, "tokenize_ids", 1, SQLITE_UTF8, NULL,
+                    &SqliteDB::sqliteFunc_tokenize_ids, NULL, NULL, NULL);
+            }
             if (result != SQLITE_OK) {
                 LOG_ERROR("Could not create tokenize function: (%d) %s",
                     result, g_sqlite3Proxy->sqlite3_errmsg(m_db));
@@ -525,6 +561,27 @@ namespace MAT_NS_BEGIN {
             }
         }
 
+        /// Bind a group of parameters that starts right after position 'offset'.
+        /// Used to fill multi-row statements one row at a time, returns the
+        /// index of the parameter that failed to bind or 0 on success.
+        template<typename... TArgs>
+        int bindGroup(int offset, TArgs&& ... args)
+        {
+            if (m_stmt == nullptr) {
+                return offset + 1;
+            }
+            return bindAll(offset, std::forward<TArgs>(args) ...);
+        }
+
+        /// Execute a statement previously filled with bindGroup().
+        bool executeBound(int bindFailedIdx)
+        {
+            if (m_stmt == nullptr) {
+                return false;
+            }
+            return execute2(bindFailedIdx);
+        }
+
         template<typename... TArgs>
         bool select(TArgs&& ... args)
         {
@@ -593,6 +650,11 @@ namespace MAT_NS_BEGIN {
             return g_sqlite3Proxy->sqlite3_bind_int64(m_stmt, idx, arg);
         }
 
+        int bind(int idx, uint64_t arg)
+        {
+            return g_sqlite3Proxy->sqlite3_bind_int64(m_stmt, idx, static_cast<int64_t>(arg));
+        }
+
         int bind(int idx, std::string const& arg)
         {
             return g_sqlite3Proxy->sqlite3_bind_text(m_stmt, idx, arg.data(), static_cast<int>(arg.size()), SQLITE_STATIC);
@@ -636,6 +698,11 @@ namespace MAT_NS_BEGIN {
             output = g_sqlite3Proxy->sqlite3_column_int64(m_stmt, idx);
         }
 
+        void retrieve(int idx, uint64_t& output)
+        {
+            output = static_cast<uint64_t>(g_sqlite3Proxy->sqlite3_column_int64(m_stmt, idx));
+        }
+
         void retrieve(int idx, std::string& output)
         {
             int len = g_sqlite3Proxy->sqlite3_column_bytes(m_stmt, idx);
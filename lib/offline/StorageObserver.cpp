@@ -5,6 +5,8 @@
 
 #include "StorageObserver.hpp"
 
+#include <algorithm>
+
 namespace MAT_NS_BEGIN {
 
     StorageObserver::StorageObserver(ITelemetrySystem& system, IOfflineStorage& offlineStorage)
@@ -41,23 +43,66 @@ namespace MAT_NS_BEGIN {
         return true;
     }
 
+    /// <summary>
+    /// Stores the records of a batch of events with one StoreRecords call and
+    /// returns whether each of them was stored.
+    /// </summary>
+    std::vector<bool> StorageObserver::storeRecords(std::vector<IncomingEventContextPtr> const& events)
+    {
+        StorageRecordVector records;
+        records.reserve(events.size());
+        int64_t now = PAL::getUtcSystemTimeMs();
+        for (auto const& event : events)
+        {
+            event->record.timestamp = now;
+            records.push_back(std::move(event->record));
+        }
+
+        std::vector<bool> stored = m_offlineStorage.StoreRecords(records);
+        stored.resize(events.size(), false);
+
+        // Stats and TPM still look at the records
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            events[i]->record = std::move(records[i]);
+            if (!stored[i])
+            {
+                storeRecordFailed(events[i]);
+            }
+        }
+        return stored;
+    }
+
     void StorageObserver::handleRetrieveEvents(EventsUploadContextPtr const& ctx)
     {
-        auto consumer = [&ctx, this](StorageRecord&& record) -> bool {
+        std::vector<TenantId> throttled;
+        if (m_tenantThrottle)
+        {
+            throttled = m_tenantThrottle->getThrottledTenants();
+        }
+
+        // The packager copies what it needs, borrowing the records saves a copy per record
+        auto consumer = [&ctx, &throttled, this](StorageRecord const& record) -> bool {
+            // Storage that cannot filter hands out throttled events anyway, they sit out the lease
+            if (!throttled.empty() && std::binary_search(throttled.begin(), throttled.end(), TenantRegistry::GetId(record)))
+            {
+                return true;
+            }
             bool wantMore = true;
-            retrievedEvent(ctx, std::move(record), wantMore);
+            retrievedEvent(ctx, record, wantMore);
             return wantMore;
         };
 
         // TODO: [MG] - expose 120000 as a configuration parameter
-        if (!m_offlineStorage.GetAndReserveRecords(consumer, 120000, ctx->requestedMinLatency, ctx->requestedMaxCount))
+        bool retrieved = m_offlineStorage.GetAndReserveRecordRefs(consumer, 120000, ctx->requestedMinLatency, ctx->requestedMaxCount, throttled);
+        ctx->fromMemory = m_offlineStorage.IsLastReadFromMemory();
+
+        if (!retrieved)
         {
-            ctx->fromMemory = m_offlineStorage.IsLastReadFromMemory();
             retrievalFailed(ctx);
         }
         else
         {
-            ctx->fromMemory = m_offlineStorage.IsLastReadFromMemory();
             retrievalFinished(ctx);
         }
     }
@@ -10,6 +10,7 @@
 #include "system/Contexts.hpp"
 #include "system/Route.hpp"
 #include "system/ITelemetrySystem.hpp"
+#include "system/TenantThrottle.hpp"
 
 namespace MAT_NS_BEGIN {
 
@@ -26,6 +27,11 @@ namespace MAT_NS_BEGIN {
             return m_system.DispatchEvent(std::move(evt));
         }
 
+        /// <summary>
+        /// Events of tenants the throttle holds are left in the storage on retrieval.
+        /// </summary>
+        void SetTenantThrottle(TenantThrottle* throttle) { m_tenantThrottle = throttle; }
+
     protected:
         bool handleStart();
         bool handleStop();
@@ -49,6 +55,7 @@ namespace MAT_NS_BEGIN {
     protected:
         ITelemetrySystem & m_system;
         IOfflineStorage  & m_offlineStorage;
+        TenantThrottle*    m_tenantThrottle = nullptr;
 
     public:
 
@@ -62,6 +69,8 @@ namespace MAT_NS_BEGIN {
             return m_offlineStorage.GetRecordCount();
         }
 
+        std::vector<bool> storeRecords(std::vector<IncomingEventContextPtr> const& events);
+
         RoutePassThrough<StorageObserver>                                        start{ this, &StorageObserver::handleStart };
         RoutePassThrough<StorageObserver>                                        stop{ this, &StorageObserver::handleStop };
 
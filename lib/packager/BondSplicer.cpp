@@ -25,6 +25,11 @@ void BondSplicer::addRecord(size_t dataPackageIndex, std::vector<uint8_t> const&
     assert(dataPackageIndex < m_packages.size());
     assert(!recordBlob.empty() && recordBlob.back() == bond_lite::BT_STOP);
 
+    if (dataPackageIndex < m_lastPackageIndex) {
+        m_inPackageOrder = false;
+    }
+    m_lastPackageIndex = dataPackageIndex;
+
     m_packages[dataPackageIndex].records.push_back(Span{m_buffer.size(), recordBlob.size()});
     m_buffer.insert(m_buffer.end(), recordBlob.begin(), recordBlob.end());
 }
@@ -37,27 +42,36 @@ size_t BondSplicer::getSizeEstimate() const
 std::vector<uint8_t> BondSplicer::splice() const
 {
     std::vector<uint8_t> output;
-    bond_lite::CompactBinaryProtocolWriter writer(output);
-
-    if (!m_packages.empty()) {
-        for (PackageInfo const& package : m_packages) {
-            if (!package.records.empty()) {
-                for (Span const& record : package.records) {
-                    writer.WriteBlob(m_buffer.data() + record.offset, record.length);
-                }
-            } 
+    output.reserve(m_buffer.size());
+    for (PackageInfo const& package : m_packages) {
+        for (Span const& record : package.records) {
+            uint8_t const* begin = m_buffer.data() + record.offset;
+            output.insert(output.end(), begin, begin + record.length);
         }
-    } 
+    }
 
     return output;
 }
 
+void BondSplicer::spliceInto(std::vector<uint8_t>& output)
+{
+    if (m_inPackageOrder) {
+        // Package bodies are plain concatenations of record blobs, hand the buffer over as is
+        output.swap(m_buffer);
+    } else {
+        output = splice();
+    }
+    clear();
+}
+
 void BondSplicer::clear()
 {
     // Swap with empty instead of clear() to release memory
     std::vector<uint8_t>().swap(m_buffer);
     std::vector<PackageInfo>().swap(m_packages);
     m_overheadEstimate = 0;
+    m_inPackageOrder = true;
+    m_lastPackageIndex = 0;
 }
 
 
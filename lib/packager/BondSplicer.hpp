@@ -21,6 +21,9 @@ class BondSplicer : public ISplicer
     std::vector<uint8_t>     m_buffer;
     std::vector<PackageInfo> m_packages;
     size_t                   m_overheadEstimate {};
+    // Records were added in package index order, so m_buffer already is the spliced body
+    bool                     m_inPackageOrder {true};
+    size_t                   m_lastPackageIndex {};
 
   public:
     BondSplicer() noexcept = default;
@@ -32,6 +35,7 @@ class BondSplicer : public ISplicer
 
     size_t getSizeEstimate() const override;
     std::vector<uint8_t> splice() const override;
+    void spliceInto(std::vector<uint8_t>& output) override;
 
     void clear() override;
 };
@@ -35,6 +35,14 @@ class ISplicer
     virtual size_t getSizeEstimate() const = 0;
     virtual std::vector<uint8_t> splice() const = 0;
 
+    // Write the spliced body into output and reset the splicer. Implementations
+    // can hand over their buffer instead of copying it when the layout allows.
+    virtual void spliceInto(std::vector<uint8_t>& output)
+    {
+        output = splice();
+        clear();
+    }
+
     virtual void clear() = 0;
 };
 
@@ -4,6 +4,7 @@
 //
 
 #include "Packager.hpp"
+#include "compression/DeflateContextPool.hpp"
 #include "ILogManager.hpp"
 #include "utils/Utils.hpp"
 #include <algorithm>
@@ -16,7 +17,7 @@ namespace MAT_NS_BEGIN {
         const char *forcedTenantToken = runtimeConfig["forcedTenantToken"];
         if (forcedTenantToken != nullptr)
         {
-            m_forcedTenantToken = forcedTenantToken;
+            m_forcedTenantId = TenantRegistry::Intern(forcedTenantToken);
         }
     }
 
@@ -26,11 +27,20 @@ namespace MAT_NS_BEGIN {
             if (ctx->maxUploadSize == 0) {
                 ctx->maxUploadSize = m_config.GetMaximumUploadSizeBytes();
             }
-            if (ctx->splicer->getSizeEstimate() + record.blob.size() > ctx->maxUploadSize) {
+            if (ctx->recordIdsAndTenantIds.empty() && !ctx->deflater) {
+                beginStreamCompression(ctx);
+            }
+            size_t packageSize = ctx->deflater ? ctx->deflater->GetSizeEstimate() : ctx->splicer->getSizeEstimate();
+            if (ctx->deflater && packageSize + record.blob.size() > ctx->maxUploadSize && ctx->deflater->Flush()) {
+                // Input held back by zlib is counted at its raw size, get the real figure first
+                packageSize = ctx->deflater->GetSizeEstimate();
+            }
+            if (packageSize + record.blob.size() > ctx->maxUploadSize) {
                 wantMore = false;
                 if (!ctx->recordIdsAndTenantIds.empty()) {
-                    LOG_TRACE("Maximum upload size %u bytes exceeded, not adding the next event (ID %s, size %u bytes)",
-                        ctx->maxUploadSize, record.id.c_str(), static_cast<unsigned>(record.blob.size()));
+                    ctx->packageFull = true;
+                    LOG_TRACE("Maximum upload size %u bytes exceeded, not adding the next event (ID %llu, size %u bytes)",
+                        ctx->maxUploadSize, static_cast<unsigned long long>(record.id), static_cast<unsigned>(record.blob.size()));
                     return;
                 }
                 else {
@@ -45,19 +55,30 @@ namespace MAT_NS_BEGIN {
                     ctx->latency, latencyToStr(ctx->latency));
             }
 
-            LOG_TRACE("Adding event %s:%s, size %u bytes",
-                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str(), static_cast<unsigned>(record.blob.size()));
+            LOG_TRACE("Adding event %s:%llu, size %u bytes",
+                tenantTokenToId(record.tenantToken).c_str(), static_cast<unsigned long long>(record.id), static_cast<unsigned>(record.blob.size()));
 
-            std::string const& tenantToken = m_forcedTenantToken.empty() ? record.tenantToken : m_forcedTenantToken;
-            auto it = ctx->packageIds.lower_bound(tenantToken);
-            if (it == ctx->packageIds.end() || it->first != tenantToken)
+            TenantId tenantId = TenantRegistry::GetId(record);
+            TenantId packageTenantId = (m_forcedTenantId != TenantRegistry::InvalidTenantId) ? m_forcedTenantId : tenantId;
+            auto it = ctx->packageIds.lower_bound(packageTenantId);
+            if (it == ctx->packageIds.end() || it->first != packageTenantId)
             {
-                it = ctx->packageIds.insert(it, { tenantToken, ctx->splicer->addTenantToken(tenantToken) });
+                it = ctx->packageIds.insert(it, { packageTenantId, ctx->splicer->addTenantToken(TenantRegistry::GetToken(packageTenantId)) });
             }
 
-            ctx->splicer->addRecord(it->second, record.blob);
+            if (ctx->deflater) {
+                // Records go out in arrival order instead of grouped by tenant,
+                // the collector does not depend on the grouping.
+                if (!ctx->deflater->Append(record.blob.data(), record.blob.size())) {
+                    wantMore = false;
+                    return;
+                }
+            }
+            else {
+                ctx->splicer->addRecord(it->second, record.blob);
+            }
 
-            ctx->recordIdsAndTenantIds[record.id] = record.tenantToken;
+            ctx->recordIdsAndTenantIds[record.id] = tenantId;
             ctx->recordTimestamps.push_back(record.timestamp);
             ctx->maxRetryCountSeen = std::max<int>(ctx->maxRetryCountSeen, record.retryCount);
         }
@@ -74,12 +95,41 @@ namespace MAT_NS_BEGIN {
             return;
         }
 
-        ctx->body = ctx->splicer->splice();
-        ctx->splicer->clear();
+        if (ctx->deflater) {
+            ctx->splicer->clear();
+            bool finished = ctx->deflater->Finish(ctx->body);
+            ctx->compressorBytesSaved = static_cast<unsigned>(ctx->deflater->GetReusedStateBytes());
+            DeflateContextPool::Release(std::move(ctx->deflater));
+            if (!finished) {
+                LOG_WARN("HTTP request compressing failed while packaging %u events",
+                    static_cast<unsigned>(ctx->recordIdsAndTenantIds.size()));
+                packagingFailed(ctx);
+                return;
+            }
+            ctx->compressed = true;
+        }
+        else {
+            ctx->splicer->spliceInto(ctx->body);
+        }
+        ctx->packageSize = static_cast<unsigned>(ctx->body.size());
 
         packagedEvents(ctx);
     }
 
+    void Packager::beginStreamCompression(EventsUploadContextPtr const& ctx)
+    {
+        // Only the built-in zlib codecs can be streamed into
+        if (!m_streamCompressionAllowed ||
+            !static_cast<bool>(m_config[CFG_MAP_HTTP][CFG_BOOL_HTTP_STREAM_COMPRESSION]) ||
+            !m_config.IsHttpRequestCompressionEnabled()) {
+            return;
+        }
+        std::string const encoding = (m_config.GetHttpRequestContentEncoding() == "gzip") ? "gzip" : "deflate";
+        int level = m_config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL];
+        ctx->deflater = DeflateContextPool::Acquire(StreamingDeflate::GetWindowBits(encoding), level);
+        ctx->contentEncoding = encoding;
+    }
+
 
 } MAT_NS_END
 
@@ -15,13 +15,20 @@ namespace MAT_NS_BEGIN {
     public:
         Packager(IRuntimeConfig& runtimeConfig);
 
+        /// <summary>
+        /// Streaming compression is turned off when a custom codec compresses request bodies.
+        /// </summary>
+        void SetStreamCompressionAllowed(bool allowed) { m_streamCompressionAllowed = allowed; }
+
     protected:
         void handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord const& record, bool& wantMore);
         void handleFinalizePackage(EventsUploadContextPtr const& ctx);
+        void beginStreamCompression(EventsUploadContextPtr const& ctx);
 
     protected:
         IRuntimeConfig & m_config;
-        std::string      m_forcedTenantToken;
+        TenantId         m_forcedTenantId = TenantRegistry::InvalidTenantId;
+        bool             m_streamCompressionAllowed = true;
 
     public:
         RouteSink<Packager, EventsUploadContextPtr const&, StorageRecord const&, bool&> addEventToPackage{ this, &Packager::handleAddEventToPackage };
@@ -29,6 +36,7 @@ namespace MAT_NS_BEGIN {
 
         RouteSource<EventsUploadContextPtr const&>                                      emptyPackage;
         RouteSource<EventsUploadContextPtr const&>                                      packagedEvents;
+        RouteSource<EventsUploadContextPtr const&>                                      packagingFailed;
     };
 
 
@@ -31,6 +31,7 @@
 #endif
 #include <unistd.h>
 #include <time.h>
+#include <stdio.h>
 #ifdef __linux__
 #include <sys/syscall.h>   /* For SYS_xxx definitions */
 #endif
@@ -287,10 +288,98 @@ namespace PAL_NS_BEGIN {
         return m_taskDispatcher;
     }
 
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable:6031)
+#ifndef _WIN32
+    namespace {
+
+        /// <summary>
+        /// xoshiro256** generator for UUIDs. There is one per thread, so it needs
+        /// no locking. The state is seeded through splitmix64 from /dev/urandom,
+        /// mixed with the clock, process, thread and a counter, so threads started
+        /// at the same moment still get different sequences.
+        /// </summary>
+        class UuidRandom
+        {
+        public:
+            UuidRandom()
+            {
+                static std::atomic<uint64_t> s_instances(0);
+                uint64_t entropy[4] = {};
+                FILE* urandom = fopen("/dev/urandom", "rb");
+                if (urandom != nullptr)
+                {
+                    if (fread(entropy, 1, sizeof(entropy), urandom) != sizeof(entropy))
+                    {
+                        LOG_WARN("Short read from /dev/urandom, UUID seed relies on clock and thread");
+                    }
+                    fclose(urandom);
+                }
+                uint64_t seed = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+                seed ^= static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()) * 0x9e3779b97f4a7c15ull;
+                seed ^= static_cast<uint64_t>(getpid()) << 32;
+                seed ^= static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+                seed ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this));
+                seed += s_instances.fetch_add(1) * 0xbf58476d1ce4e5b9ull;
+                for (size_t i = 0; i < 4; i++)
+                {
+                    m_state[i] = splitmix64(seed) ^ entropy[i];
+                }
+                if ((m_state[0] | m_state[1] | m_state[2] | m_state[3]) == 0)
+                {
+                    m_state[0] = 1;
+                }
+            }
+
+            uint64_t next()
+            {
+                uint64_t const result = rotl(m_state[1] * 5, 7) * 9;
+                uint64_t const t = m_state[1] << 17;
+                m_state[2] ^= m_state[0];
+                m_state[3] ^= m_state[1];
+                m_state[1] ^= m_state[2];
+                m_state[0] ^= m_state[3];
+                m_state[2] ^= t;
+                m_state[3] = rotl(m_state[3], 45);
+                return result;
+            }
+
+        private:
+            static uint64_t rotl(uint64_t x, int k)
+            {
+                return (x << k) | (x >> (64 - k));
+            }
+
+            static uint64_t splitmix64(uint64_t& x)
+            {
+                uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                return z ^ (z >> 31);
+            }
+
+            uint64_t m_state[4];
+        };
+
+        /// <summary>
+        /// Writes 128 bits as a lowercase 8-4-4-4-12 UUID string, 36 characters.
+        /// </summary>
+        void formatUuid(uint64_t hi, uint64_t lo, char* out)
+        {
+            static char const digits[] = "0123456789abcdef";
+            // Output position of each hex digit, skipping the dashes
+            static uint8_t const position[32] = {
+                0, 1, 2, 3, 4, 5, 6, 7,   9, 10, 11, 12,   14, 15, 16, 17,
+                19, 20, 21, 22,   24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35 };
+            for (int i = 0; i < 16; i++)
+            {
+                out[position[i]] = digits[(hi >> (60 - 4 * i)) & 0xf];
+                out[position[16 + i]] = digits[(lo >> (60 - 4 * i)) & 0xf];
+            }
+            out[8] = out[13] = out[18] = out[23] = '-';
+        }
+
+    }
 #endif
+
     std::string PlatformAbstractionLayer::generateUuidString() const
     {
 #ifdef _WIN32
@@ -300,33 +389,15 @@ namespace PAL_NS_BEGIN {
         UNREFERENCED_PARAMETER(hr);
         return MAT::to_string(uuid);
 #else
-        static std::once_flag flag;
-        std::call_once(flag, [](){
-            auto now = std::chrono::high_resolution_clock::now();
-            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
-            std::srand(static_cast<unsigned int>(std::time(0) ^ nanos));
-        });
-
-        GUID_t uuid;
-        uuid.Data1 = (static_cast<uint16_t>(std::rand()) << 16) | static_cast<uint16_t>(std::rand());
-        uuid.Data2 = static_cast<uint16_t>(std::rand());
-        uuid.Data3 = static_cast<uint16_t>(std::rand());
-        for (size_t i = 0; i < sizeof(uuid.Data4); i++)
-            uuid.Data4[i] = static_cast<uint8_t>(std::rand());
-
-        // TODO: [MG] - replace this sprintf by more robust GUID to string converter
-        char buf[40] = { 0 };
-        sprintf(buf,
-            "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-            uuid.Data1, uuid.Data2, uuid.Data3,
-            uuid.Data4[0], uuid.Data4[1], uuid.Data4[2], uuid.Data4[3],
-            uuid.Data4[4], uuid.Data4[5], uuid.Data4[6], uuid.Data4[7]);
-        return buf;
+        thread_local UuidRandom random;
+        // RFC 4122 version 4: version nibble is 4, variant bits are 10
+        uint64_t hi = (random.next() & 0xffffffffffff0fffull) | 0x0000000000004000ull;
+        uint64_t lo = (random.next() & 0x3fffffffffffffffull) | 0x8000000000000000ull;
+        std::string result(36, '\0');
+        formatUuid(hi, lo, &result[0]);
+        return result;
 #endif
     }
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
 
     int64_t PlatformAbstractionLayer::getUtcSystemTimeMs() const
     {
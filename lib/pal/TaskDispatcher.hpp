@@ -108,6 +108,7 @@ namespace PAL_NS_BEGIN {
         assert(obj != nullptr);
         auto bound = std::bind(std::mem_fn(func), obj, std::forward<TPassedArgs>(args)...);
         MAT::Task* task = new detail::TaskCall<decltype(bound)>(bound);
+        task->Affinity = obj;
         taskDispatcher->Queue(task);
     }
 
@@ -122,6 +123,7 @@ namespace PAL_NS_BEGIN {
     {
         auto bound = std::bind(std::mem_fn(func), obj, std::forward<TPassedArgs>(args)...);
         auto task = new detail::TaskCall<decltype(bound)>(bound, getMonotonicTimeMs() + (int64_t)delayMs);
+        task->Affinity = obj;
         taskDispatcher->Queue(task);
         return DeferredCallbackHandle(task, taskDispatcher);
     }
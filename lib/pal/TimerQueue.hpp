@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TIMER_QUEUE_HPP
+#define TIMER_QUEUE_HPP
+
+#include "ITaskDispatcher.hpp"
+#include "Version.hpp"
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace PAL_NS_BEGIN {
+
+    /// <summary>
+    /// Indexed binary min-heap of timed tasks ordered by TargetTime.
+    ///
+    /// Tasks with equal TargetTime come out in the order they were pushed.
+    /// The task pointer doubles as the cancellation handle: the heap keeps a
+    /// task-to-slot index, so Erase() is O(log n) instead of a linear scan.
+    /// Not thread-safe, callers hold the dispatcher lock.
+    /// </summary>
+    class TimerQueue
+    {
+    public:
+        bool empty() const { return m_heap.empty(); }
+
+        size_t size() const { return m_heap.size(); }
+
+        MAT::Task* front() const { return m_heap.front().task; }
+
+        void push(MAT::Task* task)
+        {
+            m_heap.push_back({ task->TargetTime, m_sequence++, task });
+            m_index[task] = m_heap.size() - 1;
+            siftUp(m_heap.size() - 1);
+        }
+
+        void pop_front()
+        {
+            removeAt(0);
+        }
+
+        /// <summary>
+        /// Remove a task that has not run yet.
+        /// </summary>
+        /// <returns>false if the task is not in the queue</returns>
+        bool erase(MAT::Task* task)
+        {
+            auto it = m_index.find(task);
+            if (it == m_index.end())
+            {
+                return false;
+            }
+            removeAt(it->second);
+            return true;
+        }
+
+        bool contains(MAT::Task* task) const
+        {
+            return m_index.find(task) != m_index.end();
+        }
+
+    protected:
+        struct Entry
+        {
+            uint64_t   targetTime;
+            uint64_t   sequence;
+            MAT::Task* task;
+
+            bool operator<(Entry const& other) const
+            {
+                return (targetTime < other.targetTime) ||
+                    ((targetTime == other.targetTime) && (sequence < other.sequence));
+            }
+        };
+
+        void removeAt(size_t pos)
+        {
+            m_index.erase(m_heap[pos].task);
+            size_t last = m_heap.size() - 1;
+            if (pos != last)
+            {
+                place(pos, m_heap[last]);
+                m_heap.pop_back();
+                // The moved entry may need to go either way
+                if (pos > 0 && m_heap[pos] < m_heap[(pos - 1) / 2])
+                {
+                    siftUp(pos);
+                }
+                else
+                {
+                    siftDown(pos);
+                }
+            }
+            else
+            {
+                m_heap.pop_back();
+            }
+        }
+
+        void place(size_t pos, Entry const& entry)
+        {
+            m_heap[pos] = entry;
+            m_index[entry.task] = pos;
+        }
+
+        void siftUp(size_t pos)
+        {
+            Entry entry = m_heap[pos];
+            while (pos > 0)
+            {
+                size_t parent = (pos - 1) / 2;
+                if (!(entry < m_heap[parent]))
+                {
+                    break;
+                }
+                place(pos, m_heap[parent]);
+                pos = parent;
+            }
+            place(pos, entry);
+        }
+
+        void siftDown(size_t pos)
+        {
+            Entry entry = m_heap[pos];
+            size_t count = m_heap.size();
+            for (;;)
+            {
+                size_t child = 2 * pos + 1;
+                if (child >= count)
+                {
+                    break;
+                }
+                if (child + 1 < count && m_heap[child + 1] < m_heap[child])
+                {
+                    child++;
+                }
+                if (!(m_heap[child] < entry))
+                {
+                    break;
+                }
+                place(pos, m_heap[child]);
+                pos = child;
+            }
+            place(pos, entry);
+        }
+
+        std::vector<Entry>                        m_heap;
+        std::unordered_map<MAT::Task*, size_t>    m_index;
+        uint64_t                                  m_sequence = 0;
+    };
+
+} PAL_NS_END
+
+#endif
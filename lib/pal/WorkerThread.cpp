@@ -4,6 +4,7 @@
 //
 // clang-format off
 #include "pal/WorkerThread.hpp"
+#include "pal/TimerQueue.hpp"
 #include "pal/PAL.hpp"
 
 #if defined(MATSDK_PAL_CPP11) || defined(MATSDK_PAL_WIN32)
@@ -32,7 +33,7 @@ namespace PAL_NS_BEGIN {
         std::timed_mutex      m_execution_mutex;
 
         std::list<MAT::Task*> m_queue;
-        std::list<MAT::Task*> m_timerQueue;
+        TimerQueue            m_timerQueue;
         Event                 m_event;
         MAT::Task*            m_itemInProgress;
         int count = 0;
@@ -80,11 +81,7 @@ namespace PAL_NS_BEGIN {
             LOG_INFO("queue item=%p", &item);
             LOCKGUARD(m_lock);
             if (item->Type == MAT::Task::TimedCall) {
-                auto it = m_timerQueue.begin();
-                while (it != m_timerQueue.end() && (*it)->TargetTime < item->TargetTime) {
-                    ++it;
-                }
-                m_timerQueue.insert(it, item);
+                m_timerQueue.push(item);
             }
             else {
                 m_queue.push_back(item);
@@ -151,13 +148,9 @@ namespace PAL_NS_BEGIN {
                 return (m_itemInProgress != item);
             }
 
-            {
-                auto it = std::find(m_timerQueue.begin(), m_timerQueue.end(), item);
-                if (it != m_timerQueue.end()) {
-                    // Still in the queue
-                    m_timerQueue.erase(it);
-                    delete item;
-                }
+            if (m_timerQueue.erase(item)) {
+                // Was still in the queue
+                delete item;
             }
 #if 0
             for (;;) {
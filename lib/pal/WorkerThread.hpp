@@ -82,6 +82,10 @@ namespace PAL_NS_BEGIN {
         std::shared_ptr<MAT::ITaskDispatcher> Create();
     }
 
+    namespace WorkerThreadPoolFactory {
+        std::shared_ptr<MAT::ITaskDispatcher> Create(size_t threadCount);
+    }
+
 } PAL_NS_END
 
 #endif
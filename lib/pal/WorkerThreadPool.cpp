@@ -0,0 +1,276 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+// clang-format off
+#include "pal/WorkerThread.hpp"
+#include "pal/TimerQueue.hpp"
+#include "pal/PAL.hpp"
+
+#if defined(MATSDK_PAL_CPP11) || defined(MATSDK_PAL_WIN32)
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/* Maximum scheduler interval for SDK is 1 hour required for clamping in case of monotonic clock drift */
+#define MAX_FUTURE_DELTA_MS (60 * 60 * 1000)
+
+namespace PAL_NS_BEGIN {
+
+    /// <summary>
+    /// Task dispatcher backed by a fixed pool of threads.
+    ///
+    /// Tasks are grouped into lanes by Task::Affinity. A lane is picked up by
+    /// at most one thread at a time, so tasks scheduled by the same component
+    /// keep the single worker thread ordering guarantees, while different
+    /// components (storage flush, HTTP response decode, upload packaging)
+    /// run in parallel. Any idle thread takes the next ready lane; a lane goes
+    /// to the back of the ready list after each task so that a busy component
+    /// cannot starve the others.
+    /// </summary>
+    class WorkerThreadPool : public ITaskDispatcher
+    {
+    protected:
+        typedef std::deque<MAT::Task*> Lane;
+
+        std::mutex                                      m_lock;
+        std::condition_variable                         m_wakeup;
+        std::condition_variable                         m_taskDone;
+
+        // A lane is present in the map while it has queued or running tasks
+        std::unordered_map<const void*, Lane>           m_lanes;
+        std::deque<const void*>                         m_ready;
+        TimerQueue                                      m_timerQueue;
+        std::unordered_map<MAT::Task*, std::thread::id> m_inProgress;
+
+        std::vector<std::thread>                        m_threads;
+        bool                                            m_shutdown;
+
+    public:
+
+        WorkerThreadPool(size_t threadCount) :
+            m_shutdown(false)
+        {
+            if (threadCount == 0)
+            {
+                threadCount = 1;
+            }
+            for (size_t i = 0; i < threadCount; i++)
+            {
+                m_threads.emplace_back(&WorkerThreadPool::threadFunc, this);
+            }
+            LOG_INFO("Started worker thread pool with %zu threads", threadCount);
+        }
+
+        ~WorkerThreadPool()
+        {
+            Join();
+        }
+
+        void Join() final
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_shutdown = true;
+            }
+            m_wakeup.notify_all();
+
+            std::thread::id this_id = std::this_thread::get_id();
+            for (auto& thread : m_threads)
+            {
+                try {
+                    if (thread.joinable() && (thread.get_id() != this_id))
+                        thread.join();
+                    else if (thread.joinable())
+                        thread.detach();
+                }
+                catch (...) {};
+            }
+            m_threads.clear();
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_lanes.empty())
+            {
+                LOG_WARN("m_lanes is not empty!");
+            }
+            if (!m_timerQueue.empty())
+            {
+                LOG_WARN("m_timerQueue is not empty!");
+            }
+        }
+
+        void Queue(MAT::Task* item) final
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (item->Type == MAT::Task::TimedCall) {
+                    m_timerQueue.push(item);
+                }
+                else {
+                    enqueueLocked(item);
+                }
+            }
+            m_wakeup.notify_one();
+        }
+
+        // Same contract as WorkerThread::Cancel: a task that is running on
+        // another thread is waited on for up to waitTime ms, a task that has
+        // not started yet is removed and deleted.
+        bool Cancel(MAT::Task* item, uint64_t waitTime) override
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            if (item == nullptr)
+            {
+                return false;
+            }
+
+            auto running = m_inProgress.find(item);
+            if (running != m_inProgress.end())
+            {
+                if (running->second == std::this_thread::get_id())
+                {
+                    // The SDK may attempt to cancel itself from within its own task.
+                    return true;
+                }
+                if (waitTime > 0)
+                {
+                    m_taskDone.wait_for(lock, std::chrono::milliseconds(waitTime), [this, item]() {
+                        return m_inProgress.find(item) == m_inProgress.end();
+                    });
+                }
+                return m_inProgress.find(item) == m_inProgress.end();
+            }
+
+            if (m_timerQueue.erase(item))
+            {
+                delete item;
+                return true;
+            }
+
+            // Timed tasks that came due wait in their lane behind earlier work.
+            // Only compare pointers here, item may already be gone.
+            for (auto lane = m_lanes.begin(); lane != m_lanes.end(); ++lane)
+            {
+                auto it = std::find(lane->second.begin(), lane->second.end(), item);
+                if (it != lane->second.end())
+                {
+                    lane->second.erase(it);
+                    delete item;
+                    // A running lane is dropped by its thread once the task is done,
+                    // an idle one has to leave the ready list here
+                    auto ready = std::find(m_ready.begin(), m_ready.end(), lane->first);
+                    if (lane->second.empty() && ready != m_ready.end())
+                    {
+                        m_ready.erase(ready);
+                        m_lanes.erase(lane);
+                    }
+                    break;
+                }
+            }
+            return true;
+        }
+
+    protected:
+
+        void enqueueLocked(MAT::Task* item)
+        {
+            auto it = m_lanes.find(item->Affinity);
+            if (it == m_lanes.end())
+            {
+                m_lanes[item->Affinity].push_back(item);
+                m_ready.push_back(item->Affinity);
+            }
+            else
+            {
+                // Lane is ready or running already and will be picked up again
+                it->second.push_back(item);
+            }
+        }
+
+        // Move timed tasks that are due into their lanes, return ms until the next one
+        unsigned promoteDueTimersLocked()
+        {
+            auto now = getMonotonicTimeMs();
+            while (!m_timerQueue.empty())
+            {
+                MAT::Task* item = m_timerQueue.front();
+                if (item->TargetTime <= now)
+                {
+                    m_timerQueue.pop_front();
+                    enqueueLocked(item);
+                    continue;
+                }
+                const auto delta = item->TargetTime - now;
+                if (delta > MAX_FUTURE_DELTA_MS)
+                {
+                    m_timerQueue.pop_front();
+                    item->TargetTime = now + MAX_FUTURE_DELTA_MS;
+                    m_timerQueue.push(item);
+                    return MAX_FUTURE_DELTA_MS;
+                }
+                return static_cast<unsigned>(delta);
+            }
+            return MAX_FUTURE_DELTA_MS;
+        }
+
+        void threadFunc()
+        {
+            LOG_INFO("Running pool thread %u", std::this_thread::get_id());
+            std::unique_lock<std::mutex> lock(m_lock);
+            for (;;)
+            {
+                unsigned nextTimerInMs = promoteDueTimersLocked();
+
+                if (!m_ready.empty())
+                {
+                    const void* key = m_ready.front();
+                    m_ready.pop_front();
+                    Lane& lane = m_lanes[key];
+                    std::unique_ptr<MAT::Task> item(lane.front());
+                    lane.pop_front();
+                    m_inProgress[item.get()] = std::this_thread::get_id();
+
+                    lock.unlock();
+                    LOG_TRACE("Execute item=%p type=%s\n", item.get(), item->TypeName.c_str());
+                    (*item)();
+                    item->Type = MAT::Task::Done;
+                    lock.lock();
+
+                    m_inProgress.erase(item.get());
+                    if (lane.empty())
+                    {
+                        m_lanes.erase(key);
+                    }
+                    else
+                    {
+                        m_ready.push_back(key);
+                        m_wakeup.notify_one();
+                    }
+                    lock.unlock();
+                    item.reset();
+                    m_taskDone.notify_all();
+                    lock.lock();
+                    continue;
+                }
+
+                if (m_shutdown)
+                {
+                    break;
+                }
+
+                m_wakeup.wait_for(lock, std::chrono::milliseconds(nextTimerInMs));
+            }
+        }
+    };
+
+    namespace WorkerThreadPoolFactory {
+        std::shared_ptr<ITaskDispatcher> Create(size_t threadCount)
+        {
+            return std::make_shared<WorkerThreadPool>(threadCount);
+        }
+    }
+
+} PAL_NS_END
+
+#endif
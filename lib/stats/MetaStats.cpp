@@ -4,6 +4,7 @@
 //
 
 #include "MetaStats.hpp"
+#include "system/TenantRegistry.hpp"
 
 #include <utils/Utils.hpp>
 
@@ -107,7 +108,7 @@ namespace MAT_NS_BEGIN {
     }
 
     template<typename T>
-    static void insertNonZero(std::map<std::string, ::CsProtocol::Value>& target, std::string const& key, T const& value)
+    static void insertNonZero(::CsProtocol::PropertyMap& target, std::string const& key, T const& value)
     {
         if (value != 0)
         {
@@ -213,7 +214,7 @@ namespace MAT_NS_BEGIN {
         record.baseType = "evt_stats";
         record.name = "evt_stats";
 
-        std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
+        ::CsProtocol::PropertyMap& ext = record.data[0].properties;
 
         // Stats tenant ID
         std::string statTenantToken = m_config.GetMetaStatsTenantToken();
@@ -260,6 +261,9 @@ namespace MAT_NS_BEGIN {
         addCountsPerHttpReturnCodeToRecordFields(record, "pkg_drop_HTTP", packageStats.dropPkgsPerHttpReturnCode);
         addCountsPerHttpReturnCodeToRecordFields(record, "pkg_retr_HTTP", packageStats.retryPkgsPerHttpReturnCode);
         insertNonZero(ext, "bytes", packageStats.totalBandwidthConsumedInBytes);
+        insertNonZero(ext, "pkg_cmp", packageStats.compressedPkgs);
+        insertNonZero(ext, "pkg_cmp_reuse", packageStats.compressorReusedPkgs);
+        insertNonZero(ext, "cmp_alloc_saved", packageStats.compressorBytesSaved);
 
         // RTT stats
         if (packageStats.successPkgsAcked > 0) {
@@ -462,6 +466,20 @@ namespace MAT_NS_BEGIN {
         }
     }
 
+    /// <summary>
+    /// Updates stats on a compressed package.
+    /// </summary>
+    /// <param name="compressorBytesSaved">zlib state bytes reused from the deflate pool, 0 if a new stream was allocated.</param>
+    void MetaStats::updateOnCompression(unsigned compressorBytesSaved)
+    {
+        // Cumulative only
+        m_telemetryStats.packageStats.compressedPkgs++;
+        if (compressorBytesSaved > 0) {
+            m_telemetryStats.packageStats.compressorReusedPkgs++;
+            m_telemetryStats.packageStats.compressorBytesSaved += compressorBytesSaved;
+        }
+    }
+
     /// <summary>
     /// Updates stats on successful package send.
     /// </summary>
@@ -471,7 +489,7 @@ namespace MAT_NS_BEGIN {
     /// <param name="durationMs">The duration ms.</param>
     /// <param name="latencyToSendMs">The latency to send ms.</param>
     /// <param name="metastatsOnly">if set to <c>true</c> [metastats only].</param>
-    void MetaStats::updateOnPackageSentSucceeded(std::map<std::string, std::string> const& recordIdsAndTenantids, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& /*latencyToSendMs*/, bool metastatsOnly)
+    void MetaStats::updateOnPackageSentSucceeded(std::map<StorageRecordId, TenantId> const& recordIdsAndTenantids, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& /*latencyToSendMs*/, bool metastatsOnly)
     {
         // Package summary stats
         PackageStats& packageStats = m_telemetryStats.packageStats;
@@ -505,9 +523,18 @@ namespace MAT_NS_BEGIN {
         // Per-tenant
         if (m_enableTenantStats)
         {
+            // Records of a package usually come from one or two tenants,
+            // look the token up once per run of the same tenant
+            TenantId lastTenantId = TenantRegistry::InvalidTenantId;
+            TelemetryStats* tenantStats = nullptr;
             for (const auto& entry : recordIdsAndTenantids)
             {
-                updatePackageSent(m_telemetryTenantStats[entry.second]);
+                if (tenantStats == nullptr || entry.second != lastTenantId)
+                {
+                    lastTenantId = entry.second;
+                    tenantStats = &m_telemetryTenantStats[TenantRegistry::GetToken(lastTenantId)];
+                }
+                updatePackageSent(*tenantStats);
             }
         }
 
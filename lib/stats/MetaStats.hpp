@@ -11,6 +11,7 @@
 
 #include "Enums.hpp"
 #include "CsProtocol_types.hpp"
+#include "IOfflineStorage.hpp"
 
 #include <memory>
 #include <algorithm>
@@ -312,6 +313,15 @@ namespace MAT_NS_BEGIN {
         /// the total size of packages
         unsigned int totalBandwidthConsumedInBytes;
 
+        /// number of compressed packages
+        unsigned int compressedPkgs;
+
+        /// number of compressed packages that reused a pooled zlib stream
+        unsigned int compressorReusedPkgs;
+
+        /// zlib state bytes not allocated thanks to pooled streams
+        unsigned int compressorBytesSaved;
+
         /// reset all members
         void Reset()
         {
@@ -326,6 +336,9 @@ namespace MAT_NS_BEGIN {
             dropPkgsPerHttpReturnCode.clear();
             retryPkgsPerHttpReturnCode.clear();
             totalBandwidthConsumedInBytes = 0;
+            compressedPkgs = 0;
+            compressorReusedPkgs = 0;
+            compressorBytesSaved = 0;
         }
 
         PackageStats()
@@ -526,7 +539,8 @@ namespace MAT_NS_BEGIN {
 
         void updateOnEventIncoming(std::string const& tenanttoken, unsigned size, EventLatency latency, bool metastats);
         void updateOnPostData(unsigned postDataLength, bool metastatsOnly);
-        void updateOnPackageSentSucceeded(std::map<std::string, std::string> const& recordIdsAndTenantids, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& latencyToSendMs, bool metastatsOnly);
+        void updateOnCompression(unsigned compressorBytesSaved);
+        void updateOnPackageSentSucceeded(std::map<StorageRecordId, TenantId> const& recordIdsAndTenantids, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& latencyToSendMs, bool metastatsOnly);
         void updateOnPackageFailed(int statusCode);
         void updateOnPackageRetry(int statusCode, unsigned retryFailedTimes);
         void updateOnRecordsDropped(EventDroppedReason reason, std::map<std::string, size_t> const& droppedCount);
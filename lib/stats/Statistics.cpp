@@ -76,7 +76,7 @@ namespace MAT_NS_BEGIN {
             result &= m_semanticContextDecorator.decorate(record, true);
             if (result)
             {
-                IncomingEventContext evt(PAL::generateUuidString(), tenantToken, EventLatency_Normal, EventPersistence_Normal, &record);
+                IncomingEventContext evt(tenantToken, EventLatency_Normal, EventPersistence_Normal, &record);
                 m_iTelemetrySystem.sendEvent(&evt);
             }
             else
@@ -158,10 +158,13 @@ namespace MAT_NS_BEGIN {
 
     bool Statistics::handleOnUploadStarted(EventsUploadContextPtr const& ctx)
     {
-        bool metastatsOnly = (ctx->packageIds.count(m_config.GetMetaStatsTenantToken()) == ctx->packageIds.size());
+        bool metastatsOnly = (ctx->packageIds.count(TenantRegistry::Find(m_config.GetMetaStatsTenantToken())) == ctx->packageIds.size());
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPostData(static_cast<unsigned>(ctx->httpRequest->GetSizeEstimate()), metastatsOnly);
+            if (ctx->compressed) {
+                m_metaStats.updateOnCompression(ctx->compressorBytesSaved);
+            }
         }
         scheduleSend();
 
@@ -190,7 +193,7 @@ namespace MAT_NS_BEGIN {
             latencyToSendMs.push_back(static_cast<unsigned>(std::max<int64_t>(0, std::min<int64_t>(0xFFFFFFFFu, now - ts))));
         }
 
-        bool metastatsOnly = (ctx->packageIds.count(m_config.GetMetaStatsTenantToken()) == ctx->packageIds.size());
+        bool metastatsOnly = (ctx->packageIds.count(TenantRegistry::Find(m_config.GetMetaStatsTenantToken())) == ctx->packageIds.size());
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPackageSentSucceeded(ctx->recordIdsAndTenantIds, ctx->latency, ctx->maxRetryCountSeen, ctx->durationMs, latencyToSendMs, metastatsOnly);
@@ -205,10 +208,15 @@ namespace MAT_NS_BEGIN {
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPackageFailed(status);
-            std::map<std::string, size_t> countOnTenant;
+            std::map<TenantId, size_t> countOnTenantId;
             for (const auto& recordAndTenant : ctx->recordIdsAndTenantIds)
             {
-                countOnTenant[recordAndTenant.second]++;
+                countOnTenantId[recordAndTenant.second]++;
+            }
+            std::map<std::string, size_t> countOnTenant;
+            for (const auto& tenantAndCount : countOnTenantId)
+            {
+                countOnTenant[TenantRegistry::GetToken(tenantAndCount.first)] = tenantAndCount.second;
             }
             m_metaStats.updateOnRecordsRejected(REJECTED_REASON_SERVER_DECLINED, countOnTenant);
         }
@@ -6,9 +6,11 @@
 #pragma once
 #include "IHttpClient.hpp"
 #include "IOfflineStorage.hpp"
+#include "compression/StreamingDeflate.hpp"
 #include "packager/ISplicer.hpp"
 #include "packager/BondSplicer.hpp"
 #include "pal/PAL.hpp"
+#include "system/TenantRegistry.hpp"
 #include "utils/Utils.hpp"
 
 #include <map>
@@ -25,18 +27,35 @@ namespace MAT_NS_BEGIN {
         StorageRecord          record;
         std::uint64_t          policyBitFlags;
 
+        // Part C properties that are not in source->data[0] yet and are
+        // written by BondSerializer straight from the EventProperties
+        EventProperties const* properties;
+
     public:
         IncomingEventContext() :
             source(nullptr),
-            policyBitFlags(0)
+            policyBitFlags(0),
+            properties(nullptr)
+        {
+        }
+
+        // record.id is assigned by ITelemetrySystem::sendEvent
+        IncomingEventContext(std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
+            : source(source),
+            record{ 0, tenantToken, latency, persistence },
+	    policyBitFlags(0),
+            properties(nullptr)
         {
+            record.tenantId = TenantRegistry::Intern(tenantToken);
         }
 
-        IncomingEventContext(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
+        IncomingEventContext(TenantId tenantId, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
             : source(source),
-            record{ id, tenantToken, latency, persistence },
-	    policyBitFlags(0)
+            record{ 0, TenantRegistry::GetToken(tenantId), latency, persistence },
+            policyBitFlags(0),
+            properties(nullptr)
         {
+            record.tenantId = tenantId;
         }
 
         virtual ~IncomingEventContext()
@@ -85,16 +104,26 @@ namespace MAT_NS_BEGIN {
 
         // Packaging
         std::unique_ptr<ISplicer>            splicer;
+        std::unique_ptr<StreamingDeflate>    deflater;
         unsigned                             maxUploadSize = 0;
         EventLatency                         latency = EventLatency_Unspecified;
-        std::map<std::string, size_t>        packageIds;
-        std::map<std::string, std::string>   recordIdsAndTenantIds;
+        std::map<TenantId, size_t>           packageIds;
+        std::map<StorageRecordId, TenantId>  recordIdsAndTenantIds;
         std::vector<int64_t>                 recordTimestamps;
         unsigned                             maxRetryCountSeen = 0;
+        // Stopped at maxUploadSize with more events waiting
+        bool                                 packageFull = false;
+        // Size the maxUploadSize limit applied to, compressed when streaming
+        unsigned                             packageSize = 0;
 
         // Encoding
         std::vector<uint8_t>                 body;
         bool                                 compressed = false;
+        std::string                          contentEncoding;
+        // zlib state bytes compression did not allocate thanks to a pooled stream
+        unsigned                             compressorBytesSaved = 0;
+        // Size of the body handed over to the HTTP request
+        unsigned                             bodySize = 0;
 
         // Sending
         IHttpRequest*                        httpRequest = nullptr;
@@ -33,11 +33,10 @@ namespace MAT_NS_BEGIN {
 
     EventProperties& EventProperties::operator+=(const std::map<std::string, EventProperty> &properties)
     {
+        m_storage->invalidateCopies();
         for (auto &kv : properties)
         {
-            auto key = kv.first;
-            auto val = kv.second;
-            m_storage->properties[key] = val;
+            m_storage->properties.insert_or_assign(kv.first, kv.second);
         }
         return (*this);
     }
@@ -49,6 +48,30 @@ namespace MAT_NS_BEGIN {
         return (*this);
     }
 
+    EventProperties::EventProperties(const std::string& name, std::map<std::string, EventProperty>&& properties) :
+        EventProperties(name)
+    {
+        (*this) += std::move(properties);
+    }
+
+    EventProperties& EventProperties::operator+=(std::map<std::string, EventProperty>&& properties)
+    {
+        m_storage->invalidateCopies();
+        for (auto &kv : properties)
+        {
+            m_storage->properties.insert_or_assign(kv.first, std::move(kv.second));
+        }
+        properties.clear();
+        return (*this);
+    }
+
+    EventProperties& EventProperties::operator=(std::map<std::string, EventProperty>&& properties)
+    {
+        m_storage->properties.clear();
+        (*this) += std::move(properties);
+        return (*this);
+    }
+
 
     EventProperties::EventProperties()
         : EventProperties(DefaultEventName)
@@ -114,15 +137,14 @@ namespace MAT_NS_BEGIN {
     /// </summary>
     EventProperties& EventProperties::operator=(std::initializer_list<std::pair<std::string const, EventProperty> > properties)
     {
+        m_storage->invalidateCopies();
         m_storage->properties.clear();
         m_storage->propertiesPartB.clear();
+        m_storage->properties.reserve(properties.size());
 
         for (auto &kv : properties)
         {
-            auto key = kv.first;
-            auto val = kv.second;
-
-            m_storage->properties[key] = val;
+            m_storage->properties.insert_or_assign(kv.first, kv.second);
         }
 
         return (*this);
@@ -310,8 +332,9 @@ namespace MAT_NS_BEGIN {
 
     std::tuple<bool, uint8_t> EventProperties::TryGetLevel() const
     {
-        const auto& findResult = GetProperties().find(COMMONFIELDS_EVENT_LEVEL);
-        if (findResult == GetProperties().cend())
+        const auto& properties = GetPropertiesFlat();
+        const auto& findResult = properties.find(COMMONFIELDS_EVENT_LEVEL);
+        if (findResult == properties.cend())
             return std::make_tuple<bool, uint8_t>(false, 0);
         
         const auto& property = findResult->second;
@@ -344,7 +367,8 @@ namespace MAT_NS_BEGIN {
             return;
         }
 
-        m_storage->properties[name] = prop;
+        m_storage->invalidateCopies();
+        m_storage->properties.insert_or_assign(name, std::move(prop));
     }
 
     //
@@ -362,6 +386,26 @@ namespace MAT_NS_BEGIN {
     void EventProperties::SetProperty(const std::string& name, std::vector<std::string>& value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
 
     const map<string, EventProperty>& EventProperties::GetProperties(DataCategory category) const
+    {
+        const auto& properties = GetPropertiesFlat(category);
+        bool partC = (category == DataCategory_PartC);
+        auto& copy = partC ? m_storage->propertiesCopy : m_storage->propertiesPartBCopy;
+        auto& stale = partC ? m_storage->propertiesCopyStale : m_storage->propertiesPartBCopyStale;
+        // Const readers may call this from several threads
+        LOCKGUARD(m_storage->propertiesCopyLock);
+        if (stale)
+        {
+            copy.clear();
+            for (const auto& kv : properties)
+            {
+                copy.emplace_hint(copy.end(), kv.first, kv.second);
+            }
+            stale = false;
+        }
+        return copy;
+    }
+
+    const FlatMap<string, EventProperty>& EventProperties::GetPropertiesFlat(DataCategory category) const
     {
         if (category == DataCategory_PartC)
         {
@@ -381,9 +425,22 @@ namespace MAT_NS_BEGIN {
         size_t result = 0;
         auto &props = (category == DataCategory_PartC) ? m_storage->properties : m_storage->propertiesPartB;
         result = props.erase(key);
+        if (result != 0)
+        {
+            m_storage->invalidateCopies();
+        }
         return result;
     }
 
+    /// <summary>
+    /// Reserve room for properties.
+    /// </summary>
+    void EventProperties::reserve(size_t count, DataCategory category)
+    {
+        auto &props = (category == DataCategory_PartC) ? m_storage->properties : m_storage->propertiesPartB;
+        props.reserve(count);
+    }
+
     /// <summary>
     /// Get Pii properties map
     /// </summary>
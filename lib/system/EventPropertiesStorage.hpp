@@ -4,10 +4,12 @@
 //
 #pragma once
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "Enums.hpp"
 #include "EventProperty.hpp"
+#include "FlatMap.hpp"
 #include "Version.hpp"
 
 #include "ctmacros.hpp"
@@ -24,8 +26,15 @@ namespace MAT_NS_BEGIN {
        uint64_t         eventPolicyBitflags = {};
        int64_t          timestampInMillis = {};
 
-       std::map<std::string, EventProperty> properties;
-       std::map<std::string, EventProperty> propertiesPartB;
+       FlatMap<std::string, EventProperty> properties;
+       FlatMap<std::string, EventProperty> propertiesPartB;
+
+       // What GetProperties() returns, rebuilt on the first call after a change
+       mutable std::map<std::string, EventProperty> propertiesCopy;
+       mutable std::map<std::string, EventProperty> propertiesPartBCopy;
+       mutable bool                                 propertiesCopyStale = true;
+       mutable bool                                 propertiesPartBCopyStale = true;
+       mutable std::mutex                           propertiesCopyLock;
 
        EventPropertiesStorage() noexcept {}
 
@@ -53,6 +62,7 @@ namespace MAT_NS_BEGIN {
           timestampInMillis = std::move(other.timestampInMillis);
           properties = std::move(other.properties);
           propertiesPartB = std::move(other.propertiesPartB);
+          other.invalidateCopies();
        }
 
        EventPropertiesStorage& operator=(const EventPropertiesStorage& other) noexcept
@@ -66,9 +76,20 @@ namespace MAT_NS_BEGIN {
           eventPopSample = other.eventPopSample;
           eventPolicyBitflags = other.eventPolicyBitflags;
           timestampInMillis = other.timestampInMillis;
+          invalidateCopies();
 
           return *this;
        }
+
+       /// <summary>
+       /// Has GetProperties() rebuild its copies, to be called whenever
+       /// properties or propertiesPartB change.
+       /// </summary>
+       void invalidateCopies() noexcept
+       {
+          propertiesCopyStale = true;
+          propertiesPartBCopyStale = true;
+       }
     };
 
 } MAT_NS_END
@@ -246,6 +246,13 @@ namespace MAT_NS_BEGIN {
             (memcmp(Data4, other.Data4, sizeof(Data4)) < 0);
     }
 
+    void EventProperty::release()
+    {
+        // Heap data now belongs to another property, forget it without freeing
+        type = TYPE_INT64;
+        as_int64 = 0;
+    }
+
     void EventProperty::copydata(EventProperty const* source)
     {
         switch (type)
@@ -325,11 +332,11 @@ namespace MAT_NS_BEGIN {
     /// EventProperty move constructor
     /// </summary>
     /// <param name="source">Right-hand side value of object</param>
-    EventProperty::EventProperty(EventProperty&& source) /* noexcept */ :
+    EventProperty::EventProperty(EventProperty&& source) noexcept :
         type(source.type)
     {
         memcpy((void*)this, (void*)&source, sizeof(EventProperty));
-        copydata(&source);
+        source.release();
     }
 
 
@@ -440,6 +447,20 @@ namespace MAT_NS_BEGIN {
         return (*this);
     }
 
+    /// <summary>
+    /// EventProperty move assignment operator
+    /// </summary>
+    EventProperty& EventProperty::operator=(EventProperty&& source) noexcept
+    {
+        if (this != &source)
+        {
+            clear();
+            memcpy((void*)this, (void*)&source, sizeof(EventProperty));
+            source.release();
+        }
+        return (*this);
+    }
+
     /// <summary>
     /// EventProperty assignment operator
     /// </summary>
@@ -47,6 +47,18 @@ namespace MAT_NS_BEGIN {
         // Core sendEvent
         virtual void sendEvent(IncomingEventContextPtr const& event) = 0;
 
+        // Batch sendEvent for events logged together
+        virtual void sendEvents(std::vector<IncomingEventContextPtr> const& events)
+        {
+            for (auto const& event : events)
+            {
+                sendEvent(event);
+            }
+        }
+
+        // True if the serializer writes IncomingEventContext::properties itself
+        virtual bool serializesEventProperties() const { return false; }
+
     protected:
         virtual void handleFlushTaskDispatcher() = 0;
         virtual void signalDone() = 0;
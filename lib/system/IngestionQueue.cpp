@@ -0,0 +1,221 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "IngestionQueue.hpp"
+
+#include <thread>
+
+namespace MAT_NS_BEGIN {
+
+    // Maximum time a producer waits for room in Block mode before spilling
+    static constexpr uint64_t kBlockTimeoutMs = 50;
+
+    IngestionQueue::IngestionQueue(IRuntimeConfig& runtimeConfig, ITaskDispatcher& taskDispatcher, DebugEventDispatcher& debugEventDispatcher) :
+        m_config(runtimeConfig),
+        m_taskDispatcher(taskDispatcher),
+        m_debugEventDispatcher(debugEventDispatcher),
+        m_backpressure(Backpressure::Spill),
+        m_batchSize(1),
+        m_drainScheduled(false),
+        m_stopped(false),
+        m_producers(0),
+        m_overflowCount(0)
+    {
+        uint32_t queueSize = m_config[CFG_MAP_INGEST][CFG_INT_INGEST_QUEUE_SIZE];
+        if (queueSize > 0)
+        {
+            m_ring.reset(new MpscRingBuffer<IncomingEventContext*>(queueSize));
+            uint32_t batchSize = m_config[CFG_MAP_INGEST][CFG_INT_INGEST_BATCH_SIZE];
+            m_batchSize = (batchSize > 0) ? batchSize : 1;
+            std::string backpressure = m_config[CFG_MAP_INGEST][CFG_STR_INGEST_BACKPRESSURE];
+            m_backpressure = ParseBackpressure(backpressure);
+            LOG_INFO("Ingestion queue enabled: capacity=%zu, batch=%zu, backpressure=%s",
+                m_ring->Capacity(), m_batchSize, backpressure.c_str());
+        }
+    }
+
+    IngestionQueue::~IngestionQueue()
+    {
+        if (m_ring)
+        {
+            {
+                LOCKGUARD(m_drainLock);
+                m_drainHandle.Cancel();
+            }
+            IncomingEventContext* item = nullptr;
+            while (m_ring->TryPop(item))
+            {
+                LOG_WARN("Discarding queued event %llu on shutdown", static_cast<unsigned long long>(item->record.id));
+                delete item;
+            }
+        }
+    }
+
+    IngestionQueue::Backpressure IngestionQueue::ParseBackpressure(std::string const& value)
+    {
+        if (value == "drop")
+        {
+            return Backpressure::Drop;
+        }
+        if (value == "block")
+        {
+            return Backpressure::Block;
+        }
+        return Backpressure::Spill;
+    }
+
+    bool IngestionQueue::Push(IncomingEventContextPtr const& event)
+    {
+        if (!m_ring)
+        {
+            return false;
+        }
+
+        // Registered before m_stopped is checked, so that Stop() either sees
+        // this push and waits for it, or this push sees Stop() and backs off
+        ++m_producers;
+        bool result = push(event);
+        --m_producers;
+        return result;
+    }
+
+    bool IngestionQueue::push(IncomingEventContextPtr const& event)
+    {
+        if (m_stopped)
+        {
+            return false;
+        }
+
+        // The caller context lives on the producer stack, so hand over a heap copy.
+        // source is already detached by the time events reach this point.
+        IncomingEventContext* item = new IncomingEventContext();
+        item->record = std::move(event->record);
+        item->policyBitFlags = event->policyBitFlags;
+
+        bool pushed = m_ring->TryPush(std::move(item));
+        if (!pushed && m_backpressure == Backpressure::Block)
+        {
+            uint64_t deadline = PAL::getMonotonicTimeMs() + kBlockTimeoutMs;
+            do
+            {
+                // Help the worker if nobody is draining right now, e.g. when
+                // the producer itself runs on the worker thread.
+                std::unique_lock<std::mutex> consumer(m_consumerLock, std::try_to_lock);
+                if (!consumer.owns_lock() || drainBatch(m_batchSize) == 0)
+                {
+                    consumer = std::unique_lock<std::mutex>();
+                    std::this_thread::yield();
+                }
+                pushed = m_ring->TryPush(std::move(item));
+            } while (!pushed && !m_stopped && PAL::getMonotonicTimeMs() < deadline);
+        }
+
+        if (!pushed)
+        {
+            event->record = std::move(item->record);
+            delete item;
+            reportOverflow(event);
+            if (m_backpressure == Backpressure::Drop)
+            {
+                // Consume the event so the caller does not store it
+                return true;
+            }
+            return false;
+        }
+
+        scheduleDrain();
+        return true;
+    }
+
+    void IngestionQueue::Stop()
+    {
+        if (!m_ring || m_stopped.exchange(true))
+        {
+            return;
+        }
+
+        while (m_producers != 0)
+        {
+            std::this_thread::yield();
+        }
+        {
+            LOCKGUARD(m_drainLock);
+            m_drainHandle.Cancel();
+        }
+        LOCKGUARD(m_consumerLock);
+        size_t count = drainBatch(m_ring->Capacity());
+        LOG_TRACE("Ingestion queue stopped, flushed %zu events", count);
+    }
+
+    void IngestionQueue::scheduleDrain()
+    {
+        if (!m_drainScheduled.exchange(true))
+        {
+            LOCKGUARD(m_drainLock);
+            if (!m_stopped)
+            {
+                // Stop() drains whatever is left itself
+                m_drainHandle = PAL::scheduleTask(&m_taskDispatcher, 0, this, &IngestionQueue::handleDrain);
+            }
+        }
+    }
+
+    void IngestionQueue::handleDrain()
+    {
+        // Clear the flag first so that a push racing with this drain schedules another one
+        m_drainScheduled = false;
+        {
+            std::unique_lock<std::mutex> consumer(m_consumerLock, std::try_to_lock);
+            if (!consumer.owns_lock())
+            {
+                // Another thread is draining and will reschedule if needed
+                return;
+            }
+            drainBatch(m_batchSize);
+        }
+
+        if (!m_ring->Empty() && !m_stopped)
+        {
+            scheduleDrain();
+        }
+    }
+
+    size_t IngestionQueue::drainBatch(size_t maxCount)
+    {
+        size_t count = 0;
+        IncomingEventContext* item = nullptr;
+        while (count < maxCount && m_ring->TryPop(item))
+        {
+            dequeued(item);
+            delete item;
+            count++;
+        }
+        return count;
+    }
+
+    void IngestionQueue::reportOverflow(IncomingEventContextPtr const& event)
+    {
+        size_t overflows = ++m_overflowCount;
+        if (overflows == 1 || (overflows % 1000) == 0)
+        {
+            LOG_WARN("Ingestion queue full (%zu overflows so far), event %llu: applying backpressure policy %u",
+                overflows, static_cast<unsigned long long>(event->record.id), static_cast<unsigned>(m_backpressure));
+        }
+
+        DebugEvent evt;
+        evt.type = DebugEventType::EVT_INGEST_OVERFLOW;
+        evt.param1 = static_cast<size_t>(m_backpressure);
+        evt.param2 = m_ring->Capacity();
+        m_debugEventDispatcher.DispatchEvent(evt);
+
+        if (m_backpressure == Backpressure::Drop)
+        {
+            DebugEvent dropped;
+            dropped.type = DebugEventType::EVT_DROPPED;
+            dropped.param1 = 1;
+            m_debugEventDispatcher.DispatchEvent(dropped);
+        }
+    }
+
+} MAT_NS_END
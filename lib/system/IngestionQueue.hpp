@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef INGESTIONQUEUE_HPP
+#define INGESTIONQUEUE_HPP
+
+#include "pal/PAL.hpp"
+
+#include "pal/TaskDispatcher.hpp"
+#include "api/IRuntimeConfig.hpp"
+#include "system/Contexts.hpp"
+#include "system/Route.hpp"
+#include "utils/MpscRingBuffer.hpp"
+
+#include <atomic>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Opt-in handoff of serialized incoming events from producer threads to
+    /// the worker thread. Producers push into a bounded lock-free ring, the
+    /// worker drains it in batches and forwards each event downstream.
+    /// </summary>
+    class IngestionQueue
+    {
+    public:
+        enum class Backpressure
+        {
+            /// Discard the event and report it as dropped
+            Drop,
+            /// Wait for the worker to make room, then fall back to Spill
+            Block,
+            /// Store the event synchronously on the calling thread
+            Spill
+        };
+
+        IngestionQueue(IRuntimeConfig& runtimeConfig, ITaskDispatcher& taskDispatcher, DebugEventDispatcher& debugEventDispatcher);
+        ~IngestionQueue();
+
+        /// <summary>
+        /// Whether the queue is configured (ingest.queueSize greater than 0)
+        /// </summary>
+        bool IsEnabled() const { return m_ring != nullptr; }
+
+        /// <summary>
+        /// Hand the event over to the worker thread. The record payload is
+        /// moved out of the caller context only when this returns true.
+        /// </summary>
+        /// <returns>false if the caller must store the event synchronously</returns>
+        bool Push(IncomingEventContextPtr const& event);
+
+        /// <summary>
+        /// Stop accepting new events and synchronously forward everything that
+        /// is still queued. Called on system stop, before storage shuts down.
+        /// </summary>
+        void Stop();
+
+        size_t Size() const { return (m_ring) ? m_ring->Size() : 0; }
+
+        Backpressure GetBackpressure() const { return m_backpressure; }
+
+        static Backpressure ParseBackpressure(std::string const& value);
+
+    protected:
+        bool push(IncomingEventContextPtr const& event);
+        void handleDrain();
+        size_t drainBatch(size_t maxCount);
+        void scheduleDrain();
+        void reportOverflow(IncomingEventContextPtr const& event);
+
+    protected:
+        IRuntimeConfig&                                         m_config;
+        ITaskDispatcher&                                        m_taskDispatcher;
+        DebugEventDispatcher&                                   m_debugEventDispatcher;
+        std::unique_ptr<MpscRingBuffer<IncomingEventContext*>>  m_ring;
+        Backpressure                                            m_backpressure;
+        size_t                                                  m_batchSize;
+        std::atomic<bool>                                       m_drainScheduled;
+        std::atomic<bool>                                       m_stopped;
+        // Pushes in progress, Stop() waits for them before its final drain
+        std::atomic<size_t>                                     m_producers;
+        std::mutex                                              m_consumerLock;
+        // Guards m_drainHandle and keeps drains from being scheduled after Stop()
+        std::mutex                                              m_drainLock;
+        PAL::DeferredCallbackHandle                             m_drainHandle;
+        std::atomic<size_t>                                     m_overflowCount;
+
+    public:
+        RouteSource<IncomingEventContextPtr const&>             dequeued;
+    };
+
+} MAT_NS_END
+
+#endif
@@ -45,7 +45,7 @@ namespace MAT_NS_BEGIN
         std::vector<::CsProtocol::Data>::const_iterator it;
         for (it = data.begin(); it != data.end(); ++it)
         {
-            std::map<std::string, CsProtocol::Value>::const_iterator mapIt;
+            ::CsProtocol::PropertyMap::const_iterator mapIt;
             for (mapIt = it->properties.begin(); mapIt != it->properties.end(); ++mapIt)
             {
                 switch (mapIt->second.type)
@@ -30,14 +30,18 @@ namespace MAT_NS_BEGIN {
         LogSessionDataProvider& logSessionDataProvider)
         :
         TelemetrySystemBase(logManager, runtimeConfig, taskDispatcher),
-        compression(runtimeConfig),
+        compression(runtimeConfig, std::static_pointer_cast<ICompressionCodec>(logManager.GetLogConfiguration().GetModule(CFG_MODULE_COMPRESSION_CODEC))),
         hcm(logManager, httpClient, taskDispatcher),
         httpEncoder(*this, httpClient),
         httpDecoder(*this),
         storage(*this, offlineStorage),
         packager(runtimeConfig),
-        tpm(*this, taskDispatcher, bandwidthController)
+        tpm(*this, taskDispatcher, bandwidthController),
+        ingestion(runtimeConfig, taskDispatcher, *this)
     {
+        packager.SetStreamCompressionAllowed(compression.IsBuiltInCodec());
+        storage.SetTenantThrottle(&tenantThrottle);
+        tpm.SetTenantThrottle(&tenantThrottle);
 
         // Handler for start
         onStart = [this, &logSessionDataProvider](void)
@@ -60,6 +64,9 @@ namespace MAT_NS_BEGIN {
             bool result = true;
             int64_t stopTimes[5] = { 0, 0, 0, 0, 0 };
 
+            // Persist events still waiting in the ingestion queue
+            ingestion.Stop();
+
             // Perform upload only if not paused
             if ((timeoutInSec > 0) && (!tpm.isPaused()))
             {
@@ -153,6 +160,7 @@ namespace MAT_NS_BEGIN {
 
         // On the inner worker thread
         this->preparedIncomingEvent >> storage.storeRecord >> stats.onIncomingEventAccepted >> tpm.eventArrived;
+        ingestion.dequeued >> storage.storeRecord >> stats.onIncomingEventAccepted >> tpm.eventArrived;
 
 
         storage.storeRecordFailed >> stats.onIncomingEventFailed;
@@ -164,6 +172,7 @@ namespace MAT_NS_BEGIN {
 
         storage.retrievalFailed >> tpm.nothingToUpload;
         packager.emptyPackage >> tpm.nothingToUpload;
+        packager.packagingFailed >> storage.releaseRecords >> stats.onPackagingFailed >> tpm.packagingFailed;
 
         packager.packagedEvents >>
 #ifdef HAVE_MAT_ZLIB
@@ -211,7 +220,45 @@ namespace MAT_NS_BEGIN {
         return false;
     }
 
-    void TelemetrySystem::handleIncomingEventPrepared(IncomingEventContextPtr const& event)
+    /// <summary>
+    /// Serializes and stores a batch of events on the calling thread, handing
+    /// all records to the offline storage at once. With an ingestion queue the
+    /// events are queued one by one as usual.
+    /// </summary>
+    void TelemetrySystem::sendEvents(std::vector<IncomingEventContextPtr> const& events)
+    {
+        if (ingestion.IsEnabled())
+        {
+            TelemetrySystemBase::sendEvents(events);
+            return;
+        }
+
+        std::vector<IncomingEventContextPtr> prepared;
+        prepared.reserve(events.size());
+        for (auto const& event : events)
+        {
+            event->record.id = ++m_nextRecordId;
+            if (!bondSerializer.serialize(event) || !isWithinBlobSizeLimit(event))
+            {
+                continue;
+            }
+            event->source = nullptr;
+            event->properties = nullptr;
+            prepared.push_back(event);
+        }
+
+        auto stored = storage.storeRecords(prepared);
+        for (size_t i = 0; i < prepared.size(); i++)
+        {
+            if (stored[i])
+            {
+                stats.onIncomingEventAccepted(prepared[i]);
+                tpm.eventArrived(prepared[i]);
+            }
+        }
+    }
+
+    bool TelemetrySystem::isWithinBlobSizeLimit(IncomingEventContextPtr const& event)
     {
         uint32_t maxBlobSize = m_config[CFG_MAP_TPM][CFG_INT_TPM_MAX_BLOB_BYTES];
         if (event->record.blob.size() > maxBlobSize)
@@ -222,13 +269,32 @@ namespace MAT_NS_BEGIN {
             m_logManager.DispatchEvent(evt);
             LOG_INFO("Event %s/%s dropped because size more than 2 MB",
                 tenantTokenToId(event->record.tenantToken).c_str(), event->source->baseType.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void TelemetrySystem::handleIncomingEventPrepared(IncomingEventContextPtr const& event)
+    {
+        if (!isWithinBlobSizeLimit(event))
+        {
             return;
         }
 
         event->source = nullptr;
+        event->properties = nullptr;
         preparedIncomingEventAsync(event);
     }
 
+    void TelemetrySystem::preparedIncomingEventAsync(IncomingEventContextPtr const& event)
+    {
+        // Without a queue, or when the queue spills, store on the calling thread
+        if (!ingestion.Push(event))
+        {
+            preparedIncomingEvent(event);
+        }
+    }
+
     void TelemetrySystem::handleFlushTaskDispatcher()
     {
         signalDone();
@@ -8,6 +8,7 @@
 #include "pal/PAL.hpp"
 
 #include "system/TelemetrySystemBase.hpp"
+#include "system/IngestionQueue.hpp"
 
 #include "bond/BondSerializer.hpp"
 
@@ -21,10 +22,12 @@
 
 #include "offline/StorageObserver.hpp"
 #include "offline/LogSessionDataProvider.hpp"
+#include "ICompressionCodec.hpp"
 #include "IOfflineStorage.hpp"
 #include "ITaskDispatcher.hpp"
 
 #include "packager/Packager.hpp"
+#include "system/TenantThrottle.hpp"
 
 #include "tpm/TransmissionPolicyManager.hpp"
 #include "ClockSkewDelta.h"
@@ -34,7 +37,8 @@ namespace MAT_NS_BEGIN {
     class NullCompression
     {
     public:
-          NullCompression(IRuntimeConfig & ) {};
+          NullCompression(IRuntimeConfig &, std::shared_ptr<ICompressionCodec> const&) {};
+          bool IsBuiltInCodec() const { return false; }
     };
 
     class TelemetrySystem : public TelemetrySystemBase
@@ -55,18 +59,24 @@ namespace MAT_NS_BEGIN {
         ~TelemetrySystem();
 
         virtual bool upload() override;
+        virtual void sendEvents(std::vector<IncomingEventContextPtr> const& events) override;
         virtual void handleIncomingEventPrepared(IncomingEventContextPtr const& event) override;
+        virtual void preparedIncomingEventAsync(IncomingEventContextPtr const& event) override;
+        virtual bool serializesEventProperties() const override { return true; }
 
     protected:
 
         virtual void handleFlushTaskDispatcher() override;
 
+        bool isWithinBlobSizeLimit(IncomingEventContextPtr const& event);
+
 #ifdef HAVE_MAT_ZLIB
         HttpDeflateCompression    compression;
 #else
         NullCompression           compression;
 #endif
 
+        TenantThrottle            tenantThrottle;
         HttpClientManager         hcm;
         HttpRequestEncoder        httpEncoder;
         HttpResponseDecoder       httpDecoder;
@@ -74,6 +84,7 @@ namespace MAT_NS_BEGIN {
         Packager                  packager;
         TransmissionPolicyManager tpm;
         ClockSkewDelta            clockSkewDelta;
+        IngestionQueue            ingestion;
 
     public:
         RouteSink<TelemetrySystem>                                 flushTaskDispatcher{ this, &TelemetrySystem::handleFlushTaskDispatcher };
@@ -34,6 +34,7 @@ namespace MAT_NS_BEGIN {
             m_config(runtimeConfig),
             m_isStarted(false),
             m_isPaused(false),
+            m_nextRecordId(0),
             stats(*this, taskDispatcher)
         {
             onStart  = []() { return true; };
@@ -136,6 +137,7 @@ namespace MAT_NS_BEGIN {
 
         void sendEvent(IncomingEventContextPtr const& event) override
         {
+            event->record.id = ++m_nextRecordId;
             sending(event);
         }
 
@@ -178,6 +180,11 @@ namespace MAT_NS_BEGIN {
         IRuntimeConfig &        m_config;
         std::atomic<bool>       m_isStarted;
         std::atomic<bool>       m_isPaused;
+
+        // Record IDs address events in the RAM queue of this instance only,
+        // persistent storage numbers the events it stores itself
+        std::atomic<StorageRecordId> m_nextRecordId;
+
         PAL::Event              m_done;
         BondSerializer          bondSerializer;
         Statistics              stats;
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "TenantRegistry.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace MAT_NS_BEGIN {
+
+    namespace {
+
+        struct Registry
+        {
+            std::mutex                                lock;
+            std::unordered_map<std::string, TenantId> ids;
+            // Indexed by ID - 1. A deque never moves its elements on push_back,
+            // so references handed out by GetToken() stay valid.
+            std::deque<std::string>                   tokens;
+        };
+
+        Registry& registry()
+        {
+            // Intentionally leaked: records may still be resolved by storage
+            // and upload code running during static destruction.
+            static Registry* instance = new Registry();
+            return *instance;
+        }
+
+    }
+
+    const TenantId TenantRegistry::InvalidTenantId;
+
+    TenantId TenantRegistry::Intern(std::string const& tenantToken)
+    {
+        if (tenantToken.empty())
+        {
+            return InvalidTenantId;
+        }
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        auto it = r.ids.find(tenantToken);
+        if (it != r.ids.end())
+        {
+            return it->second;
+        }
+        r.tokens.push_back(tenantToken);
+        TenantId id = static_cast<TenantId>(r.tokens.size());
+        r.ids.emplace(tenantToken, id);
+        return id;
+    }
+
+    TenantId TenantRegistry::Find(std::string const& tenantToken)
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        auto it = r.ids.find(tenantToken);
+        return (it != r.ids.end()) ? it->second : InvalidTenantId;
+    }
+
+    std::string const& TenantRegistry::GetToken(TenantId id)
+    {
+        static std::string const empty;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        if (id == InvalidTenantId || id > r.tokens.size())
+        {
+            return empty;
+        }
+        return r.tokens[id - 1];
+    }
+
+    size_t TenantRegistry::GetCount()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        return r.tokens.size();
+    }
+
+} MAT_NS_END
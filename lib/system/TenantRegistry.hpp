@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TENANTREGISTRY_HPP
+#define TENANTREGISTRY_HPP
+
+#include "IOfflineStorage.hpp"
+
+#include <string>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Process-wide table of tenant tokens. Every token gets a small integer
+    /// ID the first time it is seen; storage, packaging, the kill-switch and
+    /// stats key on the ID and only turn it back into the token string when
+    /// encoding the request or talking to the storage interface.
+    /// </summary>
+    /// <remarks>
+    /// Entries are never removed: the set of tenants a process logs to is
+    /// small and fixed, and IDs must stay valid for records still queued.
+    /// </remarks>
+    class TenantRegistry
+    {
+    public:
+        static const TenantId InvalidTenantId = 0;
+
+        /// <summary>
+        /// ID of the token, registering it if it is new. Empty tokens get
+        /// InvalidTenantId.
+        /// </summary>
+        static TenantId Intern(std::string const& tenantToken);
+
+        /// <summary>
+        /// ID of an already registered token, InvalidTenantId otherwise.
+        /// </summary>
+        static TenantId Find(std::string const& tenantToken);
+
+        /// <summary>
+        /// Token of a registered ID, empty for InvalidTenantId or unknown IDs.
+        /// The reference stays valid for the lifetime of the process.
+        /// </summary>
+        static std::string const& GetToken(TenantId id);
+
+        /// <summary>
+        /// record.tenantId if the record has one, the interned record.tenantToken otherwise.
+        /// </summary>
+        static TenantId GetId(StorageRecord const& record)
+        {
+            return (record.tenantId != InvalidTenantId) ? record.tenantId : Intern(record.tenantToken);
+        }
+
+        /// <summary>
+        /// Number of registered tokens.
+        /// </summary>
+        static size_t GetCount();
+    };
+
+} MAT_NS_END
+#endif
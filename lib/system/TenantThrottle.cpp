@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "TenantThrottle.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace MAT_NS_BEGIN {
+
+    constexpr int64_t TenantThrottle::MaxRetryAfterSecs;
+
+    namespace {
+        // Days since 1970-01-01 of a proleptic Gregorian date
+        int64_t daysFromCivil(int64_t y, unsigned m, unsigned d)
+        {
+            y -= (m <= 2);
+            int64_t const era = (y >= 0 ? y : y - 399) / 400;
+            unsigned const yoe = static_cast<unsigned>(y - era * 400);
+            unsigned const doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+            unsigned const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + static_cast<int64_t>(doe) - 719468;
+        }
+
+        // IMF-fixdate as in "Sun, 06 Nov 1994 08:49:37 GMT", -1 if malformed
+        int64_t parseHttpDate(std::string const& value)
+        {
+            static const char* const months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+            char month[4] = {};
+            int day = 0, year = 0, hour = 0, minute = 0, second = 0;
+            if (sscanf(value.c_str(), "%*3s, %2d %3s %4d %2d:%2d:%2d GMT", &day, month, &year, &hour, &minute, &second) != 6)
+            {
+                return -1;
+            }
+            char const* found = (strlen(month) == 3) ? strstr(months, month) : nullptr;
+            if (found == nullptr || (found - months) % 3 != 0 ||
+                day < 1 || day > 31 || year < 1970 || hour > 23 || minute > 59 || second > 60)
+            {
+                return -1;
+            }
+            unsigned m = static_cast<unsigned>((found - months) / 3 + 1);
+            return daysFromCivil(year, m, static_cast<unsigned>(day)) * 86400 + hour * 3600 + minute * 60 + second;
+        }
+    }
+
+    int64_t TenantThrottle::ParseRetryAfter(std::string const& value, int64_t utcNowSecs)
+    {
+        size_t begin = value.find_first_not_of(" \t");
+        size_t end = value.find_last_not_of(" \t");
+        if (begin == std::string::npos)
+        {
+            return 0;
+        }
+        std::string trimmed = value.substr(begin, end - begin + 1);
+
+        int64_t seconds = 0;
+        if (std::all_of(trimmed.begin(), trimmed.end(), [](char c) { return isdigit(static_cast<unsigned char>(c)) != 0; }))
+        {
+            // Digits past the cap are not worth reading, and must not overflow
+            for (char c : trimmed)
+            {
+                seconds = std::min<int64_t>(seconds * 10 + (c - '0'), MaxRetryAfterSecs);
+            }
+        }
+        else
+        {
+            int64_t date = parseHttpDate(trimmed);
+            seconds = (date < 0) ? 0 : date - utcNowSecs;
+        }
+        return std::min(std::max<int64_t>(seconds, 0), MaxRetryAfterSecs);
+    }
+
+    bool TenantThrottle::handleResponse(HttpHeaders const& headers, std::map<StorageRecordId, TenantId> const& records)
+    {
+        int64_t seconds = ParseRetryAfter(headers.get("Retry-After"), PAL::getUtcSystemTime());
+        if (seconds <= 0)
+        {
+            return false;
+        }
+        for (auto const& record : records)
+        {
+            throttle(record.second, std::chrono::seconds { seconds });
+        }
+        return true;
+    }
+
+    void TenantThrottle::throttle(TenantId tenantId, std::chrono::milliseconds duration)
+    {
+        if (tenantId == TenantRegistry::InvalidTenantId || duration.count() <= 0)
+        {
+            return;
+        }
+        uint64_t expiry = PAL::getMonotonicTimeMs() + static_cast<uint64_t>(duration.count());
+        LOCKGUARD(m_lock);
+        uint64_t& current = m_expiryTimes[tenantId];
+        current = std::max(current, expiry);
+        m_count = m_expiryTimes.size();
+    }
+
+    bool TenantThrottle::isThrottled(TenantId tenantId)
+    {
+        if (m_count == 0)
+        {
+            return false;
+        }
+        LOCKGUARD(m_lock);
+        auto it = m_expiryTimes.find(tenantId);
+        if (it == m_expiryTimes.end())
+        {
+            return false;
+        }
+        if (it->second > PAL::getMonotonicTimeMs())
+        {
+            return true;
+        }
+        m_expiryTimes.erase(it);
+        m_count = m_expiryTimes.size();
+        return false;
+    }
+
+    std::vector<TenantId> TenantThrottle::getThrottledTenants()
+    {
+        std::vector<TenantId> result;
+        if (m_count == 0)
+        {
+            return result;
+        }
+        LOCKGUARD(m_lock);
+        uint64_t now = PAL::getMonotonicTimeMs();
+        for (auto it = m_expiryTimes.begin(); it != m_expiryTimes.end();)
+        {
+            if (it->second > now)
+            {
+                result.push_back(it->first);
+                ++it;
+            }
+            else
+            {
+                it = m_expiryTimes.erase(it);
+            }
+        }
+        m_count = m_expiryTimes.size();
+        return result;
+    }
+
+    std::chrono::milliseconds TenantThrottle::getTimeToRelease()
+    {
+        if (m_count == 0)
+        {
+            return std::chrono::milliseconds { -1 };
+        }
+        LOCKGUARD(m_lock);
+        uint64_t now = PAL::getMonotonicTimeMs();
+        uint64_t first = std::numeric_limits<uint64_t>::max();
+        for (auto const& tenant : m_expiryTimes)
+        {
+            first = std::min(first, tenant.second);
+        }
+        if (first == std::numeric_limits<uint64_t>::max())
+        {
+            return std::chrono::milliseconds { -1 };
+        }
+        return std::chrono::milliseconds { static_cast<int64_t>((first > now) ? first - now : 0) };
+    }
+
+} MAT_NS_END
@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TENANTTHROTTLE_HPP
+#define TENANTTHROTTLE_HPP
+
+#include "pal/PAL.hpp"
+#include "IHttpClient.hpp"
+#include "system/TenantRegistry.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Tenants the collector asked to hold off with a Retry-After header and
+    /// until when. Retrieval leaves the events of throttled tenants in the
+    /// storage, so the remaining tenants keep uploading while one of them waits.
+    /// </summary>
+    class TenantThrottle
+    {
+    public:
+        // Longer Retry-After values are cut to this, a bogus header must not stall a tenant for good
+        static constexpr int64_t MaxRetryAfterSecs = 3600;
+
+        /// <summary>
+        /// Seconds a Retry-After value asks to wait, either delta-seconds or an
+        /// HTTP-date relative to utcNowSecs. 0 for missing or malformed values.
+        /// </summary>
+        static int64_t ParseRetryAfter(std::string const& value, int64_t utcNowSecs);
+
+        /// <summary>
+        /// Throttles the tenants of the records of a request per the Retry-After
+        /// header of its response.
+        /// </summary>
+        /// <returns>true if the response carried a usable Retry-After header</returns>
+        bool handleResponse(HttpHeaders const& headers, std::map<StorageRecordId, TenantId> const& records);
+
+        void throttle(TenantId tenantId, std::chrono::milliseconds duration);
+
+        bool isThrottled(TenantId tenantId);
+
+        /// <summary>
+        /// Tenants throttled at the moment, in ascending order.
+        /// </summary>
+        std::vector<TenantId> getThrottledTenants();
+
+        /// <summary>
+        /// Time until the first throttled tenant is released, negative if none is throttled.
+        /// </summary>
+        std::chrono::milliseconds getTimeToRelease();
+
+    protected:
+        std::mutex                   m_lock;
+        // Monotonic expiry time in ms per throttled tenant
+        std::map<TenantId, uint64_t> m_expiryTimes;
+        // Lets isThrottled skip the lock while nothing is throttled
+        std::atomic<size_t>          m_count { 0 };
+    };
+
+} MAT_NS_END
+
+#endif // TENANTTHROTTLE_HPP
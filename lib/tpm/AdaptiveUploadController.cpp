@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "AdaptiveUploadController.hpp"
+
+#include <algorithm>
+
+namespace MAT_NS_BEGIN {
+
+    constexpr unsigned AdaptiveUploadController::TargetDurationMs;
+
+    namespace {
+        // Weight of the latest upload in the moving averages
+        constexpr double SampleWeight = 0.25;
+        // Throttled share that stretches the timers all the way
+        constexpr double ThrottledRatioMax = 0.5;
+        // Throttled share below which the package size may grow again
+        constexpr double ThrottledRatioGrow = 0.05;
+
+        void addSample(double& average, double sample, bool first)
+        {
+            average = first ? sample : average + SampleWeight * (sample - average);
+        }
+    }
+
+    AdaptiveUploadController::AdaptiveUploadController(unsigned minUploadSize, unsigned maxUploadSize, unsigned maxTimerIntervalPercent) :
+        m_minUploadSize(std::min(minUploadSize, maxUploadSize)),
+        m_maxUploadSize(maxUploadSize),
+        m_maxTimerIntervalPercent(std::max(maxTimerIntervalPercent, 100u)),
+        m_uploadSize(maxUploadSize)
+    {
+    }
+
+    void AdaptiveUploadController::onUploadSucceeded(unsigned packageSize, unsigned bodySize, int durationMs, bool packageFull)
+    {
+        LOCKGUARD(m_lock);
+        bool first = (m_samples++ == 0);
+        double duration = std::max(durationMs, 1);
+        addSample(m_rttMs, duration, first);
+        addSample(m_throughputBps, bodySize * 1000.0 / duration, first);
+        if (packageSize > 0 && bodySize > 0)
+        {
+            addSample(m_compressionRatio, static_cast<double>(bodySize) / packageSize, first);
+        }
+        addSample(m_throttledRatio, 0, false);
+        updateTimerInterval();
+
+        // Package size that uploads in the target time at the measured throughput
+        double fit = m_throughputBps * TargetDurationMs / 1000 / m_compressionRatio;
+        if (m_rttMs > TargetDurationMs)
+        {
+            m_uploadSize = std::max(m_uploadSize / 2, std::min(m_uploadSize, fit));
+        }
+        else if (packageFull && m_rttMs < TargetDurationMs / 2 && m_throttledRatio < ThrottledRatioGrow)
+        {
+            // Partial packages say nothing about a larger size
+            m_uploadSize = std::min(m_uploadSize * 2, std::max(m_uploadSize, fit));
+        }
+        clampUploadSize();
+    }
+
+    void AdaptiveUploadController::onUploadThrottled()
+    {
+        LOCKGUARD(m_lock);
+        addSample(m_throttledRatio, 1, false);
+        updateTimerInterval();
+    }
+
+    void AdaptiveUploadController::onUploadFailed()
+    {
+        LOCKGUARD(m_lock);
+        m_uploadSize /= 2;
+        clampUploadSize();
+    }
+
+    unsigned AdaptiveUploadController::getUploadSize() const
+    {
+        LOCKGUARD(m_lock);
+        return static_cast<unsigned>(m_uploadSize);
+    }
+
+    std::chrono::milliseconds AdaptiveUploadController::scaleTimer(std::chrono::milliseconds timer) const
+    {
+        if (timer.count() <= 0)
+        {
+            return timer;
+        }
+        LOCKGUARD(m_lock);
+        return std::chrono::milliseconds { timer.count() * m_timerIntervalPercent / 100 };
+    }
+
+    UploadControlState AdaptiveUploadController::getState() const
+    {
+        LOCKGUARD(m_lock);
+        UploadControlState state;
+        state.uploadSizeBytes = static_cast<size_t>(m_uploadSize);
+        state.timerIntervalPercent = m_timerIntervalPercent;
+        state.rttMs = static_cast<size_t>(m_rttMs);
+        state.throughputBytesPerSec = static_cast<size_t>(m_throughputBps);
+        state.compressionPercent = static_cast<size_t>(m_compressionRatio * 100 + 0.5);
+        state.throttledPermille = static_cast<size_t>(m_throttledRatio * 1000 + 0.5);
+        return state;
+    }
+
+    void AdaptiveUploadController::updateTimerInterval()
+    {
+        double stretch = std::min(m_throttledRatio / ThrottledRatioMax, 1.0);
+        m_timerIntervalPercent = 100 + static_cast<unsigned>(stretch * (m_maxTimerIntervalPercent - 100) + 0.5);
+    }
+
+    void AdaptiveUploadController::clampUploadSize()
+    {
+        m_uploadSize = std::min(std::max(m_uploadSize, static_cast<double>(m_minUploadSize)), static_cast<double>(m_maxUploadSize));
+    }
+
+} MAT_NS_END
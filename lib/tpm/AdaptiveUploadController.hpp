@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef ADAPTIVEUPLOADCONTROLLER_HPP
+#define ADAPTIVEUPLOADCONTROLLER_HPP
+
+#include "pal/PAL.hpp"
+#include "DebugEvents.hpp"
+
+#include <chrono>
+#include <mutex>
+
+namespace MAT_NS_BEGIN {
+
+/// <summary>
+/// Feedback controller for the upload package size and the upload timer
+/// interval, driven by the outcome of completed uploads.
+/// </summary>
+/// <remarks>
+/// The package size follows the measured throughput: it is halved at most per
+/// upload while uploads take longer than TargetDuration, and doubled at most
+/// per upload while full packages take less than half of it. Network failures
+/// halve it. The timer interval is stretched with the share of uploads the
+/// server throttles with HTTP 429 or 503, growth is held back meanwhile.
+/// Starts at the maximum size, which is the fixed package size without it.
+/// </remarks>
+class AdaptiveUploadController
+{
+  public:
+    // Time a single upload is meant to take at the measured throughput
+    static constexpr unsigned TargetDurationMs = 2000;
+
+    AdaptiveUploadController(unsigned minUploadSize, unsigned maxUploadSize, unsigned maxTimerIntervalPercent);
+
+    /// <summary>
+    /// Feeds an accepted upload back.
+    /// </summary>
+    /// <param name="packageSize">Package size the size limit applied to</param>
+    /// <param name="bodySize">Bytes sent, after compression</param>
+    /// <param name="durationMs">HTTP request round trip time</param>
+    /// <param name="packageFull">Whether the size limit cut the package</param>
+    void onUploadSucceeded(unsigned packageSize, unsigned bodySize, int durationMs, bool packageFull);
+
+    /// <summary>
+    /// Feeds an upload the server answered with HTTP 429 or 503 back.
+    /// </summary>
+    void onUploadThrottled();
+
+    /// <summary>
+    /// Feeds an upload that failed to reach the server back.
+    /// </summary>
+    void onUploadFailed();
+
+    unsigned getUploadSize() const;
+
+    /// <summary>
+    /// Stretches a transmit profile timer by the current interval percentage,
+    /// negative (disabled) timers stay as they are.
+    /// </summary>
+    std::chrono::milliseconds scaleTimer(std::chrono::milliseconds timer) const;
+
+    UploadControlState getState() const;
+
+  protected:
+    void updateTimerInterval();
+    void clampUploadSize();
+
+    mutable std::mutex m_lock;
+    const unsigned     m_minUploadSize;
+    const unsigned     m_maxUploadSize;
+    const unsigned     m_maxTimerIntervalPercent;
+
+    double             m_uploadSize;
+    unsigned           m_timerIntervalPercent { 100 };
+    unsigned           m_samples { 0 };
+
+    // Exponentially weighted moving averages of the upload outcomes
+    double             m_rttMs { 0 };
+    double             m_throughputBps { 0 };
+    double             m_compressionRatio { 1 };
+    double             m_throttledRatio { 0 };
+};
+
+} MAT_NS_END
+
+#endif // ADAPTIVEUPLOADCONTROLLER_HPP
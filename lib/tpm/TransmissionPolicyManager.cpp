@@ -7,6 +7,7 @@
 #include "TransmitProfiles.hpp"
 #include "utils/Utils.hpp"
 
+#include <algorithm>
 #include <limits>
 
 namespace MAT_NS_BEGIN {
@@ -23,10 +24,16 @@ namespace MAT_NS_BEGIN {
         m_system(system),
         m_taskDispatcher(taskDispatcher),
         m_config(m_system.getConfig()),
-        m_bandwidthController(bandwidthController)
+        m_bandwidthController(bandwidthController),
+        m_adaptiveUpload(static_cast<bool>(m_config[CFG_MAP_TPM][CFG_BOOL_TPM_ADAPTIVE_UPLOAD])),
+        m_uploadController(m_config[CFG_MAP_TPM][CFG_INT_TPM_MIN_UPLOAD_BYTES], m_config.GetMaximumUploadSizeBytes(),
+            m_config[CFG_MAP_TPM][CFG_INT_TPM_MAX_TIMER_PERCENT])
     {
-        m_backoff = IBackoff::createFromConfig(m_backoffConfig);
-        assert(m_backoff);
+        for (UploadLane* lane : { &m_normalLane, &m_realTimeLane })
+        {
+            lane->backoff = IBackoff::createFromConfig(m_backoffConfig);
+            assert(lane->backoff);
+        }
         m_deviceStateHandler.Start();
     }
 
@@ -41,37 +48,49 @@ namespace MAT_NS_BEGIN {
         std::string config = m_config.GetUploadRetryBackoffConfig();
         if (config != m_backoffConfig)
         {
-            std::unique_ptr<IBackoff> backoff = IBackoff::createFromConfig(config);
-            if (!backoff)
+            if (!IBackoff::createFromConfig(config))
             {
                 LOG_WARN("The new backoff configuration is invalid, continuing to use current settings");
             }
             else
             {
-                m_backoff = std::move(backoff);
+                for (UploadLane* lane : { &m_normalLane, &m_realTimeLane })
+                {
+                    lane->backoff = IBackoff::createFromConfig(config);
+                }
                 m_backoffConfig = config;
             }
         }
     }
 
-    void TransmissionPolicyManager::resetBackoff()
+    TransmissionPolicyManager::UploadLane& TransmissionPolicyManager::getLane(EventLatency latency)
+    {
+        return (latency >= EventLatency_RealTime) ? m_realTimeLane : m_normalLane;
+    }
+
+    std::chrono::milliseconds TransmissionPolicyManager::getTimerDelay(UploadLane const& lane) const
+    {
+        return m_adaptiveUpload ? m_uploadController.scaleTimer(lane.timerDelay) : lane.timerDelay;
+    }
+
+    void TransmissionPolicyManager::resetBackoff(UploadLane& lane)
     {
         LOCKGUARD(m_backoffMutex);
-        if (m_backoff)
-            m_backoff->reset();
+        if (lane.backoff)
+            lane.backoff->reset();
     }
 
-    std::chrono::milliseconds TransmissionPolicyManager::increaseBackoff()
+    std::chrono::milliseconds TransmissionPolicyManager::increaseBackoff(UploadLane& lane)
     {
         LOCKGUARD(m_backoffMutex);
         checkBackoffConfigUpdate();
-        if (m_backoff == nullptr)
+        if (lane.backoff == nullptr)
         {
             return std::chrono::milliseconds{};
         }
 
-        std::chrono::milliseconds delay{m_backoff->getValue()};
-        m_backoff->increase();
+        std::chrono::milliseconds delay{lane.backoff->getValue()};
+        lane.backoff->increase();
         return delay;
     }
 
@@ -79,9 +98,10 @@ namespace MAT_NS_BEGIN {
     void TransmissionPolicyManager::scheduleUpload(const std::chrono::milliseconds& delay, EventLatency latency, bool force)
     {
         LOCKGUARD(m_scheduledUploadMutex);
-        if (delay.count() < 0 || m_timerdelay.count() < 0) 
+        updateTimersIfNecessary();
+        if (delay.count() < 0 || m_realTimeLane.timerDelay.count() < 0) 
         {
-            LOG_TRACE("Negative delay(%d) or m_timerdelay(%d), no upload", delay.count(), m_timerdelay.count());
+            LOG_TRACE("Negative delay(%d) or timer delay(%d), no upload", delay.count(), m_realTimeLane.timerDelay.count());
             return;
         }
         if (m_scheduledUploadAborted)
@@ -101,27 +121,30 @@ namespace MAT_NS_BEGIN {
             return;
         }
 
-        updateTimersIfNecessary();
-        if (m_timers[0] < 0) {
+        if (m_normalLane.timerDelay.count() < 0) {
             latency = std::max(latency, EventLatency_RealTime); // low priority disabled by profile
         }
+        UploadLane& lane = getLane(latency);
 
-        if ((!force)&&(m_isUploadScheduled))
+        // Zero or missing setting leaves the lanes limited by the total only
+        int laneWindow = m_config[CFG_INT_MAX_PENDING_REQ_PER_LATENCY];
+        if (laneWindow > 0 && uploadCount(lane) >= static_cast<size_t>(laneWindow))
+        {
+            LOG_TRACE("Maximum number of HTTP requests for lat=%d reached", lane.latency);
+            return;
+        }
+
+        if ((!force)&&(lane.isUploadScheduled))
         {
-            if (m_runningLatency > latency)
-            {
-                // Allow lower priority (normal) events to get thru in the next batch
-                m_runningLatency = latency;
-            }
             auto now = PAL::getMonotonicTimeMs();
-            auto delta = Abs64(m_scheduledUploadTime, now);
+            auto delta = Abs64(lane.scheduledUploadTime, now);
             if (delta <= static_cast<uint64_t>(delay.count()))
             {
                 // Don't need to cancel and reschedule if it's about to happen now anyways.
-                // m_isUploadScheduled check does not have to be strictly atomic because
+                // isUploadScheduled check does not have to be strictly atomic because
                 // the completion of upload will schedule more uploads as-needed, we only
                 // want to avoid the unnecessary wasteful rescheduling.
-                LOG_TRACE("WAIT  upload %d ms for lat=%d", delta, m_runningLatency);
+                LOG_TRACE("WAIT  upload %d ms for lat=%d", delta, lane.latency);
                 return;
             }
         }
@@ -129,34 +152,33 @@ namespace MAT_NS_BEGIN {
         // Cancel upload if already scheduled.
         if (force || delay.count() == 0)
         {
-            if (!cancelUploadTask())
+            if (!cancelUploadTask(lane))
             {
                 LOG_TRACE("Upload either hasn't been scheduled or already done.");
             }
         }
 
         // Schedule new upload
-        if (!m_isUploadScheduled.exchange(true))
+        if (!lane.isUploadScheduled.exchange(true))
         {
-            m_scheduledUploadTime = PAL::getMonotonicTimeMs() + delay.count();
-            m_runningLatency = latency;
-            LOG_TRACE("SCHED upload %d ms for lat=%d", delay.count(), m_runningLatency);
-            m_scheduledUpload = PAL::scheduleTask(&m_taskDispatcher, static_cast<unsigned>(delay.count()), this, &TransmissionPolicyManager::uploadAsync, latency);
+            lane.scheduledUploadTime = PAL::getMonotonicTimeMs() + delay.count();
+            LOG_TRACE("SCHED upload %d ms for lat=%d", delay.count(), lane.latency);
+            lane.scheduledUpload = PAL::scheduleTask(&m_taskDispatcher, static_cast<unsigned>(delay.count()), this, &TransmissionPolicyManager::uploadAsync, lane.latency);
         }
     }
 
     void TransmissionPolicyManager::uploadAsync(EventLatency latency)
     {
-        m_runningLatency = latency;
-        m_scheduledUploadTime = std::numeric_limits<uint64_t>::max();
+        UploadLane& lane = getLane(latency);
+        lane.scheduledUploadTime = std::numeric_limits<uint64_t>::max();
 
         {
             LOCKGUARD(m_scheduledUploadMutex);
-            m_isUploadScheduled = false;  // Allow to schedule another uploadAsync
+            lane.isUploadScheduled = false;  // Allow to schedule another uploadAsync
             if ((m_isPaused) || (m_scheduledUploadAborted))
             {
                 LOG_TRACE("Paused or upload aborted: cancel pending upload task.");
-                cancelUploadTask();  // If there is a pending upload task, kill it
+                cancelUploadTask(lane);  // If there is a pending upload task, kill it
                 return;
             }
         }
@@ -180,9 +202,20 @@ namespace MAT_NS_BEGIN {
 #endif
 
         auto ctx = m_system.createEventsUploadContext();
-        ctx->requestedMinLatency = m_runningLatency;
-        addUpload(ctx);
-        initiateUpload(ctx);
+        ctx->requestedMinLatency = lane.latency;
+        startUpload(ctx);
+
+        // Packaging is done by now. A full package means more events are waiting,
+        // package the next batch while this one is still in flight.
+        bool inFlight;
+        {
+            LOCKGUARD(m_activeUploads_lock);
+            inFlight = (m_activeUploads.count(ctx) != 0);
+        }
+        if (ctx->packageFull && inFlight)
+        {
+            scheduleUpload(std::chrono::milliseconds {}, lane.latency);
+        }
     }
 
     void TransmissionPolicyManager::finishUpload(EventsUploadContextPtr const& ctx, const std::chrono::milliseconds& nextUpload)
@@ -198,9 +231,27 @@ namespace MAT_NS_BEGIN {
         if (nextUpload.count() >= 0)
         {
             LOG_TRACE("Scheduling upload in %d ms", nextUpload.count());
-            EventLatency proposed = calculateNewPriority();
-            scheduleUpload(nextUpload, proposed); // reschedule uploadAsync again
+            scheduleUpload(nextUpload, getLane(ctx->requestedMinLatency).latency); // reschedule uploadAsync again
+        }
+    }
+
+    void TransmissionPolicyManager::startUpload(EventsUploadContextPtr const& ctx)
+    {
+        if (m_adaptiveUpload)
+        {
+            ctx->maxUploadSize = m_uploadController.getUploadSize();
         }
+        addUpload(ctx);
+        initiateUpload(ctx);
+    }
+
+    void TransmissionPolicyManager::reportUploadControl()
+    {
+        UploadControlState state = m_uploadController.getState();
+        LOG_TRACE("Upload control: size=%zu bytes, timers=%zu%%, rtt=%zu ms, throughput=%zu bytes/s, throttled=%zu permille",
+            state.uploadSizeBytes, state.timerIntervalPercent, state.rttMs, state.throughputBytesPerSec, state.throttledPermille);
+        DebugEvent evt(DebugEventType::EVT_UPLOAD_CONTROL, state.uploadSizeBytes, state.timerIntervalPercent, &state, sizeof(state));
+        m_system.DispatchEvent(evt);
     }
 
     bool TransmissionPolicyManager::updateTimersIfNecessary()
@@ -209,6 +260,8 @@ namespace MAT_NS_BEGIN {
         if (needsUpdate)
         {
             TransmitProfiles::getTimers(m_timers);
+            m_normalLane.timerDelay = std::chrono::milliseconds { m_timers[0] };
+            m_realTimeLane.timerDelay = std::chrono::milliseconds { m_timers[1] };
         }
         return needsUpdate;
     }
@@ -216,7 +269,8 @@ namespace MAT_NS_BEGIN {
     bool TransmissionPolicyManager::handleStart()
     {
         m_isPaused = false;
-        scheduleUpload(std::chrono::seconds{1}, calculateNewPriority());
+        // Normal lane picks up stored events of every latency
+        scheduleUpload(std::chrono::seconds{1}, EventLatency_Normal);
         return true;
     }
 
@@ -295,85 +349,95 @@ namespace MAT_NS_BEGIN {
         if (event->record.latency > EventLatency_RealTime) {
             auto ctx = m_system.createEventsUploadContext();
             ctx->requestedMinLatency = event->record.latency;
-            addUpload(ctx);
-            initiateUpload(ctx);
+            startUpload(ctx);
             return;
         }
 
-        // Schedule async upload if not scheduled yet
-        if (!m_isUploadScheduled || TransmitProfiles::isTimerUpdateRequired())
+        // Schedule async upload of the event's lane if not scheduled yet
+        UploadLane& lane = getLane(event->record.latency);
+        if (!lane.isUploadScheduled || TransmitProfiles::isTimerUpdateRequired())
         {
-            if (updateTimersIfNecessary())
             {
-                m_timerdelay = std::chrono::milliseconds { m_timers[1] };
-                forceTimerRestart = true;
+                LOCKGUARD(m_scheduledUploadMutex);
+                forceTimerRestart = updateTimersIfNecessary();
             }
-            EventLatency proposed = calculateNewPriority();
-            if (m_timerdelay.count() >= 0)
+            std::chrono::milliseconds delay = getTimerDelay(lane);
+            if (delay.count() < 0)
             {
-                scheduleUpload(m_timerdelay, proposed, forceTimerRestart);
+                // Lane disabled by profile, the event waits for the RealTime lane
+                delay = getTimerDelay(m_realTimeLane);
+            }
+            if (delay.count() >= 0)
+            {
+                scheduleUpload(delay, lane.latency, forceTimerRestart);
             }
         }
     }
 
-    // We do only Normal if too few values or timers[0] == timers[2]
-    // We do only RealTime if timers[0] < 0 (do not transmit)
-    // We alternate RealTime and Normal otherwise (timers differ)
-    EventLatency TransmissionPolicyManager::calculateNewPriority()
-    {
-        updateTimersIfNecessary();
-
-        if (m_timers[0] == m_timers[1])
-        {
-            return EventLatency_Normal;
-        }
-
-        if (m_timers[0] < 0)
-        {
-            return EventLatency_RealTime;
-        }
-
-        if (m_runningLatency == EventLatency_RealTime)
-        {
-            return EventLatency_Normal;
-        }
-
-        return EventLatency_RealTime;
-    }
-
     void TransmissionPolicyManager::handleNothingToUpload(EventsUploadContextPtr const& ctx)
     {
         LOG_TRACE("No stored events to send at the moment");
-        resetBackoff();
-        if (ctx->requestedMinLatency == EventLatency_Normal)
+        UploadLane& lane = getLane(ctx->requestedMinLatency);
+        resetBackoff(lane);
+        // Normal lane idles until the next event arrives
+        std::chrono::milliseconds nextUpload = (lane.latency == EventLatency_Normal) ? std::chrono::milliseconds{ -1 } : getTimerDelay(lane);
+        if (m_tenantThrottle)
         {
-            finishUpload(ctx, std::chrono::milliseconds{ -1 });
-        }
-        else
-        {
-            finishUpload(ctx, m_timerdelay);
+            // Events of throttled tenants may be waiting, come back for them once the first tenant is released
+            std::chrono::milliseconds release = m_tenantThrottle->getTimeToRelease();
+            if (release.count() >= 0 && (nextUpload.count() < 0 || release < nextUpload))
+            {
+                nextUpload = release;
+            }
         }
+        finishUpload(ctx, nextUpload);
     }
 
     void TransmissionPolicyManager::handlePackagingFailed(EventsUploadContextPtr const& ctx)
     {
-        finishUpload(ctx, m_timerdelay);
+        finishUpload(ctx, getTimerDelay(getLane(ctx->requestedMinLatency)));
     }
 
     void TransmissionPolicyManager::handleEventsUploadSuccessful(EventsUploadContextPtr const& ctx)
     {
-        resetBackoff();
+        if (m_adaptiveUpload)
+        {
+            m_uploadController.onUploadSucceeded(ctx->packageSize, ctx->bodySize, ctx->durationMs, ctx->packageFull);
+            reportUploadControl();
+        }
+        resetBackoff(getLane(ctx->requestedMinLatency));
         finishUpload(ctx, std::chrono::milliseconds{});
     }
 
     void TransmissionPolicyManager::handleEventsUploadRejected(EventsUploadContextPtr const& ctx)
     {
-        finishUpload(ctx, increaseBackoff());
+        finishUpload(ctx, increaseBackoff(getLane(ctx->requestedMinLatency)));
     }
 
     void TransmissionPolicyManager::handleEventsUploadFailed(EventsUploadContextPtr const& ctx)
     {
-        finishUpload(ctx, increaseBackoff());
+        if (m_adaptiveUpload)
+        {
+            if (ctx->httpResponse == nullptr)
+            {
+                m_uploadController.onUploadFailed();
+                reportUploadControl();
+            }
+            else if (ctx->httpResponse->GetStatusCode() == 429 || ctx->httpResponse->GetStatusCode() == 503)
+            {
+                m_uploadController.onUploadThrottled();
+                reportUploadControl();
+            }
+        }
+        if (m_tenantThrottle && ctx->httpResponse != nullptr &&
+            m_tenantThrottle->handleResponse(ctx->httpResponse->GetHeaders(), ctx->recordIdsAndTenantIds))
+        {
+            // Retrieval holds back the tenants of this upload, the others keep the lane's pace
+            LOG_TRACE("Retry-After throttles the tenants of ctx=%p", ctx.get());
+            finishUpload(ctx, getTimerDelay(getLane(ctx->requestedMinLatency)));
+            return;
+        }
+        finishUpload(ctx, increaseBackoff(getLane(ctx->requestedMinLatency)));
     }
 
     void TransmissionPolicyManager::handleEventsUploadAborted(EventsUploadContextPtr const& ctx)
@@ -413,14 +477,21 @@ namespace MAT_NS_BEGIN {
 
     bool TransmissionPolicyManager::cancelUploadTask()
     {
-        bool result = m_scheduledUpload.Cancel(getCancelWaitTime().count());
+        bool result = cancelUploadTask(m_normalLane);
+        result &= cancelUploadTask(m_realTimeLane);
+        return result;
+    }
+
+    bool TransmissionPolicyManager::cancelUploadTask(UploadLane& lane)
+    {
+        bool result = lane.scheduledUpload.Cancel(getCancelWaitTime().count());
 
         // TODO: There is a potential for upload tasks to not be canceled, especially if they aren't waited for.
         //       We either need a stronger guarantee here (could impact SDK performance), or a mechanism to
         //       ensure those tasks are canceled when the log manager is destroyed. Issue 388
         if (result)
         {
-            m_isUploadScheduled.exchange(false);
+            lane.isUploadScheduled.exchange(false);
         }
         return result;
     }
@@ -431,10 +502,18 @@ namespace MAT_NS_BEGIN {
         return m_activeUploads.size();
     }
 
+    size_t TransmissionPolicyManager::uploadCount(UploadLane const& lane) const noexcept
+    {
+        LOCKGUARD(m_activeUploads_lock);
+        return static_cast<size_t>(std::count_if(m_activeUploads.begin(), m_activeUploads.end(), [&lane](EventsUploadContextPtr const& ctx) {
+            return (ctx->requestedMinLatency >= EventLatency_RealTime) == (lane.latency >= EventLatency_RealTime);
+        }));
+    }
+
     bool TransmissionPolicyManager::isUploadInProgress() const noexcept
     {
         // unfinished uploads that haven't processed callbacks or pending upload task
-        return (uploadCount() > 0) || m_isUploadScheduled;
+        return (uploadCount() > 0) || m_normalLane.isUploadScheduled || m_realTimeLane.isUploadScheduled;
     }
 
     bool TransmissionPolicyManager::isPaused() const noexcept
@@ -14,16 +14,19 @@
 #include "system/Contexts.hpp"
 #include "system/Route.hpp"
 #include "system/ITelemetrySystem.hpp"
+#include "system/TenantThrottle.hpp"
 
 #include "DeviceStateHandler.hpp"
 #include "pal/TaskDispatcher.hpp"
 
 #include "TransmitProfiles.hpp"
+#include "AdaptiveUploadController.hpp"
 
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <set>
 
 namespace MAT_NS_BEGIN {
@@ -50,14 +53,48 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         virtual ~TransmissionPolicyManager();
         virtual void scheduleUpload(const std::chrono::milliseconds& delay, EventLatency latency, bool force = false);
 
+        /// <summary>
+        /// Retry-After answers throttle the tenants of the upload in the given
+        /// throttle instead of backing off the whole lane.
+        /// </summary>
+        void SetTenantThrottle(TenantThrottle* throttle) { m_tenantThrottle = throttle; }
+
     protected:
         MATSDK_LOG_DECL_COMPONENT_CLASS();
         void checkBackoffConfigUpdate();
-        void resetBackoff();
-        std::chrono::milliseconds increaseBackoff();
+
+        /// <summary>
+        /// Upload pipeline of one latency class with its own timer, window of
+        /// uploads in flight and retry backoff, so a slow or failing Normal
+        /// upload does not hold RealTime events back.
+        /// </summary>
+        struct UploadLane
+        {
+            UploadLane(EventLatency latency, std::chrono::milliseconds timerDelay) :
+                latency(latency),
+                timerDelay(timerDelay)
+            {
+            }
+
+            // Minimum latency of the events the lane uploads
+            const EventLatency               latency;
+            std::chrono::milliseconds        timerDelay;
+            std::atomic<bool>                isUploadScheduled { false };
+            uint64_t                         scheduledUploadTime { std::numeric_limits<uint64_t>::max() };
+            PAL::DeferredCallbackHandle      scheduledUpload;
+            // Guarded by m_backoffMutex
+            std::unique_ptr<IBackoff>        backoff;
+        };
+
+        UploadLane& getLane(EventLatency latency);
+        std::chrono::milliseconds getTimerDelay(UploadLane const& lane) const;
+        void resetBackoff(UploadLane& lane);
+        std::chrono::milliseconds increaseBackoff(UploadLane& lane);
 
         void uploadAsync(EventLatency priority);
         void finishUpload(EventsUploadContextPtr const& ctx, const std::chrono::milliseconds& nextUpload);
+        void startUpload(EventsUploadContextPtr const& ctx);
+        void reportUploadControl();
         bool updateTimersIfNecessary();
 
         bool handleStart();
@@ -75,8 +112,6 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         void handleEventsUploadFailed(EventsUploadContextPtr const& ctx);
         void handleEventsUploadAborted(EventsUploadContextPtr const& ctx);
 
-        EventLatency calculateNewPriority();
-
         std::mutex                       m_lock;
 
         ITelemetrySystem&                m_system;
@@ -86,16 +121,22 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
 
         std::recursive_mutex             m_backoffMutex;
         std::string                      m_backoffConfig { DefaultBackoffConfig };
-        std::unique_ptr<IBackoff>        m_backoff;
         DeviceStateHandler               m_deviceStateHandler;
 
         std::atomic<bool>                m_isPaused { true };
-        std::atomic<bool>                m_isUploadScheduled { false };
-        uint64_t                         m_scheduledUploadTime { std::numeric_limits<uint64_t>::max() };
         std::mutex                       m_scheduledUploadMutex;
-        PAL::DeferredCallbackHandle      m_scheduledUpload;
         bool                             m_scheduledUploadAborted { false };
 
+        // Normal lane uploads events of all latencies, RealTime lane only RealTime and up
+        UploadLane                       m_normalLane { EventLatency_Normal, std::chrono::seconds { 4 } };
+        UploadLane                       m_realTimeLane { EventLatency_RealTime, std::chrono::seconds { 2 } };
+
+        // Upload size and timer interval feedback, off unless CFG_BOOL_TPM_ADAPTIVE_UPLOAD
+        bool                             m_adaptiveUpload;
+        AdaptiveUploadController         m_uploadController;
+
+        TenantThrottle*                  m_tenantThrottle { nullptr };
+
         mutable std::mutex               m_activeUploads_lock;
         std::set<EventsUploadContextPtr> m_activeUploads;
         
@@ -120,9 +161,14 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         std::chrono::milliseconds getCancelWaitTime() const noexcept;
 
         /// <summary>
-        /// Cancels pending upload task.
+        /// Cancels pending upload tasks of all lanes.
         /// </summary>
         bool cancelUploadTask();
+
+        /// <summary>
+        /// Cancels the pending upload task of a lane.
+        /// </summary>
+        bool cancelUploadTask(UploadLane& lane);
         
         /// <summary>
         /// Calculate the number of pending upload contexts.
@@ -130,8 +176,11 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
         /// <returns></returns>
         size_t uploadCount() const noexcept;
 
-        std::chrono::milliseconds        m_timerdelay { std::chrono::seconds { 2 } };
-        EventLatency                     m_runningLatency { EventLatency_RealTime };
+        /// <summary>
+        /// Calculate the number of pending upload contexts of a lane.
+        /// </summary>
+        size_t uploadCount(UploadLane const& lane) const noexcept;
+
         TimerArray                       m_timers;
 
     public:
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef MPSCRINGBUFFER_HPP
+#define MPSCRINGBUFFER_HPP
+
+#include "Version.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace MAT_NS_BEGIN
+{
+    /// <summary>
+    /// Bounded lock-free multi-producer / single-consumer ring buffer.
+    ///
+    /// Every cell carries a sequence number that tells producers and the
+    /// consumer whose turn it is to use the cell, so producers only contend
+    /// on a single compare-and-swap of the enqueue position. Capacity is
+    /// rounded up to the next power of two. Only one thread at a time may
+    /// call TryPop().
+    /// </summary>
+    template <typename T>
+    class MpscRingBuffer
+    {
+       public:
+        explicit MpscRingBuffer(size_t capacity) :
+            m_capacity(roundUpToPowerOfTwo(capacity)),
+            m_mask(m_capacity - 1),
+            m_cells(new Cell[m_capacity]),
+            m_enqueuePos(0),
+            m_dequeuePos(0)
+        {
+            for (size_t i = 0; i < m_capacity; i++)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscRingBuffer(const MpscRingBuffer&) = delete;
+        MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+        /// <summary>
+        /// Try to append an item. Safe to call from any number of threads.
+        /// </summary>
+        /// <returns>false if the ring is full</returns>
+        bool TryPush(T&& item)
+        {
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell& cell = m_cells[pos & m_mask];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.data = std::move(item);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // Consumer has not released this cell yet
+                    return false;
+                }
+                else
+                {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Try to remove the oldest item. Single consumer only.
+        /// </summary>
+        /// <returns>false if the ring is empty</returns>
+        bool TryPop(T& item)
+        {
+            size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            Cell& cell = m_cells[pos & m_mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0)
+            {
+                return false;
+            }
+            item = std::move(cell.data);
+            cell.sequence.store(pos + m_capacity, std::memory_order_release);
+            m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /// <summary>
+        /// Approximate number of items in the ring.
+        /// </summary>
+        size_t Size() const
+        {
+            size_t head = m_dequeuePos.load(std::memory_order_relaxed);
+            size_t tail = m_enqueuePos.load(std::memory_order_relaxed);
+            return (tail > head) ? (tail - head) : 0;
+        }
+
+        bool Empty() const
+        {
+            return Size() == 0;
+        }
+
+        size_t Capacity() const
+        {
+            return m_capacity;
+        }
+
+       private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        static size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 2;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        const size_t m_capacity;
+        const size_t m_mask;
+        std::unique_ptr<Cell[]> m_cells;
+
+        // Keep producer and consumer positions on separate cache lines
+        char m_pad0[64];
+        std::atomic<size_t> m_enqueuePos;
+        char m_pad1[64];
+        std::atomic<size_t> m_dequeuePos;
+        char m_pad2[64];
+    };
+
+}
+MAT_NS_END
+
+#endif
@@ -166,6 +166,8 @@ class HttpServer : private Reactor::Callback
         SocketAddr caddr;
         if (socket.accept(csocket, caddr)) {
             csocket.setNonBlocking();
+            // Headers and body go out in separate sends, don't let Nagle hold the body back on kept-alive connections
+            csocket.setNoDelay();
             Connection& conn = m_connections[csocket];
             conn.socket = csocket;
             conn.state = Connection::Idle;
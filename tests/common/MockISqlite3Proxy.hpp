@@ -48,6 +48,7 @@ class MockISqlite3Proxy : public MAT::ISqlite3Proxy {
     MOCK_METHOD1(sqlite3_reset, int(sqlite3_stmt * stmt));
     MOCK_METHOD1(sqlite3_result_null, void(sqlite3_context * ctx));
     MOCK_METHOD4(sqlite3_result_text, void(sqlite3_context * ctx, char const* value, int size, void (* d)(void*)));
+    MOCK_METHOD2(sqlite3_result_int64, void(sqlite3_context * ctx, int64_t value));
     MOCK_METHOD4(sqlite3_set_auxdata, void(sqlite3_context * ctx, int N, void* data, void (* d)(void*)));
     MOCK_METHOD0(sqlite3_shutdown, int());
     MOCK_METHOD1(sqlite3_step, int(sqlite3_stmt * stmt));
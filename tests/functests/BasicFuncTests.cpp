@@ -350,7 +350,7 @@ public:
         {
             if (prop.second.piiKind == PiiKind_None)
             {
-                std::map<std::string, CsProtocol::Value>::const_iterator iter = actual.data[0].properties.find(prop.first);
+                ::CsProtocol::PropertyMap::const_iterator iter = actual.data[0].properties.find(prop.first);
                 if (iter != actual.data[0].properties.end())
                 {
                     CsProtocol::Value temp = iter->second;
@@ -584,6 +584,32 @@ TEST_F(BasicFuncTests, sendNoPriorityEvents)
 
 }
 
+TEST_F(BasicFuncTests, sendEventsAsBatch)
+{
+    CleanStorage();
+    Initialize();
+
+    std::vector<EventProperties> events;
+    EventProperties event("first_event");
+    event.SetProperty("property", "value");
+    events.push_back(event);
+    EventProperties event2("second_event");
+    event2.SetProperty("property", "value2");
+    event2.SetProperty("property2", "another value");
+    event2.SetProperty("pii_property", "pii_value", PiiKind_Identity);
+    events.push_back(event2);
+    logger->LogEvents(events);
+
+    LogManager::UploadNow();
+    waitForEvents(1, 3);
+    for (const auto &evt : events)
+    {
+        verifyEvent(evt, find(evt.GetName()));
+    }
+
+    FlushAndTeardown();
+}
+
 TEST_F(BasicFuncTests, sendSamePriorityNormalEvents)
 {
     CleanStorage();
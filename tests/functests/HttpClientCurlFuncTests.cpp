@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+
+#include "common/Common.hpp"
+#include "common/HttpServer.hpp"
+#include "http/HttpClientFactory.hpp"
+
+#ifdef HAVE_MAT_CURL_HTTP_CLIENT
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+
+using namespace testing;
+using namespace MAT;
+
+class HttpClientCurlFuncTests : public ::testing::Test,
+                                public HttpServer::Callback,
+                                public IHttpResponseCallback
+{
+  protected:
+    HttpServer                           _server;
+    std::string                          _hostname;
+    std::vector<IHttpRequest*>           _requests;
+    std::vector<SimpleHttpResponse*>     _responses;
+    std::vector<std::string>             _clients;
+    std::mutex                           _lock;
+    std::condition_variable              _responded;
+
+  public:
+    virtual void SetUp() override
+    {
+        int port = _server.addListeningPort(0);
+        _hostname = "localhost:" + std::to_string(port);
+        _server.setServerName(_hostname);
+        _server.addHandler("/upload/", *this);
+        _server.addHandler("/slow/", *this);
+        _server.start();
+    }
+
+    virtual void TearDown() override
+    {
+        _server.stop();
+        Clear();
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        for (auto response : _responses)
+            delete response;
+        for (auto request : _requests)
+            delete request;
+        _responses.clear();
+        _requests.clear();
+        _clients.clear();
+    }
+
+    virtual int onHttpRequest(HttpServer::Request const& request, HttpServer::Response& response) override
+    {
+        if (request.uri == "/slow/") {
+            // Answers long after the client cancelled
+            PAL::sleep(1000);
+        }
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _clients.push_back(request.client);
+        }
+        response.headers["Content-Type"] = "text/plain";
+        response.content = "OK";
+        return 200;
+    }
+
+    virtual void OnHttpResponse(IHttpResponse* response) override
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _responses.push_back(static_cast<SimpleHttpResponse*>(response));
+        _responded.notify_all();
+    }
+
+    void Send(IHttpClient& client, std::string const& path, std::vector<uint8_t> const& body = {})
+    {
+        IHttpRequest* request = client.CreateRequest();
+        request->SetMethod("POST");
+        request->GetHeaders().set("Content-Type", "application/bond-compact-binary");
+        request->SetUrl("http://" + _hostname + path);
+        std::vector<uint8_t> content(body);
+        request->SetBody(content);
+        {
+            // Requests are deleted in Clear(), the single-handle client may use them until then
+            std::lock_guard<std::mutex> lock(_lock);
+            _requests.push_back(request);
+        }
+        client.SendRequestAsync(request, this);
+    }
+
+    bool WaitForResponses(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        return _responded.wait_for(lock, std::chrono::seconds(20), [this, count]() { return _responses.size() >= count; });
+    }
+
+    /**
+     * Uploads count requests with at most inFlight of them outstanding and
+     * returns the time it took in microseconds.
+     */
+    long long Upload(IHttpClient& client, size_t count, size_t inFlight)
+    {
+        std::vector<uint8_t> body(16 * 1024, 0x5A);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            if (i >= inFlight) {
+                EXPECT_TRUE(WaitForResponses(i + 1 - inFlight));
+            }
+            Send(client, "/upload/", body);
+        }
+        EXPECT_TRUE(WaitForResponses(count));
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+TEST_F(HttpClientCurlFuncTests, MultiHandle_PostsAndReceivesResponse)
+{
+    HttpClient_Curl client(true);
+    std::vector<uint8_t> body { 1, 2, 3 };
+    Send(client, "/upload/", body);
+    ASSERT_TRUE(WaitForResponses(1));
+
+    SimpleHttpResponse* response = _responses[0];
+    EXPECT_THAT(response->GetId(), _requests[0]->GetId());
+    EXPECT_THAT(response->GetResult(), HttpResult_OK);
+    EXPECT_THAT(response->GetStatusCode(), 200u);
+    EXPECT_THAT(response->GetHeaders().get("Content-Type"), Eq("text/plain"));
+    EXPECT_THAT(std::string(response->GetBody().begin(), response->GetBody().end()), Eq("OK"));
+}
+
+TEST_F(HttpClientCurlFuncTests, MultiHandle_ReportsConnectionError)
+{
+    HttpClient_Curl client(true);
+    IHttpRequest* request = client.CreateRequest();
+    request->SetUrl("http://localhost:4/");
+    _requests.push_back(request);
+    client.SendRequestAsync(request, this);
+    ASSERT_TRUE(WaitForResponses(1));
+    EXPECT_THAT(_responses[0]->GetResult(), HttpResult_NetworkFailure);
+}
+
+TEST_F(HttpClientCurlFuncTests, MultiHandle_CancelsRequest)
+{
+    HttpClient_Curl client(true);
+    Send(client, "/slow/");
+    PAL::sleep(100);
+    client.CancelRequestAsync(_requests[0]->GetId());
+    ASSERT_TRUE(WaitForResponses(1));
+    EXPECT_THAT(_responses[0]->GetId(), _requests[0]->GetId());
+    EXPECT_THAT(_responses[0]->GetResult(), HttpResult_Aborted);
+}
+
+TEST_F(HttpClientCurlFuncTests, MultiHandle_IgnoresRequestWithIdAlreadyInFlight)
+{
+    HttpClient_Curl client(true);
+    Send(client, "/slow/");
+    client.SendRequestAsync(_requests[0], this);
+    ASSERT_TRUE(WaitForResponses(1));
+    // Only the request in flight answers, the duplicate gets no response under its ID
+    PAL::sleep(200);
+    ASSERT_THAT(_responses, SizeIs(1));
+    EXPECT_THAT(_responses[0]->GetId(), _requests[0]->GetId());
+    EXPECT_THAT(_responses[0]->GetResult(), HttpResult_OK);
+    EXPECT_THAT(_clients, SizeIs(1));
+}
+
+TEST_F(HttpClientCurlFuncTests, MultiHandle_ReusesConnectionForConsecutiveRequests)
+{
+    HttpClient_Curl client(true);
+    const size_t count = 10;
+    for (size_t i = 0; i < count; i++) {
+        Send(client, "/upload/");
+        ASSERT_TRUE(WaitForResponses(i + 1));
+    }
+
+    // Every request arrived from the same client socket
+    ASSERT_THAT(_clients, SizeIs(count));
+    EXPECT_THAT(static_cast<size_t>(std::count(_clients.begin(), _clients.end(), _clients[0])), count);
+}
+
+TEST_F(HttpClientCurlFuncTests, MultiHandle_SurvivesManyConcurrentRequests)
+{
+    HttpClient_Curl client(true);
+    const size_t count = 100;
+    for (size_t i = 0; i < count; i++) {
+        Send(client, "/upload/");
+    }
+    ASSERT_TRUE(WaitForResponses(count));
+    for (auto response : _responses) {
+        EXPECT_THAT(response->GetResult(), HttpResult_OK);
+        EXPECT_THAT(response->GetStatusCode(), 200u);
+    }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST_F(HttpClientCurlFuncTests, DISABLED_BenchmarkMultiHandleAgainstHandlePerRequest)
+{
+    // 16 KiB uploads to the local HttpServer, one at a time as the SDK
+    // usually sends them, and with several in flight
+    const size_t count = 200;
+    for (size_t inFlight : { 1, 4 }) {
+        long long elapsedUs[2];
+        for (bool multiHandle : { false, true }) {
+            HttpClient_Curl client(multiHandle);
+            elapsedUs[multiHandle] = Upload(client, count, inFlight);
+            for (auto response : _responses) {
+                EXPECT_THAT(response->GetResult(), HttpResult_OK);
+            }
+            Clear();
+        }
+        std::string name = "InFlight" + std::to_string(inFlight);
+        RecordProperty(name + "HandlePerRequestUs", std::to_string(elapsedUs[0]));
+        RecordProperty(name + "MultiHandleUs", std::to_string(elapsedUs[1]));
+    }
+}
+
+#endif // HAVE_MAT_CURL_HTTP_CLIENT
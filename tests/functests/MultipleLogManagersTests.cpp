@@ -191,6 +191,7 @@ class MockLogger : public NullLogger
 {
    public:
     std::function<void(const EventProperties& properties)> m_logEventOverride;
+    using ILogger::LogEvent;
     virtual void LogEvent(EventProperties const& properties) override
     {
         if (m_logEventOverride)
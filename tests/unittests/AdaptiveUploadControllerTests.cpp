@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "tpm/AdaptiveUploadController.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    const unsigned MinSize = 64 * 1024;
+    const unsigned MaxSize = 2 * 1024 * 1024;
+
+    // Feeds uploads of a full package at the given link speed in bytes per second
+    void uploadAt(AdaptiveUploadController& controller, unsigned bytesPerSec, int count, bool full = true)
+    {
+        for (int i = 0; i < count; i++) {
+            unsigned size = controller.getUploadSize();
+            unsigned body = size / 4;
+            controller.onUploadSucceeded(size, body, static_cast<int>(50 + 1000ull * body / bytesPerSec), full);
+        }
+    }
+
+} // namespace
+
+TEST(AdaptiveUploadControllerTests, StartsAtMaximumSizeAndProfileTimers)
+{
+    AdaptiveUploadController controller(MinSize, MaxSize, 400);
+    EXPECT_THAT(controller.getUploadSize(), MaxSize);
+    EXPECT_THAT(controller.scaleTimer(std::chrono::milliseconds { 2000 }).count(), 2000);
+
+    UploadControlState state = controller.getState();
+    EXPECT_THAT(state.uploadSizeBytes, MaxSize);
+    EXPECT_THAT(state.timerIntervalPercent, 100u);
+    EXPECT_THAT(state.throttledPermille, 0u);
+}
+
+TEST(AdaptiveUploadControllerTests, SlowLinkShrinksUploadsToTargetDuration)
+{
+    AdaptiveUploadController controller(MinSize, MaxSize, 400);
+    // 64 KiB/s of compressed bytes at 4:1 compression fit 512 KiB packages in 2 s
+    uploadAt(controller, 64 * 1024, 20);
+    EXPECT_THAT(controller.getUploadSize(), AllOf(Ge(400u * 1024), Le(512u * 1024)));
+
+    UploadControlState state = controller.getState();
+    EXPECT_THAT(state.compressionPercent, 25u);
+    EXPECT_THAT(state.throughputBytesPerSec, AllOf(Ge(50u * 1024), Le(64u * 1024)));
+    EXPECT_THAT(state.rttMs, AllOf(Ge(1500u), Le(2100u)));
+}
+
+TEST(AdaptiveUploadControllerTests, ShrinksAtMostByHalfPerUpload)
+{
+    AdaptiveUploadController controller(MinSize, MaxSize, 400);
+    controller.onUploadSucceeded(MaxSize, MaxSize, 60000, true);
+    EXPECT_THAT(controller.getUploadSize(), MaxSize / 2);
+}
+
+TEST(AdaptiveUploadControllerTests, StaysWithinMinimumSize)
+{
+    AdaptiveUploadController controller(MinSize, MaxSize, 400);
+    uploadAt(controller, 1024, 20);
+    EXPECT_THAT(controller.getUploadSize(), MinSize);
+    for (int i = 0; i < 10; i++) {
+        controller.onUploadFailed();
+    }
+    EXPECT_THAT(controller.getUploadSize(), MinSize);
+}
+
+TEST(AdaptiveUploadControllerTests, FastFullUploadsGrowBackToMaximum)
+{
+    AdaptiveUploadController controller(MinSize, MaxSize, 400);
+    for (int i = 0; i < 5; i++) {
+        controller.onUploadFailed();
+    }
+    ASSERT_THAT(controller.getUploadSize(), MinSize);
+
+    uploadAt(controller, 10 * 1024 * 1024, 1);
+    EXPECT_THAT(controller.getUploadSize(), 2 * MinSize);
+    uploadAt(controller, 10 * 1024 * 1024, 10);
+    EXPECT_THAT(controller.getUploadSize(), MaxSize);
+}
+
+TEST(AdaptiveUploadControllerTests, PartialPackagesDoNotGrow)
+{
+    AdaptiveUploadController controller(MinSize, MaxSize, 400);
+    controller.onUploadFailed();
+    uploadAt(controller, 10 * 1024 * 1024, 10, false);
+    EXPECT_THAT(controller.getUploadSize(), MaxSize / 2);
+}
+
+TEST(AdaptiveUploadControllerTests, ThrottlingStretchesTimersAndHoldsGrowth)
+{
+    AdaptiveUploadController controller(MinSize, MaxSize, 400);
+    controller.onUploadFailed();
+
+    controller.onUploadThrottled();
+    unsigned percent = static_cast<unsigned>(controller.getState().timerIntervalPercent);
+    EXPECT_THAT(percent, AllOf(Gt(100u), Lt(400u)));
+    controller.onUploadThrottled();
+    controller.onUploadThrottled();
+    EXPECT_THAT(controller.getState().timerIntervalPercent, 400u);
+    EXPECT_THAT(controller.getState().throttledPermille, AllOf(Gt(500u), Lt(600u)));
+    EXPECT_THAT(controller.scaleTimer(std::chrono::milliseconds { 2000 }).count(), 8000);
+
+    // Disabled timers stay disabled
+    EXPECT_THAT(controller.scaleTimer(std::chrono::milliseconds { -1 }).count(), -1);
+    EXPECT_THAT(controller.scaleTimer(std::chrono::milliseconds { 0 }).count(), 0);
+
+    // Successful uploads relax the timers again, but the size only grows
+    // once the server has stopped throttling for a while
+    uploadAt(controller, 10 * 1024 * 1024, 1);
+    EXPECT_THAT(controller.getUploadSize(), MaxSize / 2);
+    uploadAt(controller, 20 * 1024 * 1024, 30);
+    EXPECT_THAT(controller.getState().timerIntervalPercent, 100u);
+    EXPECT_THAT(controller.getUploadSize(), MaxSize);
+}
+
+TEST(AdaptiveUploadControllerTests, MinimumAboveMaximumPinsMaximum)
+{
+    AdaptiveUploadController controller(MaxSize, MinSize, 50);
+    controller.onUploadFailed();
+    EXPECT_THAT(controller.getUploadSize(), MinSize);
+    controller.onUploadThrottled();
+    EXPECT_THAT(controller.getState().timerIntervalPercent, 100u);
+}
@@ -0,0 +1,351 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "api/LogManagerImpl.hpp"
+#include "bond/BondSerializer.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+#include "decorators/EventPropertiesDecorator.hpp"
+
+#include <chrono>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    class TestBondSerializer : public BondSerializer
+    {
+      public:
+        using BondSerializer::handleSerialize;
+    };
+
+    class LogEventListener : public DebugEventListener
+    {
+      public:
+        void OnDebugEvent(DebugEvent&) override {}
+    };
+
+    /// Same properties as BondDecoderTests, plus arrays and values that are omitted on the wire
+    EventProperties makeProperties()
+    {
+        EventProperties props("Streamer.Detailed",
+            {
+                { "strKey",  "hello" },
+                { "int64Key", int64_t { 1 } },
+                { "dblKey",   3.14 },
+                { "boolKey",  false },
+                { "guidKey0", GUID_t("00000000-0000-0000-0000-000000000000") },
+                { "guidKey1", GUID_t("00010203-0405-0607-0809-0A0B0C0D0E0F") },
+                { "timeKey1",  time_ticks_t((uint64_t)0) },
+                { "piiKind.None",               EventProperty("field_value",  PiiKind_None) },
+                { "piiKind.DistinguishedName",  EventProperty("/CN=Jack Frost,OU=ARIA,DC=REDMOND,DC=COM",  PiiKind_DistinguishedName) },
+                { "piiKind.GenericData",        EventProperty("generic_data",  PiiKind_GenericData) },
+                { "piiKind.IPv4Address",        EventProperty("127.0.0.1", PiiKind_IPv4Address) },
+                { "piiKind.IPv6Address",        EventProperty("2001:0db8:85a3:0000:0000:8a2e:0370:7334", PiiKind_IPv6Address) },
+                { "piiKind.MailSubject",        EventProperty("RE: test",  PiiKind_MailSubject) },
+                { "piiKind.PhoneNumber",        EventProperty("+1-425-829-5875", PiiKind_PhoneNumber) },
+                { "piiKind.QueryString",        EventProperty("a=1&b=2&c=3", PiiKind_QueryString) },
+                { "piiKind.SipAddress",         EventProperty("sip:info@microsoft.com", PiiKind_SipAddress) },
+                { "piiKind.SmtpAddress",        EventProperty("Jack Frost <jackfrost@fabrikam.com>", PiiKind_SmtpAddress) },
+                { "piiKind.Identity",           EventProperty("Jack Frost", PiiKind_Identity) },
+                { "piiKind.Uri",                EventProperty("http://www.microsoft.com", PiiKind_Uri) },
+                { "piiKind.Fqdn",               EventProperty("www.microsoft.com", PiiKind_Fqdn) },
+                { "piiKind.Int",                EventProperty(int64_t { 42 }, PiiKind_Identity) },
+                { "customerContent",            EventProperty("content", CustomerContentKind_GenericData) },
+                { "emptyStr",  "" },
+                { "zeroInt",   int64_t { 0 } },
+                { "zeroDbl",   0.0 },
+                { "trueKey",   true },
+                { "timeKey2",  time_ticks_t((uint64_t)637000000000000000) },
+                { "shared",    "fromEvent" }
+            });
+        std::vector<int64_t> longs{ 1, -2, 300000000000 };
+        std::vector<double> doubles{ 0.5, -1.25 };
+        std::vector<std::string> strings{ "a", "", "ccc" };
+        std::vector<GUID_t> guids{ GUID_t("00010203-0405-0607-0809-0A0B0C0D0E0F"), GUID_t() };
+        std::vector<int64_t> empty;
+        props.SetProperty("int64Array", longs);
+        props.SetProperty("dblArray", doubles);
+        props.SetProperty("strArray", strings);
+        props.SetProperty("guidArray", guids);
+        props.SetProperty("emptyArray", empty);
+        return props;
+    }
+
+}
+
+class BondSerializerTests : public Test
+{
+  protected:
+    ILogConfiguration          configuration;
+    LogManagerImpl             logManager;
+    EventPropertiesDecorator   decorator;
+    ContextFieldsProvider      context;
+    TestBondSerializer         serializer;
+
+    BondSerializerTests() :
+        logManager(configuration),
+        decorator(logManager),
+        context(nullptr)
+    {
+        context.SetAppId("appId");
+        context.SetCustomField("contextOnly", "fromContext");
+        context.SetCustomField("shared", int64_t { 7 });
+        context.SetCustomField("zzz", EventProperty("last", PiiKind_Identity));
+    }
+
+    std::vector<uint8_t> serialize(EventProperties const& props, bool direct, ::CsProtocol::Record& record)
+    {
+        record.name = props.GetName();
+        context.writeToRecord(record);
+        EventLatency latency = EventLatency_Normal;
+        EXPECT_TRUE(decorator.decorate(record, latency, props, direct));
+
+        IncomingEventContext event("token", latency, EventPersistence_Normal, &record);
+        if (direct)
+        {
+            event.properties = &props;
+        }
+        EXPECT_TRUE(serializer.handleSerialize(&event));
+        return event.record.blob;
+    }
+};
+
+TEST_F(BondSerializerTests, DirectPropertiesMatchRecordPath)
+{
+    EventProperties props = makeProperties();
+    ASSERT_TRUE(EventPropertiesDecorator::canSerializeDirectly(props));
+
+    ::CsProtocol::Record record;
+    ::CsProtocol::Record directRecord;
+    std::vector<uint8_t> expected = serialize(props, false, record);
+    std::vector<uint8_t> actual = serialize(props, true, directRecord);
+    EXPECT_THAT(actual, Eq(expected));
+
+    // The direct path leaves Part C out of the record
+    EXPECT_THAT(directRecord.data[0].properties.size(), Eq(3u));
+
+    ::CsProtocol::Record decoded;
+    bond_lite::CompactBinaryProtocolReader reader(actual);
+    ASSERT_TRUE(bond_lite::Deserialize(reader, decoded));
+    EXPECT_THAT(decoded, Eq(record));
+    EXPECT_THAT(decoded.data[0].properties["shared"].stringValue, Eq("fromEvent"));
+    EXPECT_THAT(decoded.data[0].properties["contextOnly"].stringValue, Eq("fromContext"));
+}
+
+TEST_F(BondSerializerTests, DirectPropertiesMatchWithoutContextOrProperties)
+{
+    context.ClearCustomFields();
+    for (auto const& props : { EventProperties("Empty"), makeProperties() })
+    {
+        ::CsProtocol::Record record;
+        ::CsProtocol::Record directRecord;
+        EXPECT_THAT(serialize(props, true, directRecord), Eq(serialize(props, false, record)));
+    }
+}
+
+TEST_F(BondSerializerTests, MergePropertiesMaterializesRecord)
+{
+    EventProperties props = makeProperties();
+    ::CsProtocol::Record record;
+    ::CsProtocol::Record directRecord;
+    serialize(props, false, record);
+    serialize(props, true, directRecord);
+
+    EventPropertiesDecorator::mergeProperties(directRecord, props);
+    EXPECT_THAT(directRecord.data, Eq(record.data));
+}
+
+TEST_F(BondSerializerTests, PartBAndCorrelationVectorUseRecordPath)
+{
+    EventProperties partB("PartB");
+    partB.SetProperty("b", "value", PiiKind_None, DataCategory_PartB);
+    EXPECT_FALSE(EventPropertiesDecorator::canSerializeDirectly(partB));
+
+    EventProperties cv("CorrelationVector");
+    cv.SetProperty(CorrelationVector::PropertyName, "cv.1");
+    EXPECT_FALSE(EventPropertiesDecorator::canSerializeDirectly(cv));
+}
+
+TEST_F(BondSerializerTests, LogEventListenerDisablesDirectProperties)
+{
+    EXPECT_TRUE(logManager.CanSerializePropertiesDirectly());
+
+    LogEventListener listener;
+    logManager.AddEventListener(DebugEventType::EVT_LOG_EVENT, listener);
+    EXPECT_FALSE(logManager.CanSerializePropertiesDirectly());
+    logManager.RemoveEventListener(DebugEventType::EVT_LOG_EVENT, listener);
+    EXPECT_TRUE(logManager.CanSerializePropertiesDirectly());
+}
+
+TEST_F(BondSerializerTests, LogEventListenerOnCascadedSourceDisablesDirectProperties)
+{
+    // As with LogManager, which listeners are added to after its source was attached
+    DebugEventSource cascaded;
+    logManager.AttachEventSource(cascaded);
+    EXPECT_TRUE(logManager.CanSerializePropertiesDirectly());
+
+    LogEventListener listener;
+    cascaded.AddEventListener(DebugEventType::EVT_LOG_EVENT, listener);
+    EXPECT_FALSE(logManager.CanSerializePropertiesDirectly());
+    cascaded.RemoveEventListener(DebugEventType::EVT_LOG_EVENT, listener);
+    EXPECT_TRUE(logManager.CanSerializePropertiesDirectly());
+    logManager.DetachEventSource(cascaded);
+}
+
+TEST_F(BondSerializerTests, WriterAppendsAndRoundTripsEncodingBoundaries)
+{
+    std::vector<uint64_t> values{ 0, 127, 128, 16383, 16384, (1ull << 21) - 1, 1ull << 21, (1ull << 35) + 5, UINT64_MAX };
+    std::vector<std::string> strings{ "", std::string(127, 'a'), std::string(128, 'b'), std::string(5000, 'c') };
+    std::vector<uint16_t> ids{ 5, 6, 255, 256, 0xffff };
+
+    // Existing content is kept, the rest is written after it
+    std::vector<uint8_t> blob{ 0xAA };
+    blob.reserve(8);
+    {
+        bond_lite::CompactBinaryProtocolWriter writer(blob);
+        for (auto value : values)
+        {
+            writer.WriteUInt64(value);
+        }
+        writer.WriteInt64(INT64_MIN);
+        writer.WriteInt32(-1);
+        for (auto const& value : strings)
+        {
+            writer.WriteString(value);
+        }
+        for (auto id : ids)
+        {
+            writer.WriteFieldBegin(bond_lite::BT_STRING, id, nullptr);
+        }
+        writer.WriteDouble(3.5);
+        writer.WriteBool(true);
+    }
+
+    bond_lite::CompactBinaryProtocolReader reader(blob);
+    uint8_t prefix = 0;
+    ASSERT_TRUE(reader.ReadUInt8(prefix));
+    EXPECT_THAT(prefix, Eq(0xAA));
+    for (auto expected : values)
+    {
+        uint64_t value = 1;
+        ASSERT_TRUE(reader.ReadUInt64(value));
+        EXPECT_THAT(value, Eq(expected));
+    }
+    int64_t int64Value = 0;
+    int32_t int32Value = 0;
+    ASSERT_TRUE(reader.ReadInt64(int64Value));
+    ASSERT_TRUE(reader.ReadInt32(int32Value));
+    EXPECT_THAT(int64Value, Eq(INT64_MIN));
+    EXPECT_THAT(int32Value, Eq(-1));
+    for (auto const& expected : strings)
+    {
+        std::string value;
+        ASSERT_TRUE(reader.ReadString(value));
+        EXPECT_THAT(value, Eq(expected));
+    }
+    for (auto expected : ids)
+    {
+        uint8_t type = 0;
+        uint16_t id = 0;
+        ASSERT_TRUE(reader.ReadFieldBegin(type, id));
+        EXPECT_THAT(type, Eq(bond_lite::BT_STRING));
+        EXPECT_THAT(id, Eq(expected));
+    }
+    double doubleValue = 0;
+    bool boolValue = false;
+    ASSERT_TRUE(reader.ReadDouble(doubleValue));
+    ASSERT_TRUE(reader.ReadBool(boolValue));
+    EXPECT_THAT(doubleValue, Eq(3.5));
+    EXPECT_TRUE(boolValue);
+
+    // Nothing past what was written
+    EXPECT_THAT(reader.getSize(), Eq(blob.size()));
+}
+
+TEST_F(BondSerializerTests, NestedWritersKeepTheirOutputsApart)
+{
+    std::vector<uint8_t> outer;
+    std::vector<uint8_t> inner;
+    {
+        // The outer writer takes the thread's scratch buffer, the inner one gets its own
+        bond_lite::CompactBinaryProtocolWriter outerWriter(outer);
+        outerWriter.WriteString(std::string(300, 'o'));
+        {
+            bond_lite::CompactBinaryProtocolWriter innerWriter(inner);
+            innerWriter.WriteString(std::string(200, 'i'));
+        }
+        outerWriter.WriteUInt8(7);
+    }
+
+    std::string value;
+    uint8_t last = 0;
+    bond_lite::CompactBinaryProtocolReader outerReader(outer);
+    ASSERT_TRUE(outerReader.ReadString(value));
+    EXPECT_THAT(value, Eq(std::string(300, 'o')));
+    ASSERT_TRUE(outerReader.ReadUInt8(last));
+    EXPECT_THAT(last, Eq(7));
+    EXPECT_THAT(outerReader.getSize(), Eq(outer.size()));
+
+    bond_lite::CompactBinaryProtocolReader innerReader(inner);
+    ASSERT_TRUE(innerReader.ReadString(value));
+    EXPECT_THAT(value, Eq(std::string(200, 'i')));
+    EXPECT_THAT(innerReader.getSize(), Eq(inner.size()));
+}
+
+TEST_F(BondSerializerTests, BlobKeepsNoSpareCapacity)
+{
+    for (bool direct : { false, true })
+    {
+        // A large event first, so that the size estimate is well above the next one
+        EventProperties large = makeProperties();
+        large.SetProperty("large", std::string(64 * 1024, 'x'));
+        ::CsProtocol::Record largeRecord;
+        serialize(large, direct, largeRecord);
+
+        EventProperties small("Small");
+        ::CsProtocol::Record record;
+        record.name = small.GetName();
+        EventLatency latency = EventLatency_Normal;
+        ASSERT_TRUE(decorator.decorate(record, latency, small, direct));
+        IncomingEventContext event("token", latency, EventPersistence_Normal, &record);
+        event.properties = direct ? &small : nullptr;
+        ASSERT_TRUE(serializer.handleSerialize(&event));
+        EXPECT_THAT(event.record.blob, Not(IsEmpty()));
+        EXPECT_THAT(event.record.blob.capacity(), Eq(event.record.blob.size()));
+    }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST_F(BondSerializerTests, DISABLED_SerializeThroughput)
+{
+    // Records serialized into a fresh blob, as for every logged event
+    EventProperties props = makeProperties();
+    ::CsProtocol::Record record;
+    ::CsProtocol::Record directRecord;
+    size_t expectedSize = serialize(props, false, record).size();
+    serialize(props, true, directRecord);
+
+    const size_t count = 20000;
+    for (bool direct : { false, true })
+    {
+        IncomingEventContext event("token", EventLatency_Normal, EventPersistence_Normal, direct ? &directRecord : &record);
+        event.properties = direct ? &props : nullptr;
+        size_t totalSize = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++)
+        {
+            std::vector<uint8_t>().swap(event.record.blob);
+            serializer.handleSerialize(&event);
+            totalSize += event.record.blob.size();
+        }
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_THAT(totalSize, Eq(count * expectedSize));
+        RecordProperty(direct ? "DirectUs" : "RecordUs", std::to_string(elapsedUs));
+    }
+}
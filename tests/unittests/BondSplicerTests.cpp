@@ -17,6 +17,7 @@ class ShadowBondSplicer : protected MAT::BondSplicer
 {
   public:
     using MAT::BondSplicer::addTenantToken;
+    using MAT::BondSplicer::spliceInto;
 
     void addRecord(size_t dataPackageIndex, ::CsProtocol::Record& record)
     {
@@ -143,3 +144,48 @@ TEST_F(BondSplicerTests, splice_TwoDataPackagesWithOneNonEmptyRecordEach_SizeTwe
 
    EXPECT_THAT(bs.splice().size(), size_t { 20 });
 }
+
+TEST_F(BondSplicerTests, spliceInto_RecordsInPackageOrder_MatchesSplice)
+{
+   ::CsProtocol::Record r;
+   r.name = std::string { "Record1" };
+   ::CsProtocol::Record r2;
+   r2.name = std::string { "Record2" };
+   auto firstTokenIndex = bs.addTenantToken("tenant1");
+   auto secondTokenIndex = bs.addTenantToken("tenant2");
+   bs.addRecord(firstTokenIndex, r);
+   bs.addRecord(firstTokenIndex, r);
+   bs.addRecord(secondTokenIndex, r2);
+
+   std::vector<uint8_t> expected = bs.splice();
+   std::vector<uint8_t> output;
+   bs.spliceInto(output);
+   EXPECT_THAT(output, Eq(expected));
+   EXPECT_THAT(bs.splice().size(), size_t { 0 });
+}
+
+TEST_F(BondSplicerTests, spliceInto_InterleavedPackages_GroupsRecordsByPackage)
+{
+   ::CsProtocol::Record r;
+   r.name = std::string { "Record1" };
+   ::CsProtocol::Record r2;
+   r2.name = std::string { "Record2" };
+   auto firstTokenIndex = bs.addTenantToken("tenant1");
+   auto secondTokenIndex = bs.addTenantToken("tenant2");
+   bs.addRecord(firstTokenIndex, r);
+   bs.addRecord(secondTokenIndex, r2);
+   bs.addRecord(firstTokenIndex, r);
+
+   std::vector<uint8_t> expected = bs.splice();
+   std::vector<uint8_t> output;
+   bs.spliceInto(output);
+   EXPECT_THAT(output, Eq(expected));
+   ASSERT_THAT(output.size(), size_t { 30 });
+   // Both tenant1 records come first
+   EXPECT_THAT(std::vector<uint8_t>(output.begin(), output.begin() + 10), Eq(std::vector<uint8_t>(output.begin() + 10, output.begin() + 20)));
+
+   // Splicer is reset and ready for the next package
+   bs.addRecord(bs.addTenantToken("tenant3"), r2);
+   bs.spliceInto(output);
+   EXPECT_THAT(output.size(), size_t { 10 });
+}
@@ -0,0 +1,222 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "compression/DeflateCodec.hpp"
+#include "compression/HttpDeflateCompression.hpp"
+#include "config/RuntimeConfig_Default.hpp"
+#include "packager/BondSplicer.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+
+#include <utils/ZlibUtils.hpp>
+#include <algorithm>
+#include <ctime>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    /// Stand-in for an external codec such as zstd
+    class ReversingCodec : public ICompressionCodec
+    {
+      public:
+        bool fail = false;
+        int  calls = 0;
+
+        const char* GetContentEncoding() const noexcept override
+        {
+            return "x-reverse";
+        }
+
+        bool Compress(std::vector<uint8_t>& body) override
+        {
+            calls++;
+            std::reverse(body.begin(), body.end());
+            return !fail;
+        }
+    };
+
+    /// Uncompressed copy, the baseline for the benchmark
+    class IdentityCodec : public ICompressionCodec
+    {
+      public:
+        const char* GetContentEncoding() const noexcept override
+        {
+            return "identity";
+        }
+
+        bool Compress(std::vector<uint8_t>& body) override
+        {
+            std::vector<uint8_t> copy(body);
+            body.swap(copy);
+            return true;
+        }
+    };
+
+    /// Request body spliced from Bond records shaped like real SDK events
+    std::vector<uint8_t> makeBondPayload(size_t minSize)
+    {
+        BondSplicer splicer;
+        size_t tenants[] = { splicer.addTenantToken("tenant1-token"), splicer.addTenantToken("tenant2-token") };
+        for (int i = 0; splicer.getSizeEstimate() < minSize; i++)
+        {
+            ::CsProtocol::Record record;
+            record.ver = "3.0";
+            record.name = "Microsoft.Test.Event" + std::to_string(i % 7);
+            record.time = 1580000000000 + i * 37;
+            record.iKey = "o:tenant" + std::to_string(i % 2);
+            record.extDevice.push_back({});
+            record.extDevice[0].localId = "c:0b6c4f2d-98e5-4b2d-9d8e-4b7f0d7a7c1e";
+            record.extDevice[0].deviceClass = "Windows.Desktop";
+            record.extOs.push_back({});
+            record.extOs[0].name = "Windows Desktop";
+            record.extOs[0].ver = "10.0.19041.1.amd64fre.vb_release.191206-1406";
+            record.extApp.push_back({});
+            record.extApp[0].id = "com.microsoft.test";
+            record.extApp[0].ver = "1.2." + std::to_string(i % 3);
+            record.data.push_back({});
+            auto& properties = record.data[0].properties;
+            properties["EventInfo.Sequence"].stringValue = std::to_string(i);
+            properties["PageName"].stringValue = "Page" + std::to_string(i % 13);
+            properties["DurationMs"].type = ::CsProtocol::ValueKind::ValueInt64;
+            properties["DurationMs"].longValue = (i * 7919) % 5000;
+            properties["SessionId"].stringValue = "6f1c2e0a-" + std::to_string(i / 100) + "-4d3b-8f5e-2a9b7c6d4e1f";
+
+            std::vector<uint8_t> blob;
+            {
+                bond_lite::CompactBinaryProtocolWriter writer(blob);
+                bond_lite::Serialize(writer, record);
+            }
+            splicer.addRecord(tenants[i % 2], blob);
+        }
+        std::vector<uint8_t> body;
+        splicer.spliceInto(body);
+        return body;
+    }
+
+}
+
+class CompressionCodecTests : public StrictMock<Test> {
+  protected:
+    ILogConfiguration                                                logConfig;
+    RuntimeConfig_Default                                            config;
+    RouteSource<EventsUploadContextPtr const&>                       input;
+    RouteSink<CompressionCodecTests, EventsUploadContextPtr const&>  succeeded{this, &CompressionCodecTests::resultSucceeded};
+    RouteSink<CompressionCodecTests, EventsUploadContextPtr const&>  failed{this, &CompressionCodecTests::resultFailed};
+
+  protected:
+    CompressionCodecTests() :
+        config(logConfig)
+    {
+        config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    }
+
+    void connect(HttpDeflateCompression& compression)
+    {
+        input >> compression.compress >> succeeded;
+        compression.compressionFailed >> failed;
+    }
+
+    MOCK_METHOD1(resultSucceeded, void(EventsUploadContextPtr const &));
+    MOCK_METHOD1(resultFailed,    void(EventsUploadContextPtr const &));
+};
+
+TEST_F(CompressionCodecTests, CustomCodecSetsContentEncoding)
+{
+    auto codec = std::make_shared<ReversingCodec>();
+    HttpDeflateCompression compression(config, codec);
+    connect(compression);
+    EXPECT_FALSE(compression.IsBuiltInCodec());
+
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    event->body = { 1, 2, 3 };
+    EXPECT_CALL(*this, resultSucceeded(event)).Times(1);
+    input(event);
+
+    EXPECT_THAT(codec->calls, Eq(1));
+    EXPECT_THAT(event->body, ElementsAre(3, 2, 1));
+    EXPECT_TRUE(event->compressed);
+    EXPECT_THAT(event->contentEncoding, Eq("x-reverse"));
+}
+
+TEST_F(CompressionCodecTests, CustomCodecFailureFailsPackage)
+{
+    auto codec = std::make_shared<ReversingCodec>();
+    codec->fail = true;
+    HttpDeflateCompression compression(config, codec);
+    connect(compression);
+
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    event->body = { 1, 2, 3 };
+    EXPECT_CALL(*this, resultFailed(event)).Times(1);
+    input(event);
+    EXPECT_FALSE(event->compressed);
+}
+
+TEST_F(CompressionCodecTests, BuiltInCodecFollowsConfiguredEncoding)
+{
+    config[CFG_MAP_HTTP][CFG_STR_HTTP_CONTENT_ENCODING] = "gzip";
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = 1;
+    HttpDeflateCompression compression(config);
+    connect(compression);
+    EXPECT_TRUE(compression.IsBuiltInCodec());
+
+    std::vector<uint8_t> payload = makeBondPayload(4096);
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    event->body = payload;
+    EXPECT_CALL(*this, resultSucceeded(event)).Times(1);
+    input(event);
+
+    EXPECT_THAT(event->contentEncoding, Eq("gzip"));
+    std::vector<uint8_t> inflated;
+    ZlibUtils::InflateVector(event->body, inflated, true);
+    EXPECT_THAT(inflated, Eq(payload));
+
+    config[CFG_MAP_HTTP][CFG_STR_HTTP_CONTENT_ENCODING] = "deflate";
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = -1;
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Results go to
+// the test properties of the XML report.
+TEST_F(CompressionCodecTests, DISABLED_CompareCodecsOnBondPayload)
+{
+    std::vector<uint8_t> const payload = makeBondPayload(1024 * 1024);
+    double const payloadMB = payload.size() / (1024.0 * 1024.0);
+    const int rounds = 5;
+
+    struct Candidate
+    {
+        const char*                         name;
+        std::shared_ptr<ICompressionCodec>  codec;
+    } candidates[] = {
+        { "Identity",       std::make_shared<IdentityCodec>() },
+        { "DeflateDefault", std::make_shared<DeflateCodec>("deflate") },
+        { "Deflate1",       std::make_shared<DeflateCodec>("deflate", 1) },
+        { "Deflate9",       std::make_shared<DeflateCodec>("deflate", 9) },
+        { "GzipDefault",    std::make_shared<DeflateCodec>("gzip") },
+    };
+
+    RecordProperty("PayloadBytes", std::to_string(payload.size()));
+    for (auto const& candidate : candidates)
+    {
+        std::vector<uint8_t> body;
+        std::clock_t start = std::clock();
+        for (int i = 0; i < rounds; i++)
+        {
+            body = payload;
+            ASSERT_TRUE(candidate.codec->Compress(body));
+        }
+        double cpuMs = 1000.0 * (std::clock() - start) / CLOCKS_PER_SEC;
+        double ratio = static_cast<double>(body.size()) / payload.size();
+        RecordProperty(std::string(candidate.name) + "Ratio", std::to_string(ratio));
+        RecordProperty(std::string(candidate.name) + "CpuMsPerMB", std::to_string(cpuMs / rounds / payloadMB));
+        if (candidate.codec->GetContentEncoding() != std::string("identity"))
+        {
+            EXPECT_THAT(ratio, Lt(0.5));
+        }
+    }
+}
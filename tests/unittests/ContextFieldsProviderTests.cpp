@@ -5,6 +5,8 @@
 
 #include "common/Common.hpp"
 #include "api/ContextFieldsProvider.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
 
 using namespace testing;
 using namespace MAT;
@@ -136,6 +138,13 @@ TEST(ContextFieldsProviderTests, UsesPalValues)
 class TestContextFieldsProvider : public ContextFieldsProvider
 {
 public:
+	using ContextFieldsProvider::ContextFieldsProvider;
+
+	std::shared_ptr<const PartA> GetPartA()
+	{
+		return getPartA();
+	}
+
 	std::map<std::string, std::string>& GetCommonContextEventToConfigIds() noexcept
 	{
 		return m_commonContextEventToConfigIds;
@@ -180,3 +189,117 @@ TEST(ContextFieldsProviderTests, SetEventExperimentIds_EmptyExperimentIdsRemoves
 	provider.SetEventExperimentIds("Rodgers", "");
 	EXPECT_THAT(provider.GetCommonContextEventToConfigIds().size(), 0);
 }
+
+namespace {
+
+    std::vector<uint8_t> serialize(::CsProtocol::Record const& record)
+    {
+        std::vector<uint8_t> blob;
+        {
+            bond_lite::CompactBinaryProtocolWriter writer(blob);
+            bond_lite::Serialize(writer, record);
+        }
+        return blob;
+    }
+
+    // A record that already has Part A structs is merged field by field
+    ::CsProtocol::Record writeFieldByField(ContextFieldsProvider& ctx, std::string const& name, bool commonOnly)
+    {
+        ::CsProtocol::Record record;
+        record.name = name;
+        record.extApp.push_back(::CsProtocol::App());
+        ctx.writeToRecord(record, commonOnly);
+        return record;
+    }
+
+}
+
+TEST(ContextFieldsProviderTests, PartATemplateMatchesFieldByFieldMerge)
+{
+    ContextFieldsProvider ctx(nullptr);
+    TestContextFieldsProvider loggerCtx(&ctx);
+
+    ctx.SetAppId("appId");
+    ctx.SetAppExperimentIds("parentExperimentIds");
+    ctx.SetEventExperimentIds("parentevent", "parentEventIds");
+    ctx.SetDeviceMake("deviceMake");
+    ctx.SetCommonField(COMMONFIELDS_COMMERCIAL_ID, "commercialId");
+    ctx.SetNetworkCost(NetworkCost_Metered);
+    ctx.SetCustomField("parent", "parentValue");
+    ctx.SetCustomField("shared", 42.5);
+    ctx.SetTicket(TicketType_AAD_User, "parentTicket");
+    loggerCtx.SetAppVersion("1.2.3");
+    loggerCtx.SetUserId("userId");
+    loggerCtx.SetCommonField(SESSION_IMPRESSION_ID, "impression");
+    loggerCtx.SetCustomField("shared", true);
+    loggerCtx.SetCustomField("child", EventProperty("childValue", PiiKind_GenericData));
+    loggerCtx.SetTicket(TicketType_MSA_Device, "childTicket");
+
+    for (bool commonOnly : { false, true })
+    {
+        for (std::string name : { "someevent", "parentevent" })
+        {
+            ::CsProtocol::Record record;
+            record.name = name;
+            loggerCtx.writeToRecord(record, commonOnly);
+            EXPECT_THAT(serialize(record), Eq(serialize(writeFieldByField(loggerCtx, name, commonOnly))));
+        }
+    }
+
+    ::CsProtocol::Record record;
+    record.name = "parentevent";
+    loggerCtx.writeToRecord(record);
+    EXPECT_THAT(record.extApp[0].expId, Eq("parentEventIds"));
+    EXPECT_THAT(record.extApp[0].ver, Eq("1.2.3"));
+    EXPECT_THAT(record.data[0].properties["shared"].type, Eq(::CsProtocol::ValueKind::ValueBool));
+    EXPECT_THAT(record.extProtocol.size(), Eq(3u));
+
+    // The innermost context with experiment ids wins, also for event specific ones
+    loggerCtx.SetAppExperimentIds("childExperimentIds");
+    ::CsProtocol::Record record1;
+    record1.name = "parentevent";
+    loggerCtx.writeToRecord(record1);
+    EXPECT_THAT(record1.extApp[0].expId, Eq("childExperimentIds"));
+    EXPECT_THAT(serialize(record1), Eq(serialize(writeFieldByField(loggerCtx, "parentevent", false))));
+}
+
+TEST(ContextFieldsProviderTests, PartATemplateRebuiltOnlyOnContextChange)
+{
+    ContextFieldsProvider ctx(nullptr);
+    TestContextFieldsProvider loggerCtx(&ctx);
+    ctx.SetAppId("appId");
+
+    auto partA = loggerCtx.GetPartA();
+    EXPECT_THAT(loggerCtx.GetPartA(), Eq(partA));
+    ::CsProtocol::Record record;
+    loggerCtx.writeToRecord(record);
+    EXPECT_THAT(loggerCtx.GetPartA(), Eq(partA));
+
+    // Parent change
+    ctx.SetAppId("otherAppId");
+    auto partA1 = loggerCtx.GetPartA();
+    EXPECT_THAT(partA1, Ne(partA));
+    EXPECT_THAT(partA1->record.extApp[0].id, Eq("otherAppId"));
+
+    // Own change
+    loggerCtx.SetCustomField("child", "value");
+    auto partA2 = loggerCtx.GetPartA();
+    EXPECT_THAT(partA2, Ne(partA1));
+    EXPECT_THAT(partA2->allData[0].properties.at("child").stringValue, Eq("value"));
+    EXPECT_THAT(partA2->record.data[0].properties.count("child"), Eq(0u));
+
+    // Detaching from the parent
+    loggerCtx.SetParentContext(nullptr);
+    auto partA3 = loggerCtx.GetPartA();
+    EXPECT_THAT(partA3, Ne(partA2));
+    EXPECT_THAT(partA3->record.extApp[0].id, IsEmpty());
+
+    // Reading the fields leaves the template alone, clearing them rebuilds it
+    EXPECT_THAT(loggerCtx.GetCustomFields().size(), Eq(1u));
+    EXPECT_THAT(loggerCtx.GetCommonFields().size(), Eq(0u));
+    EXPECT_THAT(loggerCtx.GetPartA(), Eq(partA3));
+    loggerCtx.ClearCustomFields();
+    auto partA4 = loggerCtx.GetPartA();
+    EXPECT_THAT(partA4, Ne(partA3));
+    EXPECT_THAT(partA4->allData[0].properties.count("child"), Eq(0u));
+}
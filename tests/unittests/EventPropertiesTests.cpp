@@ -5,6 +5,7 @@
 
 #include "common/Common.hpp"
 #include "api/ContextFieldsProvider.hpp"
+#include "FlatMap.hpp"
 
 using namespace testing;
 using namespace MAT;
@@ -114,6 +115,57 @@ TEST(EventPropertiesTests, Properties)
     EXPECT_THAT(ep.GetPiiProperties(), IsEmpty());
 }
 
+TEST(EventPropertiesTests, MovesPropertiesIn)
+{
+    EventProperty value(std::string(64, 'x'));
+    EventProperties ep("test");
+    ep.SetProperty("moved", std::move(value));
+    EXPECT_THAT(ep.GetProperties(), Contains(Pair("moved", EventProperty(std::string(64, 'x')))));
+    EXPECT_THAT(value.type, Eq(EventProperty::TYPE_INT64));
+
+    std::vector<std::string> strings { "2", "3" };
+    std::map<std::string, EventProperty> values = { { "a", EventProperty("1") }, { "b", EventProperty(strings) } };
+    EventProperties fromMap("test", std::move(values));
+    EXPECT_THAT(fromMap.GetProperties(), SizeIs(3));
+    EXPECT_THAT(fromMap.GetProperties(), Contains(Pair("a", EventProperty("1"))));
+    EXPECT_THAT(fromMap.GetProperties().at("b").as_stringArray->size(), Eq(2u));
+    EXPECT_THAT(values, IsEmpty());
+}
+
+TEST(EventPropertiesTests, ReserveKeepsPropertiesSorted)
+{
+    EventProperties ep("test");
+    ep.reserve(32);
+    for (int i = 30; i > 0; i--)
+    {
+        ep.SetProperty("prop" + std::to_string(i), int64_t { i });
+    }
+    auto const& flat = ep.GetPropertiesFlat();
+    EXPECT_THAT(flat, SizeIs(31));
+    EXPECT_TRUE(std::is_sorted(flat.begin(), flat.end(),
+        [](std::pair<std::string, EventProperty> const& a, std::pair<std::string, EventProperty> const& b) { return a.first < b.first; }));
+    EXPECT_THAT(ep.erase("prop7"), Eq(1u));
+    EXPECT_THAT(ep.GetProperties(), SizeIs(30));
+    EXPECT_THAT(ep.GetProperties().at("prop8").as_int64, Eq(8));
+}
+
+TEST(EventPropertiesTests, GetPropertiesReturnsStdMap)
+{
+    EventProperties ep("test");
+    ep.SetProperty("b", "2");
+    ep.SetProperty("a", "1");
+    std::map<std::string, EventProperty> const& properties = ep.GetProperties();
+    EXPECT_THAT(properties, SizeIs(3));
+    EXPECT_THAT(properties, Contains(Pair("a", EventProperty("1"))));
+    EXPECT_THAT(properties, Contains(Pair("b", EventProperty("2"))));
+
+    // The same map until the properties change, then it catches up
+    EXPECT_THAT(&ep.GetProperties(), Eq(&properties));
+    ep.SetProperty("c", "3");
+    EXPECT_THAT(ep.GetProperties(), SizeIs(4));
+    EXPECT_THAT(ep.GetProperties(), Contains(Pair("c", EventProperty("3"))));
+}
+
 TEST(EventPropertiesTests, NumericProperties)
 {
     EventProperties ep("test");
@@ -178,7 +230,8 @@ TEST(EventPropertiesTests, SetLevel_SetsPropertyName)
 {
     EventProperties properties;
     properties.SetLevel(42);
-    EXPECT_TRUE(properties.GetProperties().find(COMMONFIELDS_EVENT_LEVEL) != properties.GetProperties().cend());
+    auto const& map = properties.GetProperties();
+    EXPECT_TRUE(map.find(COMMONFIELDS_EVENT_LEVEL) != map.cend());
 }
 
 TEST(EventPropertiesTests, SetLevel_SetsPropertyTypeInt64)
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "CsProtocol_types.hpp"
+#include "FlatMap.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+
+#include <map>
+#include <random>
+
+using namespace testing;
+
+namespace {
+
+    std::vector<std::string> keysOf(::CsProtocol::PropertyMap const& map)
+    {
+        std::vector<std::string> keys;
+        for (auto const& kv : map)
+        {
+            keys.push_back(kv.first);
+        }
+        return keys;
+    }
+
+}
+
+TEST(FlatMapTests, KeepsKeysSortedWhateverTheInsertOrder)
+{
+    ::CsProtocol::PropertyMap map;
+    for (auto const& key : { "m", "z", "a", "q", "b" })
+    {
+        map[key].stringValue = key;
+    }
+    EXPECT_THAT(keysOf(map), ElementsAre("a", "b", "m", "q", "z"));
+    for (auto const& kv : map)
+    {
+        EXPECT_THAT(kv.second.stringValue, Eq(kv.first));
+    }
+}
+
+TEST(FlatMapTests, LookupAndModify)
+{
+    ::CsProtocol::PropertyMap map;
+    map["one"].longValue = 1;
+    map["two"].longValue = 2;
+
+    // Existing entries are returned, not duplicated
+    map["one"].longValue = 11;
+    EXPECT_THAT(map.size(), Eq(2u));
+    EXPECT_THAT(map.at("one").longValue, Eq(11));
+    EXPECT_THAT(map.count("two"), Eq(1u));
+    EXPECT_THAT(map.count("three"), Eq(0u));
+    EXPECT_TRUE(map.find("three") == map.end());
+    EXPECT_THROW(map.at("three"), std::out_of_range);
+
+    ::CsProtocol::Value value;
+    value.longValue = 3;
+    EXPECT_TRUE(map.insert(std::make_pair(std::string("three"), value)).second);
+    EXPECT_FALSE(map.emplace("three", ::CsProtocol::Value()).second);
+    EXPECT_THAT(map.at("three").longValue, Eq(3));
+
+    EXPECT_THAT(map.erase("two"), Eq(1u));
+    EXPECT_THAT(map.erase("two"), Eq(0u));
+    EXPECT_THAT(keysOf(map), ElementsAre("one", "three"));
+
+    map.erase(map.find("one"));
+    EXPECT_THAT(keysOf(map), ElementsAre("three"));
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(FlatMapTests, EqualityDependsOnContentOnly)
+{
+    ::CsProtocol::PropertyMap first;
+    ::CsProtocol::PropertyMap second;
+    first["a"].stringValue = "x";
+    first["b"].longValue = 1;
+    second["b"].longValue = 1;
+    second["a"].stringValue = "x";
+    EXPECT_THAT(first, Eq(second));
+
+    second["b"].longValue = 2;
+    EXPECT_THAT(first, Ne(second));
+}
+
+TEST(FlatMapTests, RoundTripsThroughBond)
+{
+    ::CsProtocol::Data data;
+    data.properties["strKey"].stringValue = "hello";
+    data.properties["intKey"].type = ::CsProtocol::ValueKind::ValueInt64;
+    data.properties["intKey"].longValue = 42;
+    data.properties["arrKey"].type = ::CsProtocol::ValueKind::ValueArrayString;
+    data.properties["arrKey"].stringArray.push_back({ "a", "b" });
+
+    std::vector<uint8_t> blob;
+    {
+        bond_lite::CompactBinaryProtocolWriter writer(blob);
+        bond_lite::Serialize(writer, data, false);
+    }
+
+    ::CsProtocol::Data decoded;
+    bond_lite::CompactBinaryProtocolReader reader(blob);
+    ASSERT_TRUE(bond_lite::Deserialize(reader, decoded, false));
+    EXPECT_THAT(decoded, Eq(data));
+    EXPECT_THAT(keysOf(decoded.properties), ElementsAre("arrKey", "intKey", "strKey"));
+}
+
+TEST(FlatMapTests, MatchesStdMapUnderRandomInsertsAndErases)
+{
+    MAT::FlatMap<std::string, int> map;
+    std::map<std::string, int> expected;
+    std::mt19937 random(12345);
+    for (int i = 0; i < 2000; i++)
+    {
+        std::string key = "key" + std::to_string(random() % 64);
+        if (random() % 3 == 0)
+        {
+            EXPECT_THAT(map.erase(key), Eq(expected.erase(key)));
+        }
+        else
+        {
+            map[key] = i;
+            expected[key] = i;
+        }
+        ASSERT_THAT(map.size(), Eq(expected.size()));
+    }
+    EXPECT_TRUE(std::equal(map.begin(), map.end(), expected.begin(),
+        [](std::pair<std::string, int> const& a, std::pair<std::string const, int> const& b) { return a.first == b.first && a.second == b.second; }));
+}
+
+TEST(FlatMapTests, EraseByIteratorReturnsNextInKeyOrder)
+{
+    MAT::FlatMap<std::string, int> map { { "c", 3 }, { "a", 1 }, { "d", 4 }, { "b", 2 } };
+    auto it = map.erase(map.find("b"));
+    ASSERT_TRUE(it != map.end());
+    EXPECT_THAT(it->first, Eq("c"));
+    EXPECT_THAT(it->second, Eq(3));
+
+    it = map.erase(map.find("d"));
+    EXPECT_TRUE(it == map.end());
+    EXPECT_THAT(map.at("a"), Eq(1));
+    EXPECT_THAT(map.at("c"), Eq(3));
+}
@@ -7,6 +7,11 @@
 #include "utils/Utils.hpp"
 #include "EventProperties.hpp"
 
+#include <chrono>
+#include <random>
+#include <thread>
+#include <unordered_set>
+
 using namespace testing;
 using namespace MAT;
 
@@ -57,3 +62,120 @@ TEST(GuidTests, Ctor_InputIsTooLong_IgnoresExtraData)
     ASSERT_EQ("9D016D64-372E-4DCE-9FA3-0D0772217C54", guid.to_string());
 }
 
+namespace {
+
+    /// Previous POSIX implementation, the baseline for the benchmark
+    std::string legacyUuidString()
+    {
+        // One generator per thread in place of the shared std::rand() state
+        static thread_local std::minstd_rand random(std::random_device{}());
+        GUID_t uuid;
+        uuid.Data1 = (static_cast<uint16_t>(random()) << 16) | static_cast<uint16_t>(random());
+        uuid.Data2 = static_cast<uint16_t>(random());
+        uuid.Data3 = static_cast<uint16_t>(random());
+        for (size_t i = 0; i < sizeof(uuid.Data4); i++)
+            uuid.Data4[i] = static_cast<uint8_t>(random());
+        char buf[40] = { 0 };
+        snprintf(buf, sizeof(buf),
+            "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+            uuid.Data1, uuid.Data2, uuid.Data3,
+            uuid.Data4[0], uuid.Data4[1], uuid.Data4[2], uuid.Data4[3],
+            uuid.Data4[4], uuid.Data4[5], uuid.Data4[6], uuid.Data4[7]);
+        return buf;
+    }
+
+    template<typename TGenerate>
+    double uuidsPerSecond(TGenerate generate, unsigned threadCount, size_t perThread)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&generate, perThread]() {
+                size_t sum = 0;
+                for (size_t i = 0; i < perThread; i++)
+                {
+                    sum += generate()[0];
+                }
+                EXPECT_NE(0u, sum);
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return threadCount * perThread / seconds;
+    }
+
+}
+
+TEST(GuidTests, GenerateUuidString_IsRandomVersion4)
+{
+    for (int i = 0; i < 1000; i++)
+    {
+        std::string uuid = PAL::generateUuidString();
+        ASSERT_EQ(36u, uuid.size());
+        for (size_t j = 0; j < uuid.size(); j++)
+        {
+            if (j == 8 || j == 13 || j == 18 || j == 23)
+            {
+                ASSERT_EQ('-', uuid[j]);
+            }
+            else
+            {
+                ASSERT_TRUE(::isxdigit(uuid[j])) << uuid;
+            }
+        }
+#ifndef _WIN32
+        EXPECT_EQ('4', uuid[14]) << uuid;
+        EXPECT_NE(std::string::npos, std::string("89ab").find(uuid[19])) << uuid;
+#endif
+        // Round-trips through GUID_t
+        EXPECT_TRUE(equalsIgnoreCase(GUID_t(uuid.c_str()).to_string(), uuid)) << uuid;
+    }
+}
+
+TEST(GuidTests, GenerateUuidString_UniqueAcrossThreads)
+{
+    unsigned const threadCount = 8;
+    size_t const perThread = 20000;
+    std::vector<std::vector<std::string>> generated(threadCount);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&generated, t, perThread]() {
+            generated[t].reserve(perThread);
+            for (size_t i = 0; i < perThread; i++)
+            {
+                generated[t].push_back(PAL::generateUuidString());
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::unordered_set<std::string> unique;
+    for (auto const& uuids : generated)
+    {
+        unique.insert(uuids.begin(), uuids.end());
+    }
+    EXPECT_EQ(threadCount * perThread, unique.size());
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Rates go to
+// the test properties of the XML report.
+TEST(GuidTests, DISABLED_GenerateUuidString_Benchmark)
+{
+    size_t const perThread = 200000;
+    for (unsigned threadCount : { 1u, 4u })
+    {
+        double current = uuidsPerSecond([]() { return PAL::generateUuidString(); }, threadCount, perThread);
+        double legacy = uuidsPerSecond(legacyUuidString, threadCount, perThread);
+        std::string threads = "Threads" + std::to_string(threadCount);
+        RecordProperty(threads + "GenerateUuidStringPerSec", std::to_string(static_cast<uint64_t>(current)));
+        RecordProperty(threads + "RandSprintfPerSec", std::to_string(static_cast<uint64_t>(legacy)));
+    }
+}
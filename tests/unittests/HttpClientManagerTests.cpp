@@ -50,9 +50,9 @@ TEST_F(HttpClientManagerTests, HandlesRequestFlow)
     auto ctx = std::make_shared<EventsUploadContext>();
     ctx->httpRequestId = req->GetId();
     ctx->httpRequest = req;
-    ctx->recordIdsAndTenantIds["r1"] = "t1"; ctx->recordIdsAndTenantIds["r2"] = "t1";
+    ctx->recordIdsAndTenantIds[1] = TenantRegistry::Intern("t1"); ctx->recordIdsAndTenantIds[2] = TenantRegistry::Intern("t1");
     ctx->latency = EventLatency_Normal;
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[TenantRegistry::Intern("tenant1-token")] = 0;
 
     IHttpResponseCallback* callback = nullptr;
     EXPECT_CALL(httpClientMock, SendRequestAsync(ctx->httpRequest, _))
@@ -5,6 +5,9 @@
 
 #include "common/Common.hpp"
 #include "compression/HttpDeflateCompression.hpp"
+#include "compression/DeflateContextPool.hpp"
+#include "compression/StreamingDeflate.hpp"
+#include "packager/Packager.hpp"
 #include "config/RuntimeConfig_Default.hpp"
 
 #include <utils/ZlibUtils.hpp>
@@ -175,3 +178,142 @@ TEST_F(HttpDeflateCompressionTests, CompressesGzipCorrectly)
     EXPECT_THAT(event->compressed, true);
     config[CFG_MAP_HTTP]["contentEncoding"] = "deflate";
 }
+
+namespace {
+
+    StorageRecord makeTextRecord(StorageRecordId id, std::string const& tenantToken, size_t size)
+    {
+        static char const text[] = "EventInfo.Name=aria_send_test;DeviceInfo.OsName=Windows;";
+        std::vector<uint8_t> blob;
+        for (size_t i = 0; blob.size() + 1 < size; i++)
+        {
+            blob.push_back(static_cast<uint8_t>(text[i % (sizeof(text) - 1)]));
+        }
+        blob.push_back(0 /*BT_STOP*/);
+        return StorageRecord(id, tenantToken, EventLatency_Normal, EventPersistence_Normal, 1234567890, std::move(blob));
+    }
+
+}
+
+TEST_F(HttpDeflateCompressionTests, StreamingDeflateMatchesInput)
+{
+    StreamingDeflate deflater;
+    std::vector<uint8_t> expected;
+    ASSERT_TRUE(deflater.Begin(StreamingDeflate::GetWindowBits("deflate")));
+    // Enough input to go through a few periodic flushes and buffer growths
+    for (int i = 0; i < 2000; i++)
+    {
+        StorageRecord record = makeTextRecord(i + 1, "tenant", 100 + i % 50);
+        ASSERT_TRUE(deflater.Append(record.blob.data(), record.blob.size()));
+        expected.insert(expected.end(), record.blob.begin(), record.blob.end());
+        EXPECT_THAT(deflater.GetSizeEstimate(), Le(expected.size() + 64));
+    }
+    EXPECT_THAT(deflater.GetInputSize(), Eq(expected.size()));
+
+    std::vector<uint8_t> body;
+    ASSERT_TRUE(deflater.Finish(body));
+    EXPECT_FALSE(deflater.IsActive());
+    EXPECT_THAT(body.size(), Lt(expected.size() / 4));
+
+    std::vector<uint8_t> inflated;
+    ZlibUtils::InflateVector(body, inflated, false);
+    EXPECT_THAT(inflated, Eq(expected));
+
+    // Reusable for the next package, here with a gzip header
+    ASSERT_TRUE(deflater.Begin(StreamingDeflate::GetWindowBits("gzip")));
+    ASSERT_TRUE(deflater.Append(testPayload.data(), testPayload.size()));
+    ASSERT_TRUE(deflater.Finish(body));
+    std::vector<uint8_t> inflatedGzip;
+    ZlibUtils::InflateVector(body, inflatedGzip, true);
+    EXPECT_THAT(inflatedGzip, Eq(testPayload));
+}
+
+TEST_F(HttpDeflateCompressionTests, ReusesPooledDeflateStream)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    for (int i = 0; i < 3; i++)
+    {
+        EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+        event->body = testPayload;
+        EXPECT_CALL(*this, resultSucceeded(event)).Times(1);
+        input(event);
+
+        std::vector<uint8_t> inflated;
+        ZlibUtils::InflateVector(event->body, inflated, false);
+        EXPECT_THAT(inflated, Eq(testPayload));
+        if (i > 0)
+        {
+            // Same thread, same encoding: deflateReset() instead of deflateInit2()
+            EXPECT_THAT(event->compressorBytesSaved, Eq(StreamingDeflate::GetStateSize(-MAX_WBITS)));
+        }
+    }
+
+    // Each thread has its own streams
+    std::unique_ptr<StreamingDeflate> onOtherThread;
+    std::thread([&onOtherThread]() {
+        onOtherThread = DeflateContextPool::Acquire(-MAX_WBITS);
+    }).join();
+    ASSERT_THAT(onOtherThread, NotNull());
+    EXPECT_THAT(onOtherThread->GetReusedStateBytes(), Eq(size_t { 0 }));
+    EXPECT_THAT(StreamingDeflate::GetStateSize(-MAX_WBITS), Eq(size_t { 256 * 1024 }));
+}
+
+TEST_F(HttpDeflateCompressionTests, PackagerStreamsCompressedBody)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_STREAM_COMPRESSION] = true;
+    Packager packager(config);
+    packager.packagedEvents >> compression.compress >> succeeded;
+
+    auto ctx = std::make_shared<EventsUploadContext>();
+    std::vector<uint8_t> expected;
+    bool wantMore = true;
+    for (int i = 0; i < 10; i++)
+    {
+        StorageRecord record = makeTextRecord(i + 1, (i % 2) ? "tenant1" : "tenant2", 200);
+        packager.addEventToPackage(ctx, record, wantMore);
+        expected.insert(expected.end(), record.blob.begin(), record.blob.end());
+    }
+    EXPECT_TRUE(wantMore);
+    EXPECT_THAT(ctx->packageIds, SizeIs(2));
+
+    EXPECT_CALL(*this, resultSucceeded(ctx)).Times(1);
+    packager.finalizePackage(ctx);
+    EXPECT_TRUE(ctx->compressed);
+    EXPECT_THAT(ctx->deflater, IsNull());
+
+    // Compressed once by the packager, passed through by HttpDeflateCompression
+    std::vector<uint8_t> inflated;
+    ZlibUtils::InflateVector(ctx->body, inflated, false);
+    EXPECT_THAT(inflated, Eq(expected));
+
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_STREAM_COMPRESSION] = false;
+}
+
+TEST_F(HttpDeflateCompressionTests, StreamingFitsMoreEventsUnderUploadLimit)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    config[CFG_MAP_TPM][CFG_INT_TPM_MAX_BLOB_BYTES] = 4096;
+
+    auto countPackaged = [this](bool streaming) {
+        config[CFG_MAP_HTTP][CFG_BOOL_HTTP_STREAM_COMPRESSION] = streaming;
+        Packager packager(config);
+        auto ctx = std::make_shared<EventsUploadContext>();
+        bool wantMore = true;
+        for (int i = 0; i < 1000 && wantMore; i++)
+        {
+            packager.addEventToPackage(ctx, makeTextRecord(i + 1, "tenant", 300), wantMore);
+        }
+        packager.finalizePackage(ctx);
+        EXPECT_THAT(ctx->body.size(), Le(size_t { 4096 }));
+        return ctx->recordIdsAndTenantIds.size();
+    };
+
+    size_t plain = countPackaged(false);
+    size_t streamed = countPackaged(true);
+    EXPECT_THAT(plain, Eq(size_t { 13 }));
+    EXPECT_THAT(streamed, Gt(plain * 4));
+
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_STREAM_COMPRESSION] = false;
+    config[CFG_MAP_TPM][CFG_INT_TPM_MAX_BLOB_BYTES] = 2097152;
+}
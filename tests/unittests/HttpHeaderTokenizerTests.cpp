@@ -0,0 +1,272 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "http/HttpHeaderTokenizer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <regex>
+#include <sstream>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    int parse(std::string const& raw, HttpHeaders& headers)
+    {
+        return ParseHttpHeaders(raw.data(), raw.size(), headers);
+    }
+
+    std::vector<std::pair<std::string, std::string>> fieldsOf(HttpHeaders const& headers)
+    {
+        return std::vector<std::pair<std::string, std::string>>(headers.begin(), headers.end());
+    }
+
+    // Typical collector response as handed over by curl's header callback
+    std::string const collectorResponse =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 42\r\n"
+        "Content-Type: application/json\r\n"
+        "Server: Microsoft-HTTPAPI/2.0\r\n"
+        "Strict-Transport-Security: max-age=31536000\r\n"
+        "time-delta-millis: 25\r\n"
+        "kill-tokens: 6d084bbf6a9644ef83f40a77c9e34580-c2d379e0-4408-4325-9b4d-2a7d78131e14-7322:all\r\n"
+        "kill-duration: 3600\r\n"
+        "Retry-After: 120\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Date: Mon, 01 Jun 2020 10:00:00 GMT\r\n"
+        "\r\n";
+
+    // The regex based parser HttpClient_Curl used before, kept as a reference for the benchmark
+    std::map<std::string, std::string> parseWithRegex(std::vector<uint8_t> const& respHeaders)
+    {
+        std::map<std::string, std::string> result;
+        std::stringstream ss;
+        ss.str(std::string(reinterpret_cast<char const*>(respHeaders.data()), respHeaders.size()));
+        std::string header;
+        while (std::getline(ss, header, '\n')) {
+            std::smatch match;
+            std::regex http_headers_regex("(.*)\\: (.*)\\n*");
+            if (std::regex_search(header, match, http_headers_regex))
+                result[match[1]] = match[2];
+        }
+        return result;
+    }
+
+} // namespace
+
+TEST(HttpHeaderTokenizerTests, TokenizesStatusLineAndFields)
+{
+    std::string raw = "HTTP/1.1 204 No Content\r\nRetry-After: 10\r\nX-Empty:\r\n\r\n";
+    HttpHeaderTokenizer tokenizer(raw.data(), raw.size());
+
+    ASSERT_TRUE(tokenizer.next());
+    EXPECT_THAT(tokenizer.type(), HttpHeaderTokenizer::StatusLine);
+    EXPECT_THAT(tokenizer.statusCode(), 204);
+
+    ASSERT_TRUE(tokenizer.next());
+    EXPECT_THAT(tokenizer.type(), HttpHeaderTokenizer::Field);
+    EXPECT_TRUE(tokenizer.name().equals("Retry-After"));
+    EXPECT_TRUE(tokenizer.value().equals("10"));
+    // Tokens point into the input
+    EXPECT_THAT(tokenizer.name().data, raw.data() + raw.find("Retry-After"));
+
+    ASSERT_TRUE(tokenizer.next());
+    EXPECT_TRUE(tokenizer.name().equals("X-Empty"));
+    EXPECT_THAT(tokenizer.value().size, 0u);
+
+    EXPECT_FALSE(tokenizer.next());
+    EXPECT_FALSE(tokenizer.next());
+}
+
+TEST(HttpHeaderTokenizerTests, ParsesCollectorResponse)
+{
+    HttpHeaders headers;
+    EXPECT_THAT(parse(collectorResponse, headers), 200);
+    EXPECT_THAT(headers.size(), 10u);
+    EXPECT_THAT(headers.get("Content-Type"), Eq("application/json"));
+    EXPECT_THAT(headers.get("kill-tokens"), Eq("6d084bbf6a9644ef83f40a77c9e34580-c2d379e0-4408-4325-9b4d-2a7d78131e14-7322:all"));
+    EXPECT_THAT(headers.get("Retry-After"), Eq("120"));
+    EXPECT_THAT(headers.get("Date"), Eq("Mon, 01 Jun 2020 10:00:00 GMT"));
+}
+
+TEST(HttpHeaderTokenizerTests, KeepsFinalResponseOnly)
+{
+    HttpHeaders headers;
+    EXPECT_THAT(parse("HTTP/1.1 100 Continue\r\n\r\n"
+                      "HTTP/1.1 307 Temporary Redirect\r\nLocation: https://example.com/\r\n\r\n"
+                      "HTTP/2 429\r\nretry-after: 5\r\n\r\n", headers), 429);
+    EXPECT_THAT(fieldsOf(headers), ElementsAre(std::make_pair(std::string("retry-after"), std::string("5"))));
+}
+
+TEST(HttpHeaderTokenizerTests, KeepsRepeatedFields)
+{
+    HttpHeaders headers;
+    parse("HTTP/1.1 200 OK\r\nkill-tokens: a:all\r\nkill-tokens: b:all\r\n", headers);
+    EXPECT_THAT(headers.count("kill-tokens"), 2u);
+}
+
+TEST(HttpHeaderTokenizerTests, ParsesCorpus)
+{
+    struct Case
+    {
+        std::string raw;
+        int status;
+        std::vector<std::pair<std::string, std::string>> fields;
+    };
+    typedef std::pair<std::string, std::string> F;
+
+    std::vector<Case> corpus = {
+        {"", 0, {}},
+        {"\r\n\r\n\n", 0, {}},
+        {"HTTP/1.1 200 OK", 200, {}},
+        {"HTTP/1.0 503 Service Unavailable\n", 503, {}},
+        {"HTTP/2 200\r\n", 200, {}},
+        {"HTTP/1.1  404   Not Found\r\n", 404, {}},
+        // Broken status lines
+        {"HTTP/1.1 20 OK\r\n", 0, {}},
+        {"HTTP/1.1 2000\r\n", 0, {}},
+        {"HTTP/ 200 OK\r\n", 0, {}},
+        {"HTTP/1.1\r\n", 0, {}},
+        {"HTTP/1.1 abc\r\n", 0, {}},
+        {"http/1.1 200 OK\r\n", 0, {}},
+        // Line endings
+        {"A: 1\nB: 2\r\nC: 3", 0, {F("A", "1"), F("B", "2"), F("C", "3")}},
+        {"A: 1\r\r\n", 0, {F("A", "1\r")}},
+        // Whitespace
+        {"A:1\r\n", 0, {F("A", "1")}},
+        {"A: \t 1 2 \t \r\n", 0, {F("A", "1 2")}},
+        {"A:    \r\n", 0, {F("A", "")}},
+        {"A : 1\r\n", 0, {}},
+        {" A: 1\r\n", 0, {}},
+        {"A: 1\r\n folded\r\n", 0, {F("A", "1")}},
+        {"A B: 1\r\n", 0, {}},
+        // Colons
+        {": 1\r\n", 0, {}},
+        {"A: b: c\r\n", 0, {F("A", "b: c")}},
+        {"A:: 1\r\n", 0, {F("A", ": 1")}},
+        {"no colon here\r\n", 0, {}},
+        {"Date: Mon, 01 Jun 2020 10:00:00 GMT", 0, {F("Date", "Mon, 01 Jun 2020 10:00:00 GMT")}},
+        // Status code like fields are fields
+        {"HTTP/1.1: 200\r\n", 0, {F("HTTP/1.1", "200")}},
+        // Binary junk
+        {std::string("A: 1\0 2\r\n", 9), 0, {F("A", std::string("1\0 2", 4))}},
+        {std::string("\0\0: x\r\n", 7), 0, {}},
+        {"\x7F: x\r\n\xFF: y\r\n", 0, {F("\xFF", "y")}},
+    };
+
+    for (auto const& c : corpus) {
+        SCOPED_TRACE(c.raw);
+        HttpHeaders headers;
+        EXPECT_THAT(parse(c.raw, headers), c.status);
+        std::vector<std::pair<std::string, std::string>> expected = c.fields;
+        std::stable_sort(expected.begin(), expected.end(), [](F const& a, F const& b) { return a.first < b.first; });
+        EXPECT_THAT(fieldsOf(headers), ContainerEq(expected));
+    }
+}
+
+TEST(HttpHeaderTokenizerTests, SurvivesMutatedInput)
+{
+    // Fuzz style: random byte flips, truncations and splices of a valid block must
+    // only ever produce well formed tokens inside the input
+    std::mt19937 random(12345);
+    std::string const alphabet("HTP/1.0 29:\r\n \tAz\x7F\xFF");
+    for (int round = 0; round < 20000; round++) {
+        std::string raw = collectorResponse;
+        int edits = 1 + static_cast<int>(random() % 8);
+        for (int i = 0; i < edits && !raw.empty(); i++) {
+            size_t at = random() % raw.size();
+            switch (random() % 4) {
+            case 0:
+                raw[at] = alphabet[random() % alphabet.size()];
+                break;
+            case 1:
+                raw.insert(at, 1, alphabet[random() % alphabet.size()]);
+                break;
+            case 2:
+                raw.erase(at, 1 + random() % 16);
+                break;
+            default:
+                raw.resize(at);
+                break;
+            }
+        }
+
+        // Exact sized copy, so reading past the end is caught by sanitizers
+        std::unique_ptr<char[]> data(new char[raw.size() + 1]);
+        memcpy(data.get(), raw.data(), raw.size());
+        char const* begin = data.get();
+        char const* end = begin + raw.size();
+
+        HttpHeaderTokenizer tokenizer(begin, raw.size());
+        size_t lines = 0;
+        while (tokenizer.next()) {
+            ASSERT_THAT(++lines, Le(raw.size()));
+            if (tokenizer.type() == HttpHeaderTokenizer::StatusLine) {
+                ASSERT_THAT(tokenizer.statusCode(), AllOf(Ge(0), Le(999)));
+                continue;
+            }
+            auto const& name = tokenizer.name();
+            auto const& value = tokenizer.value();
+            ASSERT_THAT(name.size, Gt(0u));
+            ASSERT_TRUE(name.data >= begin && name.data + name.size <= end);
+            ASSERT_TRUE(value.data >= begin && value.data + value.size <= end);
+            ASSERT_THAT(name.str(), Not(AnyOf(HasSubstr(":"), HasSubstr(" "), HasSubstr("\n"))));
+            ASSERT_THAT(value.str(), Not(HasSubstr("\n")));
+            if (value.size > 0) {
+                ASSERT_THAT(value.data[0], Not(AnyOf(' ', '\t')));
+                ASSERT_THAT(value.data[value.size - 1], Not(AnyOf(' ', '\t')));
+            }
+        }
+    }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST(HttpHeaderTokenizerTests, DISABLED_ParseCostBenchmark)
+{
+    std::vector<uint8_t> raw(collectorResponse.begin(), collectorResponse.end());
+    const int count = 2000;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t regexFields = 0;
+    for (int i = 0; i < count; i++) {
+        regexFields += parseWithRegex(raw).size();
+    }
+    auto regexNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    size_t tokenizerFields = 0;
+    HttpHeaders headers;
+    for (int i = 0; i < count; i++) {
+        ParseHttpHeaders(reinterpret_cast<char const*>(raw.data()), raw.size(), headers);
+        tokenizerFields += headers.size();
+    }
+    auto tokenizerNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    size_t tokens = 0;
+    for (int i = 0; i < count; i++) {
+        HttpHeaderTokenizer tokenizer(reinterpret_cast<char const*>(raw.data()), raw.size());
+        while (tokenizer.next()) {
+            tokens++;
+        }
+    }
+    auto tokenizeOnlyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_THAT(regexFields, count * 10u);
+    EXPECT_THAT(tokenizerFields, count * 10u);
+    EXPECT_THAT(tokens, count * 11u);
+    RecordProperty("ResponseHeaderBytes", std::to_string(raw.size()));
+    RecordProperty("RegexNsPerParse", std::to_string(static_cast<long long>(regexNs / count)));
+    RecordProperty("HttpHeadersNsPerParse", std::to_string(static_cast<long long>(tokenizerNs / count)));
+    RecordProperty("TokenizeOnlyNsPerParse", std::to_string(static_cast<long long>(tokenizeOnlyNs / count)));
+}
@@ -55,7 +55,7 @@ TEST_F(HttpRequestEncoderTests, SetsAllParameters)
     EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
     ctx->compressed = false;
     ctx->body = { 1, 127, 255 };
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[TenantRegistry::Intern("tenant1-token")] = 0;
     ctx->latency = EventLatency_RealTime;
 
     encoder.encode(ctx);
@@ -90,6 +90,13 @@ TEST_F(HttpRequestEncoderTests, AddsCompressionHeader)
     ASSERT_THAT(ctx->httpRequestId, Eq("HttpRequestEncoderTests"));
     req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
     EXPECT_THAT(req->m_headers, Contains(Pair("Content-Encoding", "deflate")));
+
+    // Header follows the codec that compressed the body
+    ctx->contentEncoding = "zstd";
+    encoder.encode(ctx);
+    req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
+    EXPECT_THAT(req->m_headers, Contains(Pair("Content-Encoding", "zstd")));
+    EXPECT_THAT(req->m_headers, Not(Contains(Pair("Content-Encoding", "deflate"))));
 }
 
 TEST_F(HttpRequestEncoderTests, BuildsApiKeyCorrectly)
@@ -101,18 +108,19 @@ TEST_F(HttpRequestEncoderTests, BuildsApiKeyCorrectly)
     SimpleHttpRequest const* req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
     EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "")));
 
-    ctx->packageIds["tenant1-token"] = 0;
+    // Tokens are listed in the order they were first registered
+    ctx->packageIds[TenantRegistry::Intern("apikey-tenant1-token")] = 0;
     encoder.encode(ctx);
     ASSERT_THAT(ctx->httpRequestId, Eq("HttpRequestEncoderTests"));
     req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
-    EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "tenant1-token")));
+    EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "apikey-tenant1-token")));
 
-    ctx->packageIds["tenant2-token"] = 1;
-    ctx->packageIds["tenant3-token"] = 2;
+    ctx->packageIds[TenantRegistry::Intern("apikey-tenant2-token")] = 1;
+    ctx->packageIds[TenantRegistry::Intern("apikey-tenant3-token")] = 2;
     encoder.encode(ctx);
     ASSERT_THAT(ctx->httpRequestId, Eq("HttpRequestEncoderTests"));
     req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
-    EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "tenant1-token,tenant2-token,tenant3-token")));
+    EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "apikey-tenant1-token,apikey-tenant2-token,apikey-tenant3-token")));
 }
 
 TEST_F(HttpRequestEncoderTests, DispatchDataViewerEventCorrectly)
@@ -0,0 +1,306 @@
+// Copyright (c) Microsoft. All rights reserved.
+
+#include "common/Common.hpp"
+#include "system/IngestionQueue.hpp"
+#include "config/RuntimeConfig_Default.hpp"
+
+#include <algorithm>
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+/// Task dispatcher that only runs tasks when the test asks it to
+class ManualTaskDispatcher : public ITaskDispatcher
+{
+  public:
+    std::mutex         lock;
+    std::vector<Task*> tasks;
+
+    ~ManualTaskDispatcher()
+    {
+        for (Task* task : tasks)
+        {
+            delete task;
+        }
+    }
+
+    virtual void Join() override {}
+
+    virtual void Queue(Task* task) override
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(task);
+    }
+
+    virtual bool Cancel(Task* task, uint64_t) override
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = std::find(tasks.begin(), tasks.end(), task);
+        if (it != tasks.end())
+        {
+            delete *it;
+            tasks.erase(it);
+        }
+        return true;
+    }
+
+    size_t RunAll()
+    {
+        std::vector<Task*> pending;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            pending.swap(tasks);
+        }
+        for (Task* task : pending)
+        {
+            (*task)();
+            delete task;
+        }
+        return pending.size();
+    }
+};
+
+class CountingDebugEventDispatcher : public DebugEventDispatcher
+{
+  public:
+    std::atomic<unsigned> overflows{0};
+    std::atomic<unsigned> dropped{0};
+
+    virtual bool DispatchEvent(DebugEvent evt) override
+    {
+        if (evt.type == EVT_INGEST_OVERFLOW)
+            overflows++;
+        if (evt.type == EVT_DROPPED)
+            dropped++;
+        return true;
+    }
+};
+
+class IngestionQueueTests : public Test
+{
+  protected:
+    ILogConfiguration                                         logConfig;
+    std::unique_ptr<RuntimeConfig_Default>                    config;
+    ManualTaskDispatcher                                      dispatcher;
+    CountingDebugEventDispatcher                              debugEvents;
+    std::unique_ptr<IngestionQueue>                           queue;
+    std::vector<StorageRecordId>                              stored;
+    RouteSink<IngestionQueueTests, IncomingEventContextPtr const&> dequeued{this, &IngestionQueueTests::onDequeued};
+
+    void onDequeued(IncomingEventContextPtr const& event)
+    {
+        stored.push_back(event->record.id);
+    }
+
+    void createQueue(int queueSize, int batchSize, const char* backpressure)
+    {
+        logConfig[CFG_MAP_INGEST][CFG_INT_INGEST_QUEUE_SIZE] = queueSize;
+        logConfig[CFG_MAP_INGEST][CFG_INT_INGEST_BATCH_SIZE] = batchSize;
+        logConfig[CFG_MAP_INGEST][CFG_STR_INGEST_BACKPRESSURE] = backpressure;
+        config.reset(new RuntimeConfig_Default(logConfig));
+        queue.reset(new IngestionQueue(*config, dispatcher, debugEvents));
+        queue->dequeued >> dequeued;
+    }
+
+    bool push(StorageRecordId id)
+    {
+        IncomingEventContext ctx("tenant", EventLatency_Normal, EventPersistence_Normal, nullptr);
+        ctx.record.id = id;
+        ctx.record.blob.assign(8, 0x5a);
+        IncomingEventContextPtr event = &ctx;
+        bool accepted = queue->Push(event);
+        if (!accepted)
+        {
+            // Record payload stays with the caller for synchronous storage
+            EXPECT_THAT(ctx.record.id, Eq(id));
+            EXPECT_THAT(ctx.record.blob.size(), Eq(size_t { 8 }));
+        }
+        return accepted;
+    }
+};
+
+TEST(MpscRingBufferTests, CapacityIsRoundedUpToPowerOfTwo)
+{
+    MpscRingBuffer<int> ring(5);
+    EXPECT_THAT(ring.Capacity(), Eq(size_t { 8 }));
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_TRUE(ring.TryPush(std::move(i)));
+    }
+    int extra = 8;
+    EXPECT_FALSE(ring.TryPush(std::move(extra)));
+
+    int value = -1;
+    for (int i = 0; i < 8; i++)
+    {
+        ASSERT_TRUE(ring.TryPop(value));
+        EXPECT_THAT(value, Eq(i));
+    }
+    EXPECT_FALSE(ring.TryPop(value));
+    EXPECT_TRUE(ring.Empty());
+}
+
+TEST(MpscRingBufferTests, MultipleProducersDeliverEveryItemOnce)
+{
+    const int producers = 4;
+    const int perProducer = 20000;
+    MpscRingBuffer<int> ring(256);
+    std::vector<int> seen(producers * perProducer, 0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&ring, p, perProducer]()
+        {
+            for (int i = 0; i < perProducer; i++)
+            {
+                int value = p * perProducer + i;
+                while (!ring.TryPush(std::move(value)))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int received = 0;
+    int lastFromProducer[producers] = { -1, -1, -1, -1 };
+    while (received < producers * perProducer)
+    {
+        int value;
+        if (ring.TryPop(value))
+        {
+            seen[value]++;
+            // Items from one producer keep their order
+            int p = value / perProducer;
+            EXPECT_THAT(value, Gt(lastFromProducer[p]));
+            lastFromProducer[p] = value;
+            received++;
+        }
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_THAT(std::count(seen.begin(), seen.end(), 1), Eq(producers * perProducer));
+}
+
+TEST_F(IngestionQueueTests, DisabledByDefault)
+{
+    config.reset(new RuntimeConfig_Default(logConfig));
+    queue.reset(new IngestionQueue(*config, dispatcher, debugEvents));
+    EXPECT_FALSE(queue->IsEnabled());
+    EXPECT_FALSE(push(1));
+    EXPECT_THAT(dispatcher.tasks, IsEmpty());
+}
+
+TEST_F(IngestionQueueTests, DrainsInBatchesOnTaskDispatcher)
+{
+    createQueue(16, 2, "spill");
+    EXPECT_TRUE(push(1));
+    EXPECT_TRUE(push(2));
+    EXPECT_TRUE(push(3));
+    // A single drain task is scheduled however many events are queued
+    EXPECT_THAT(dispatcher.tasks.size(), Eq(size_t { 1 }));
+    EXPECT_THAT(stored, IsEmpty());
+
+    dispatcher.RunAll();
+    EXPECT_THAT(stored, ElementsAre(1u, 2u));
+    // Remaining events are picked up by a follow-up task
+    EXPECT_THAT(dispatcher.tasks.size(), Eq(size_t { 1 }));
+
+    dispatcher.RunAll();
+    EXPECT_THAT(stored, ElementsAre(1u, 2u, 3u));
+    EXPECT_THAT(dispatcher.tasks, IsEmpty());
+    EXPECT_THAT(queue->Size(), Eq(size_t { 0 }));
+}
+
+TEST_F(IngestionQueueTests, SpillReturnsEventToCaller)
+{
+    createQueue(2, 16, "spill");
+    EXPECT_TRUE(push(1));
+    EXPECT_TRUE(push(2));
+    EXPECT_FALSE(push(3));
+    EXPECT_THAT(debugEvents.overflows.load(), Eq(1u));
+    EXPECT_THAT(debugEvents.dropped.load(), Eq(0u));
+
+    dispatcher.RunAll();
+    EXPECT_THAT(stored, ElementsAre(1u, 2u));
+}
+
+TEST_F(IngestionQueueTests, DropDiscardsEventAndReportsIt)
+{
+    createQueue(2, 16, "drop");
+    EXPECT_TRUE(push(1));
+    EXPECT_TRUE(push(2));
+    EXPECT_TRUE(push(3));
+    EXPECT_THAT(debugEvents.overflows.load(), Eq(1u));
+    EXPECT_THAT(debugEvents.dropped.load(), Eq(1u));
+
+    dispatcher.RunAll();
+    EXPECT_THAT(stored, ElementsAre(1u, 2u));
+}
+
+TEST_F(IngestionQueueTests, BlockDrainsOnProducerWhenConsumerIsIdle)
+{
+    createQueue(2, 1, "block");
+    EXPECT_TRUE(push(1));
+    EXPECT_TRUE(push(2));
+    EXPECT_TRUE(push(3));
+    EXPECT_THAT(debugEvents.overflows.load(), Eq(0u));
+    EXPECT_THAT(stored, ElementsAre(1u));
+
+    dispatcher.RunAll();
+    dispatcher.RunAll();
+    EXPECT_THAT(stored, ElementsAre(1u, 2u, 3u));
+}
+
+TEST_F(IngestionQueueTests, StopFlushesAndRejectsNewEvents)
+{
+    createQueue(16, 1, "spill");
+    EXPECT_TRUE(push(1));
+    EXPECT_TRUE(push(2));
+    queue->Stop();
+    EXPECT_THAT(stored, ElementsAre(1u, 2u));
+    EXPECT_THAT(dispatcher.tasks, IsEmpty());
+    EXPECT_FALSE(push(3));
+}
+
+TEST_F(IngestionQueueTests, StopForwardsEveryEventAcceptedWhileStopping)
+{
+    createQueue(8192, 16, "spill");
+    const int producers = 4;
+    const int perProducer = 2000;
+    std::atomic<int> accepted(0);
+    std::atomic<int> started(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&, p]() {
+            started++;
+            for (int i = 0; i < perProducer; i++)
+            {
+                if (push(p * perProducer + i + 1))
+                {
+                    accepted++;
+                }
+            }
+        });
+    }
+    while (started < producers)
+    {
+        std::this_thread::yield();
+    }
+    queue->Stop();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Nothing accepted is left behind in the ring, and no drain outlives Stop()
+    EXPECT_THAT(stored.size(), Eq(static_cast<size_t>(accepted.load())));
+    EXPECT_THAT(queue->Size(), Eq(size_t { 0 }));
+    EXPECT_THAT(dispatcher.tasks, IsEmpty());
+}
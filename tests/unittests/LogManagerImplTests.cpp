@@ -4,6 +4,8 @@
 //
 #include "api/LogManagerImpl.hpp"
 #include "common/Common.hpp"
+#include "config/RuntimeConfig_Default.hpp"
+#include "system/TelemetrySystemBase.hpp"
 
 using namespace testing;
 using namespace MAT;
@@ -81,6 +83,26 @@ TEST(LogManagerImplTests, DeadLoggersAreDead)
     logger->LogEvent("DeadLoggerEvent");
 }
 
+TEST(LogManagerImplTests, TelemetrySystemAssignsIncreasingRecordIds)
+{
+    ILogConfiguration configuration;
+    auto httpClient = std::make_shared<TestHttpClient>();
+    configuration.AddModule(CFG_MODULE_HTTP_CLIENT, httpClient);
+    TestLogManagerImpl logManager{configuration, true};
+    RuntimeConfig_Default config(configuration);
+    TelemetrySystemBase system(logManager, config, *PAL::getDefaultTaskDispatcher());
+
+    IncomingEventContext first("token", EventLatency_Normal, EventPersistence_Normal, nullptr);
+    IncomingEventContext second("token", EventLatency_Normal, EventPersistence_Normal, nullptr);
+    EXPECT_EQ(0u, first.record.id);
+    system.sendEvent(&first);
+    system.sendEvent(&second);
+
+    // 0 is not a valid ID
+    EXPECT_EQ(1u, first.record.id);
+    EXPECT_EQ(first.record.id + 1, second.record.id);
+}
+
 class LogManagerModuleTests : public ::testing::Test
 {
    public:
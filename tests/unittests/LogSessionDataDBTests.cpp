@@ -98,3 +98,24 @@ TEST_F(LogSessionDataDBTests, subTest) {
 #endif
 }
 
+
+TEST_F(LogSessionDataDBTests, StoreRecordsReportsKilledTenantInTheMiddleOfABatch)
+{
+    // The collector kills one tenant in the response to an upload
+    HttpHeaders headers;
+    headers.add("kill-tokens", "killed-tenant-token");
+    headers.add("kill-duration", "3600");
+    bool fromMemory = true;
+    offlineStorage->DeleteRecords({ 999 }, headers, fromMemory);
+
+    StorageRecordVector records;
+    records.emplace_back(1, "live-tenant-token", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob { 1 });
+    records.emplace_back(2, "killed-tenant-token", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob { 2 });
+    records.emplace_back(3, "live-tenant-token", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob { 3 });
+    EXPECT_THAT(offlineStorage->StoreRecords(records), ElementsAre(true, false, true));
+    EXPECT_EQ(2u, offlineStorage->GetRecordCount(EventLatency_Unspecified));
+
+    // Shutdown flushes the live records to disk
+    EXPECT_CALL(observerMock, OnStorageRecordsSaved(2u))
+        .WillOnce(Return());
+}
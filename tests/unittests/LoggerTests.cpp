@@ -4,6 +4,11 @@
 //
 #include "common/Common.hpp"
 #include "api/Logger.hpp"
+#include "FlatMap.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 using namespace testing;
 using namespace MAT;
@@ -21,9 +26,59 @@ public:
     using Logger::CanEventPropertiesBeSent;
 
     bool SubmitCalled = {};
-    void submit(::CsProtocol::Record&, const EventProperties&) override
+    ::CsProtocol::Record LastRecord;
+    void submit(::CsProtocol::Record& record, const EventProperties&, bool) override
     {
         SubmitCalled = true;
+        LastRecord = std::move(record);
+    }
+};
+
+// Counts submits from many threads, and the ones that started after shut-down completed
+class CountingLogger : public Logger
+{
+public:
+    CountingLogger(ILogManagerInternal& logManager,
+        ContextFieldsProvider& parentContext,
+        IRuntimeConfig& runtimeConfig) noexcept
+        : Logger("", "", "", logManager, parentContext, runtimeConfig) { }
+
+    std::atomic<size_t> Submitted { 0 };
+    std::atomic<size_t> SubmittedAfterShutdown { 0 };
+    std::atomic<bool> ShutdownDone { false };
+    void submit(::CsProtocol::Record&, const EventProperties&, bool) override
+    {
+        if (ShutdownDone)
+        {
+            SubmittedAfterShutdown++;
+        }
+        // Stay inside the call for a while so shut-down has calls to wait for
+        std::this_thread::yield();
+        Submitted++;
+    }
+};
+
+class TestLogManager : public LogManagerImpl
+{
+public:
+    TestLogManager(ILogConfiguration& configuration)
+        : LogManagerImpl(configuration) { }
+
+    size_t SendEventCalls = 0;
+    size_t SendEventsCalls = 0;
+    std::vector<std::string> SentNames;
+    void sendEvent(IncomingEventContextPtr const& event) override
+    {
+        SendEventCalls++;
+        SentNames.push_back(event->source->name);
+    }
+    void sendEvents(std::vector<IncomingEventContextPtr> const& events) override
+    {
+        SendEventsCalls++;
+        for (auto const& event : events)
+        {
+            SentNames.push_back(event->source->name);
+        }
     }
 };
 
@@ -37,7 +92,7 @@ public:
     { }
 
     ILogConfiguration configuration;
-    LogManagerImpl logManager;
+    TestLogManager logManager;
     ContextFieldsProvider contextFieldsProvider;
     RuntimeConfig_Default runtimeConfig;
     TestLogger logger;
@@ -62,6 +117,15 @@ protected:
     {
         return std::unique_ptr<LoggerTestEventFilter>(new LoggerTestEventFilter(returnValue));
     }
+
+    class NameEventFilter : public IEventFilter
+    {
+    public:
+        NameEventFilter(std::string blockedName) : BlockedName(std::move(blockedName)) { }
+        const char* GetName() const noexcept override { return "NameEventFilter"; }
+        std::string BlockedName;
+        bool CanEventPropertiesBeSent(const EventProperties& properties) const noexcept override { return properties.GetName() != BlockedName; }
+    };
 };
 
 TEST_F(LoggerTests, CanEventPropertiesBeSent_NoFiltersInLoggerOrLogManager_ReturnsTrue)
@@ -324,4 +388,219 @@ TEST_F(LoggerTests, LogSession_CanEventPropertiesBeSentReturnsTrue_CallsSubmit)
     EXPECT_TRUE(logger.SubmitCalled);
 }
 
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST_F(LoggerTests, DISABLED_LogEvent_BuildAndLogThroughput)
+{
+    // Build a typical event and hand it to the logger, as an app would
+    const size_t count = 20000;
+    for (bool reserve : { false, true })
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++)
+        {
+            EventProperties props("App.Benchmark.Event");
+            if (reserve)
+            {
+                props.reserve(24);
+            }
+            props.SetProperty("Page", "https://www.example.com/some/page/path");
+            props.SetProperty("Referrer", "https://www.example.com/");
+            props.SetProperty("Session", "7d3c2b6a-5f4e-4d3c-9b2a-1f0e9d8c7b6a");
+            props.SetProperty("Component", "Benchmark");
+            props.SetProperty("Action", "Click");
+            props.SetProperty("Target", "SubmitButton");
+            props.SetProperty("Result", "Success");
+            props.SetProperty("Market", "en-US");
+            props.SetProperty("Count", static_cast<int64_t>(i));
+            props.SetProperty("Duration", 12.5);
+            props.SetProperty("Retries", int64_t { 0 });
+            props.SetProperty("Flag", true);
+            props.SetProperty("Width", int64_t { 1920 });
+            props.SetProperty("Height", int64_t { 1080 });
+            props.SetProperty("Latency", 0.25);
+            props.SetProperty("Build", "1.2.3.4");
+            props.SetProperty("Channel", "Production");
+            props.SetProperty("Experiment", "ControlGroup");
+            props.SetProperty("UserType", "Anonymous");
+            props.SetProperty("Zoom", int64_t { 100 });
+            logger.LogEvent(props);
+        }
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_TRUE(logger.SubmitCalled);
+        std::string name = reserve ? "Reserved" : "Unreserved";
+        RecordProperty(name + "Us", std::to_string(elapsedUs));
+        RecordProperty(name + "EventsPerSec", std::to_string(count * 1000000 / std::max<long long>(elapsedUs, 1)));
+    }
+}
 
+TEST_F(LoggerTests, LogEvent_Rvalue_MovesArrayValuesIntoRecord)
+{
+    std::vector<std::string> stack;
+    for (int i = 0; i < 1000; i++)
+    {
+        stack.push_back("frame #" + std::to_string(i) + " in some/long/source/path/File.cpp");
+    }
+    // Part B keeps the property out of direct serialization, so the decorator builds the record value
+    EventProperties copied("App.Crash");
+    copied.SetProperty("Stack", stack, PiiKind_None, DataCategory_PartB);
+    EventProperties moved(copied);
+
+    // The vector buffer holding the frames of each source
+    std::string const* copiedFrames = copied.GetPropertiesFlat().at("Stack").as_stringArray->data();
+    std::string const* movedFrames = moved.GetPropertiesFlat().at("Stack").as_stringArray->data();
+
+    logger.LogEvent(copied);
+    ASSERT_THAT(logger.LastRecord.baseData, SizeIs(1));
+    std::vector<std::string> const& copiedRecordStack = logger.LastRecord.baseData[0].properties.at("Stack").stringArray[0];
+    EXPECT_THAT(copiedRecordStack, Eq(stack));
+    // Copying allocates every frame again
+    EXPECT_THAT(copiedRecordStack.data(), Ne(copiedFrames));
+
+    logger.LogEvent(std::move(moved));
+    ASSERT_THAT(logger.LastRecord.baseData, SizeIs(1));
+    std::vector<std::string> const& movedRecordStack = logger.LastRecord.baseData[0].properties.at("Stack").stringArray[0];
+    EXPECT_THAT(movedRecordStack, Eq(stack));
+    // Moving takes the array over whole
+    EXPECT_THAT(movedRecordStack.data(), Eq(movedFrames));
+
+    EXPECT_THAT(*moved.GetPropertiesFlat().at("Stack").as_stringArray, IsEmpty());
+    EXPECT_THAT(*copied.GetPropertiesFlat().at("Stack").as_stringArray, Eq(stack));
+}
+
+TEST_F(LoggerTests, LogEvents_SendsEventsAsOneBatch)
+{
+    std::vector<EventProperties> events { EventProperties("Event.A"), EventProperties("Event.B"), EventProperties("Event.C") };
+    logger.LogEvents(events);
+    EXPECT_THAT(logManager.SendEventsCalls, Eq(1u));
+    EXPECT_THAT(logManager.SendEventCalls, Eq(0u));
+    EXPECT_THAT(logManager.SentNames, ElementsAre("Event.A", "Event.B", "Event.C"));
+}
+
+TEST_F(LoggerTests, LogEvents_FilteredEventsAreLeftOut)
+{
+    logger.GetEventFilters().RegisterEventFilter(std::unique_ptr<IEventFilter>(new NameEventFilter("Event.B")));
+    logManager.GetEventFilters().RegisterEventFilter(std::unique_ptr<IEventFilter>(new NameEventFilter("Event.C")));
+    EventProperties off("Event.D");
+    off.SetLatency(EventLatency_Off);
+    std::vector<EventProperties> events { EventProperties("Event.A"), EventProperties("Event.B"), EventProperties("Event.C"), off };
+    logger.LogEvents(events);
+    EXPECT_THAT(logManager.SentNames, ElementsAre("Event.A"));
+}
+
+TEST_F(LoggerTests, LogEvents_AllFilteredSendsNothing)
+{
+    logger.GetEventFilters().RegisterEventFilter(MakeTestEventFilter(false));
+    std::vector<EventProperties> events { EventProperties("Event.A"), EventProperties("Event.B") };
+    logger.LogEvents(events);
+    EXPECT_THAT(logManager.SendEventsCalls, Eq(0u));
+    EXPECT_THAT(logManager.SentNames, IsEmpty());
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST_F(LoggerTests, DISABLED_LogEvents_BatchThroughput)
+{
+    // The same events logged one by one and as batches of 100
+    const size_t count = 20000;
+    const size_t batchSize = 100;
+    std::vector<EventProperties> events;
+    for (size_t i = 0; i < batchSize; i++)
+    {
+        EventProperties props("App.Benchmark.Event");
+        props.SetProperty("Page", "https://www.example.com/some/page/path");
+        props.SetProperty("Action", "Click");
+        props.SetProperty("Count", static_cast<int64_t>(i));
+        props.SetProperty("Duration", 12.5);
+        events.push_back(props);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        logger.LogEvent(events[i % batchSize]);
+    }
+    auto singleUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i += batchSize)
+    {
+        logger.LogEvents(events);
+    }
+    auto batchUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_THAT(logManager.SendEventsCalls, Eq(count / batchSize));
+    RecordProperty("LogEventUs", std::to_string(singleUs));
+    RecordProperty("LogEventsUs", std::to_string(batchUs));
+}
+
+TEST_F(LoggerTests, RecordShutdown_RacingLogEvent_WaitsForCallsInProgress)
+{
+    const size_t threadCount = 4;
+    for (int round = 0; round < 20; round++)
+    {
+        CountingLogger counting(logManager, contextFieldsProvider, runtimeConfig);
+        std::atomic<bool> start { false };
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&counting, &start]() {
+                while (!start)
+                {
+                    std::this_thread::yield();
+                }
+                EventProperties props("App.Stress");
+                for (int i = 0; i < 500; i++)
+                {
+                    counting.LogEvent(props);
+                    counting.GetSemanticContext();
+                }
+            });
+        }
+        start = true;
+        std::this_thread::sleep_for(std::chrono::microseconds(round * 50));
+        counting.RecordShutdown();
+        counting.ShutdownDone = true;
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        // Nothing runs inside the logger once RecordShutdown() returned
+        EXPECT_THAT(counting.SubmittedAfterShutdown.load(), Eq(0u));
+        EXPECT_THAT(counting.Submitted.load(), Le(threadCount * 500));
+        counting.LogEvent(EventProperties("App.AfterShutdown"));
+        EXPECT_THAT(counting.SubmittedAfterShutdown.load(), Eq(0u));
+    }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST_F(LoggerTests, DISABLED_LogEvent_FromManyThreadsThroughput)
+{
+    // Contended logger entry from several threads
+    const size_t threadCount = 4;
+    const size_t count = 5000;
+    CountingLogger counting(logManager, contextFieldsProvider, runtimeConfig);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&counting, count]() {
+            EventProperties props("App.Benchmark.Event");
+            props.SetProperty("Action", "Click");
+            for (size_t i = 0; i < count; i++)
+            {
+                counting.LogEvent(props);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_THAT(counting.Submitted.load(), Eq(threadCount * count));
+    RecordProperty("ElapsedUs", std::to_string(elapsedUs));
+    RecordProperty("EventsPerSec", std::to_string(threadCount * count * 1000000 / std::max<long long>(elapsedUs, 1)));
+}
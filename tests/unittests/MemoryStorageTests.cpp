@@ -6,6 +6,7 @@
 #include "utils/Utils.hpp"
 
 #include "offline/MemoryStorage.hpp"
+#include "system/TenantRegistry.hpp"
 #include "config/RuntimeConfig_Default.hpp"
 #include "NullObjects.hpp"
 
@@ -20,6 +21,7 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <chrono>
 
 using namespace testing;
 using namespace MAT;
@@ -86,6 +88,9 @@ std::set<EventLatency> latencies =
 
 constexpr size_t num_iterations = 10000;
 
+// Record IDs are unique per telemetry system, same for the tests
+static StorageRecordId lastRecordId = 0;
+
 /// <summary>
 /// Adds events of various latencies to storage
 /// </summary>
@@ -99,7 +104,7 @@ size_t addEvents(MemoryStorage& storage)
     {
         for (const EventLatency &lat : latencies)
         {
-            StorageRecord record{ PAL::generateUuidString(), "token", lat, EventPersistence_Critical, INT64_MIN + 1, { 5, 4, 3, 2, 1 }, 77, INT64_MAX - 1 };
+            StorageRecord record{ ++lastRecordId, "token", lat, EventPersistence_Critical, INT64_MIN + 1, { 5, 4, 3, 2, 1 }, 77, INT64_MAX - 1 };
             total_db_size += record.blob.size() + sizeof(record);
             storage.StoreRecord(record);
         }
@@ -125,7 +130,7 @@ TEST(MemoryStorageTests, StoreAndGetRecords)
     EXPECT_THAT(storage.GetSize(), 0);
     
     // Check that EventLatency_Off doesn't get saved to ram queue
-    StorageRecord record{ PAL::generateUuidString(), "token", EventLatency_Off, EventPersistence_Critical, INT64_MIN + 1, { 5, 4, 3, 2, 1 }, 77, INT64_MAX - 1 };
+    StorageRecord record{ ++lastRecordId, "token", EventLatency_Off, EventPersistence_Critical, INT64_MIN + 1, { 5, 4, 3, 2, 1 }, 77, INT64_MAX - 1 };
     EXPECT_THAT(storage.StoreRecord(record), false);
     EXPECT_THAT(storage.GetSize(), 0);
 
@@ -270,6 +275,143 @@ TEST(MemoryStorageTests, GetAndReserveSome)
     EXPECT_EQ(totalCount - howMany, storage.GetRecordCount());
 }
 
+TEST(MemoryStorageTests, GetAndReserveRecordRefsLendsStoredRecords)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    auto total_db_size = addEvents(storage);
+    auto total_records = storage.GetRecordCount();
+
+    std::vector<StorageRecordId> ids;
+    std::set<StorageRecord const*> lent;
+    storage.GetAndReserveRecordRefs([&](StorageRecord const& record) -> bool {
+        EXPECT_THAT(record.blob, ElementsAre(5, 4, 3, 2, 1));
+        EXPECT_THAT(record.reservedUntil, Gt(0));
+        lent.insert(&record);
+        ids.push_back(record.id);
+        return true;
+    }, 1500);
+    EXPECT_THAT(lent.size(), total_records);
+    EXPECT_THAT(storage.GetReservedCount(), total_records);
+    EXPECT_THAT(storage.GetSize(), 0);
+
+    // Reserved records still hold their blobs, releasing them does not copy
+    HttpHeaders headers;
+    bool fromMemory = true;
+    storage.ReleaseRecords(ids, true, headers, fromMemory);
+    EXPECT_THAT(storage.GetSize(), total_db_size);
+    EXPECT_THAT(storage.GetReservedCount(), 0);
+
+    auto records = storage.GetRecords();
+    ASSERT_THAT(records.size(), total_records);
+    for (auto const& record : records)
+    {
+        EXPECT_THAT(record.retryCount, 78);
+        EXPECT_THAT(record.reservedUntil, 0);
+        EXPECT_THAT(record.blob.size(), 5u);
+    }
+}
+
+TEST(MemoryStorageTests, DeleteQueuedAndReservedRecordsById)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    std::vector<StorageRecordId> ids;
+    for (int i = 0; i < 10; i++)
+    {
+        StorageRecord record{ static_cast<StorageRecordId>(i + 1), "token", EventLatency_Normal, EventPersistence_Normal, 0, { 1, 2, 3 } };
+        storage.StoreRecord(record);
+        ids.push_back(record.id);
+    }
+    size_t recordSize = storage.GetSize() / 10;
+
+    // Newest records are read first
+    std::vector<StorageRecordId> reserved;
+    storage.GetAndReserveRecords([&reserved](StorageRecord&& record) -> bool {
+        reserved.push_back(record.id);
+        return true;
+    }, 1500, EventLatency_Unspecified, 3);
+    EXPECT_THAT(reserved, ElementsAre(10u, 9u, 8u));
+
+    HttpHeaders headers;
+    bool fromMemory = true;
+    storage.DeleteRecords({ 9, 3, 6, 1000 }, headers, fromMemory);
+    EXPECT_THAT(storage.GetReservedCount(), 2u);
+    EXPECT_THAT(storage.GetRecordCount(), 5u);
+    EXPECT_THAT(storage.GetSize(), 5 * recordSize);
+
+    // Queued records are not affected by release
+    storage.ReleaseRecords({ 10, 1 }, false, headers, fromMemory);
+    EXPECT_THAT(storage.GetReservedCount(), 1u);
+    EXPECT_THAT(storage.GetRecordCount(), 6u);
+
+    storage.DeleteRecords({ { "record_id", "8" } });
+    storage.DeleteRecords({ { "record_id", "2" } });
+    EXPECT_THAT(storage.GetReservedCount(), 0u);
+
+    // Freed slots are reused
+    StorageRecord record{ 100, "token", EventLatency_RealTime, EventPersistence_Normal, 0, { 1, 2, 3 } };
+    storage.StoreRecord(record);
+
+    std::vector<StorageRecordId> remaining;
+    for (auto const& r : storage.GetRecords())
+    {
+        remaining.push_back(r.id);
+    }
+    EXPECT_THAT(remaining, ElementsAre(100u, 10u, 7u, 5u, 4u, 1u));
+    EXPECT_THAT(storage.GetSize(), 0u);
+}
+
+TEST(MemoryStorageTests, StoreRecordReplacesSameId)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    StorageRecord record{ 1, "token", EventLatency_Normal, EventPersistence_Normal, 0, { 1 } };
+    storage.StoreRecord(record);
+    record.blob = { 1, 2 };
+    storage.StoreRecord(record);
+    EXPECT_THAT(storage.GetRecordCount(), 1u);
+
+    auto records = storage.GetRecords();
+    ASSERT_THAT(records.size(), 1u);
+    EXPECT_THAT(records[0].blob, ElementsAre(1, 2));
+}
+
+TEST(MemoryStorageTests, StoresTenantIdAndRestoresToken)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    StorageRecord byToken{ 1, "memory-tenant-a", EventLatency_Normal, EventPersistence_Normal, 0, { 1 } };
+    StorageRecord byId{ 2, "", EventLatency_Normal, EventPersistence_Normal, 0, { 2 } };
+    byId.tenantId = TenantRegistry::Intern("memory-tenant-b");
+    storage.StoreRecord(byToken);
+    storage.StoreRecord(byId);
+
+    std::map<StorageRecordId, std::string> tokens;
+    storage.GetAndReserveRecords([&tokens](StorageRecord&& record) -> bool {
+        EXPECT_THAT(record.tenantId, TenantRegistry::Find(record.tenantToken));
+        tokens[record.id] = record.tenantToken;
+        return true;
+    }, 1500);
+    EXPECT_THAT(tokens, ElementsAre(Pair(1u, "memory-tenant-a"), Pair(2u, "memory-tenant-b")));
+
+    HttpHeaders headers;
+    bool fromMemory = true;
+    storage.ReleaseRecords({ 1, 2 }, false, headers, fromMemory);
+    storage.DeleteRecords({ { "tenant_token", "memory-tenant-a" } });
+    auto records = storage.GetRecords();
+    ASSERT_THAT(records.size(), 1u);
+    EXPECT_THAT(records[0].id, 2u);
+}
+
+TEST(MemoryStorageTests, StoreRecordsStoresBatchAndSkipsLatencyOff)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    StorageRecordVector records;
+    records.push_back(StorageRecord{ 1, "token", EventLatency_Normal, EventPersistence_Normal, 0, { 1 } });
+    records.push_back(StorageRecord{ 2, "token", EventLatency_Off, EventPersistence_Normal, 0, { 2 } });
+    records.push_back(StorageRecord{ 3, "token", EventLatency_RealTime, EventPersistence_Normal, 0, { 3 } });
+    EXPECT_THAT(storage.StoreRecords(records), ElementsAre(true, false, true));
+    EXPECT_THAT(storage.GetRecordCount(), 2u);
+    EXPECT_THAT(storage.GetRecordCount(EventLatency_RealTime), 1u);
+}
+
 // This method is not implemented for RAM storage
 TEST(MemoryStorageTests, StoreSetting)
 {
@@ -354,3 +496,114 @@ TEST(MemoryStorageTests, MultiThreadPerfTest)
 
 }
 
+
+namespace {
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// <summary>
+    /// Runs the addEvents() workload through the upload cycle: reserve in
+    /// packages, delete sent packages, release every fourth one for a retry,
+    /// then deletes queued records by ID one at a time. Borrowing is how
+    /// StorageObserver reads records for the packager.
+    /// </summary>
+    void benchmarkUploadCycle(size_t blobSize, bool borrow)
+    {
+        MemoryStorage storage(testLogManager, testConfig);
+        std::vector<uint8_t> blob(blobSize, 0x5a);
+        HttpHeaders headers;
+        bool fromMemory = true;
+
+        std::vector<StorageRecord> records;
+        for (size_t i = 0; i < num_iterations; i++)
+        {
+            for (const EventLatency &lat : latencies)
+            {
+                records.push_back({ ++lastRecordId, "token", lat, EventPersistence_Critical, 0, std::vector<uint8_t>(blob) });
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (auto const& record : records)
+        {
+            storage.StoreRecord(record);
+        }
+        double storeMs = elapsedMs(start);
+        size_t total = storage.GetRecordCount();
+
+        start = std::chrono::steady_clock::now();
+        size_t packages = 0;
+        std::vector<StorageRecordId> ids;
+        auto consumer = [&ids](StorageRecord&& record) -> bool {
+            ids.push_back(record.id);
+            return true;
+        };
+        auto borrower = [&ids](StorageRecord const& record) -> bool {
+            ids.push_back(record.id);
+            return true;
+        };
+        while (storage.GetRecordCount() > 0)
+        {
+            ids.clear();
+            if (borrow)
+            {
+                storage.GetAndReserveRecordRefs(borrower, 120000, EventLatency_Unspecified, 500);
+            }
+            else
+            {
+                storage.GetAndReserveRecords(consumer, 120000, EventLatency_Unspecified, 500);
+            }
+            if (++packages % 4 == 0 && packages < 40)
+            {
+                storage.ReleaseRecords(ids, true, headers, fromMemory);
+            }
+            else
+            {
+                storage.DeleteRecords(ids, headers, fromMemory);
+            }
+        }
+        double uploadMs = elapsedMs(start);
+        EXPECT_THAT(storage.GetReservedCount(), 0u);
+
+        // Deleting queued records by ID, as the kill-switch and flush paths do
+        for (size_t i = 0; i < 1000; i++)
+        {
+            StorageRecord record{ ++lastRecordId, "token", EventLatency_Normal, EventPersistence_Normal, 0, std::vector<uint8_t>(blob) };
+            storage.StoreRecord(record);
+            ids.push_back(record.id);
+        }
+        for (size_t i = 0; i < 30000; i++)
+        {
+            StorageRecord record{ ++lastRecordId, "token", EventLatency_Normal, EventPersistence_Normal, 0, std::vector<uint8_t>(blob) };
+            storage.StoreRecord(record);
+        }
+        start = std::chrono::steady_clock::now();
+        for (auto const& id : ids)
+        {
+            storage.DeleteRecords({ id }, headers, fromMemory);
+        }
+        double deleteMs = elapsedMs(start);
+        EXPECT_THAT(storage.GetRecordCount(), 30000u);
+
+        // Reported through the test properties of the XML report
+        std::string name = std::string(borrow ? "Borrowed" : "Copied") + std::to_string(blobSize) + "ByteBlobs";
+        ::testing::Test::RecordProperty(name + "Records", std::to_string(total));
+        ::testing::Test::RecordProperty(name + "StoreMs", std::to_string(storeMs));
+        ::testing::Test::RecordProperty(name + "UploadCycleMs", std::to_string(uploadMs));
+        ::testing::Test::RecordProperty(name + "Packages", std::to_string(packages));
+        ::testing::Test::RecordProperty(name + "DeleteQueuedByIdMs", std::to_string(deleteMs));
+    }
+
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests
+TEST(MemoryStorageTests, DISABLED_BenchmarkUploadCycle)
+{
+    for (bool borrow : { false, true })
+    {
+        benchmarkUploadCycle(5, borrow);
+        benchmarkUploadCycle(1024, borrow);
+    }
+}
@@ -6,6 +6,7 @@
 #include "common/Common.hpp"
 #include "common/MockIRuntimeConfig.hpp"
 #include "stats/MetaStats.hpp"
+#include "system/TenantRegistry.hpp"
 
 using namespace testing;
 using namespace MAT;
@@ -45,8 +46,8 @@ TEST_F(MetaStatsTests, GenerateStartEvent)
     stats.updateOnStorageOpened("MyStorage/Normal");
     stats.updateOnPostData(postDataLength, false);
 
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
+    std::map<StorageRecordId, TenantId> recordIdAndTenantid;
+    recordIdAndTenantid[1] = TenantRegistry::Intern("t");
     stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Normal,        0,   333, std::vector<unsigned>{ 1333 },          false);
     stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Normal,     1,   444, std::vector<unsigned>{ 1444, 2444 },    false);
     stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime,       3,  5555, std::vector<unsigned>{ 15, 255, 3555 }, false);
@@ -73,8 +74,8 @@ TEST_F(MetaStatsTests, GenerateStopEvent)
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsSendIntervalSec()).WillRepeatedly(Return(0));
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsTenantToken()).WillRepeatedly(Return("metastats-tenant-token"));
     stats.updateOnPostData(16, false);
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
+    std::map<StorageRecordId, TenantId> recordIdAndTenantid;
+    recordIdAndTenantid[1] = TenantRegistry::Intern("t");
     stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime, 1, 99, std::vector<unsigned>{ 100, 101, 102, 103, 104, 105, 106 }, false);
     stats.updateOnPackageFailed(501);
     stats.updateOnPackageFailed(403);
@@ -106,8 +107,8 @@ TEST_F(MetaStatsTests, NoNewDataOrMetastatsOnlyGenerateNoEvents)
     stats.updateOnEventIncoming("s",123, EventLatency_RealTime, true);
     stats.updateOnEventIncoming("s",123, EventLatency_Normal, true);
     stats.updateOnPostData(123, true);
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
+    std::map<StorageRecordId, TenantId> recordIdAndTenantid;
+    recordIdAndTenantid[1] = TenantRegistry::Intern("t");
     stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime, 0, 123, std::vector<unsigned>{ 1234 }, true);
     events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_ONGOING);
     //EXPECT_THAT(events, SizeIs(0));
@@ -124,3 +125,21 @@ TEST_F(MetaStatsTests, NoNewDataOrMetastatsOnlyGenerateNoEvents)
     //EXPECT_THAT(events[0].Extension, Contains(Pair("requests_acked_succeeded", "1")));
 }
 
+TEST_F(MetaStatsTests, ReportsCompressorReuse)
+{
+    EXPECT_CALL(runtimeConfigMock, GetMetaStatsSendIntervalSec()).WillRepeatedly(Return(0));
+    EXPECT_CALL(runtimeConfigMock, GetMetaStatsTenantToken()).WillRepeatedly(Return("metastats-tenant-token"));
+    stats.updateOnPostData(100, false);
+    stats.updateOnCompression(0);
+    stats.updateOnPostData(100, false);
+    stats.updateOnCompression(262144);
+    stats.updateOnPostData(100, false);
+    stats.updateOnCompression(262144);
+
+    auto events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_START);
+    ASSERT_THAT(events, Not(IsEmpty()));
+    auto& ext = events[0].data[0].properties;
+    EXPECT_THAT(ext["pkg_cmp"].stringValue, Eq("3"));
+    EXPECT_THAT(ext["pkg_cmp_reuse"].stringValue, Eq("2"));
+    EXPECT_THAT(ext["cmp_alloc_saved"].stringValue, Eq("524288"));
+}
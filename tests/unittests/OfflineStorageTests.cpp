@@ -79,14 +79,36 @@ TEST_F(OfflineStorageTests, StoreRecordIsForwarded)
     EXPECT_THAT(offlineStorage.storeRecord(ctx), false);
 }
 
+TEST_F(OfflineStorageTests, StoreRecordsReportsFailuresByIndex)
+{
+    std::vector<IncomingEventContextPtr> events;
+    for (StorageRecordId id = 1; id <= 3; id++)
+    {
+        events.push_back(new IncomingEventContext());
+        events.back()->record.id = id;
+    }
+
+    EXPECT_CALL(offlineStorageMock, StoreRecords(_))
+        .WillOnce(Return(std::vector<bool> { true, false, true }));
+    EXPECT_CALL(*this, resultStoreRecordFailed(events[1]))
+        .WillOnce(Return());
+    EXPECT_THAT(offlineStorage.storeRecords(events), ElementsAre(true, false, true));
+    EXPECT_THAT(events[1]->record.id, 2u);
+
+    for (auto event : events)
+    {
+        delete event;
+    }
+}
+
 TEST_F(OfflineStorageTests, RetrieveEventsPassesRecordsThrough)
 {
     auto ctx = std::make_shared<EventsUploadContext>();
     ctx->requestedMinLatency = EventLatency_Normal;
     ctx->requestedMaxCount = 6;
 
-    StorageRecord record1("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 127, 255});
-    StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2, 128, 0});
+    StorageRecord record1(1, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 127, 255});
+    StorageRecord record2(2, "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2, 128, 0});
     EXPECT_CALL(offlineStorageMock, GetAndReserveRecords(_, Gt(1000u), ctx->requestedMinLatency, ctx->requestedMaxCount))
         .WillOnce(DoAll(
             Invoke([&record1, &record2](std::function<bool(StorageRecord&&)> const& consumer, unsigned, EventLatency, unsigned) {
@@ -128,12 +150,44 @@ TEST_F(OfflineStorageTests, RetrieveEventsFailureAborts)
     offlineStorage.retrieveEvents(ctx);
 }
 
+TEST_F(OfflineStorageTests, RetrieveEventsLeavesThrottledTenantsOut)
+{
+    TenantThrottle throttle;
+    TenantId throttled = TenantRegistry::Intern("throttled-token");
+    throttle.throttle(throttled, std::chrono::seconds { 60 });
+    offlineStorage.SetTenantThrottle(&throttle);
+
+    auto ctx = std::make_shared<EventsUploadContext>();
+    ctx->requestedMinLatency = EventLatency_Normal;
+    ctx->requestedMaxCount = 6;
+
+    // The mock storage cannot filter, the throttled record still comes back
+    StorageRecord record1(1, "throttled-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 127, 255});
+    StorageRecord record2(2, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2});
+    EXPECT_CALL(offlineStorageMock, GetAndReserveRecords(_, Gt(1000u), ctx->requestedMinLatency, ctx->requestedMaxCount))
+        .WillOnce(DoAll(
+            Invoke([&record1, &record2](std::function<bool(StorageRecord&&)> const& consumer, unsigned, EventLatency, unsigned) {
+        EXPECT_THAT(consumer(std::move(record1)), true);
+        EXPECT_THAT(consumer(std::move(record2)), true);
+    }),
+            Return(true)));
+    EXPECT_CALL(offlineStorageMock, IsLastReadFromMemory())
+        .WillOnce(Return(false));
+
+    EXPECT_CALL(*this, resultRetrievedEvent(ctx, Field(&StorageRecord::id, 2u), _))
+        .WillOnce(Return());
+    EXPECT_CALL(*this, resultRetrievalFinished(ctx))
+        .WillOnce(Return());
+
+    offlineStorage.retrieveEvents(ctx);
+}
+
 TEST_F(OfflineStorageTests, DeleteRecordsIsForwarded)
 {
     auto ctx = std::make_shared<EventsUploadContext>();
     HttpHeaders test;
     bool fromMemory = false;
-    std::vector<std::string> recordIds;
+    std::vector<StorageRecordId> recordIds;
     for (const auto& element : ctx->recordIdsAndTenantIds)
     {
         recordIds.push_back(element.first);
@@ -148,7 +202,7 @@ TEST_F(OfflineStorageTests, ReleaseRecordsIsForwarded)
     auto ctx = std::make_shared<EventsUploadContext>();
     HttpHeaders test;
     bool fromMemory = false;
-    std::vector<std::string> recordIds;
+    std::vector<StorageRecordId> recordIds;
     for (const auto& element : ctx->recordIdsAndTenantIds)
     {
         recordIds.push_back(element.first);
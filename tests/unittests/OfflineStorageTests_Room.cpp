@@ -16,8 +16,13 @@
 #include "offline/OfflineStorage_Room.hpp"
 #endif
 #include "offline/OfflineStorage_SQLite.hpp"
+#include "system/TenantRegistry.hpp"
 #include "NullObjects.hpp"
+#include "sqlite3.h"
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <set>
 #include <string>
 #include <fstream>
 #ifdef ANDROID
@@ -98,10 +103,10 @@ public:
         if (records.empty()) {
             return;
         }
-        std::vector<std::string> ids;
+        std::vector<StorageRecordId> ids;
         ids.reserve(records.size());
         for (auto &record : records) {
-            ids.emplace_back(std::move(record.id));
+            ids.emplace_back(record.id);
         }
         HttpHeaders h;
         bool fromMemory = false;
@@ -127,7 +132,7 @@ public:
                 id_stream << "Fred-" << i << "-" << latency;
                 std::string id = id_stream.str();
                 records.emplace_back(
-                        id,
+                        static_cast<StorageRecordId>(100 * latency + i + 1),
                         id,
                         latency,
                         EventPersistence_Normal,
@@ -195,6 +200,189 @@ TEST_P(OfflineStorageTestsRoom, TestBadFile)
     badStorage->Shutdown();
 }
 
+TEST_P(OfflineStorageTestsRoom, UpgradeFromStringRecordIds)
+{
+    if (implementation != StorageImplementation::SQLite) {
+        return;
+    }
+
+    // Schema version 1 kept a UUID string per record
+    auto path = GetTempDirectory() + "SchemaV1.db";
+    ::remove(path.c_str());
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db,
+            "PRAGMA user_version=1;"
+            "CREATE TABLE events (record_id TEXT, tenant_token TEXT NOT NULL, latency INTEGER, persistence INTEGER,"
+            " timestamp INTEGER, retry_count INTEGER DEFAULT 0, reserved_until INTEGER DEFAULT 0, payload BLOB);"
+            "INSERT INTO events (record_id,tenant_token,latency,persistence,timestamp,retry_count,payload) VALUES"
+            " ('3f2504e0-4f89-11d3-9a0c-0305e82c3301','Fred',1,1,100,2,x'010203'),"
+            " ('3f2504e0-4f89-11d3-9a0c-0305e82c3302','George',2,1,200,0,x'0405');",
+            nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    configMock[CFG_STR_CACHE_FILE_PATH] = path.c_str();
+    MAE::OfflineStorage_SQLite upgraded(nullLogManager, configMock);
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default"))
+        .RetiresOnSaturation();
+    upgraded.Initialize(observerMock);
+
+    auto records = upgraded.GetRecords(true, EventLatency_Unspecified, 0);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ("George", records[0].tenantToken);
+    EXPECT_EQ(StorageBlob({4, 5}), records[0].blob);
+    EXPECT_EQ("Fred", records[1].tenantToken);
+    EXPECT_EQ(2, records[1].retryCount);
+    EXPECT_NE(0u, records[0].id);
+    EXPECT_NE(0u, records[1].id);
+    EXPECT_NE(records[0].id, records[1].id);
+
+    // Migrated records are addressed by their new IDs
+    HttpHeaders headers;
+    bool fromMemory = false;
+    upgraded.DeleteRecords({ records[0].id }, headers, fromMemory);
+    EXPECT_EQ(1u, upgraded.GetRecordCount(EventLatency_Unspecified));
+    EXPECT_TRUE(upgraded.StoreRecord({ records[0].id, "George", EventLatency_Normal, EventPersistence_Normal, 300, StorageBlob{6} }));
+    EXPECT_EQ(2u, upgraded.GetRecordCount(EventLatency_Unspecified));
+    upgraded.Shutdown();
+    ::remove(path.c_str());
+}
+
+TEST_P(OfflineStorageTestsRoom, UpgradeFromTenantTokenColumn)
+{
+    if (implementation != StorageImplementation::SQLite) {
+        return;
+    }
+
+    // Schema version 2 kept the tenant token string in every row
+    auto path = GetTempDirectory() + "SchemaV2.db";
+    ::remove(path.c_str());
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db,
+            "PRAGMA user_version=2;"
+            "CREATE TABLE events (record_id INTEGER PRIMARY KEY, tenant_token TEXT NOT NULL, latency INTEGER, persistence INTEGER,"
+            " timestamp INTEGER, retry_count INTEGER DEFAULT 0, reserved_until INTEGER DEFAULT 0, payload BLOB);"
+            "INSERT INTO events (record_id,tenant_token,latency,persistence,timestamp,retry_count,payload) VALUES"
+            " (7,'Fred',1,1,100,2,x'010203'),"
+            " (8,'George',2,1,200,0,x'0405'),"
+            " (9,'Fred',1,1,300,0,x'06');",
+            nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    configMock[CFG_STR_CACHE_FILE_PATH] = path.c_str();
+    MAE::OfflineStorage_SQLite upgraded(nullLogManager, configMock);
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default"))
+        .RetiresOnSaturation();
+    upgraded.Initialize(observerMock);
+
+    auto records = upgraded.GetRecords(true, EventLatency_Unspecified, 0);
+    ASSERT_EQ(3u, records.size());
+    std::map<StorageRecordId, std::string> tokens;
+    for (auto const& record : records) {
+        tokens[record.id] = record.tenantToken;
+        EXPECT_EQ(TenantRegistry::Find(record.tenantToken), record.tenantId);
+    }
+    EXPECT_THAT(tokens, ElementsAre(Pair(7u, "Fred"), Pair(8u, "George"), Pair(9u, "Fred")));
+
+    // Deleting by token goes through the tenants table
+    upgraded.DeleteRecords({ { "tenant_token", "George" } });
+    EXPECT_EQ(2u, upgraded.GetRecordCount(EventLatency_Unspecified));
+    upgraded.Shutdown();
+
+    // One row per distinct token, each event references it by ID
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    std::vector<std::string> stored;
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db,
+            "SELECT tenant_token FROM tenants WHERE tenant_id IN (SELECT tenant_id FROM events) ORDER BY tenant_token",
+            [](void* context, int, char** values, char**) -> int {
+                static_cast<std::vector<std::string>*>(context)->push_back(values[0]);
+                return 0;
+            }, &stored, nullptr));
+    sqlite3_close(db);
+    EXPECT_THAT(stored, ElementsAre("Fred"));
+    ::remove(path.c_str());
+}
+
+TEST_P(OfflineStorageTestsRoom, UpgradeFromClientRecordIds)
+{
+    if (implementation != StorageImplementation::SQLite) {
+        return;
+    }
+
+    // Schema version 3 stored the record IDs the LogManager assigned
+    auto path = GetTempDirectory() + "SchemaV3.db";
+    ::remove(path.c_str());
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db,
+            "PRAGMA user_version=3;"
+            "CREATE TABLE tenants (tenant_id INTEGER PRIMARY KEY, tenant_token TEXT NOT NULL UNIQUE);"
+            "CREATE TABLE events (record_id INTEGER PRIMARY KEY, tenant_id INTEGER NOT NULL, latency INTEGER, persistence INTEGER,"
+            " timestamp INTEGER, retry_count INTEGER DEFAULT 0, reserved_until INTEGER DEFAULT 0, payload BLOB);"
+            "INSERT INTO tenants (tenant_id,tenant_token) VALUES (1,'Fred');"
+            "INSERT INTO events (record_id,tenant_id,latency,persistence,timestamp,retry_count,payload) VALUES"
+            " (1805603255500767232,1,1,1,100,2,x'010203');",
+            nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    configMock[CFG_STR_CACHE_FILE_PATH] = path.c_str();
+    MAE::OfflineStorage_SQLite upgraded(nullLogManager, configMock);
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default"))
+        .RetiresOnSaturation();
+    upgraded.Initialize(observerMock);
+
+    // New events are numbered above the migrated ones
+    EXPECT_TRUE(upgraded.StoreRecord({ 1, "Fred", EventLatency_Normal, EventPersistence_Normal, 200, StorageBlob{4} }));
+    auto records = upgraded.GetRecords(true, EventLatency_Unspecified, 0);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(1805603255500767232u, records[0].id);
+    EXPECT_EQ(2, records[0].retryCount);
+    EXPECT_EQ(1805603255500767233u, records[1].id);
+    upgraded.Shutdown();
+    ::remove(path.c_str());
+}
+
+TEST_P(OfflineStorageTestsRoom, SharedDatabaseKeepsRecordsWithSameClientIds)
+{
+    if (implementation != StorageImplementation::SQLite) {
+        return;
+    }
+
+    // Two LogManager instances that started at the same time on one cache file.
+    // The second leaves the sqlite library to the first, as an app embedding
+    // several instances does.
+    configMock["skipSqliteInitAndShutdown"] = "true";
+    MAE::OfflineStorage_SQLite other(nullLogManager, configMock);
+    configMock["skipSqliteInitAndShutdown"] = "false";
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default"))
+        .RetiresOnSaturation();
+    other.Initialize(observerMock);
+
+    auto now = PAL::getUtcSystemTimeMs();
+    StorageRecordVector records;
+    for (StorageRecordId id = 1; id <= 3; ++id) {
+        records.emplace_back(id, "Fred", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob {1});
+    }
+    StorageRecordVector otherRecords;
+    for (StorageRecordId id = 1; id <= 3; ++id) {
+        otherRecords.emplace_back(id, "George", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob {2});
+    }
+    EXPECT_THAT(offlineStorage->StoreRecords(records), Each(true));
+    EXPECT_THAT(other.StoreRecords(otherRecords), Each(true));
+    EXPECT_TRUE(other.StoreRecord({ 1, "George", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob {3} }));
+
+    // Nothing was overwritten, and every stored event has an ID of its own
+    auto stored = offlineStorage->GetRecords(true, EventLatency_Unspecified, 0);
+    ASSERT_EQ(7u, stored.size());
+    std::set<StorageRecordId> ids;
+    for (auto const& record : stored) {
+        ids.insert(record.id);
+    }
+    EXPECT_EQ(7u, ids.size());
+    other.Shutdown();
+}
+
 TEST_P(OfflineStorageTestsRoom, TestStoreRecords)
 {
     auto now = PAL::getUtcSystemTimeMs();
@@ -204,7 +392,7 @@ TEST_P(OfflineStorageTestsRoom, TestStoreRecords)
         id_stream << "Fred-" << i;
         std::string id = id_stream.str();
         records.emplace_back(
-                id,
+                static_cast<StorageRecordId>(i + 1),
                 id,
                 EventLatency_Normal,
                 EventPersistence_Normal,
@@ -249,7 +437,7 @@ TEST_P(OfflineStorageTestsRoom, TestGetAndReserveManyAcceptSome) {
         id_stream << "Fred-" << i;
         std::string id = id_stream.str();
         records.emplace_back(
-                id,
+                static_cast<StorageRecordId>(i + 1),
                 id,
                 EventLatency_Normal,
                 EventPersistence_Normal,
@@ -366,7 +554,7 @@ TEST_P(OfflineStorageTestsRoom, TestGetRecords) {
         std::ostringstream s;
         s << "Fred-" << i;
         records.emplace_back(
-                s.str(),
+                static_cast<StorageRecordId>(i + 1),
                 s.str(),
                 i < 10 ? EventLatency_Normal : EventLatency_RealTime,
                 EventPersistence_Normal,
@@ -400,7 +588,7 @@ TEST_P(OfflineStorageTestsRoom, TestManyExpiredRecords) {
     for (size_t i = 0; i < count; ++i) {
         std::string thing = std::to_string(i);
         manyRecords.emplace_back(
-            thing, // id std::string const& tenantToken, EventLatency latency, EventPersistence persistence)
+            static_cast<StorageRecordId>(i + 1), // id
             thing, // token
             EventLatency_Normal,
             EventPersistence_Normal,
@@ -427,7 +615,7 @@ TEST_P(OfflineStorageTestsRoom, TestManyExpiredRecords) {
         EXPECT_EQ(count, manyRecords.size());
         EXPECT_THAT(manyRecords, Each(Field(&StorageRecord::retryCount, Eq(retry))));
         for (auto const & record : manyRecords) {
-            manyIds.emplace_back(std::move(record.id));
+            manyIds.emplace_back(record.id);
         }
         bool fromMemory;
         offlineStorage->ReleaseRecords(manyIds, true, HttpHeaders(), fromMemory);
@@ -450,7 +638,7 @@ TEST_P(OfflineStorageTestsRoom, LastReadRecordCount) {
         auto id = id_hash(i);
         auto id_string = std::to_string(id);
         records.emplace_back(
-                id_string,
+                static_cast<StorageRecordId>(i + 1),
                 id_string,
                 EventLatency_Normal,
                 EventPersistence_Normal,
@@ -477,7 +665,7 @@ TEST_P(OfflineStorageTestsRoom, LastReadRecordCount) {
 TEST_P(OfflineStorageTestsRoom, ReleaseActuallyReleases) {
     auto now = PAL::getUtcSystemTimeMs();
     StorageRecord r(
-            "Fred",
+            1,
             "George",
             EventLatency_Normal,
             EventPersistence_Normal,
@@ -513,15 +701,45 @@ TEST_P(OfflineStorageTestsRoom, ReleaseActuallyReleases) {
             );
 }
 
+TEST_P(OfflineStorageTestsRoom, SkippedTenantsAreNeitherReadNorReserved)
+{
+    if (implementation == StorageImplementation::Room) {
+        return;
+    }
+
+    auto now = PAL::getUtcSystemTimeMs();
+    StorageRecordVector records;
+    for (StorageRecordId id = 1; id <= 5; ++id) {
+        records.emplace_back(id, (id == 3) ? "George" : "Throttled", EventLatency_Normal, EventPersistence_Normal, now + id, StorageBlob {1});
+    }
+    offlineStorage->StoreRecords(records);
+
+    // The skipped events do not use up maxCount either
+    std::vector<TenantId> skipped { TenantRegistry::Intern("Throttled") };
+    std::vector<std::string> tokens;
+    EXPECT_TRUE(offlineStorage->GetAndReserveRecordRefs([&tokens](StorageRecord const& record) -> bool {
+        tokens.push_back(record.tenantToken);
+        return true;
+    }, 5000, EventLatency_Unspecified, 1, skipped));
+    EXPECT_THAT(tokens, ElementsAre("George"));
+
+    // Once the tenant is no longer skipped its events are all there
+    tokens.clear();
+    offlineStorage->GetAndReserveRecordRefs([&tokens](StorageRecord const& record) -> bool {
+        tokens.push_back(record.tenantToken);
+        return true;
+    }, 5000);
+    EXPECT_THAT(tokens, ElementsAre("Throttled", "Throttled", "Throttled", "Throttled"));
+}
+
 TEST_P(OfflineStorageTestsRoom, DeleteByToken)
 {
     StorageRecordVector records;
     auto now = PAL::getUtcSystemTimeMs();
     for (size_t i = 0; i < 1000; ++i) {
-        auto id = std::to_string(i);
         auto tenantToken = std::to_string(i % 5);
         records.emplace_back(
-                id,
+                static_cast<StorageRecordId>(i + 1),
                 tenantToken,
                 EventLatency_Normal,
                 EventPersistence_Normal,
@@ -544,7 +762,7 @@ TEST_P(OfflineStorageTestsRoom, ResizeDB)
     auto now = PAL::getUtcSystemTimeMs();
 
     StorageRecord record(
-            "",
+            0,
             "TenantFred",
             EventLatency_Normal,
             EventPersistence_Normal,
@@ -553,7 +771,7 @@ TEST_P(OfflineStorageTestsRoom, ResizeDB)
             );
     size_t index = 1;
     while (offlineStorage->GetSize() <= configMock.GetOfflineStorageMaximumSizeBytes()) {
-        record.id = std::to_string(index);
+        record.id = index;
         offlineStorage->StoreRecord(record);
         index += 1;
     }
@@ -572,7 +790,7 @@ TEST_P(OfflineStorageTestsRoom, StoreManyRecords)
     std::random_device rd;   // non-deterministic generator
     std::mt19937_64 gen(rd());  // to seed mersenne twister.
     std::uniform_int_distribution<> randomByte(0,255);
-    std::uniform_int_distribution<uint64_t> randomWord(0, UINT64_MAX);
+    std::uniform_int_distribution<uint64_t> randomWord(1, UINT64_MAX);
     auto now = PAL::getUtcSystemTimeMs();
 
     StorageBlob masterBlob;
@@ -585,7 +803,7 @@ TEST_P(OfflineStorageTestsRoom, StoreManyRecords)
     records.reserve(blockSize);
     while (records.size() < blockSize) {
         records.emplace_back(
-                "",
+                0,
                 "Fred-Doom-Token23",
                 EventLatency_Normal,
                 EventPersistence_Normal,
@@ -596,7 +814,7 @@ TEST_P(OfflineStorageTestsRoom, StoreManyRecords)
 
     while (offlineStorage->GetSize() < targetSize) {
         for (auto & record : records) {
-            record.id = std::to_string(randomWord(gen));
+            record.id = randomWord(gen);
         }
         offlineStorage->StoreRecords(records);
         ++blocks;
@@ -604,6 +822,35 @@ TEST_P(OfflineStorageTestsRoom, StoreManyRecords)
     EXPECT_EQ(blocks * blockSize, offlineStorage->GetRecordCount());
 }
 
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST_P(OfflineStorageTestsRoom, DISABLED_StoreRecordsThroughput)
+{
+    StorageBlob blob(256, 0x5A);
+    for (size_t batchSize : { 1000, 10000, 100000 }) {
+        DeleteAllRecords();
+        auto now = PAL::getUtcSystemTimeMs();
+        StorageRecordVector records;
+        records.reserve(batchSize);
+        for (size_t i = 0; i < batchSize; ++i) {
+            records.emplace_back(
+                    static_cast<StorageRecordId>(i + 1),
+                    "Fred-Doom-Token23",
+                    EventLatency_Normal,
+                    EventPersistence_Normal,
+                    now,
+                    StorageBlob(blob));
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto stored = offlineStorage->StoreRecords(records);
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_THAT(stored, Each(true));
+        std::string name = "StoreRecords" + std::to_string(batchSize);
+        RecordProperty(name + "Us", std::to_string(elapsedUs));
+        RecordProperty(name + "EventsPerSec", std::to_string(batchSize * 1000000.0 / std::max<long long>(elapsedUs, 1)));
+    }
+}
+
 #ifdef ANDROID
 auto values = Values(StorageImplementation::Room, StorageImplementation::SQLite, StorageImplementation::Memory);
 #else
@@ -101,8 +101,8 @@ TEST_F(OfflineStorageTests_SQLite, InitializeAndShutdownCreateFileThatCanBeDelet
 
 TEST_F(OfflineStorageTests_SQLite, StorageRecordConstructorSetsAllFields)
 {
-    StorageRecord record{ "guid", "token", EventLatency_RealTime, EventPersistence_Critical, INT64_MIN + 1, { 5, 4, 3, 2, 1 }, 77, INT64_MAX - 1 };
-    EXPECT_THAT(record.id, StrEq("guid"));
+    StorageRecord record{ 1, "token", EventLatency_RealTime, EventPersistence_Critical, INT64_MIN + 1, { 5, 4, 3, 2, 1 }, 77, INT64_MAX - 1 };
+    EXPECT_THAT(record.id, Eq(1u));
     EXPECT_THAT(record.tenantToken, StrEq("token"));
     EXPECT_THAT(record.latency, EventLatency_RealTime);
     EXPECT_THAT(record.timestamp, INT64_MIN + 1);
@@ -113,7 +113,7 @@ TEST_F(OfflineStorageTests_SQLite, StorageRecordConstructorSetsAllFields)
 
 TEST_F(OfflineStorageTests_SQLite, GetAndReservedReturnsStoredRecord)
 {
-    StorageRecord record{ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, { 5, 4, 3, 2, 1 } };
+    StorageRecord record{ 1, "token", EventLatency_Normal, EventPersistence_Normal, 1, { 5, 4, 3, 2, 1 } };
     ASSERT_THAT(offlineStorage->StoreRecord(record), true);
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
@@ -129,9 +129,9 @@ TEST_F(OfflineStorageTests_SQLite, GetAndReservedReturnsStoredRecord)
 
 TEST_F(OfflineStorageTests_SQLite, ReservedRecordIsNotReturned)
 {
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid1", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid2", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid3", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({2, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({3, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000, EventLatency_Unspecified, 1), true);
     ASSERT_THAT(consumer.records.size(), 1);
@@ -142,23 +142,23 @@ TEST_F(OfflineStorageTests_SQLite, ReservedRecordIsNotReturned)
 
 TEST_F(OfflineStorageTests_SQLite, DeletedRecordsAreNotReturned)
 {
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid1", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid2", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid3", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({2, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({3, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
     HttpHeaders test;
     bool fromMemory = false;
-    offlineStorage->DeleteRecords({"guid1", "guid3"}, test, fromMemory);
+    offlineStorage->DeleteRecords({1, 3}, test, fromMemory);
 
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
     ASSERT_THAT(consumer.records.size(), 1);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid2"));
+    EXPECT_THAT(consumer.records[0].id, Eq(2u));
 }
 
 TEST_F(OfflineStorageTests_SQLite, ReservedRecordsAreReleasedAfterTimeout)
 {
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid1", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid2", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({2, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
     TestRecordConsumer consumer;
     // Reserve first for 2 secs
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 2000, EventLatency_Unspecified, 1), true);
@@ -184,12 +184,12 @@ TEST_F(OfflineStorageTests_SQLite, ReservedRecordsAreReleasedAfterTimeout)
 TEST_F(OfflineStorageTests_SQLite, GetAndReserveRecordsReservesRecordsSortedByTimestamp)
 {
     StorageRecord unsortedRecords[] = {
-        { "guid-6", "token", EventLatency_Normal, EventPersistence_Normal, 3, {11} },
-        { "guid-1", "token", EventLatency_Normal, EventPersistence_Normal, 4, {22} },
-        { "guid-5", "token", EventLatency_Normal, EventPersistence_Normal, 1, {33} },
-        { "guid-4", "token", EventLatency_Normal, EventPersistence_Normal, 2, {44} },
-        { "guid-3", "token", EventLatency_Normal, EventPersistence_Normal, 6, {55} },
-        { "guid-2", "token", EventLatency_Normal, EventPersistence_Normal, 5, {66} }
+        { 6, "token", EventLatency_Normal, EventPersistence_Normal, 3, {11} },
+        { 1, "token", EventLatency_Normal, EventPersistence_Normal, 4, {22} },
+        { 5, "token", EventLatency_Normal, EventPersistence_Normal, 1, {33} },
+        { 4, "token", EventLatency_Normal, EventPersistence_Normal, 2, {44} },
+        { 3, "token", EventLatency_Normal, EventPersistence_Normal, 6, {55} },
+        { 2, "token", EventLatency_Normal, EventPersistence_Normal, 5, {66} }
     };
 
     for (auto const& r : unsortedRecords) {
@@ -213,71 +213,71 @@ TEST_F(OfflineStorageTests_SQLite, GetAndReserveRecordsReservesRecordsSortedByTi
 
 TEST_F(OfflineStorageTests_SQLite, GetAndReserveRecordsReturnsOnlyHighestPriority)
 {
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-11", "token1", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-12", "token1", EventLatency_Normal, EventPersistence_Normal, 2, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-13", "token1", EventLatency_RealTime, EventPersistence_Critical,   3, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-21", "token2", EventLatency_Normal, EventPersistence_Normal, 4, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-22", "token2", EventLatency_RealTime, EventPersistence_Critical,   5, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({11, "token1", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({12, "token1", EventLatency_Normal, EventPersistence_Normal, 2, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({13, "token1", EventLatency_RealTime, EventPersistence_Critical,   3, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({21, "token2", EventLatency_Normal, EventPersistence_Normal, 4, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({22, "token2", EventLatency_RealTime, EventPersistence_Critical,   5, {}}), true);
 
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 10000, EventLatency_RealTime), true);
     ASSERT_THAT(consumer.records.size(), 2);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid-13"));
-    EXPECT_THAT(consumer.records[1].id, StrEq("guid-22"));
+    EXPECT_THAT(consumer.records[0].id, Eq(13u));
+    EXPECT_THAT(consumer.records[1].id, Eq(22u));
 }
 
 TEST_F(OfflineStorageTests_SQLite, GetAndReserveRecordsReturnsLowerPriorityIfHighestReserved)
 {
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-11", "token1", EventLatency_RealTime, EventPersistence_Critical,   1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-12", "token1", EventLatency_Normal, EventPersistence_Normal, 2, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-13", "token1", EventLatency_Normal, EventPersistence_Normal, 3, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({11, "token1", EventLatency_RealTime, EventPersistence_Critical,   1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({12, "token1", EventLatency_Normal, EventPersistence_Normal, 2, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({13, "token1", EventLatency_Normal, EventPersistence_Normal, 3, {}}), true);
 
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 10000, EventLatency_RealTime), true);
     ASSERT_THAT(consumer.records.size(), 1);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid-11"));
+    EXPECT_THAT(consumer.records[0].id, Eq(11u));
     consumer.records.clear();
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 10000, EventLatency_Normal), true);
     ASSERT_THAT(consumer.records.size(), 2);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid-12"));
-    EXPECT_THAT(consumer.records[1].id, StrEq("guid-13"));
+    EXPECT_THAT(consumer.records[0].id, Eq(12u));
+    EXPECT_THAT(consumer.records[1].id, Eq(13u));
 }
 
 TEST_F(OfflineStorageTests_SQLite, GetAndReserveRecordsReservesOnlyReturnedRecordsWhenLimited)
 {
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-1", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-2", "token", EventLatency_Normal, EventPersistence_Normal, 2, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-3", "token", EventLatency_Normal, EventPersistence_Normal, 3, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-4", "token", EventLatency_Normal, EventPersistence_Normal, 4, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-5", "token", EventLatency_Normal, EventPersistence_Normal, 5, {}}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"guid-6", "token", EventLatency_Normal, EventPersistence_Normal, 6, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({2, "token", EventLatency_Normal, EventPersistence_Normal, 2, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({3, "token", EventLatency_Normal, EventPersistence_Normal, 3, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({4, "token", EventLatency_Normal, EventPersistence_Normal, 4, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({5, "token", EventLatency_Normal, EventPersistence_Normal, 5, {}}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({6, "token", EventLatency_Normal, EventPersistence_Normal, 6, {}}), true);
 
     // limiting by consumer
     TestRecordConsumer limitedConsumer;
     limitedConsumer.maxCount = 2;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(limitedConsumer, 10000), true);
     ASSERT_THAT(limitedConsumer.records.size(), 2);
-    EXPECT_THAT(limitedConsumer.records[0].id, StrEq("guid-1"));
-    EXPECT_THAT(limitedConsumer.records[1].id, StrEq("guid-2"));
+    EXPECT_THAT(limitedConsumer.records[0].id, Eq(1u));
+    EXPECT_THAT(limitedConsumer.records[1].id, Eq(2u));
 
     // limiting by maxCount in getAndReserveRecords
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 10000, EventLatency_Normal, 2), true);
     ASSERT_THAT(consumer.records.size(), 2);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid-3"));
-    EXPECT_THAT(consumer.records[1].id, StrEq("guid-4"));
+    EXPECT_THAT(consumer.records[0].id, Eq(3u));
+    EXPECT_THAT(consumer.records[1].id, Eq(4u));
 
     // still can reserve not consumed records
     consumer.records.clear();
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 10000), true);
     ASSERT_THAT(consumer.records.size(), 2);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid-5"));
-    EXPECT_THAT(consumer.records[1].id, StrEq("guid-6"));
+    EXPECT_THAT(consumer.records[0].id, Eq(5u));
+    EXPECT_THAT(consumer.records[1].id, Eq(6u));
 }
 
 TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsMakesThemAvailableAgain)
 {
-    StorageRecord record{ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, {11} };
+    StorageRecord record{ 1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {11} };
     ASSERT_THAT(offlineStorage->StoreRecord(record), true);
 
     TestRecordConsumer consumer;
@@ -286,7 +286,7 @@ TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsMakesThemAvailableAgain)
     EXPECT_THAT(consumer.records[0].retryCount, 0);
     HttpHeaders test;
     bool fromMemory = false;
-    offlineStorage->ReleaseRecords({ "guid" }, false, test, fromMemory);
+    offlineStorage->ReleaseRecords({ 1 }, false, test, fromMemory);
 
     consumer.records.clear();
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
@@ -296,7 +296,7 @@ TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsMakesThemAvailableAgain)
 
 TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsIncrementsRetryCount)
 {
-    StorageRecord record{ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, {11} };
+    StorageRecord record{ 1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {11} };
     ASSERT_THAT(offlineStorage->StoreRecord(record), true);
 
     TestRecordConsumer consumer;
@@ -308,7 +308,7 @@ TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsIncrementsRetryCount)
         .WillOnce(Return(2));
     HttpHeaders test;
     bool fromMemory = false;
-    offlineStorage->ReleaseRecords({ "guid" }, true, test, fromMemory);
+    offlineStorage->ReleaseRecords({ 1 }, true, test, fromMemory);
 
     consumer.records.clear();
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
@@ -318,14 +318,14 @@ TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsIncrementsRetryCount)
 
 TEST_F(OfflineStorageTests_SQLite, ReleaseUnreservedRecordsDoesntIncrementRetryCount)
 {
-    StorageRecord record{ "guid", "token", EventLatency_Normal, EventPersistence_Normal, 1, {11} };
+    StorageRecord record{ 1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {11} };
     ASSERT_THAT(offlineStorage->StoreRecord(record), true);
 
     EXPECT_CALL(configMock, GetMaximumRetryCount())
         .WillOnce(Return(2));
     HttpHeaders test;
     bool fromMemory = false;
-    offlineStorage->ReleaseRecords({ "guid" }, true, test, fromMemory);
+    offlineStorage->ReleaseRecords({ 1 }, true, test, fromMemory);
 
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
@@ -335,8 +335,8 @@ TEST_F(OfflineStorageTests_SQLite, ReleaseUnreservedRecordsDoesntIncrementRetryC
 
 TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsDeletesRecordsOverMaxRetryCount)
 {
-    ASSERT_THAT(offlineStorage->StoreRecord({ "guid",  "token", EventLatency_RealTime, EventPersistence_Critical, 1, {11} }), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({ "guid2", "token", EventLatency_Normal, EventPersistence_Normal, 1, {22} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ 1,  "token", EventLatency_RealTime, EventPersistence_Critical, 1, {11} }), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({ 2, "token", EventLatency_Normal, EventPersistence_Normal, 1, {22} }), true);
 
     TestRecordConsumer consumer;
     int const MaxRetryCount = 5;
@@ -354,25 +354,25 @@ TEST_F(OfflineStorageTests_SQLite, ReleaseRecordsDeletesRecordsOverMaxRetryCount
             .Times((i == MaxRetryCount) ? 1 : 0);
         HttpHeaders test;
         bool fromMemory = false;
-        offlineStorage->ReleaseRecords({ "guid" }, true, test, fromMemory);
+        offlineStorage->ReleaseRecords({ 1 }, true, test, fromMemory);
     }
 
     consumer.records.clear();
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000, EventLatency_Normal), true);
     ASSERT_THAT(consumer.records.size(), 1);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid2"));
+    EXPECT_THAT(consumer.records[0].id, Eq(2u));
     EXPECT_THAT(consumer.records[0].retryCount, 0);
 }
 
 TEST_F(OfflineStorageTests_SQLite, GetAndReserveRecordsReturnsRecordsSortedByTimestamp)
 {
     StorageRecord unsortedRecords[] = {
-        { "guid-6", "token3", EventLatency_Normal, EventPersistence_Normal,    3, {11} },
-        { "guid-1", "token5", EventLatency_RealTime, EventPersistence_Critical, 4, {22} },
-        { "guid-5", "token4", EventLatency_Max, EventPersistence_Critical,2, {33} },
-        { "guid-4", "token2", EventLatency_Normal, EventPersistence_Normal, 1, {44} },
-        { "guid-3", "token1", EventLatency_Max, EventPersistence_Critical, 6, {55} },
-        { "guid-2", "token6", EventLatency_Max, EventPersistence_Critical, 5, {66} }
+        { 6, "token3", EventLatency_Normal, EventPersistence_Normal,    3, {11} },
+        { 1, "token5", EventLatency_RealTime, EventPersistence_Critical, 4, {22} },
+        { 5, "token4", EventLatency_Max, EventPersistence_Critical,2, {33} },
+        { 4, "token2", EventLatency_Normal, EventPersistence_Normal, 1, {44} },
+        { 3, "token1", EventLatency_Max, EventPersistence_Critical, 6, {55} },
+        { 2, "token6", EventLatency_Max, EventPersistence_Critical, 5, {66} }
     };
 
     for (auto const& r : unsortedRecords) {
@@ -382,9 +382,9 @@ TEST_F(OfflineStorageTests_SQLite, GetAndReserveRecordsReturnsRecordsSortedByTim
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000, EventLatency_Max), true);
     ASSERT_THAT(consumer.records.size(), 3);
-    EXPECT_THAT(consumer.records[0].id, StrEq("guid-5"));
-    EXPECT_THAT(consumer.records[1].id, StrEq("guid-2"));
-    EXPECT_THAT(consumer.records[2].id, StrEq("guid-3"));
+    EXPECT_THAT(consumer.records[0].id, Eq(5u));
+    EXPECT_THAT(consumer.records[1].id, Eq(2u));
+    EXPECT_THAT(consumer.records[2].id, Eq(3u));
 }
 
 TEST_F(OfflineStorageTests_SQLite, StoreThousandEventsTakesLessThanASecond)
@@ -504,17 +504,17 @@ TEST_P(BadRecordsTests, BadRecordStoredIsNotFoundInDb)
 }
 
 StorageRecord GOOD_RECORDS[] = {
-    { "{ guid-\"' ", "tenant -to\"ken'", EventLatency_Normal, EventPersistence_Normal, INT64_MAX, StorageBlob{ 1, 2, 3, 4, 5, 6, 7 } },
-    { "guid",        "tenant-token",     EventLatency_Max, EventPersistence_Critical, 1, StorageBlob(1024 * 1024, uint8_t(7)) },
-    { "guid",        "tenant-token",     EventLatency_Off, EventPersistence_Normal, 1, {} }
+    { static_cast<StorageRecordId>(INT64_MAX), "tenant -to\"ken'", EventLatency_Normal, EventPersistence_Normal, INT64_MAX, StorageBlob{ 1, 2, 3, 4, 5, 6, 7 } },
+    { 2,        "tenant-token",     EventLatency_Max, EventPersistence_Critical, 1, StorageBlob(1024 * 1024, uint8_t(7)) },
+    { 3,        "tenant-token",     EventLatency_Off, EventPersistence_Normal, 1, {} }
 };
 
 StorageRecord BAD_RECORDS[] = {
-    { "",     "tenant-token", EventLatency_Normal, EventPersistence_Normal,                2, { 1, 2, 3 } },
-    { "guid", "",             EventLatency_Normal, EventPersistence_Normal,                2, { 1, 2, 3 } },
-    { "guid", "tenant-token", EventLatency_Unspecified,EventPersistence_Normal,       0, {} },
-    { "guid", "tenant-token", static_cast<EventLatency>(987),EventPersistence_Normal,  0, {} },
-    { "guid", "tenant-token", EventLatency_Normal, EventPersistence_Normal,            -1, {} }
+    { 0, "tenant-token", EventLatency_Normal, EventPersistence_Normal,                2, { 1, 2, 3 } },
+    { 1, "",             EventLatency_Normal, EventPersistence_Normal,                2, { 1, 2, 3 } },
+    { 1, "tenant-token", EventLatency_Unspecified,EventPersistence_Normal,       0, {} },
+    { 1, "tenant-token", static_cast<EventLatency>(987),EventPersistence_Normal,  0, {} },
+    { 1, "tenant-token", EventLatency_Normal, EventPersistence_Normal,            -1, {} }
 };
 
 INSTANTIATE_TEST_CASE_P(OfflineStorageTests_SQLite, GoodRecordsTests, ::testing::ValuesIn(GOOD_RECORDS));
@@ -570,12 +570,12 @@ TEST_F(OfflineStorageTests_SQLite, APICallsAreHarmlessAfterStorageIsShutdown)
     offlineStorage->Shutdown();
     HttpHeaders test;
     bool fromMemory = false;
-    offlineStorage->DeleteRecords({ "1", "2", "" }, test, fromMemory);
+    offlineStorage->DeleteRecords({ 1, 2, 0 }, test, fromMemory);
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), false);
     fromMemory = false;
-    offlineStorage->ReleaseRecords({ "1", "2", "" }, true, test, fromMemory);
-    offlineStorage->StoreRecord({"guid-1", "token", EventLatency_Normal, EventPersistence_Normal, 1, {}});
+    offlineStorage->ReleaseRecords({ 1, 2, 0 }, true, test, fromMemory);
+    offlineStorage->StoreRecord({1, "token", EventLatency_Normal, EventPersistence_Normal, 1, {}});
     offlineStorage->StoreSetting("name", "value");
     EXPECT_THAT(offlineStorage->GetSetting("name"), StrEq(""));
 
@@ -588,26 +588,26 @@ TEST_F(OfflineStorageTests_SQLite, ExceededStorageSizeCausesDbToDropOldestEvents
     EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillRepeatedly(Return(5 * 1024 * 1024)); // 5M
     EXPECT_CALL(configMock, GetOfflineStorageResizeThresholdPct()).WillOnce(Return(60)); // 60% = 3 of 5
 
-    ASSERT_THAT(offlineStorage->StoreRecord({"oldest with high prio", "token", EventLatency_RealTime, EventPersistence_Critical,   1, StorageBlob(1024 * 1024)}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"oldest with mid prio1", "token", EventLatency_Normal, EventPersistence_Normal, 2, StorageBlob(1024 * 1024)}), true); // X
-    ASSERT_THAT(offlineStorage->StoreRecord({"some more mid prio e1", "token", EventLatency_Normal, EventPersistence_Normal, 3, StorageBlob(1024 * 1024)}), true);
-    ASSERT_THAT(offlineStorage->StoreRecord({"oldest with low prio ", "token", EventLatency_Normal, EventPersistence_Normal,    4, StorageBlob(1024 * 1024)}), true); // X
+    ASSERT_THAT(offlineStorage->StoreRecord({1, "token", EventLatency_RealTime, EventPersistence_Critical,   1, StorageBlob(1024 * 1024)}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({2, "token", EventLatency_Normal, EventPersistence_Normal, 2, StorageBlob(1024 * 1024)}), true); // X
+    ASSERT_THAT(offlineStorage->StoreRecord({3, "token", EventLatency_Normal, EventPersistence_Normal, 3, StorageBlob(1024 * 1024)}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({4, "token", EventLatency_Normal, EventPersistence_Normal,    4, StorageBlob(1024 * 1024)}), true); // X
    
 
     std::map<std::string, size_t> trimedRecord;
     trimedRecord["token"] = 3;
     // This should exceed storage size and trigger resize
     EXPECT_CALL(observerMock, OnStorageTrimmed(trimedRecord));
-    ASSERT_THAT(offlineStorage->StoreRecord({"newest with low prio", "token", EventLatency_Normal, EventPersistence_Normal, 5, StorageBlob(1024 * 1024)}), true); // X
+    ASSERT_THAT(offlineStorage->StoreRecord({5, "token", EventLatency_Normal, EventPersistence_Normal, 5, StorageBlob(1024 * 1024)}), true); // X
 
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000, EventLatency_RealTime), true);
     ASSERT_THAT(consumer.records.size(), 1);
-    EXPECT_THAT(consumer.records[0].id, StrEq("oldest with high prio"));
+    EXPECT_THAT(consumer.records[0].id, Eq(1u));
     consumer.records.clear();
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000, EventLatency_Normal), true);
     ASSERT_THAT(consumer.records.size(), 1);
-    EXPECT_THAT(consumer.records[0].id, StrEq("newest with low prio"));
+    EXPECT_THAT(consumer.records[0].id, Eq(5u));
     consumer.records.clear();
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000, EventLatency_Normal), true);
     ASSERT_THAT(consumer.records.size(), 0);
@@ -623,17 +623,17 @@ TEST_F(OfflineStorageTests_SQLite, TrimmingAlwaysDropsAtLeastOneEvent)
     trimedRecord["token"] = 1;
     EXPECT_CALL(observerMock, OnStorageTrimmed(trimedRecord));
 
-    ASSERT_THAT(offlineStorage->StoreRecord({"old", "token", EventLatency_Normal, EventPersistence_Normal, 1, StorageBlob(33 * 1024)}), true); // X
-    ASSERT_THAT(offlineStorage->StoreRecord({"mid", "token", EventLatency_Normal, EventPersistence_Normal, 2, StorageBlob(33 * 1024)}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({1, "token", EventLatency_Normal, EventPersistence_Normal, 1, StorageBlob(33 * 1024)}), true); // X
+    ASSERT_THAT(offlineStorage->StoreRecord({2, "token", EventLatency_Normal, EventPersistence_Normal, 2, StorageBlob(33 * 1024)}), true);
     // The next call triggers the trimming (after the insertion is done) and
     // removes the oldest event marked with X above.
-    ASSERT_THAT(offlineStorage->StoreRecord({"new", "token", EventLatency_Normal, EventPersistence_Normal, 3, StorageBlob(33 * 1024)}), true);
+    ASSERT_THAT(offlineStorage->StoreRecord({3, "token", EventLatency_Normal, EventPersistence_Normal, 3, StorageBlob(33 * 1024)}), true);
 
     TestRecordConsumer consumer;
     EXPECT_THAT(offlineStorage->GetAndReserveRecords(consumer, 100000), true);
     ASSERT_THAT(consumer.records.size(), 2);
-    EXPECT_THAT(consumer.records[0].id, StrEq("mid"));
-    EXPECT_THAT(consumer.records[1].id, StrEq("new"));
+    EXPECT_THAT(consumer.records[0].id, Eq(2u));
+    EXPECT_THAT(consumer.records[1].id, Eq(3u));
 }
 #endif
 
@@ -48,7 +48,7 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
         .WillOnce(Return(100000))
         .RetiresOnSaturation();
 
-    StorageRecord record1("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
+    StorageRecord record1(1, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
     bool wantMore = true;
     packager.addEventToPackage(ctx, record1, wantMore);
 
@@ -58,14 +58,14 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
 
     EXPECT_THAT(ctx->body, Not(IsEmpty()));
     EXPECT_THAT(ctx->recordIdsAndTenantIds, SizeIs(1));
-    std::vector<std::string> recordIds;
+    std::vector<StorageRecordId> recordIds;
     for (const auto& element : ctx->recordIdsAndTenantIds)
     {
         recordIds.push_back(element.first);
     }
-    EXPECT_THAT(recordIds, Contains("r1"));
+    EXPECT_THAT(recordIds, Contains(1u));
     EXPECT_THAT(ctx->packageIds, SizeIs(1));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Find("tenant1-token"))));
 
 
     ctx = std::make_shared<EventsUploadContext>();
@@ -75,7 +75,7 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
 
     wantMore = true;
     packager.addEventToPackage(ctx, record1, wantMore);
-    StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2, 2, 2, 0});
+    StorageRecord record2(2, "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2, 2, 2, 0});
     packager.addEventToPackage(ctx, record2, wantMore);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
@@ -90,11 +90,11 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
     {
         recordIds.push_back(element.first);
     }
-    EXPECT_THAT(recordIds, Contains("r1"));
-    EXPECT_THAT(recordIds, Contains("r2"));
+    EXPECT_THAT(recordIds, Contains(1u));
+    EXPECT_THAT(recordIds, Contains(2u));
     EXPECT_THAT(ctx->packageIds, SizeIs(2));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant2-token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Find("tenant1-token"))));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Find("tenant2-token"))));
 }
 
 TEST_F(PackagerTests, UsesPriorityOfTheFirstEvent)
@@ -105,7 +105,7 @@ TEST_F(PackagerTests, UsesPriorityOfTheFirstEvent)
         .RetiresOnSaturation();
     EXPECT_THAT(ctx->latency, EventLatency_Unspecified);
 
-    StorageRecord record("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
+    StorageRecord record(1, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
     bool wantMore = false;
     packager.addEventToPackage(ctx, record, wantMore);
     EXPECT_THAT(ctx->latency, EventLatency_Normal);
@@ -124,7 +124,7 @@ TEST_F(PackagerTests, HonorsMaximumPackageSize)
     bool wantMore = true;
     int i = 0;
     while (i < 4 && wantMore) {
-        StorageRecord record("r" + toString(i), "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890 + i, std::vector<uint8_t>(PartSize, 0));
+        StorageRecord record(i + 1, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890 + i, std::vector<uint8_t>(PartSize, 0));
         packager.addEventToPackage(ctx, record, wantMore);
         i++;
     }
@@ -149,7 +149,7 @@ TEST_F(PackagerTests, PackagesAtLeastOneEventEvenIfOverSizeLimit)
         .RetiresOnSaturation();
 
     bool wantMore = true;
-    StorageRecord record("r", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>(MaxSize, 0));
+    StorageRecord record(1, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>(MaxSize, 0));
     packager.addEventToPackage(ctx, record, wantMore);
     EXPECT_THAT(wantMore, false);
 
@@ -168,11 +168,11 @@ TEST_F(PackagerTests, SetsRequestBondFieldsCorrectly)
         .RetiresOnSaturation();
 
     bool wantMore = true;
-    StorageRecord record1("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{0});
+    StorageRecord record1(1, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{0});
     packager.addEventToPackage(ctx, record1, wantMore);
-    StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
+    StorageRecord record2(2, "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
     packager.addEventToPackage(ctx, record2, wantMore);
-    StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
+    StorageRecord record3(3, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
     packager.addEventToPackage(ctx, record1, wantMore);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
@@ -214,11 +214,11 @@ TEST_F(PackagerTests, ForcedTenantIsForced)
         .RetiresOnSaturation();
 
     bool wantMore = true;
-    StorageRecord record1("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{0});
+    StorageRecord record1(1, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{0});
     packagerF.addEventToPackage(ctx, record1, wantMore);
-    StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
+    StorageRecord record2(2, "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
     packagerF.addEventToPackage(ctx, record2, wantMore);
-    StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
+    StorageRecord record3(3, "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
     packagerF.addEventToPackage(ctx, record1, wantMore);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
@@ -226,7 +226,9 @@ TEST_F(PackagerTests, ForcedTenantIsForced)
     packagerF.finalizePackage(ctx);
 
     EXPECT_THAT(ctx->packageIds, SizeIs(1));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("forced-Tenant-Token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Find("forced-Tenant-Token"))));
+    // The mock shares the default configuration with the tests that follow
+    runtimeConfigMock["forcedTenantToken"] = "";
 /*
     AriaProtocol::ClientToCollectorRequest r;
     bond_lite::CompactBinaryProtocolReader reader(ctx->body);
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "system/TenantRegistry.hpp"
+#include "offline/KillSwitchManager.hpp"
+
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+TEST(TenantRegistryTests, InternReturnsSameIdForSameToken)
+{
+    TenantId first = TenantRegistry::Intern("registry-tenant-a");
+    TenantId second = TenantRegistry::Intern("registry-tenant-b");
+    EXPECT_NE(TenantRegistry::InvalidTenantId, first);
+    EXPECT_NE(TenantRegistry::InvalidTenantId, second);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(first, TenantRegistry::Intern(std::string("registry-tenant-a")));
+    EXPECT_EQ("registry-tenant-a", TenantRegistry::GetToken(first));
+    EXPECT_EQ("registry-tenant-b", TenantRegistry::GetToken(second));
+}
+
+TEST(TenantRegistryTests, FindDoesNotRegister)
+{
+    size_t count = TenantRegistry::GetCount();
+    EXPECT_EQ(TenantRegistry::InvalidTenantId, TenantRegistry::Find("registry-never-interned"));
+    EXPECT_EQ(count, TenantRegistry::GetCount());
+
+    TenantId id = TenantRegistry::Intern("registry-found");
+    EXPECT_EQ(id, TenantRegistry::Find("registry-found"));
+}
+
+TEST(TenantRegistryTests, InvalidIdsAndEmptyTokens)
+{
+    EXPECT_EQ(TenantRegistry::InvalidTenantId, TenantRegistry::Intern(""));
+    EXPECT_THAT(TenantRegistry::GetToken(TenantRegistry::InvalidTenantId), IsEmpty());
+    EXPECT_THAT(TenantRegistry::GetToken(static_cast<TenantId>(TenantRegistry::GetCount() + 1)), IsEmpty());
+}
+
+TEST(TenantRegistryTests, GetIdPrefersRecordTenantId)
+{
+    TenantId id = TenantRegistry::Intern("registry-record-tenant");
+    StorageRecord record(1, "registry-record-tenant", EventLatency_Normal, EventPersistence_Normal);
+    EXPECT_EQ(id, TenantRegistry::GetId(record));
+
+    record.tenantToken.clear();
+    record.tenantId = id;
+    EXPECT_EQ(id, TenantRegistry::GetId(record));
+}
+
+TEST(TenantRegistryTests, ConcurrentInternAgreesOnIds)
+{
+    const size_t threadCount = 8;
+    const size_t tokenCount = 200;
+    std::vector<std::vector<TenantId>> ids(threadCount, std::vector<TenantId>(tokenCount));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&ids, t, tokenCount]()
+        {
+            for (size_t i = 0; i < tokenCount; i++)
+            {
+                // Walk the tokens in a different order on every thread
+                size_t k = (i * 7 + t * 31) % tokenCount;
+                ids[t][k] = TenantRegistry::Intern("registry-concurrent-" + std::to_string(k));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t k = 0; k < tokenCount; k++)
+    {
+        for (size_t t = 1; t < threadCount; t++)
+        {
+            ASSERT_EQ(ids[0][k], ids[t][k]);
+        }
+        EXPECT_EQ("registry-concurrent-" + std::to_string(k), TenantRegistry::GetToken(ids[0][k]));
+    }
+}
+
+TEST(TenantRegistryTests, KillSwitchBlocksByTenantId)
+{
+    KillSwitchManager killSwitch;
+    EXPECT_FALSE(killSwitch.isActive());
+    killSwitch.addToken("registry-killed-tenant", 3600);
+    EXPECT_TRUE(killSwitch.isActive());
+
+    TenantId killed = TenantRegistry::Find("registry-killed-tenant");
+    EXPECT_TRUE(killSwitch.isTokenBlocked(killed));
+    EXPECT_TRUE(killSwitch.isTokenBlocked("registry-killed-tenant"));
+    EXPECT_FALSE(killSwitch.isTokenBlocked(TenantRegistry::Intern("registry-alive-tenant")));
+    EXPECT_FALSE(killSwitch.isTokenBlocked("registry-unknown-tenant"));
+    EXPECT_THAT(killSwitch.getTokensList(), ElementsAre("registry-killed-tenant"));
+
+    killSwitch.removeToken("registry-killed-tenant");
+    EXPECT_FALSE(killSwitch.isTokenBlocked(killed));
+    EXPECT_FALSE(killSwitch.isActive());
+}
+
+TEST(TenantRegistryTests, KillSwitchLeavesRetryAfterToTenantThrottle)
+{
+    KillSwitchManager killSwitch;
+    HttpHeaders headers;
+    headers.set("Retry-After", "Wed, 21 Oct 2015 07:28:00 GMT");
+    EXPECT_FALSE(killSwitch.handleResponse(headers));
+    EXPECT_FALSE(killSwitch.isActive());
+    EXPECT_FALSE(killSwitch.isTokenBlocked(TenantRegistry::Intern("registry-alive-tenant")));
+}
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "system/TenantThrottle.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+TEST(TenantThrottleTests, ParseRetryAfter_DeltaSeconds)
+{
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("120", 0), 120);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter(" 5 ", 0), 5);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("0", 0), 0);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("99999999999999999999999", 0), TenantThrottle::MaxRetryAfterSecs);
+}
+
+TEST(TenantThrottleTests, ParseRetryAfter_HttpDate)
+{
+    // Wed, 21 Oct 2015 07:28:00 GMT
+    const int64_t date = 1445412480;
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("Wed, 21 Oct 2015 07:28:00 GMT", date - 90), 90);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("Wed, 21 Oct 2015 07:28:00 GMT", date + 90), 0);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("Wed, 21 Oct 2015 07:28:00 GMT", date - 86400), TenantThrottle::MaxRetryAfterSecs);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("Tue, 29 Feb 2028 00:00:01 GMT", 1835395200), 1);
+}
+
+TEST(TenantThrottleTests, ParseRetryAfter_MalformedIsIgnored)
+{
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("", 0), 0);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("-5", 0), 0);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("soon", 0), 0);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("Wed, 21 Foo 2015 07:28:00 GMT", 0), 0);
+    EXPECT_THAT(TenantThrottle::ParseRetryAfter("Wed, 21 Oct 2015 25:28:00 GMT", 0), 0);
+}
+
+TEST(TenantThrottleTests, ThrottlesOnlyTheTenantsOfTheResponse)
+{
+    TenantThrottle throttle;
+    TenantId throttled = TenantRegistry::Intern("throttle-tenant-a");
+    TenantId other = TenantRegistry::Intern("throttle-tenant-b");
+    EXPECT_FALSE(throttle.isThrottled(throttled));
+    EXPECT_THAT(throttle.getTimeToRelease().count(), -1);
+
+    HttpHeaders headers;
+    EXPECT_FALSE(throttle.handleResponse(headers, { { 1, throttled } }));
+    headers.set("Retry-After", "30");
+    EXPECT_TRUE(throttle.handleResponse(headers, { { 1, throttled }, { 2, throttled } }));
+
+    EXPECT_TRUE(throttle.isThrottled(throttled));
+    EXPECT_FALSE(throttle.isThrottled(other));
+    EXPECT_THAT(throttle.getThrottledTenants(), ElementsAre(throttled));
+    EXPECT_THAT(throttle.getTimeToRelease().count(), AllOf(Gt(25000), Le(30000)));
+}
+
+TEST(TenantThrottleTests, ReleasesTenantOnExpiry)
+{
+    TenantThrottle throttle;
+    TenantId tenant = TenantRegistry::Intern("throttle-tenant-a");
+    throttle.throttle(tenant, std::chrono::milliseconds { 20 });
+    // A shorter throttle does not cut the running one
+    throttle.throttle(tenant, std::chrono::milliseconds { 1 });
+    EXPECT_TRUE(throttle.isThrottled(tenant));
+
+    PAL::sleep(50);
+    EXPECT_THAT(throttle.getTimeToRelease().count(), 0);
+    EXPECT_FALSE(throttle.isThrottled(tenant));
+    EXPECT_THAT(throttle.getThrottledTenants(), IsEmpty());
+    EXPECT_THAT(throttle.getTimeToRelease().count(), -1);
+}
@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/TimerQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <random>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    Task* makeTimedTask(uint64_t targetTime)
+    {
+        Task* task = new Task();
+        task->Type = Task::TimedCall;
+        task->TargetTime = targetTime;
+        return task;
+    }
+
+    /// Sorted list used by WorkerThread before the heap, kept as a baseline
+    class SortedListTimerQueue
+    {
+      public:
+        std::list<Task*> items;
+
+        void push(Task* task)
+        {
+            auto it = items.begin();
+            while (it != items.end() && (*it)->TargetTime < task->TargetTime)
+            {
+                ++it;
+            }
+            items.insert(it, task);
+        }
+
+        bool erase(Task* task)
+        {
+            auto it = std::find(items.begin(), items.end(), task);
+            if (it == items.end())
+            {
+                return false;
+            }
+            items.erase(it);
+            return true;
+        }
+
+        Task* front() const { return items.front(); }
+        void pop_front() { items.pop_front(); }
+        bool empty() const { return items.empty(); }
+    };
+
+    /// Schedule everything, cancel every other task (the TPM / storage flush
+    /// reschedule pattern), then drain the rest in order.
+    template <typename TQueue>
+    double runScheduleCancelDrain(std::vector<Task*> const& tasks)
+    {
+        TQueue queue;
+        auto start = std::chrono::steady_clock::now();
+        for (Task* task : tasks)
+        {
+            queue.push(task);
+        }
+        for (size_t i = 0; i < tasks.size(); i += 2)
+        {
+            queue.erase(tasks[i]);
+        }
+        while (!queue.empty())
+        {
+            queue.pop_front();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+}
+
+TEST(TimerQueueTests, PopsInTargetTimeOrder)
+{
+    PAL::TimerQueue queue;
+    std::vector<std::unique_ptr<Task>> tasks;
+    for (uint64_t t : { 50, 10, 40, 20, 30 })
+    {
+        tasks.emplace_back(makeTimedTask(t));
+        queue.push(tasks.back().get());
+    }
+
+    std::vector<uint64_t> order;
+    while (!queue.empty())
+    {
+        order.push_back(queue.front()->TargetTime);
+        queue.pop_front();
+    }
+    EXPECT_THAT(order, ElementsAre(10, 20, 30, 40, 50));
+}
+
+TEST(TimerQueueTests, EqualTargetTimesKeepQueueOrder)
+{
+    PAL::TimerQueue queue;
+    std::vector<std::unique_ptr<Task>> tasks;
+    for (int i = 0; i < 8; i++)
+    {
+        tasks.emplace_back(makeTimedTask(100));
+        queue.push(tasks.back().get());
+    }
+
+    for (auto const& task : tasks)
+    {
+        ASSERT_FALSE(queue.empty());
+        EXPECT_THAT(queue.front(), Eq(task.get()));
+        queue.pop_front();
+    }
+}
+
+TEST(TimerQueueTests, EraseRemovesOnlyThatTask)
+{
+    PAL::TimerQueue queue;
+    std::vector<std::unique_ptr<Task>> tasks;
+    for (uint64_t t = 0; t < 100; t++)
+    {
+        tasks.emplace_back(makeTimedTask((t * 37) % 100));
+        queue.push(tasks.back().get());
+    }
+
+    // Erase from the root, a leaf and somewhere in between
+    Task* root = queue.front();
+    EXPECT_TRUE(queue.erase(root));
+    EXPECT_FALSE(queue.erase(root));
+    EXPECT_FALSE(queue.contains(root));
+    EXPECT_TRUE(queue.erase(tasks[99].get()));
+    EXPECT_TRUE(queue.erase(tasks[50].get()));
+    EXPECT_THAT(queue.size(), Eq(size_t { 97 }));
+
+    uint64_t last = 0;
+    while (!queue.empty())
+    {
+        Task* task = queue.front();
+        EXPECT_THAT(task->TargetTime, Ge(last));
+        EXPECT_THAT(task, Ne(root));
+        EXPECT_THAT(task, Ne(tasks[99].get()));
+        EXPECT_THAT(task, Ne(tasks[50].get()));
+        last = task->TargetTime;
+        queue.pop_front();
+    }
+}
+
+// Microbenchmark, run with --gtest_also_run_disabled_tests. Timings go to
+// the test properties of the XML report.
+TEST(TimerQueueTests, DISABLED_ScheduleCancelThroughputVsSortedList)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint64_t> delay(0, 60 * 60 * 1000);
+
+    for (size_t count : { 1000, 10000 })
+    {
+        std::vector<std::unique_ptr<Task>> owned;
+        std::vector<Task*> tasks;
+        for (size_t i = 0; i < count; i++)
+        {
+            owned.emplace_back(makeTimedTask(delay(rng)));
+            tasks.push_back(owned.back().get());
+        }
+
+        double heapMs = runScheduleCancelDrain<PAL::TimerQueue>(tasks);
+        double listMs = runScheduleCancelDrain<SortedListTimerQueue>(tasks);
+        std::string timers = "Timers" + std::to_string(count);
+        RecordProperty(timers + "HeapMs", std::to_string(heapMs));
+        RecordProperty(timers + "SortedListMs", std::to_string(listMs));
+    }
+}
@@ -8,6 +8,7 @@
 #include "common/Common.hpp"
 #include "common/MockIRuntimeConfig.hpp"
 #include "common/MockIBandwidthController.hpp"
+#include "common/MockITelemetrySystem.hpp"
 #include "tpm/TransmissionPolicyManager.hpp"
 #include "TransmitProfiles.hpp"
 
@@ -37,22 +38,22 @@ class TransmissionPolicyManager4Test : public TransmissionPolicyManager {
     using TransmissionPolicyManager::removeUpload;
     using TransmissionPolicyManager::getCancelWaitTime;
     using TransmissionPolicyManager::cancelUploadTask;
+    using TransmissionPolicyManager::uploadCount;
 
-    using TransmissionPolicyManager::m_backoff;
     using TransmissionPolicyManager::m_isPaused;
     using TransmissionPolicyManager::m_scheduledUploadAborted;
-    using TransmissionPolicyManager::m_isUploadScheduled;
-    using TransmissionPolicyManager::m_scheduledUploadTime;
-    using TransmissionPolicyManager::m_timerdelay;
-    using TransmissionPolicyManager::m_runningLatency;
+    using TransmissionPolicyManager::m_normalLane;
+    using TransmissionPolicyManager::m_realTimeLane;
     using TransmissionPolicyManager::m_backoffConfig;
+    using TransmissionPolicyManager::m_adaptiveUpload;
+    using TransmissionPolicyManager::m_uploadController;
 
     MOCK_METHOD3(scheduleUpload, void(const std::chrono::milliseconds&, EventLatency,bool));
     MOCK_METHOD1(uploadAsync, void(EventLatency));
     MOCK_METHOD0(handleStop, bool());
 
-    bool uploadScheduled() const { return m_isUploadScheduled; }
-    void uploadScheduled(bool state) { m_isUploadScheduled = state; }
+    bool uploadScheduled() const { return m_normalLane.isUploadScheduled || m_realTimeLane.isUploadScheduled; }
+    void uploadScheduled(bool state) { m_normalLane.isUploadScheduled = state; m_realTimeLane.isUploadScheduled = state; }
 
     std::set<EventsUploadContextPtr> const& activeUploads() const { return m_activeUploads; }
     EventsUploadContextPtr fakeActiveUpload() { auto ctx = std::make_shared<EventsUploadContext>(); ctx->requestedMinLatency = EventLatency_RealTime; m_activeUploads.insert(ctx); return ctx; }
@@ -61,8 +62,6 @@ class TransmissionPolicyManager4Test : public TransmissionPolicyManager {
     bool paused() const { return m_isPaused; }
     void paused(bool state) { m_isPaused = state; }
 
-    void runningLatency(EventLatency latency) { m_runningLatency = latency; }
-
     void NotMockScheduleUpload(const std::chrono::milliseconds& delay, EventLatency latency, bool force)
     {
         TransmissionPolicyManager::scheduleUpload(delay, latency, force);
@@ -177,10 +176,18 @@ TEST_F(TransmissionPolicyManagerTests, IncomingEventSchedulesUpload)
     auto event = new IncomingEventContext();
     event->record.latency = EventLatency_Normal;
 
-    
-    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds { 1000 }, EventLatency_Normal, true))
+    // Normal lane runs on the first timer of the profile
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds { 4000 }, EventLatency_Normal, true))
+        .WillOnce(Return());
+    tpm.eventArrived(event);
+
+    // RealTime lane on the last one
+    event = new IncomingEventContext();
+    event->record.latency = EventLatency_RealTime;
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds { 1000 }, EventLatency_RealTime, false))
         .WillOnce(Return());
     tpm.eventArrived(event);
+    TransmitProfiles::reset();
 }
 
 TEST_F(TransmissionPolicyManagerTests, ProfileAffectsSchedule)
@@ -282,7 +289,7 @@ TEST_F(TransmissionPolicyManagerTests, UploadPostponedWithInsufficientAvailableB
 
 TEST_F(TransmissionPolicyManagerTests, UploadInitiatesUpload)
 {
-    tpm.uploadScheduled(true);
+    tpm.m_normalLane.isUploadScheduled = true;
     tpm.paused(false);
 
     EventsUploadContextPtr upload;
@@ -303,13 +310,12 @@ TEST_F(TransmissionPolicyManagerTests, EmptyUploadCeasesUploadingForRunningLaten
     tpm.nothingToUpload(upload);
 }
 
-TEST_F(TransmissionPolicyManagerTests, EmptyUploadReschedulesAtTimerDelayForRunningLatencyRealtime)
+TEST_F(TransmissionPolicyManagerTests, EmptyUploadReschedulesAtTimerDelayForLaneRealtime)
 {
     auto upload = tpm.fakeActiveUpload();
     constexpr std::chrono::milliseconds delay { std::chrono::seconds(300) };
-    tpm.m_timerdelay = delay;
-    tpm.runningLatency(EventLatency_RealTime);
-    EXPECT_CALL(tpm, scheduleUpload(delay, EventLatency_Normal, false))
+    tpm.m_realTimeLane.timerDelay = delay;
+    EXPECT_CALL(tpm, scheduleUpload(delay, EventLatency_RealTime, false))
       .WillOnce(Return());
     tpm.nothingToUpload(upload);
 }
@@ -317,7 +323,7 @@ TEST_F(TransmissionPolicyManagerTests, EmptyUploadReschedulesAtTimerDelayForRunn
 TEST_F(TransmissionPolicyManagerTests, FailedUploadPackagingSchedulesNextOneWithDelay)
 {
     auto upload = tpm.fakeActiveUpload();
-    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{ 2000 }, EventLatency_Normal, false))
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{ 2000 }, EventLatency_RealTime, false))
         .WillOnce(Return());
     tpm.packagingFailed(upload);
 }
@@ -325,7 +331,7 @@ TEST_F(TransmissionPolicyManagerTests, FailedUploadPackagingSchedulesNextOneWith
 TEST_F(TransmissionPolicyManagerTests, SuccessfulUploadSchedulesNextOneImmediately)
 {
     auto upload = tpm.fakeActiveUpload();
-    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{ 0 }, EventLatency_Normal, false))
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{ 0 }, EventLatency_RealTime, false))
         .WillOnce(Return());
     tpm.eventsUploadSuccessful(upload);
 }
@@ -452,7 +458,7 @@ TEST_F(TransmissionPolicyManagerTests, FinishAllUploads)
         .WillOnce(Return());
     tpm.start();
 
-    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds { 0 }, EventLatency_Normal, false))
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds { 0 }, EventLatency_RealTime, false))
         .Times(2)
         .WillOnce(Return())
         .WillOnce(Return());
@@ -505,7 +511,7 @@ TEST_F(TransmissionPolicyManagerTests, Constructor_IsPaused_True)
 
 TEST_F(TransmissionPolicyManagerTests, Constructor_IsUploadScheduled_False)
 {
-    ASSERT_FALSE(tpm.m_isUploadScheduled);
+    ASSERT_FALSE(tpm.uploadScheduled());
 }
 
 TEST_F(TransmissionPolicyManagerTests, Constructor_ScheduledUploadAborted_False)
@@ -515,22 +521,29 @@ TEST_F(TransmissionPolicyManagerTests, Constructor_ScheduledUploadAborted_False)
 
 TEST_F(TransmissionPolicyManagerTests, Constructor_ScheduledUploadTime_Uint64Max)
 {
-    ASSERT_EQ(tpm.m_scheduledUploadTime, std::numeric_limits<uint64_t>::max());
+    ASSERT_EQ(tpm.m_normalLane.scheduledUploadTime, std::numeric_limits<uint64_t>::max());
+    ASSERT_EQ(tpm.m_realTimeLane.scheduledUploadTime, std::numeric_limits<uint64_t>::max());
 }
 
 TEST_F(TransmissionPolicyManagerTests, Constructor_TimerDelay_TwoSeconds)
 {
-    ASSERT_EQ(tpm.m_timerdelay, std::chrono::seconds{ 2 });
+    ASSERT_EQ(tpm.m_realTimeLane.timerDelay, std::chrono::seconds{ 2 });
 }
 
 TEST_F(TransmissionPolicyManagerTests, Constructor_TimerDelayInteger_TwoThousand)
 {
-    ASSERT_EQ(tpm.m_timerdelay.count(), 2000);
+    ASSERT_EQ(tpm.m_realTimeLane.timerDelay.count(), 2000);
 }
 
-TEST_F(TransmissionPolicyManagerTests, Constructor_RunningLatency_RealTime)
+TEST_F(TransmissionPolicyManagerTests, Constructor_NormalLaneTimerDelay_FourSeconds)
 {
-    ASSERT_EQ(tpm.m_runningLatency, EventLatency_RealTime);
+    ASSERT_EQ(tpm.m_normalLane.timerDelay, std::chrono::seconds{ 4 });
+}
+
+TEST_F(TransmissionPolicyManagerTests, Constructor_LaneLatencies_NormalAndRealTime)
+{
+    ASSERT_EQ(tpm.m_normalLane.latency, EventLatency_Normal);
+    ASSERT_EQ(tpm.m_realTimeLane.latency, EventLatency_RealTime);
 }
 
 TEST_F(TransmissionPolicyManagerTests, Constructor_BackoffConfig_RealTime)
@@ -603,24 +616,274 @@ TEST_F(TransmissionPolicyManagerTests, cancelUploadTask_ScheduledUpload_ReturnsT
 
 TEST_F(TransmissionPolicyManagerTests, cancelUploadTask_ScheduledUpload_IsUploadScheduledSetToFalse)
 {
-    tpm.m_isUploadScheduled = true;
+    tpm.uploadScheduled(true);
     tpm.cancelUploadTask();
-    ASSERT_FALSE(tpm.m_isUploadScheduled);
+    ASSERT_FALSE(tpm.uploadScheduled());
 }
 
 TEST_F(TransmissionPolicyManagerTests, increaseBackoff_EmptyBackoffObject_ReturnZero)
 {
-    tpm.m_backoff = nullptr;
-    ASSERT_EQ(tpm.increaseBackoff(), std::chrono::milliseconds{});
+    tpm.m_normalLane.backoff = nullptr;
+    ASSERT_EQ(tpm.increaseBackoff(tpm.m_normalLane), std::chrono::milliseconds{});
 }
 
 TEST_F(TransmissionPolicyManagerTests, increaseBackoff_ValidBackoffObject_ReturnsGreaterThanZero)
 {
-    ASSERT_GT(tpm.increaseBackoff(), std::chrono::milliseconds{});
+    ASSERT_GT(tpm.increaseBackoff(tpm.m_normalLane), std::chrono::milliseconds{});
 }
 
 TEST_F(TransmissionPolicyManagerTests, increaseBackoff_CalledTwice_ReturnsHigherValue)
 {
-    auto first = tpm.increaseBackoff();
-    ASSERT_GT(tpm.increaseBackoff(), first);
+    auto first = tpm.increaseBackoff(tpm.m_normalLane);
+    ASSERT_GT(tpm.increaseBackoff(tpm.m_normalLane), first);
+}
+
+TEST_F(TransmissionPolicyManagerTests, increaseBackoff_OtherLane_Unaffected)
+{
+    tpm.increaseBackoff(tpm.m_normalLane);
+    auto second = tpm.increaseBackoff(tpm.m_normalLane);
+    // Still the first, jittered step
+    ASSERT_LE(tpm.increaseBackoff(tpm.m_realTimeLane), second);
+}
+
+TEST_F(TransmissionPolicyManagerTests, FailedNormalUploadBacksOffNormalLaneOnly)
+{
+    auto normal = tpm.fakeActiveUpload(EventLatency_Normal);
+    auto realTime = tpm.fakeActiveUpload(EventLatency_RealTime);
+
+    EXPECT_CALL(tpm, scheduleUpload(Gt(std::chrono::milliseconds{}), EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.eventsUploadFailed(normal);
+
+    // RealTime lane keeps uploading right away
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds{}, EventLatency_RealTime, false))
+        .WillOnce(Return());
+    tpm.eventsUploadSuccessful(realTime);
+}
+
+// Slow local server: uploads are packaged and handed over, but no response
+// comes back until the test completes them
+class TransmissionPolicyManagerSlowServerTests : public TransmissionPolicyManagerTests {
+  protected:
+    std::mutex                          uploadsLock;
+    std::vector<EventsUploadContextPtr> uploads;
+
+    virtual void SetUp() override
+    {
+        TransmissionPolicyManagerTests::SetUp();
+        TransmitProfiles::reset();
+        tpm.paused(false);
+        ON_CALL(tpm, scheduleUpload(_, _, _))
+            .WillByDefault(Invoke(&tpm, &TransmissionPolicyManager4Test::NotMockScheduleUpload));
+        EXPECT_CALL(tpm, scheduleUpload(_, _, _)).Times(AnyNumber());
+        EXPECT_CALL(tpm, uploadAsync(_)).Times(AnyNumber());
+    }
+
+    virtual void TearDown() override
+    {
+        // Server finally answers
+        std::vector<EventsUploadContextPtr> pending;
+        {
+            std::lock_guard<std::mutex> lock(uploadsLock);
+            pending.swap(uploads);
+        }
+        for (auto const& ctx : pending) {
+            tpm.eventsUploadAborted(ctx);
+        }
+        EXPECT_CALL(*this, resultAllUploadsFinished()).WillOnce(Return());
+        tpm.stop();
+    }
+
+    // Packages the upload and keeps it waiting for the server
+    void sendToSlowServer(EventsUploadContextPtr const& ctx, bool packageFull)
+    {
+        ctx->packageFull = packageFull;
+        std::lock_guard<std::mutex> lock(uploadsLock);
+        uploads.push_back(ctx);
+    }
+
+    size_t waitForUploads(size_t count)
+    {
+        for (int i = 0; i < 200 && tpm.uploadCount() < count; i++) {
+            PAL::sleep(10);
+        }
+        return tpm.uploadCount();
+    }
+
+    std::vector<EventLatency> uploadLatencies()
+    {
+        std::lock_guard<std::mutex> lock(uploadsLock);
+        std::vector<EventLatency> result;
+        for (auto const& ctx : uploads) {
+            result.push_back(ctx->requestedMinLatency);
+        }
+        return result;
+    }
+};
+
+TEST_F(TransmissionPolicyManagerSlowServerTests, SlowNormalUploadsDoNotBlockRealTimeLane)
+{
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillRepeatedly(Invoke([this](EventsUploadContextPtr const& ctx) { sendToSlowServer(ctx, false); }));
+
+    // Normal lane fills its window of two and waits for the server
+    tpm.uploadAsyncParent(EventLatency_Normal);
+    tpm.uploadAsyncParent(EventLatency_Normal);
+    tpm.NotMockScheduleUpload(std::chrono::milliseconds{}, EventLatency_Normal, false);
+    EXPECT_FALSE(tpm.m_normalLane.isUploadScheduled);
+
+    // RealTime lane still gets its upload out
+    tpm.NotMockScheduleUpload(std::chrono::milliseconds{}, EventLatency_RealTime, false);
+    EXPECT_THAT(waitForUploads(3), 3u);
+    EXPECT_THAT(uploadLatencies(), ElementsAre(EventLatency_Normal, EventLatency_Normal, EventLatency_RealTime));
+}
+
+TEST_F(TransmissionPolicyManagerSlowServerTests, FullPackagePipelinesNextBatchUpToLaneWindow)
+{
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillRepeatedly(Invoke([this](EventsUploadContextPtr const& ctx) { sendToSlowServer(ctx, true); }));
+
+    // Backlog of full packages: the next batch is packaged while the first is in flight
+    tpm.uploadAsyncParent(EventLatency_RealTime);
+    EXPECT_THAT(waitForUploads(2), 2u);
+
+    // Window of two reached, nothing more until the server answers
+    PAL::sleep(100);
+    EXPECT_THAT(tpm.uploadCount(), 2u);
+    EXPECT_FALSE(tpm.m_realTimeLane.isUploadScheduled);
+    EXPECT_THAT(uploadLatencies(), ElementsAre(EventLatency_RealTime, EventLatency_RealTime));
+}
+
+TEST_F(TransmissionPolicyManagerSlowServerTests, PartialPackageDoesNotPipeline)
+{
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillRepeatedly(Invoke([this](EventsUploadContextPtr const& ctx) { sendToSlowServer(ctx, false); }));
+
+    tpm.uploadAsyncParent(EventLatency_RealTime);
+    PAL::sleep(100);
+    EXPECT_THAT(tpm.uploadCount(), 1u);
+    EXPECT_FALSE(tpm.uploadScheduled());
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUpload_Off_LeavesUploadSizeToPackager)
+{
+    tpm.paused(false);
+    tpm.m_uploadController.onUploadFailed();
+
+    EventsUploadContextPtr upload;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillOnce(SaveArg<0>(&upload));
+    tpm.uploadAsync(EventLatency_Normal);
+    ASSERT_THAT(upload, NotNull());
+    EXPECT_THAT(upload->maxUploadSize, 0u);
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUpload_UploadUsesControllerSize)
+{
+    tpm.paused(false);
+    tpm.m_adaptiveUpload = true;
+    tpm.m_uploadController.onUploadFailed();
+
+    EventsUploadContextPtr upload;
+    EXPECT_CALL(*this, resultInitiateUpload(_))
+        .WillOnce(SaveArg<0>(&upload));
+    tpm.uploadAsync(EventLatency_Normal);
+    ASSERT_THAT(upload, NotNull());
+    EXPECT_THAT(upload->maxUploadSize, tpm.m_uploadController.getUploadSize());
+    EXPECT_THAT(upload->maxUploadSize, Lt(testing::getSystem().getConfig().GetMaximumUploadSizeBytes()));
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUpload_ThrottledUploadStretchesTimersAndReportsState)
+{
+    auto& system = static_cast<MockITelemetrySystem&>(testing::getSystem());
+    tpm.m_adaptiveUpload = true;
+    tpm.m_realTimeLane.timerDelay = std::chrono::milliseconds { 2000 };
+
+    auto upload = tpm.fakeActiveUpload(EventLatency_RealTime);
+    auto response = new SimpleHttpResponse("throttled");
+    response->m_result = HttpResult_OK;
+    response->m_statusCode = 429;
+    upload->httpResponse = response;
+
+    EXPECT_CALL(system, DispatchEvent(AllOf(
+            Field(&DebugEvent::type, EVT_UPLOAD_CONTROL),
+            Field(&DebugEvent::param2, Gt(100u)),
+            Field(&DebugEvent::size, sizeof(UploadControlState)))))
+        .WillOnce(Return(true));
+    EXPECT_CALL(tpm, scheduleUpload(_, EventLatency_RealTime, false))
+        .WillOnce(Return());
+    tpm.eventsUploadFailed(upload);
+    Mock::VerifyAndClearExpectations(&system);
+
+    auto next = tpm.fakeActiveUpload(EventLatency_RealTime);
+    EXPECT_CALL(tpm, scheduleUpload(Gt(std::chrono::milliseconds { 2000 }), EventLatency_RealTime, false))
+        .WillOnce(Return());
+    tpm.packagingFailed(next);
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUpload_SuccessfulUploadFeedsController)
+{
+    auto& system = static_cast<MockITelemetrySystem&>(testing::getSystem());
+    tpm.m_adaptiveUpload = true;
+
+    auto upload = tpm.fakeActiveUpload(EventLatency_Normal);
+    upload->packageSize = 400000;
+    upload->bodySize = 100000;
+    upload->durationMs = 10000;
+
+    EXPECT_CALL(system, DispatchEvent(AllOf(
+            Field(&DebugEvent::type, EVT_UPLOAD_CONTROL),
+            Field(&DebugEvent::param1, Lt(2097152u)))))
+        .WillOnce(Return(true));
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds {}, EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.eventsUploadSuccessful(upload);
+    Mock::VerifyAndClearExpectations(&system);
+
+    UploadControlState state = tpm.m_uploadController.getState();
+    EXPECT_THAT(state.rttMs, 10000u);
+    EXPECT_THAT(state.throughputBytesPerSec, 10000u);
+    EXPECT_THAT(state.compressionPercent, 25u);
+}
+
+TEST_F(TransmissionPolicyManagerTests, RetryAfter_ThrottlesTenantsInsteadOfBackingOff)
+{
+    TenantThrottle throttle;
+    tpm.SetTenantThrottle(&throttle);
+    tpm.m_normalLane.timerDelay = std::chrono::milliseconds { 1000000 };
+
+    TenantId throttled = TenantRegistry::Intern("tpm-retry-after-tenant");
+    auto upload = tpm.fakeActiveUpload(EventLatency_Normal);
+    upload->recordIdsAndTenantIds[1] = throttled;
+    auto response = new SimpleHttpResponse("throttled");
+    response->m_result = HttpResult_OK;
+    response->m_statusCode = 429;
+    response->m_headers.set("Retry-After", "120");
+    upload->httpResponse = response;
+
+    // The lane keeps its timer, only the tenant of the upload waits
+    EXPECT_CALL(tpm, scheduleUpload(std::chrono::milliseconds { 1000000 }, EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.eventsUploadFailed(upload);
+    EXPECT_TRUE(throttle.isThrottled(throttled));
+    EXPECT_FALSE(throttle.isThrottled(TenantRegistry::Intern("tpm-other-tenant")));
+
+    // Without Retry-After the lane still backs off
+    auto next = tpm.fakeActiveUpload(EventLatency_Normal);
+    next->httpResponse = new SimpleHttpResponse("failed");
+    EXPECT_CALL(tpm, scheduleUpload(Le(std::chrono::milliseconds { 300000 }), EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.eventsUploadFailed(next);
+}
+
+TEST_F(TransmissionPolicyManagerTests, RetryAfter_NothingToUploadWaitsForRelease)
+{
+    TenantThrottle throttle;
+    tpm.SetTenantThrottle(&throttle);
+    throttle.throttle(TenantRegistry::Intern("tpm-retry-after-tenant"), std::chrono::seconds { 60 });
+
+    auto upload = tpm.fakeActiveUpload(EventLatency_Normal);
+    EXPECT_CALL(tpm, scheduleUpload(AllOf(Gt(std::chrono::seconds { 50 }), Le(std::chrono::seconds { 60 })), EventLatency_Normal, false))
+        .WillOnce(Return());
+    tpm.nothingToUpload(upload);
 }
@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/TaskDispatcher.hpp"
+
+#include <atomic>
+#include <vector>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    class Component
+    {
+      public:
+        std::mutex        lock;
+        std::vector<int>  order;
+        std::atomic<int>  running{0};
+        std::atomic<int>  maxRunning{0};
+        std::atomic<bool> cancelled{false};
+        PAL::Event        release;
+
+        void record(int value)
+        {
+            int now = ++running;
+            int seen = maxRunning;
+            while (now > seen && !maxRunning.compare_exchange_weak(seen, now))
+            {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                order.push_back(value);
+            }
+            --running;
+        }
+
+        void waitForRelease()
+        {
+            release.wait(5000);
+        }
+
+        void releaseOther(Component* other)
+        {
+            other->release.post();
+        }
+
+        void cancel(PAL::DeferredCallbackHandle* handle)
+        {
+            cancelled = handle->Cancel();
+        }
+    };
+
+    bool waitFor(std::function<bool()> const& condition)
+    {
+        for (int i = 0; i < 500 && !condition(); i++)
+        {
+            PAL::sleep(10);
+        }
+        return condition();
+    }
+
+}
+
+TEST(WorkerThreadPoolTests, TasksOfOneComponentRunInOrder)
+{
+    auto pool = PAL::WorkerThreadPoolFactory::Create(4);
+    Component component;
+    for (int i = 0; i < 50; i++)
+    {
+        PAL::dispatchTask(pool.get(), &component, &Component::record, i);
+    }
+    ASSERT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> guard(component.lock); return component.order.size() == 50; }));
+    pool->Join();
+
+    EXPECT_THAT(component.maxRunning.load(), Eq(1));
+    for (int i = 0; i < 50; i++)
+    {
+        EXPECT_THAT(component.order[i], Eq(i));
+    }
+}
+
+TEST(WorkerThreadPoolTests, DifferentComponentsRunInParallel)
+{
+    auto pool = PAL::WorkerThreadPoolFactory::Create(2);
+    Component storage;
+    Component http;
+
+    // storage blocks until http runs, which only works with two threads
+    PAL::dispatchTask(pool.get(), &storage, &Component::waitForRelease);
+    PAL::dispatchTask(pool.get(), &http, &Component::releaseOther, &storage);
+    PAL::dispatchTask(pool.get(), &storage, &Component::record, 1);
+
+    EXPECT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> guard(storage.lock); return storage.order.size() == 1; }));
+    EXPECT_TRUE(storage.release.IsSet());
+    pool->Join();
+}
+
+TEST(WorkerThreadPoolTests, TimedTasksRunAfterDelayAndCanBeCancelled)
+{
+    auto pool = PAL::WorkerThreadPoolFactory::Create(2);
+    Component component;
+
+    auto start = PAL::getMonotonicTimeMs();
+    PAL::scheduleTask(pool.get(), 100, &component, &Component::record, 1);
+    PAL::DeferredCallbackHandle cancelled = PAL::scheduleTask(pool.get(), 50, &component, &Component::record, 2);
+    EXPECT_TRUE(cancelled.Cancel());
+
+    ASSERT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> guard(component.lock); return !component.order.empty(); }));
+    EXPECT_THAT(PAL::getMonotonicTimeMs() - start, Ge(100u));
+    PAL::sleep(100);
+    pool->Join();
+    EXPECT_THAT(component.order, ElementsAre(1));
+}
+
+TEST(WorkerThreadPoolTests, CancellingTheOnlyTaskOfAReadyLaneDropsTheLane)
+{
+    auto pool = PAL::WorkerThreadPoolFactory::Create(1);
+    Component blocker;
+    Component timed;
+
+    // The only thread is busy while the timed task comes due, then runs the
+    // cancelling task while the timed task waits in its ready lane
+    PAL::dispatchTask(pool.get(), &blocker, &Component::waitForRelease);
+    PAL::DeferredCallbackHandle handle = PAL::scheduleTask(pool.get(), 20, &timed, &Component::record, 1);
+    PAL::dispatchTask(pool.get(), &blocker, &Component::cancel, &handle);
+    PAL::sleep(100);
+    blocker.release.post();
+
+    ASSERT_TRUE(waitFor([&]() { return blocker.cancelled.load(); }));
+    PAL::dispatchTask(pool.get(), &timed, &Component::record, 2);
+    ASSERT_TRUE(waitFor([&]() { std::lock_guard<std::mutex> guard(timed.lock); return !timed.order.empty(); }));
+    pool->Join();
+    EXPECT_THAT(timed.order, ElementsAre(2));
+}